@@ -13,6 +13,8 @@
 //  - by polling (in buttons_task() function which should be called periodically from application loop)
 //  - directly from ISR context (in buttons_isr() function)
 //
+// Counters of raw edges and events after filtering are available over buttons_get_stats()
+//
 // All functions are reenterable:
 //  - driver doesn't use internal static data
 //  - driver's instance and table of buttons are supposed to be stored externally
@@ -95,14 +97,22 @@ extern "C" {
 //==================================================================================================
 
 //------------------------------------------------------------------------------
-// Size of hidden structure buttons_button_t
+// Size of hidden structure buttons_button_t (32-bit / 64-bit platforms)
 //------------------------------------------------------------------------------
+#if (UINTPTR_MAX == UINT32_MAX)
 #define BUTTONS_SINGLE_BUTTON_INSTANCE_SIZE (28)
+#else
+#define BUTTONS_SINGLE_BUTTON_INSTANCE_SIZE (40)
+#endif
 
 //------------------------------------------------------------------------------
-// Size of hidden structure buttons_t
+// Size of hidden structure buttons_t (32-bit / 64-bit platforms)
 //------------------------------------------------------------------------------
-#define BUTTONS_DRIVER_INSTANCE_SIZE (16)
+#if (UINTPTR_MAX == UINT32_MAX)
+#define BUTTONS_DRIVER_INSTANCE_SIZE (32 + (8 * DRV_PROF) + (4 * DRV_TRACE))
+#else
+#define BUTTONS_DRIVER_INSTANCE_SIZE (48 + (16 * DRV_PROF) + (8 * DRV_TRACE))
+#endif
 
 //==================================================================================================
 //========================================== TYPEDEFS ==============================================
@@ -165,6 +175,15 @@ typedef struct buttons_hw_interface_s {
     buttons_gpio_read_cb_t      gpio_read;      // Read hardware GPIO state
 } buttons_hw_interface_t;
 
+//------------------------------------------------------------------------------
+// Counters of driver activity (wrap around at 2^32)
+// Difference between edges and events shows how much bouncing is filtered
+//------------------------------------------------------------------------------
+typedef struct buttons_stats_s {
+    uint32_t    edges;          // number of raw edges before bouncing filter (from polling and ISR)
+    uint32_t    events;         // number of non-empty events passed to handlers (several flags of one call are one event)
+} buttons_stats_t;
+
 //------------------------------------------------------------------------------
 // Time settings
 // `bouncing_ms`    - bouncing filter time in milliseconds (if 0 - bouncing filter is disabled)
@@ -274,6 +293,53 @@ void buttons_task(const buttons_t * inst_p);
 //------------------------------------------------------------------------------
 void buttons_isr(const buttons_t * inst_p, uint32_t idx, bool gpio_state);
 
+//------------------------------------------------------------------------------
+// Check if buttons can be left without buttons_task() calls until the next interrupt
+//
+// Buttons are idle if there are no buttons checked in polling and no unprocessed changes from buttons_isr()
+// Timeouts of buttons are measured by software timers, so swtimers_next_expiry_ticks() covers them
+// Doesn't scan the table of buttons
+//
+// `inst_p` - pointer to initialized driver instance
+//
+// Returns - 'true' if only an interrupt can produce new work for buttons_task(), 'false' otherwise
+//------------------------------------------------------------------------------
+bool buttons_is_idle(const buttons_t * inst_p);
+
+//------------------------------------------------------------------------------
+// Get counters of driver activity
+//
+// Snapshot and reset are done in critical section (edges are counted in buttons_isr() too)
+//
+// `inst_p`      - pointer to initialized driver instance
+// `stats_out_p` - out - snapshot of counters since init or the previous reset
+// `is_reset`    - 'true' - clear counters after taking snapshot
+//------------------------------------------------------------------------------
+void buttons_get_stats(const buttons_t * inst_p, buttons_stats_t * stats_out_p, bool is_reset);
+
+#if (DRV_TRACE == 1)
+//------------------------------------------------------------------------------
+// Attach trace of raw edges and events (see drv_trace.h)
+//
+// `inst_p`  - pointer to initialized driver instance
+// `trace_p` - pointer to initialized trace instance (can be NULL to detach)
+//------------------------------------------------------------------------------
+void buttons_set_trace(const buttons_t * inst_p, const trace_t * trace_p);
+#endif
+
+#if (DRV_PROF == 1)
+//------------------------------------------------------------------------------
+// Attach profiling statistics of buttons_task() (see drv_prof.h)
+//
+// Statistics are updated from application loop, button handlers are included
+//
+// `inst_p`    - pointer to initialized driver instance
+// `cycles_cb` - read cycle counter (can be NULL to detach)
+// `stats_p`   - pointer to zero-initialized statistics (can be NULL to detach)
+//------------------------------------------------------------------------------
+void buttons_set_prof(const buttons_t * inst_p, prof_cycles_cb_t cycles_cb, prof_stats_t * stats_p);
+#endif
+
 //==================================================================================================
 //============================================ TESTS ===============================================
 //==================================================================================================
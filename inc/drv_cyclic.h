@@ -0,0 +1,200 @@
+//**************************************************************************************************
+// Cyclic executive - time-triggered activation of periodic tasks
+//**************************************************************************************************
+// Depends on drv_swtimers:
+//  - swtimers driver should be initialized before any usage of this driver
+//  - swtimers_isr() should be called periodically from ISR context
+//  - cyclic executive occupies one software timer (periodic, called from ISR)
+//
+// Schedule is calculated once at initialization from a constant table of tasks:
+//  - minor frame  - greatest common divisor of all periods and offsets
+//  - hyperperiod  - least common multiple of all periods
+//  - frames table - mask of tasks released at the beginning of each minor frame
+//
+// Each tick of the executive's timer (one minor frame) costs one lookup in the frames table,
+// tasks are called from cyclic_task() in the order of the tasks table
+// All tasks of a frame must be finished before the next frame, otherwise frame overrun is reported
+//
+// All functions are reenterable:
+//  - driver doesn't use internal static data
+//  - driver's instance, table of tasks and table of frames are supposed to be stored externally
+//
+//**************************************************************************************************
+// Example
+//**************************************************************************************************
+// Tasks: A - period 10 ms, offset 0 ms; B - period 20 ms, offset 5 ms
+// Minor frame = 5 ms, hyperperiod = 20 ms, 4 frames
+//
+//  frame:   0       1       2       3       0
+//           |-------|-------|-------|-------|- _ _
+//  tasks:   A       B       A               A
+//
+//**************************************************************************************************
+#ifndef DRV_CYCLIC_H
+#define DRV_CYCLIC_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "drv_swtimers.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//==================================================================================================
+//=========================================== MACROS ===============================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Size of hidden structure cyclic_t (32-bit / 64-bit platforms)
+//------------------------------------------------------------------------------
+#if (UINTPTR_MAX == UINT32_MAX)
+#define CYCLIC_DRIVER_INSTANCE_SIZE (60)
+#else
+#define CYCLIC_DRIVER_INSTANCE_SIZE (88)
+#endif
+
+//------------------------------------------------------------------------------
+// Maximal number of tasks
+//------------------------------------------------------------------------------
+#define CYCLIC_TASKS_MAX (32)
+
+//------------------------------------------------------------------------------
+// Number of frames in the schedule (size of frames table)
+//
+// `hyperperiod_ms` - least common multiple of all periods
+// `minor_ms`       - greatest common divisor of all periods and offsets
+//------------------------------------------------------------------------------
+#define CYCLIC_FRAMES_NUM(hyperperiod_ms, minor_ms) ((hyperperiod_ms) / (minor_ms))
+
+//==================================================================================================
+//========================================== TYPEDEFS ==============================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Callback - Periodic task (to be called from application context)
+//
+// `arg_p` - pointer to application data, passed over cyclic_task_t structure (can be NULL)
+//------------------------------------------------------------------------------
+typedef void (*cyclic_task_cb_t)(void * arg_p);
+
+//------------------------------------------------------------------------------
+// Callback - Frame overrun report (to be called from application context)
+//
+// `overrun_cnt` - total number of frame overruns since start
+// `frame_idx`   - index of the frame which was released before the previous one was finished
+// `arg_p`       - pointer to application data, passed over cyclic_init function (can be NULL)
+//------------------------------------------------------------------------------
+typedef void (*cyclic_overrun_cb_t)(uint32_t overrun_cnt, uint32_t frame_idx, void * arg_p);
+
+//------------------------------------------------------------------------------
+// Periodic task settings
+//------------------------------------------------------------------------------
+typedef struct cyclic_task_s {
+    cyclic_task_cb_t    task_cb;        // Task callback
+    void*               arg_p;          // Pointer to application data to be passed into task callback (can be NULL)
+    uint32_t            period_ms;      // Period of task activation in milliseconds (must be > 0)
+    uint32_t            offset_ms;      // Offset of the first activation in milliseconds (must be < period_ms)
+    uint32_t            budget_us;      // Worst case execution time in microseconds (can be 0 if unknown)
+} cyclic_task_t;
+
+//------------------------------------------------------------------------------
+// Driver instance (structure is hidden in .c file)
+//------------------------------------------------------------------------------
+typedef struct cyclic_s {
+    uint8_t data[CYCLIC_DRIVER_INSTANCE_SIZE];
+} cyclic_t;
+
+//==================================================================================================
+//================================ PUBLIC FUNCTIONS DECLARATIONS ===================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Init cyclic executive and calculate the schedule
+//
+// Sum of budgets of tasks released in the same frame must not exceed duration of the minor frame
+// Minor frame must be a non-zero multiple of the software timers tick (checked with assert)
+//
+// `inst_p`         - pointer to driver instance, can be uninitialized
+// `swtimers_p`     - pointer to initialized software timers driver instance
+// `timer_idx`      - index of software timer to measure minor frames
+// `tasks_p`        - pointer to table of tasks (structure must be alive until deinitialization of the driver)
+// `tasks_num`      - number of tasks (must be 1 .. CYCLIC_TASKS_MAX)
+// `frames_table_p` - pointer to array of frames to be filled with the schedule
+// `frames_num`     - size of frames array (should be >= hyperperiod / minor frame)
+// `overrun_cb`     - pointer to overrun report callback (can be NULL)
+// `arg_p`          - pointer to application data to be passed into overrun report callback (can be NULL)
+//
+// Returns - 'true' if the schedule is calculated, 'false' if hyperperiod exceeds UINT32_MAX ms or
+//           frames array is too small (frames array isn't written, driver stays uninitialized)
+//------------------------------------------------------------------------------
+bool cyclic_init(cyclic_t * inst_p, const swtimers_t * swtimers_p, uint32_t timer_idx,
+                 const cyclic_task_t * tasks_p, uint32_t tasks_num, uint32_t * frames_table_p, uint32_t frames_num,
+                 cyclic_overrun_cb_t overrun_cb, void * arg_p);
+
+//------------------------------------------------------------------------------
+// Deinit cyclic executive
+// Stops software timer
+//
+// `inst_p` - pointer to driver instance, can be uninitialized
+//------------------------------------------------------------------------------
+void cyclic_deinit(cyclic_t * inst_p);
+
+//------------------------------------------------------------------------------
+// Start cyclic executive from the frame 0
+// Tasks of frame 0 are released immediately
+//
+// `inst_p` - pointer to initialized driver instance
+//------------------------------------------------------------------------------
+void cyclic_start(const cyclic_t * inst_p);
+
+//------------------------------------------------------------------------------
+// Stop cyclic executive
+// Released tasks which haven't been called yet are dropped
+//
+// `inst_p` - pointer to initialized driver instance
+//------------------------------------------------------------------------------
+void cyclic_stop(const cyclic_t * inst_p);
+
+//------------------------------------------------------------------------------
+// Get parameters of the calculated schedule
+//
+// `inst_p`            - pointer to initialized driver instance
+// `minor_ms_out_p`    - out - duration of the minor frame in milliseconds (can be NULL)
+// `frames_num_out_p`  - out - number of frames in the hyperperiod (can be NULL)
+//------------------------------------------------------------------------------
+void cyclic_get_schedule(const cyclic_t * inst_p, uint32_t * minor_ms_out_p, uint32_t * frames_num_out_p);
+
+//------------------------------------------------------------------------------
+// Get number of frame overruns since start
+//
+// `inst_p` - pointer to initialized driver instance
+//------------------------------------------------------------------------------
+uint32_t cyclic_get_overruns(const cyclic_t * inst_p);
+
+//------------------------------------------------------------------------------
+// Call released tasks and report overruns
+//
+// To be called periodically from main loop
+//
+// `inst_p` - pointer to initialized driver instance
+//------------------------------------------------------------------------------
+void cyclic_task(const cyclic_t * inst_p);
+
+//==================================================================================================
+//============================================ TESTS ===============================================
+//==================================================================================================
+
+//-----------------------------------------------------------------------------
+// Run unit-tests
+// Returns - number of failed test or 0 if all tests are successful
+//-----------------------------------------------------------------------------
+int32_t cyclic_tests(void);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // DRV_CYCLIC_H
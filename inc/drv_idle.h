@@ -0,0 +1,114 @@
+//**************************************************************************************************
+// Idle helper for sleep-until-next-event application loops
+//**************************************************************************************************
+// Aggregates next wakeup times of drivers:
+//  - drv_swtimers - ticks until the nearest timer expiration or pending handlers of swtimers_task()
+//  - drv_buttons  - polled buttons or unprocessed changes from buttons_isr()
+//  - drv_leds     - doesn't need own entry, each blinking phase is measured by software timer
+//
+// Typical application loop:
+//  - call swtimers_task(), buttons_task() and other routines
+//  - call drv_idle() to sleep until the nearest event
+//
+// All functions are reenterable:
+//  - driver doesn't use internal static data
+//**************************************************************************************************
+
+#ifndef DRV_IDLE_H
+#define DRV_IDLE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "drv_swtimers.h"
+#include "drv_buttons.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//==================================================================================================
+//=========================================== MACROS ===============================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Value returned by drv_next_wakeup() if only an interrupt can wake the application
+//------------------------------------------------------------------------------
+#define DRV_WAKEUP_NEVER (SWTIMERS_NO_EXPIRY)
+
+//==================================================================================================
+//========================================== TYPEDEFS ==============================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Callback - Disable all interrupts (interrupt must still be able to wake the core)
+// Callback - Enable all interrupts
+//
+// `hw_p` - pointer to hardware driver, passed over drv_idle_hw_interface_t structure (can be NULL)
+//------------------------------------------------------------------------------
+typedef void (*drv_idle_irq_ctrl_cb_t)(void * hw_p);
+
+//------------------------------------------------------------------------------
+// Callback - Sleep until interrupt or until timeout
+// Called with disabled interrupts, must return on any pending interrupt (like __WFI instruction)
+//
+// `hw_p`  - pointer to hardware driver, passed over drv_idle_hw_interface_t structure (can be NULL)
+// `ticks` - maximal sleep duration in ticks of software timers or DRV_WAKEUP_NEVER
+//------------------------------------------------------------------------------
+typedef void (*drv_idle_sleep_cb_t)(void * hw_p, uint32_t ticks);
+
+//------------------------------------------------------------------------------
+// Interface to hardware core
+//------------------------------------------------------------------------------
+typedef struct drv_idle_hw_interface_s {
+    void*                       hw_p;           // Pointer to hardware driver to be passed into callbacks (can be NULL)
+    drv_idle_irq_ctrl_cb_t      irq_disable_cb; // Disable all interrupts
+    drv_idle_irq_ctrl_cb_t      irq_enable_cb;  // Enable all interrupts
+    drv_idle_sleep_cb_t         sleep_cb;       // Sleep until interrupt or until timeout
+} drv_idle_hw_interface_t;
+
+//==================================================================================================
+//================================ PUBLIC FUNCTIONS DECLARATIONS ===================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Get number of ticks until the nearest work of drivers
+//
+// Doesn't scan tables of drivers, cheap enough to be called on every loop iteration
+//
+// `swtimers_p` - pointer to initialized software timers driver instance
+// `buttons_p`  - pointer to initialized buttons driver instance (can be NULL)
+//
+// Returns - 0 if driver routines should be called without sleeping,
+//           DRV_WAKEUP_NEVER if only an interrupt can produce new work,
+//           number of software timer ticks until the nearest timer expiration otherwise
+//------------------------------------------------------------------------------
+uint32_t drv_next_wakeup(const swtimers_t * swtimers_p, const buttons_t * buttons_p);
+
+//------------------------------------------------------------------------------
+// Idle hook - sleep until the nearest work of drivers
+//
+// Disables interrupts, checks drv_next_wakeup() and calls sleep callback if there is no work to do,
+// so an interrupt between the check and the sleep can't be lost
+//
+// `hw_interface_p` - pointer to hardware core interface
+// `swtimers_p`     - pointer to initialized software timers driver instance
+// `buttons_p`      - pointer to initialized buttons driver instance (can be NULL)
+//------------------------------------------------------------------------------
+void drv_idle(const drv_idle_hw_interface_t * hw_interface_p, const swtimers_t * swtimers_p, const buttons_t * buttons_p);
+
+//==================================================================================================
+//============================================ TESTS ===============================================
+//==================================================================================================
+
+//-----------------------------------------------------------------------------
+// Run unit-tests
+// Returns - number of failed test or 0 if all tests are successful
+//-----------------------------------------------------------------------------
+int32_t drv_idle_tests(void);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // DRV_IDLE_H
@@ -5,7 +5,46 @@
 //  - swtimers driver should be initialized before any usage of this driver
 //  - swtimers_task() should be called periodically from application loop
 //  - swtimers_isr() should be called periodically from ISR context
-//  - each LED occupies one software timer
+//  - each LED occupies one software timer, or all LEDs share one software timer in engine mode
+//
+// Pattern sequencer (leds_pattern()):
+//  - pattern is a constant program of 16-bit operations (leds_op_t), can be stored in flash and shared by LEDs
+//  - LEDS_OP_ON(ms) / LEDS_OP_OFF(ms) - switch LED and wait, LEDS_OP_REPEAT(back, times) - repeat block,
+//    LEDS_OP_LOOP - start from the beginning, LEDS_OP_END - stop in the last state
+//  - LED keeps only pointer to the program and index of operation, program costs no RAM
+//
+// Groups of LEDs (leds_group_init()):
+//  - state of all members is a function of time base of software timers (swtimers_get_time_ms()) and blink parameters,
+//    so groups with the same parameters are in phase regardless of the moment of start
+//  - one software timer per group, one timer event switches all members (one port write if batching is enabled)
+//  - on/off/toggle/blinking of a member takes it out of the group until the next start of the group
+//
+// Fading of groups (leds_group_fade(), leds_group_breathe()):
+//  - linear level of the group is moved by its periodic software timer, brightness of members is set with BAM dimming
+//  - level is mapped to brightness by constant table shared by all LEDs (one lookup per step for the whole group),
+//    tables of gamma and CIE lightness curves are generated by the compiler (LEDS_CURVE_TABLE()), no floating point
+//  - members are updated only if brightness is changed since the previous step
+//  - breathing is in phase with time base of software timers, like blinking of groups
+//
+// Lazy blinking (leds_blink_lazy()):
+//  - no software timer, state of LED is calculated in closed form from blink parameters and start time (leds_state_at(),
+//    leds_blink_state_at() - the same calculation without LED instance)
+//  - GPIO is written only when application samples the LED (leds_sample()) or refreshes all lazy LEDs (leds_refresh()),
+//    and only if the state is changed since the previous write
+//  - time base is supplied by application (swtimers_get_time_ms() or any other millisecond counter)
+//
+// Engine mode (leds_set_engine()):
+//  - next switching moments of blinking LEDs are kept in a binary heap ordered by time
+//  - one single-shot software timer is armed to the nearest moment and switches only LEDs which are due
+//  - cost of blinking doesn't depend on number of LEDs in the table of software timers
+//
+// Dimming with bit-angle modulation (leds_set_bam(), leds_set_brightness()):
+//  - 8-bit brightness, one BAM cycle is 255 calls of leds_bam_isr(), slot of bit N lasts 2^N calls
+//  - at the beginning of each slot one precomputed set/clear mask is written per GPIO port (gpio_write_port())
+//  - flicker-free refresh (>= ~100 Hz) needs >= 255 * 100 calls of leds_bam_isr() per second (period <= ~39 us),
+//    so it should be called from ISR of a fast hardware timer (LEDS_BAM_EXTERNAL_ISR)
+//  - periodic ISR-mode software timer calls it once per tick of swtimers (1 ms tick - ~4 Hz refresh, visible flicker)
+//  - on/off/toggle/blinking of the LED leaves dimming mode
 //
 // Driver uses GPIO-ouitputs accessed over callback functions
 //
@@ -13,6 +52,19 @@
 //  - manually in on-off mode (by calling leds_on() or leds_off() or leds_toggle() function)
 //  - automatically in blinking mode (swtimers_task() call internal handler by pointer)
 //
+// Counters of GPIO writes and blinking steps are available over leds_get_stats()
+//
+// Shadow of LED states (leds_get_state()):
+//  - writes of the state which LED already has are suppressed (useful for LEDs behind I2C/SPI port expanders)
+//  - toggle is done as write of the inverted shadow state, gpio_toggle() is called only while the state is unknown
+//  - state is unknown after leds_set_pin() and leds_set_brightness() until the next write
+//
+// Optional batching of GPIO writes (leds_set_batch()):
+//  - pin index is LEDS_PORT_PIN(port, bit), up to 32 pins in one port
+//  - changes made by blinking are accumulated into set/clear masks of ports during swtimers_task()
+//  - masks are written with one gpio_write_port() call per port at the end of swtimers_task(),
+//    so LEDs switched on the same tick change at once
+//
 // All functions are reenterable:
 //  - driver doesn't use internal static data
 //  - driver's instance and table of LEDs are supposed to be stored externally
@@ -97,17 +149,100 @@ extern "C" {
 //------------------------------------------------------------------------------
 // Size of hidden structure leds_led_t
 //------------------------------------------------------------------------------
-#define LEDS_SINGLE_LED_INSTANCE_SIZE (28)
+#define LEDS_SINGLE_LED_INSTANCE_SIZE (32)
+
+//------------------------------------------------------------------------------
+// Size of hidden structure leds_port_t
+//------------------------------------------------------------------------------
+#define LEDS_SINGLE_PORT_INSTANCE_SIZE (8)
+
+//------------------------------------------------------------------------------
+// Size of hidden structure leds_group_t (32-bit / 64-bit platforms)
+//------------------------------------------------------------------------------
+#if (UINTPTR_MAX == UINT32_MAX)
+#define LEDS_GROUP_INSTANCE_SIZE (44)
+#else
+#define LEDS_GROUP_INSTANCE_SIZE (56)
+#endif
+
+//------------------------------------------------------------------------------
+// Size of hidden structure leds_bam_port_t
+//------------------------------------------------------------------------------
+#define LEDS_BAM_PORT_INSTANCE_SIZE (36)
+
+//------------------------------------------------------------------------------
+// Size of hidden structure leds_t (32-bit / 64-bit platforms)
+//------------------------------------------------------------------------------
+#if (UINTPTR_MAX == UINT32_MAX)
+#define LEDS_DRIVER_INSTANCE_SIZE (80 + (8 * DRV_PROF) + (4 * DRV_TRACE))
+#else
+#define LEDS_DRIVER_INSTANCE_SIZE (104 + (16 * DRV_PROF) + (8 * DRV_TRACE))
+#endif
 
 //------------------------------------------------------------------------------
-// Size of hidden structure leds_t
+// Index of GPIO pin for batched writes (`port` - index of port, `bit` - pin in the port 0 .. 31)
 //------------------------------------------------------------------------------
-#define LEDS_DRIVER_INSTANCE_SIZE (16)
+#define LEDS_PORT_PIN(port, bit) (((uint32_t)(port) * 32u) + (uint32_t)(bit))
+
+//------------------------------------------------------------------------------
+// Operations of pattern program (leds_op_t), 2 high bits - code, 14 low bits - argument
+//
+// LEDS_OP_ON(ms), LEDS_OP_OFF(ms) - switch LED ON/OFF and wait `ms` milliseconds (1 .. 16383)
+// LEDS_OP_REPEAT(back, times)     - jump `back` operations back (1 .. 255) `times` times (1 .. 63),
+//                                   so the block is passed times+1 times (blocks can't be nested)
+// LEDS_OP_LOOP                    - start the program from the beginning
+// LEDS_OP_END                     - stop the program, LED stays in the last state
+//------------------------------------------------------------------------------
+#define LEDS_OP_CODE_MASK       (0xC000u)
+#define LEDS_OP_ARG_MASK        (0x3FFFu)
+#define LEDS_OP_CODE_OFF        (0x0000u)
+#define LEDS_OP_CODE_ON         (0x4000u)
+#define LEDS_OP_CODE_REPEAT     (0x8000u)
+#define LEDS_OP_CODE_CTRL       (0xC000u)
+
+#define LEDS_OP_OFF(ms)             ((leds_op_t)(LEDS_OP_CODE_OFF | ((ms) & LEDS_OP_ARG_MASK)))
+#define LEDS_OP_ON(ms)              ((leds_op_t)(LEDS_OP_CODE_ON | ((ms) & LEDS_OP_ARG_MASK)))
+#define LEDS_OP_REPEAT(back, times) ((leds_op_t)(LEDS_OP_CODE_REPEAT | (((times) & 0x3Fu) << 8) | ((back) & 0xFFu)))
+#define LEDS_OP_END                 ((leds_op_t)(LEDS_OP_CODE_CTRL | 0u))
+#define LEDS_OP_LOOP                ((leds_op_t)(LEDS_OP_CODE_CTRL | 1u))
+
+//------------------------------------------------------------------------------
+// Intensity curves for fading, integer constant expressions (`i` - level 0 .. 255, result - brightness 0 .. 255)
+//
+// LEDS_CURVE_GAMMA(i)     - gamma 2.2, approximated by x^2 * (0.75 + 0.25 * x) with error up to 1 step
+// LEDS_CURVE_CIE(i)       - CIE 1931 lightness L* = 100 * i / 255, Y = ((L* + 16) / 116)^3, or L* / 903.3 if L* <= 8
+// LEDS_CURVE_TABLE(curve) - 256 initializers of constant table of curve, e.g.
+//                           static const uint8_t cie_table[256] = { LEDS_CURVE_TABLE(LEDS_CURVE_CIE) };
+//------------------------------------------------------------------------------
+#define LEDS_CURVE_GAMMA(i) ((uint8_t)((((uint32_t)(i) * (uint32_t)(i) * (765u + (uint32_t)(i))) + 130050u) / 260100u))
+
+#define LEDS_CURVE_CIE_BASE(i) ((100ull * (uint32_t)(i)) + 4080ull) // (L* + 16) / 116 scaled by 116 * 255
+#define LEDS_CURVE_CIE(i) ((uint8_t)(((uint32_t)(i) <= 20u) ? ((((uint32_t)(i) * 1000u) + 4516u) / 9033u) :                   \
+                                     ((255ull * LEDS_CURVE_CIE_BASE(i) * LEDS_CURVE_CIE_BASE(i) * LEDS_CURVE_CIE_BASE(i) + \
+                                       12940900956000ull) / 25881801912000ull)))
+
+#define LEDS_CURVE_4(curve, i)  curve((i) + 0u), curve((i) + 1u), curve((i) + 2u), curve((i) + 3u)
+#define LEDS_CURVE_16(curve, i) LEDS_CURVE_4(curve, (i) + 0u), LEDS_CURVE_4(curve, (i) + 4u),  \
+                                LEDS_CURVE_4(curve, (i) + 8u), LEDS_CURVE_4(curve, (i) + 12u)
+#define LEDS_CURVE_64(curve, i) LEDS_CURVE_16(curve, (i) + 0u),  LEDS_CURVE_16(curve, (i) + 16u), \
+                                LEDS_CURVE_16(curve, (i) + 32u), LEDS_CURVE_16(curve, (i) + 48u)
+#define LEDS_CURVE_TABLE(curve) LEDS_CURVE_64(curve, 0u),   LEDS_CURVE_64(curve, 64u), \
+                                LEDS_CURVE_64(curve, 128u), LEDS_CURVE_64(curve, 192u)
+
+//------------------------------------------------------------------------------
+// Index of timer for leds_set_bam() if leds_bam_isr() is called by application from hardware timer ISR
+//------------------------------------------------------------------------------
+#define LEDS_BAM_EXTERNAL_ISR (UINT32_MAX)
 
 //==================================================================================================
 //========================================== TYPEDEFS ==============================================
 //==================================================================================================
 
+//------------------------------------------------------------------------------
+// Operation of pattern program (see LEDS_OP_* macros)
+//------------------------------------------------------------------------------
+typedef uint16_t leds_op_t;
+
 //------------------------------------------------------------------------------
 // Callback - Set hardware GPIO state
 //
@@ -125,6 +260,16 @@ typedef void (*leds_gpio_write_cb_t)(void * hw_gpio_p, uint32_t pin_idx, uint8_t
 //------------------------------------------------------------------------------
 typedef void (*leds_gpio_toggle_cb_t)(void * hw_gpio_p, uint32_t pin_idx);
 
+//------------------------------------------------------------------------------
+// Callback - Set and clear several pins of hardware GPIO port at once (e.g. with BSRR register)
+//
+// `hw_gpio_p`  - pointer to hardware GPIO driver, passed over leds_hw_interface_t structure
+// `port_idx`   - index of GPIO port
+// `set_mask`   - pins to be set to logical one
+// `clear_mask` - pins to be set to logical zero (doesn't intersect with set_mask)
+//------------------------------------------------------------------------------
+typedef void (*leds_gpio_write_port_cb_t)(void * hw_gpio_p, uint32_t port_idx, uint32_t set_mask, uint32_t clear_mask);
+
 //------------------------------------------------------------------------------
 // Interface to hardware GPIO
 //------------------------------------------------------------------------------
@@ -132,8 +277,41 @@ typedef struct leds_hw_interface_s {
     void*                        hw_gpio_p;     // Pointer to hardware GPIO driver to be passed into callbacks (can be NULL)
     leds_gpio_write_cb_t         gpio_write;    // Set hardware GPIO state
     leds_gpio_toggle_cb_t        gpio_toggle;   // Toggle hardware GPIO state
+    leds_gpio_write_port_cb_t    gpio_write_port; // Write several pins of GPIO port (can be NULL if batching isn't used)
 } leds_hw_interface_t;
 
+//------------------------------------------------------------------------------
+// Counters of driver activity (wrap around at 2^32)
+//------------------------------------------------------------------------------
+typedef struct leds_stats_s {
+    uint32_t    writes;         // number of gpio_write() calls
+    uint32_t    toggles;        // number of gpio_toggle() calls
+    uint32_t    blink_steps;    // number of blinking state changes by software timers
+    uint32_t    port_writes;    // number of gpio_write_port() calls
+    uint32_t    suppressed;     // number of writes skipped because LED is already in the requested state
+} leds_stats_t;
+
+//------------------------------------------------------------------------------
+// Pending changes of one GPIO port (structure is hidden in .c file)
+//------------------------------------------------------------------------------
+typedef struct leds_port_s {
+    uint8_t data[LEDS_SINGLE_PORT_INSTANCE_SIZE];
+} leds_port_t;
+
+//------------------------------------------------------------------------------
+// Group of LEDs blinking in phase (structure is hidden in .c file)
+//------------------------------------------------------------------------------
+typedef struct leds_group_s {
+    uint8_t data[LEDS_GROUP_INSTANCE_SIZE];
+} leds_group_t;
+
+//------------------------------------------------------------------------------
+// Precomputed BAM masks of one GPIO port (structure is hidden in .c file)
+//------------------------------------------------------------------------------
+typedef struct leds_bam_port_s {
+    uint8_t data[LEDS_BAM_PORT_INSTANCE_SIZE];
+} leds_bam_port_t;
+
 //------------------------------------------------------------------------------
 // Single LED instance (structure is hidden in .c file)
 //------------------------------------------------------------------------------
@@ -177,7 +355,7 @@ void leds_deinit(leds_t * inst_p);
 // `inst_p`         - pointer to initialized driver instance
 // `idx`            - LED number (must be 0 .. num-1)
 // `pin`            - index of GPIO pin connected to the LED
-// `timer_id`       - id of software timer to measure blinking time
+// `timer_id`       - id of software timer to measure blinking time (ignored in engine mode)
 // `is_active_high` - 'true' if LED is active-high, 'false' if LED is active-low
 //------------------------------------------------------------------------------
 void leds_set_pin(leds_t * inst_p, uint32_t idx, uint32_t pin_idx, uint32_t timer_idx, bool is_active_high);
@@ -239,6 +417,272 @@ void leds_blink(const leds_t * inst_p, uint32_t idx, uint8_t series, uint32_t pu
 void leds_blink_ext(const leds_t * inst_p, uint32_t idx, uint8_t series, uint32_t pulse_ms, uint32_t pause_ms,
                     uint32_t period_ms, uint32_t delay_ms, bool is_inverted);
 
+//------------------------------------------------------------------------------
+// Run pattern program (the first operations are done at once)
+//
+// Example: SOS - three short, three long, three short pulses, then pause
+//  static const leds_op_t sos[] = {
+//      LEDS_OP_ON(150), LEDS_OP_OFF(150), LEDS_OP_REPEAT(2, 2),
+//      LEDS_OP_ON(450), LEDS_OP_OFF(150), LEDS_OP_REPEAT(2, 2),
+//      LEDS_OP_ON(150), LEDS_OP_OFF(150), LEDS_OP_REPEAT(2, 2),
+//      LEDS_OP_OFF(1000), LEDS_OP_LOOP,
+//  };
+//
+// `inst_p`    - pointer to initialized driver instance
+// `idx`       - LED number (must be 0 .. num-1)
+// `pattern_p` - pointer to program (must be alive while the pattern is running, up to 256 operations),
+//               program without reachable LEDS_OP_ON/LEDS_OP_OFF is stopped as by LEDS_OP_END
+//------------------------------------------------------------------------------
+void leds_pattern(const leds_t * inst_p, uint32_t idx, const leds_op_t * pattern_p);
+
+//------------------------------------------------------------------------------
+// Init group of LEDs (group is stopped)
+//
+// `inst_p`      - pointer to initialized driver instance
+// `group_p`     - pointer to group, can be uninitialized
+// `members_p`   - pointer to array of LED numbers (must be alive while the group is used, can be constant)
+// `members_num` - number of LEDs in the group (must be > 0)
+// `timer_idx`   - index of software timer of the group
+//------------------------------------------------------------------------------
+void leds_group_init(const leds_t * inst_p, leds_group_t * group_p, const uint16_t * members_p, uint32_t members_num, uint32_t timer_idx);
+
+//------------------------------------------------------------------------------
+// Run blink of all LEDs of the group, phase is counted from time 0 of software timers driver
+// (state of members is updated at once)
+//
+// `inst_p`      - pointer to initialized driver instance
+// `group_p`     - pointer to initialized group
+// `series`      - number of pulses within one series
+// `pulse_ms`    - duration of "pulse" in milliseconds
+// `pause_ms`    - duration of "pause" between pulses in milliseconds
+// `period_ms`   - duration of one series in milliseconds (must be >= sum of pulses and pauses)
+// `is_inverted` - if 'true' LEDs are OFF during the "pulse", ON during "pause" and "wait"
+//------------------------------------------------------------------------------
+void leds_group_blink(const leds_t * inst_p, leds_group_t * group_p, uint8_t series, uint32_t pulse_ms, uint32_t pause_ms,
+                      uint32_t period_ms, bool is_inverted);
+
+//------------------------------------------------------------------------------
+// Run meander blink of all LEDs of the group (LEDs are ON during duration_ms and OFF during duration_ms)
+//
+// `inst_p`      - pointer to initialized driver instance
+// `group_p`     - pointer to initialized group
+// `duration_ms` - duration of ON state in milliseconds (OFF state duration is the same)
+//------------------------------------------------------------------------------
+void leds_group_meander(const leds_t * inst_p, leds_group_t * group_p, uint32_t duration_ms);
+
+//------------------------------------------------------------------------------
+// Stop group and turn OFF LEDs which are still members of the group
+//
+// `inst_p`  - pointer to initialized driver instance
+// `group_p` - pointer to initialized group
+//------------------------------------------------------------------------------
+void leds_group_stop(const leds_t * inst_p, leds_group_t * group_p);
+
+//------------------------------------------------------------------------------
+// Run fade of all LEDs of the group from one level to another (members are switched into dimming mode at once)
+//
+// Brightness of members stays at table_p[to] after the end of fade, software timer of the group is stopped
+//
+// `inst_p`      - pointer to initialized driver instance with enabled dimming
+// `group_p`     - pointer to initialized group
+// `table_p`     - pointer to table of 256 brightness values (LEDS_CURVE_TABLE()), NULL - brightness is equal to level
+// `from`        - level at the beginning of fade (e.g. 0 to fade in, 255 to fade out)
+// `to`          - level at the end of fade
+// `duration_ms` - duration of fade in milliseconds (up to UINT32_MAX / 255)
+// `step_ms`     - period of brightness updates in milliseconds (must be > 0)
+//------------------------------------------------------------------------------
+void leds_group_fade(const leds_t * inst_p, leds_group_t * group_p, const uint8_t * table_p, uint8_t from, uint8_t to,
+                     uint32_t duration_ms, uint32_t step_ms);
+
+//------------------------------------------------------------------------------
+// Run breathing of all LEDs of the group - level goes 0 .. 255 .. 0 within each period,
+// phase is counted from time 0 of software timers driver (brightness of members is updated at once)
+//
+// `inst_p`    - pointer to initialized driver instance with enabled dimming
+// `group_p`   - pointer to initialized group
+// `table_p`   - pointer to table of 256 brightness values (LEDS_CURVE_TABLE()), NULL - brightness is equal to level
+// `period_ms` - duration of one breath in milliseconds (must be > 0, up to UINT32_MAX / 510)
+// `step_ms`   - period of brightness updates in milliseconds (must be > 0)
+//------------------------------------------------------------------------------
+void leds_group_breathe(const leds_t * inst_p, leds_group_t * group_p, const uint8_t * table_p, uint32_t period_ms, uint32_t step_ms);
+
+//------------------------------------------------------------------------------
+// Run blink without software timer (GPIO isn't written until leds_sample() or leds_refresh() call)
+// Timings are the same as of leds_blink_ext() started at `start_ms`
+//
+// `inst_p`      - pointer to initialized driver instance
+// `idx`         - LED number (must be 0 .. num-1)
+// `series`      - number of pulses within one series
+// `pulse_ms`    - duration of "pulse" in milliseconds
+// `pause_ms`    - duration of "pause" between pulses in milliseconds
+// `period_ms`   - duration of one series in milliseconds (can be 0 for single series)
+// `start_ms`    - time of the first "pulse" in time base of application (LED is in "delay" state before it)
+// `is_inverted` - blinking inversion as in leds_blink_ext()
+//------------------------------------------------------------------------------
+void leds_blink_lazy(const leds_t * inst_p, uint32_t idx, uint8_t series, uint32_t pulse_ms, uint32_t pause_ms,
+                     uint32_t period_ms, uint32_t start_ms, bool is_inverted);
+
+//------------------------------------------------------------------------------
+// Calculate state of lazy blinking LED at arbitrary time (GPIO isn't written)
+//
+// `inst_p`  - pointer to initialized driver instance
+// `idx`     - LED number (must be 0 .. num-1), LED must be started by leds_blink_lazy()
+// `time_ms` - time in time base of leds_blink_lazy() call (wraps around, up to 2^31 ms from start)
+//
+// Returns - 'true' if LED is ON
+//------------------------------------------------------------------------------
+bool leds_state_at(const leds_t * inst_p, uint32_t idx, uint32_t time_ms);
+
+//------------------------------------------------------------------------------
+// Calculate state of blinking at arbitrary time from blink parameters (no LED instance is needed)
+// Timings are the same as of leds_blink_lazy() started with the same parameters
+//
+// `series`        - number of pulses within one series (must be > 0)
+// `pulse_ms`      - duration of "pulse" in milliseconds (must be > 0)
+// `pause_ms`      - duration of "pause" between pulses in milliseconds
+// `period_ms`     - duration of one series in milliseconds (0 - single series)
+// `start_ms`      - time of the first "pulse"
+// `is_inverted`   - blinking inversion as in leds_blink_ext()
+// `time_ms`       - time in time base of `start_ms` (wraps around, up to 2^31 ms from start)
+// `next_ms_out_p` - out - time until the next switching in milliseconds, 0 - no more switching (can be NULL)
+//
+// Returns - 'true' if LED is ON
+//------------------------------------------------------------------------------
+bool leds_blink_state_at(uint8_t series, uint32_t pulse_ms, uint32_t pause_ms, uint32_t period_ms, uint32_t start_ms,
+                         bool is_inverted, uint32_t time_ms, uint32_t * next_ms_out_p);
+
+//------------------------------------------------------------------------------
+// Calculate state of lazy blinking LED and write GPIO if the state is changed
+//
+// `inst_p`  - pointer to initialized driver instance
+// `idx`     - LED number (must be 0 .. num-1), LED must be started by leds_blink_lazy()
+// `time_ms` - current time in time base of leds_blink_lazy() call
+//
+// Returns - 'true' if LED is ON
+//------------------------------------------------------------------------------
+bool leds_sample(const leds_t * inst_p, uint32_t idx, uint32_t time_ms);
+
+//------------------------------------------------------------------------------
+// Write GPIO of all lazy blinking LEDs with changed state (one write per port if batching is enabled)
+//
+// `inst_p`  - pointer to initialized driver instance
+// `time_ms` - current time in time base of leds_blink_lazy() calls
+//------------------------------------------------------------------------------
+void leds_refresh(const leds_t * inst_p, uint32_t time_ms);
+
+//------------------------------------------------------------------------------
+// Get counters of driver activity
+//
+// Counters are updated from application loop, so the function should be called from application loop too
+//
+// `inst_p`      - pointer to initialized driver instance
+// `stats_out_p` - out - snapshot of counters since init or the previous reset
+// `is_reset`    - 'true' - clear counters after taking snapshot
+//------------------------------------------------------------------------------
+void leds_get_stats(const leds_t * inst_p, leds_stats_t * stats_out_p, bool is_reset);
+
+//------------------------------------------------------------------------------
+// Get shadow state of LED (the last written or pending state, GPIO isn't read)
+//
+// `inst_p`      - pointer to initialized driver instance
+// `idx`         - LED number (must be 0 .. num-1)
+// `is_on_out_p` - out - 'true' if LED is ON (not changed if the state is unknown)
+//
+// Returns - 'false' if the state is unknown (no writes since leds_set_pin(), toggle by hardware or dimming)
+//------------------------------------------------------------------------------
+bool leds_get_state(const leds_t * inst_p, uint32_t idx, bool * is_on_out_p);
+
+//------------------------------------------------------------------------------
+// Enable batching of GPIO writes by ports
+//
+// Attaches hook of software timers driver (swtimers_set_task_hook()) to flush pending changes,
+// so only one LED driver instance with batching can share one software timers driver instance
+// Writes outside of software timer handlers are done at once, unless the pin has a pending change
+//
+// `inst_p`    - pointer to initialized driver instance (gpio_write_port callback must be set)
+// `ports_p`   - pointer to array of pending changes of ports (can be NULL to disable batching)
+// `ports_num` - number of ports, all pins of LEDs must be < LEDS_PORT_PIN(ports_num, 0)
+//------------------------------------------------------------------------------
+void leds_set_batch(const leds_t * inst_p, leds_port_t * ports_p, uint32_t ports_num);
+
+//------------------------------------------------------------------------------
+// Enable engine mode - all blinking LEDs are driven by one software timer
+//
+// Should be called after leds_init() before any blinking, disabling of engine mode stops blinking of all LEDs
+//
+// `inst_p`    - pointer to initialized driver instance
+// `timer_idx` - index of software timer for all LEDs
+// `queue_p`   - pointer to array of `num` elements for queue of blinking LEDs (can be NULL to disable engine mode)
+//------------------------------------------------------------------------------
+void leds_set_engine(const leds_t * inst_p, uint32_t timer_idx, uint16_t * queue_p);
+
+//------------------------------------------------------------------------------
+// Enable dimming with bit-angle modulation
+//
+// Disabling of dimming turns OFF all dimmed LEDs
+//
+// `inst_p`    - pointer to initialized driver instance (gpio_write_port callback must be set)
+// `ports_p`   - pointer to array of BAM masks of ports (can be NULL to disable dimming)
+// `ports_num` - number of ports, all pins of dimmed LEDs must be < LEDS_PORT_PIN(ports_num, 0)
+// `timer_idx` - index of software timer to be started in periodic ISR mode with one tick period (refresh rate
+//               is 1/255 of tick rate, only for slow ticks of hardware timer or tests), or LEDS_BAM_EXTERNAL_ISR
+//               if leds_bam_isr() is called by application from ISR of a fast hardware timer (recommended)
+//------------------------------------------------------------------------------
+void leds_set_bam(const leds_t * inst_p, leds_bam_port_t * ports_p, uint32_t ports_num, uint32_t timer_idx);
+
+//------------------------------------------------------------------------------
+// Set brightness of LED and switch it into dimming mode (blinking is stopped)
+//
+// New brightness is applied from the next BAM slot, during the current BAM cycle
+// the LED can show a mix of the old and the new brightness
+//
+// `inst_p`     - pointer to initialized driver instance with enabled dimming
+// `idx`        - LED number (must be 0 .. num-1)
+// `brightness` - brightness 0 (OFF) .. 255 (ON)
+//------------------------------------------------------------------------------
+void leds_set_brightness(const leds_t * inst_p, uint32_t idx, uint8_t brightness);
+
+//------------------------------------------------------------------------------
+// Step of bit-angle modulation, should be called periodically from ISR context if dimming is enabled
+// with LEDS_BAM_EXTERNAL_ISR (refresh rate of LEDs is 1/255 of call rate)
+//
+// `inst_p` - pointer to initialized driver instance
+//------------------------------------------------------------------------------
+void leds_bam_isr(const leds_t * inst_p);
+
+//------------------------------------------------------------------------------
+// Write pending changes of all ports (one gpio_write_port() call per changed port)
+//
+// Is called automatically at the end of swtimers_task() if batching is enabled
+//
+// `inst_p` - pointer to initialized driver instance
+//------------------------------------------------------------------------------
+void leds_flush(const leds_t * inst_p);
+
+#if (DRV_TRACE == 1)
+//------------------------------------------------------------------------------
+// Attach trace of GPIO writes (see drv_trace.h)
+//
+// `inst_p`  - pointer to initialized driver instance
+// `trace_p` - pointer to initialized trace instance (can be NULL to detach)
+//------------------------------------------------------------------------------
+void leds_set_trace(const leds_t * inst_p, const trace_t * trace_p);
+#endif
+
+#if (DRV_PROF == 1)
+//------------------------------------------------------------------------------
+// Attach profiling statistics of blinking processing (see drv_prof.h)
+//
+// Each switching of blinking LED by software timer handler is measured (in engine mode - each engine call)
+// Statistics are updated from application loop (from swtimers_task())
+//
+// `inst_p`    - pointer to initialized driver instance
+// `cycles_cb` - read cycle counter (can be NULL to detach)
+// `stats_p`   - pointer to zero-initialized statistics (can be NULL to detach)
+//------------------------------------------------------------------------------
+void leds_set_prof(const leds_t * inst_p, prof_cycles_cb_t cycles_cb, prof_stats_t * stats_p);
+#endif
+
 //==================================================================================================
 //============================================ TESTS ===============================================
 //==================================================================================================
@@ -0,0 +1,159 @@
+//**************************************************************************************************
+// Multiplexed LED matrix / shift register backend for LED control driver
+//**************************************************************************************************
+// Ready-made leds_hw_interface_t which renders LED states into a double-buffered frame buffer:
+//  - frame is `rows` rows of `row_bytes` bytes, one bit per LED, pin index is LEDS_MATRIX_PIN(row, col, row_bytes)
+//  - each row is kept in shift-out order and is passed to row_out callback as ready byte buffer
+//    (e.g. for SPI DMA into 74HC595 chain: byte 0 is shifted first and ends in the last register,
+//    column `col` is output Q(col % 8) of register col / 8 with MSB-first shifting)
+//  - one row per call of leds_matrix_isr() - periodic ISR-mode software timer or hardware timer ISR,
+//    cost of refresh is one callback per tick regardless of number of LEDs
+//  - drv_leds writes into the back frame from application loop, leds_matrix_commit() makes it visible
+//    at the beginning of the next frame, so rows of one frame are never mixed from different moments
+//  - plain chain of shift registers without multiplexing is a matrix with one row
+//
+// Blinking, patterns, groups, engine mode and batching of drv_leds work unchanged with this backend,
+// dimming (leds_set_bam()) isn't supported since it writes pins from ISR
+//
+// All functions are reenterable:
+//  - driver doesn't use internal static data
+//  - driver's instance and frame buffers are supposed to be stored externally
+//
+//**************************************************************************************************
+// Example - 8 rows x 32 columns (4 x 74HC595), row is switched by application callback
+//**************************************************************************************************
+//  static uint8_t frames[LEDS_MATRIX_BUFFER_SIZE(8, 4)];
+//
+//  leds_matrix_init(&matrix_inst, &row_out, &spi, 8, 4, frames, &timers_inst, MATRIX_TIMER);
+//  leds_init(&leds_inst, leds_matrix_get_hw_interface(&matrix_inst), 256, leds, &timers_inst);
+//  leds_set_pin(&leds_inst, 0, LEDS_MATRIX_PIN(0, 0, 4), LED_0_TIMER, true);
+//
+//  for (;;) {
+//      swtimers_task(&timers_inst);
+//      leds_matrix_commit(&matrix_inst);
+//  }
+//
+//**************************************************************************************************
+
+#ifndef DRV_LEDS_MATRIX_H
+#define DRV_LEDS_MATRIX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "drv_leds.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//==================================================================================================
+//=========================================== MACROS ===============================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Size of hidden structure leds_matrix_t (32-bit / 64-bit platforms)
+//------------------------------------------------------------------------------
+#if (UINTPTR_MAX == UINT32_MAX)
+#define LEDS_MATRIX_DRIVER_INSTANCE_SIZE (52)
+#else
+#define LEDS_MATRIX_DRIVER_INSTANCE_SIZE (88)
+#endif
+
+//------------------------------------------------------------------------------
+// Size of frame buffers in bytes (two frames of `rows` rows with `row_bytes` bytes)
+//------------------------------------------------------------------------------
+#define LEDS_MATRIX_BUFFER_SIZE(rows, row_bytes) (2u * (uint32_t)(rows) * (uint32_t)(row_bytes))
+
+//------------------------------------------------------------------------------
+// Index of GPIO pin for leds_set_pin() (`row` - row of matrix, `col` - column 0 .. row_bytes * 8 - 1)
+//------------------------------------------------------------------------------
+#define LEDS_MATRIX_PIN(row, col, row_bytes) (((uint32_t)(row) * (uint32_t)(row_bytes) * 8u) + (uint32_t)(col))
+
+//------------------------------------------------------------------------------
+// Index of timer for leds_matrix_init() if leds_matrix_isr() is called by application from hardware timer ISR
+//------------------------------------------------------------------------------
+#define LEDS_MATRIX_EXTERNAL_ISR (UINT32_MAX)
+
+//==================================================================================================
+//========================================== TYPEDEFS ==============================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Callback - Output one row of the frame (called from ISR context)
+//
+// Typically switches off the previous row, shifts `data_p` out (DMA), latches registers and switches on `row_idx`
+//
+// `hw_out_p` - pointer to hardware driver, passed over leds_matrix_init function
+// `row_idx`  - index of row
+// `data_p`   - pointer to bytes of row in shift-out order (valid until the next call)
+// `size`     - number of bytes (row_bytes)
+//------------------------------------------------------------------------------
+typedef void (*leds_matrix_row_out_cb_t)(void * hw_out_p, uint32_t row_idx, const uint8_t * data_p, uint32_t size);
+
+//------------------------------------------------------------------------------
+// Driver instance (structure is hidden in .c file)
+//------------------------------------------------------------------------------
+typedef struct leds_matrix_s {
+    uint8_t data[LEDS_MATRIX_DRIVER_INSTANCE_SIZE];
+} leds_matrix_t;
+
+//==================================================================================================
+//================================ PUBLIC FUNCTIONS DECLARATIONS ===================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Init backend, all pins are logical zero, refresh is started
+//
+// `inst_p`     - pointer to driver instance, can be uninitialized
+// `row_out_cb` - callback to output one row
+// `hw_out_p`   - pointer to hardware driver to be passed into callback (can be NULL)
+// `rows`       - number of rows (must be > 0)
+// `row_bytes`  - number of bytes in one row (must be > 0)
+// `buffers_p`  - pointer to array of LEDS_MATRIX_BUFFER_SIZE(rows, row_bytes) bytes
+// `swtimers_p` - pointer to initialized software timers driver (can be NULL for LEDS_MATRIX_EXTERNAL_ISR)
+// `timer_idx`  - index of software timer to be started in periodic ISR mode with one tick period,
+//                or LEDS_MATRIX_EXTERNAL_ISR if leds_matrix_isr() is called by application
+//------------------------------------------------------------------------------
+void leds_matrix_init(leds_matrix_t * inst_p, leds_matrix_row_out_cb_t row_out_cb, void * hw_out_p, uint32_t rows,
+                      uint32_t row_bytes, uint8_t * buffers_p, const swtimers_t * swtimers_p, uint32_t timer_idx);
+
+//------------------------------------------------------------------------------
+// Deinit backend - stop refresh
+//
+// `inst_p` - pointer to driver instance, can be uninitialized
+//------------------------------------------------------------------------------
+void leds_matrix_deinit(leds_matrix_t * inst_p);
+
+//------------------------------------------------------------------------------
+// Get hardware interface to be passed into leds_init()
+//
+// `inst_p` - pointer to initialized driver instance
+//
+// Returns - pointer to hardware interface stored in driver instance
+//------------------------------------------------------------------------------
+const leds_hw_interface_t * leds_matrix_get_hw_interface(const leds_matrix_t * inst_p);
+
+//------------------------------------------------------------------------------
+// Make changes of LEDs visible from the beginning of the next frame
+//
+// Should be called from application loop after LEDs are updated (e.g. after swtimers_task())
+//
+// `inst_p` - pointer to initialized driver instance
+//------------------------------------------------------------------------------
+void leds_matrix_commit(const leds_matrix_t * inst_p);
+
+//------------------------------------------------------------------------------
+// Output the next row
+//
+// Is called by software timer of backend, or by application from hardware timer ISR (LEDS_MATRIX_EXTERNAL_ISR)
+//
+// `inst_p` - pointer to initialized driver instance
+//------------------------------------------------------------------------------
+void leds_matrix_isr(const leds_matrix_t * inst_p);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // DRV_LEDS_MATRIX_H
@@ -0,0 +1,150 @@
+//**************************************************************************************************
+// Addressable LED strip (WS2812-style) backend for LED control driver
+//**************************************************************************************************
+// Ready-made leds_hw_interface_t which renders LED states into a frame of RGB pixels:
+//  - pin index is index of pixel, logical one - pixel has its color (leds_strip_set_color()), zero - pixel is black
+//  - blinking, patterns, groups and engine mode of drv_leds work unchanged on pixels
+//  - frame is encoded into SPI bitstream in caller-provided DMA buffer, each data bit is expanded to
+//    3 line bits (1 - 110, 0 - 100, SPI at 2.4 MHz) or 4 line bits (1 - 1110, 0 - 1000, SPI at 3.2 MHz),
+//    bytes of pixel are in wire order G, R, B, MSB first
+//  - only range of changed pixels is encoded by leds_strip_encode()
+//  - encoder uses lookup tables of nibbles, 4-bit format is vectorized with SSE2 or NEON if available (LEDS_STRIP_SIMD)
+//  - reset pulse (line is low for more than 50 us) between frames is made by application (e.g. idle SPI line)
+//
+// All functions are reenterable:
+//  - driver doesn't use internal static data
+//  - driver's instance, pixels storage and DMA buffer are supposed to be stored externally
+//
+//**************************************************************************************************
+// Example - 60 pixels
+//**************************************************************************************************
+//  static uint8_t pixels[LEDS_STRIP_STORAGE_SIZE(60)];
+//  static uint8_t dma[LEDS_STRIP_DMA_SIZE(60, LEDS_STRIP_FORMAT_SPI_4BIT)];
+//
+//  leds_strip_init(&strip_inst, 60, pixels, dma, LEDS_STRIP_FORMAT_SPI_4BIT);
+//  leds_init(&leds_inst, leds_strip_get_hw_interface(&strip_inst), 60, leds, &timers_inst);
+//  leds_set_pin(&leds_inst, 0, 0, LED_0_TIMER, true);
+//  leds_strip_set_color(&strip_inst, 0, 255, 0, 0);
+//  leds_meander(&leds_inst, 0, 500);
+//
+//  for (;;) {
+//      swtimers_task(&timers_inst);
+//      if (!spi_is_busy() && (leds_strip_encode(&strip_inst) != 0)) {
+//          spi_dma_start(dma, sizeof(dma));
+//      }
+//  }
+//
+//**************************************************************************************************
+
+#ifndef DRV_LEDS_STRIP_H
+#define DRV_LEDS_STRIP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "drv_leds.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//==================================================================================================
+//=========================================== MACROS ===============================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Vectorized encoder: 0 - lookup tables only, 1 - SSE2/NEON if target supports it
+//------------------------------------------------------------------------------
+#ifndef LEDS_STRIP_SIMD
+#define LEDS_STRIP_SIMD (1)
+#endif
+
+//------------------------------------------------------------------------------
+// Size of hidden structure leds_strip_t (32-bit / 64-bit platforms)
+//------------------------------------------------------------------------------
+#if (UINTPTR_MAX == UINT32_MAX)
+#define LEDS_STRIP_DRIVER_INSTANCE_SIZE (48)
+#else
+#define LEDS_STRIP_DRIVER_INSTANCE_SIZE (80)
+#endif
+
+//------------------------------------------------------------------------------
+// Size of pixels storage in bytes (frame, colors and states of `num` pixels)
+//------------------------------------------------------------------------------
+#define LEDS_STRIP_STORAGE_SIZE(num) ((6u * (uint32_t)(num)) + (((uint32_t)(num) + 7u) / 8u))
+
+//------------------------------------------------------------------------------
+// Size of DMA buffer in bytes (`num` pixels, `format` - leds_strip_format_t)
+//------------------------------------------------------------------------------
+#define LEDS_STRIP_DMA_SIZE(num, format) (3u * (uint32_t)(num) * (uint32_t)(format))
+
+//==================================================================================================
+//========================================== TYPEDEFS ==============================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Format of bitstream (value - number of line bits per data bit)
+//------------------------------------------------------------------------------
+typedef enum leds_strip_format_e {
+    LEDS_STRIP_FORMAT_SPI_3BIT = 3,     // 1 - 110, 0 - 100
+    LEDS_STRIP_FORMAT_SPI_4BIT = 4,     // 1 - 1110, 0 - 1000
+} leds_strip_format_t;
+
+//------------------------------------------------------------------------------
+// Driver instance (structure is hidden in .c file)
+//------------------------------------------------------------------------------
+typedef struct leds_strip_s {
+    uint8_t data[LEDS_STRIP_DRIVER_INSTANCE_SIZE];
+} leds_strip_t;
+
+//==================================================================================================
+//================================ PUBLIC FUNCTIONS DECLARATIONS ===================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Init backend, all pixels are black and have black color, the whole frame is to be encoded
+//
+// `inst_p`    - pointer to driver instance, can be uninitialized
+// `num`       - number of pixels (must be > 0)
+// `storage_p` - pointer to array of LEDS_STRIP_STORAGE_SIZE(num) bytes
+// `dma_p`     - pointer to array of LEDS_STRIP_DMA_SIZE(num, format) bytes
+// `format`    - format of bitstream
+//------------------------------------------------------------------------------
+void leds_strip_init(leds_strip_t * inst_p, uint32_t num, uint8_t * storage_p, uint8_t * dma_p, leds_strip_format_t format);
+
+//------------------------------------------------------------------------------
+// Get hardware interface to be passed into leds_init()
+//
+// `inst_p` - pointer to initialized driver instance
+//
+// Returns - pointer to hardware interface stored in driver instance
+//------------------------------------------------------------------------------
+const leds_hw_interface_t * leds_strip_get_hw_interface(const leds_strip_t * inst_p);
+
+//------------------------------------------------------------------------------
+// Set color of pixel in ON state (pixel which is ON now is changed at once)
+//
+// `inst_p` - pointer to initialized driver instance
+// `idx`    - pixel number (must be 0 .. num-1)
+// `red`    - red component
+// `green`  - green component
+// `blue`   - blue component
+//------------------------------------------------------------------------------
+void leds_strip_set_color(const leds_strip_t * inst_p, uint32_t idx, uint8_t red, uint8_t green, uint8_t blue);
+
+//------------------------------------------------------------------------------
+// Encode changed pixels into DMA buffer
+//
+// Should be called from application loop while DMA transfer isn't running
+//
+// `inst_p` - pointer to initialized driver instance
+//
+// Returns - number of encoded pixels (0 - frame isn't changed since the previous call)
+//------------------------------------------------------------------------------
+uint32_t leds_strip_encode(const leds_strip_t * inst_p);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // DRV_LEDS_STRIP_H
@@ -0,0 +1,114 @@
+//**************************************************************************************************
+// Lock-free bounded multi-producer single-consumer queue
+//**************************************************************************************************
+// mpsc_push() can be called concurrently from any number of threads
+// mpsc_pop() should be called from a single consumer thread
+//
+// Queue is a ring of cells, each cell holds a sequence number and a copy of one item:
+//  - producers reserve cells with one compare-and-swap, there are no locks and no system calls
+//  - producers and consumer work on different cache lines
+//  - items are popped in order of reservation
+//
+// Requires C11 atomics
+//
+// All functions are reenterable:
+//  - driver doesn't use internal static data
+//  - queue instance and table of cells are supposed to be stored externally
+//**************************************************************************************************
+
+#ifndef DRV_MPSC_H
+#define DRV_MPSC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdalign.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//==================================================================================================
+//=========================================== MACROS ===============================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Size of cache line to separate data of producers and consumer
+//------------------------------------------------------------------------------
+#define MPSC_CACHE_LINE_SIZE (64)
+
+//------------------------------------------------------------------------------
+// Size of hidden structure mpsc_t
+//------------------------------------------------------------------------------
+#define MPSC_INSTANCE_SIZE (3 * MPSC_CACHE_LINE_SIZE)
+
+//------------------------------------------------------------------------------
+// Size of one cell in bytes - sequence number and item rounded up to 8 bytes
+//
+// `item_size` - size of one item in bytes
+//------------------------------------------------------------------------------
+#define MPSC_CELL_SIZE(item_size) (8 + ((((item_size) + 7) / 8) * 8))
+
+//==================================================================================================
+//========================================== TYPEDEFS ==============================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Queue instance (structure is hidden in .c file)
+//------------------------------------------------------------------------------
+typedef struct mpsc_s {
+    alignas(MPSC_CACHE_LINE_SIZE) uint8_t data[MPSC_INSTANCE_SIZE];
+} mpsc_t;
+
+//==================================================================================================
+//================================ PUBLIC FUNCTIONS DECLARATIONS ===================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Init queue
+//
+// `inst_p`    - pointer to queue instance, can be uninitialized
+// `cells_p`   - pointer to array of cells aligned to 8 bytes with size = num * MPSC_CELL_SIZE(item_size) bytes
+// `num`       - number of cells (must be a power of 2)
+// `item_size` - size of one item in bytes (must be > 0)
+//------------------------------------------------------------------------------
+void mpsc_init(mpsc_t * inst_p, void * cells_p, uint32_t num, uint32_t item_size);
+
+//------------------------------------------------------------------------------
+// Push copy of item into queue
+//
+// Can be called from any thread
+//
+// `inst_p` - pointer to initialized queue instance
+// `item_p` - pointer to item with size passed into mpsc_init()
+//
+// Returns - 'true' if item is pushed, 'false' if queue is full
+//------------------------------------------------------------------------------
+bool mpsc_push(const mpsc_t * inst_p, const void * item_p);
+
+//------------------------------------------------------------------------------
+// Pop the oldest item from queue
+//
+// Must be called from a single consumer thread
+//
+// `inst_p`     - pointer to initialized queue instance
+// `item_out_p` - out - pointer to buffer for item with size passed into mpsc_init()
+//
+// Returns - 'true' if item is popped, 'false' if queue is empty
+//------------------------------------------------------------------------------
+bool mpsc_pop(const mpsc_t * inst_p, void * item_out_p);
+
+//==================================================================================================
+//============================================ TESTS ===============================================
+//==================================================================================================
+
+//-----------------------------------------------------------------------------
+// Run unit-tests
+// Returns - number of failed test or 0 if all tests are successful
+//-----------------------------------------------------------------------------
+int32_t mpsc_tests(void);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // DRV_MPSC_H
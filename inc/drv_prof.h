@@ -0,0 +1,136 @@
+//**************************************************************************************************
+// Cycle-count profiling statistics
+//**************************************************************************************************
+// Accumulates durations measured in cycles of a user-supplied counter (e.g. DWT->CYCCNT on Cortex-M3+,
+// SysTick extended by reload counter on Cortex-M0+) - count, min, max, sum and log2 histogram
+//
+// Profiling hooks of drivers (drv_swtimers, drv_leds, drv_buttons) are compiled only if DRV_PROF == 1,
+// by default hooks are compiled out and don't cost anything
+// DRV_PROF must be defined in the same way for all translation units (e.g. with -DDRV_PROF=1)
+//
+// Statistics are updated by a single writer (ISR or application loop) without critical sections,
+// reader takes consistent snapshot with prof_stats_read() while the system is running
+// (reader mustn't preempt the writer - e.g. statistics of application loop can't be read from ISR)
+//
+// All functions are reenterable:
+//  - driver doesn't use internal static data
+//  - statistics are supposed to be stored externally
+//**************************************************************************************************
+
+#ifndef DRV_PROF_H
+#define DRV_PROF_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//==================================================================================================
+//=========================================== MACROS ===============================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Profiling hooks of drivers: 0 - compiled out, 1 - compiled in
+//------------------------------------------------------------------------------
+#ifndef DRV_PROF
+#define DRV_PROF (0)
+#endif
+
+//------------------------------------------------------------------------------
+// Number of histogram buckets
+// Bucket 0 - 0 cycles, bucket k - from 2^(k-1) to 2^k - 1 cycles, the last bucket - 2^30 cycles and more
+//------------------------------------------------------------------------------
+#define PROF_HIST_SIZE (32)
+
+//==================================================================================================
+//========================================== TYPEDEFS ==============================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Callback - Read cycle counter
+// Counter must increase and wrap around at 2^32, durations are calculated as differences
+//
+// Returns - current value of cycle counter
+//------------------------------------------------------------------------------
+typedef uint32_t (*prof_cycles_cb_t)(void);
+
+//------------------------------------------------------------------------------
+// Statistics of one measurement point (all fields are zero before the first measurement)
+//------------------------------------------------------------------------------
+typedef struct prof_stats_s {
+    volatile uint32_t   seq;                    // sequence counter, odd while writer updates statistics
+    volatile bool       is_reset_pending;       // 'true' - if statistics should be cleared by writer
+    uint8_t             align[3];
+    volatile uint32_t   count;                  // number of measurements
+    volatile uint32_t   min;                    // minimal duration in cycles
+    volatile uint32_t   max;                    // maximal duration in cycles
+    volatile uint64_t   sum;                    // sum of durations in cycles
+    volatile uint32_t   hist[PROF_HIST_SIZE];   // log2 histogram of durations
+} prof_stats_t;
+
+//==================================================================================================
+//================================ PUBLIC FUNCTIONS DECLARATIONS ===================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Add measurement (to be called by writer only)
+//
+// `stats_p` - pointer to statistics
+// `cycles`  - duration in cycles
+//------------------------------------------------------------------------------
+void prof_stats_add(prof_stats_t * stats_p, uint32_t cycles);
+
+//------------------------------------------------------------------------------
+// Get consistent snapshot of statistics
+//
+// Doesn't block the writer, repeats copying if the writer has updated statistics during the copy
+//
+// `stats_p`    - pointer to statistics
+// `snapshot_p` - out - copy of statistics
+//------------------------------------------------------------------------------
+void prof_stats_read(const prof_stats_t * stats_p, prof_stats_t * snapshot_p);
+
+//------------------------------------------------------------------------------
+// Clear statistics
+//
+// Statistics are cleared by the writer before the next measurement, snapshots are empty until that
+//
+// `stats_p` - pointer to statistics
+//------------------------------------------------------------------------------
+void prof_stats_reset(prof_stats_t * stats_p);
+
+//------------------------------------------------------------------------------
+// Get mean duration
+//
+// `snapshot_p` - pointer to snapshot of statistics
+//
+// Returns - mean duration in cycles, 0 if there are no measurements
+//------------------------------------------------------------------------------
+uint32_t prof_stats_mean(const prof_stats_t * snapshot_p);
+
+//------------------------------------------------------------------------------
+// Get index of histogram bucket for duration
+//
+// `cycles` - duration in cycles
+//
+// Returns - index of bucket (0 .. PROF_HIST_SIZE-1)
+//------------------------------------------------------------------------------
+uint32_t prof_hist_bucket(uint32_t cycles);
+
+//==================================================================================================
+//============================================ TESTS ===============================================
+//==================================================================================================
+
+//-----------------------------------------------------------------------------
+// Run unit-tests
+// Returns - number of failed test or 0 if all tests are successful
+//-----------------------------------------------------------------------------
+int32_t prof_tests(void);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // DRV_PROF_H
@@ -0,0 +1,282 @@
+//**************************************************************************************************
+// Protothreads - stackless cooperative coroutines based on software timers
+//**************************************************************************************************
+// Depends on drv_swtimers:
+//  - swtimers driver should be initialized before any usage of this driver
+//  - swtimers_task() should be called periodically from application loop
+//  - swtimers_isr() should be called periodically from ISR context
+//  - each protothread occupies one software timer
+//
+// Protothread is a function which can wait in the middle of its body and continue from the same place:
+//  - PT_AWAIT_MS()     - continues from swtimers_task() after timeout (handler of the timer is bound once
+//                        in pt_init(), each wait only re-arms its threshold with swtimers_restart())
+//  - PT_AWAIT_BUTTON() - continues from buttons_task() on button event (pt_buttons_handler() must be set as
+//                        handler of the button with pointer to protothread as argument)
+//  - PT_AWAIT_FLAG()   - checks condition once per tick of software timers until it becomes 'true'
+//                        (PT_AWAIT_FLAG_POLL() checks it with the given period to save polling work)
+//
+// Local variables of protothread function are not preserved between waits (use `arg_p` or static storage)
+// Waits can't be used inside of switch statements of protothread function
+//
+// All functions are reenterable:
+//  - driver doesn't use internal static data
+//  - protothread instances are supposed to be stored externally
+//
+//**************************************************************************************************
+// Example
+//**************************************************************************************************
+//  static pt_state_t app_blink_thread(pt_t * pt_p, void * arg_p)
+//  {
+//      PT_BEGIN(pt_p);
+//      PT_AWAIT_BUTTON(pt_p, BUTTONS_PRESSED);
+//      leds_on(&leds_inst, LED_1);
+//      PT_AWAIT_MS(pt_p, 500);
+//      leds_off(&leds_inst, LED_1);
+//      PT_AWAIT_FLAG(pt_p, app_is_ready);
+//      PT_END(pt_p);
+//  }
+//
+//  pt_init(&app_pt, &timers_inst, TIMER_APP_PT, app_blink_thread, NULL);
+//  buttons_configure(&buttons_inst, BTN_1, GPIO_BTN1, TIMER_BTN_1, true, BUTTONS_CHECK_IN_POLLING,
+//                    &buttons_time_settings, pt_buttons_handler, &app_pt);
+//  pt_start(&app_pt);
+//
+//**************************************************************************************************
+#ifndef DRV_PT_H
+#define DRV_PT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "drv_swtimers.h"
+#include "drv_buttons.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//==================================================================================================
+//=========================================== MACROS ===============================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Start / end of protothread body
+//
+// `pt_p` - pointer to protothread instance, passed into protothread function
+//------------------------------------------------------------------------------
+#define PT_BEGIN(pt_p)                                                              \
+    switch ((pt_p)->lc) {                                                           \
+        case 0:
+
+#define PT_END(pt_p)                                                                \
+    }                                                                               \
+    (pt_p)->lc = 0;                                                                 \
+    return PT_STATE_EXITED
+
+//------------------------------------------------------------------------------
+// Leave protothread from the middle of the body
+//
+// `pt_p` - pointer to protothread instance, passed into protothread function
+//------------------------------------------------------------------------------
+#define PT_EXIT(pt_p)                                                               \
+    do {                                                                            \
+        (pt_p)->lc = 0;                                                             \
+        return PT_STATE_EXITED;                                                     \
+    } while (0)
+
+//------------------------------------------------------------------------------
+// Wait for timeout
+//
+// `pt_p` - pointer to protothread instance, passed into protothread function
+// `ms`   - timeout in milliseconds (can be 0 to continue at the next tick)
+//------------------------------------------------------------------------------
+#define PT_AWAIT_MS(pt_p, ms)                                                       \
+    do {                                                                            \
+        pt_wait_ms((pt_p), (ms));                                                   \
+        (pt_p)->lc = __LINE__;                                                      \
+        return PT_STATE_WAITING;                                                    \
+        case __LINE__:;                                                             \
+    } while (0)
+
+//------------------------------------------------------------------------------
+// Wait for button event
+// Received event and button index can be read with pt_get_button_event()
+//
+// `pt_p`  - pointer to protothread instance, passed into protothread function
+// `event` - mask of awaited button events, combined with logical OR
+//------------------------------------------------------------------------------
+#define PT_AWAIT_BUTTON(pt_p, event)                                                \
+    do {                                                                            \
+        pt_wait_button((pt_p), (event));                                            \
+        while ((pt_p)->wait != PT_WAIT_NONE) {                                      \
+            (pt_p)->lc = __LINE__;                                                  \
+            return PT_STATE_WAITING;                                                \
+            case __LINE__:;                                                         \
+        }                                                                           \
+    } while (0)
+
+//------------------------------------------------------------------------------
+// Wait until condition becomes 'true'
+// Condition is checked immediately and then once per `poll_ms`
+//
+// `pt_p`    - pointer to protothread instance, passed into protothread function
+// `cond`    - condition expression (e.g. flag set from ISR)
+// `poll_ms` - period of checks in milliseconds (0 - check at every tick of software timers)
+//------------------------------------------------------------------------------
+#define PT_AWAIT_FLAG_POLL(pt_p, cond, poll_ms)                                     \
+    do {                                                                            \
+        while (!(cond)) {                                                           \
+            pt_wait_ms((pt_p), (poll_ms));                                          \
+            (pt_p)->lc = __LINE__;                                                  \
+            return PT_STATE_WAITING;                                                \
+            case __LINE__:;                                                         \
+        }                                                                           \
+    } while (0)
+
+//------------------------------------------------------------------------------
+// Wait until condition becomes 'true'
+// Condition is checked immediately and then once per tick of software timers
+//
+// `pt_p` - pointer to protothread instance, passed into protothread function
+// `cond` - condition expression (e.g. flag set from ISR)
+//------------------------------------------------------------------------------
+#define PT_AWAIT_FLAG(pt_p, cond)   PT_AWAIT_FLAG_POLL(pt_p, cond, 0)
+
+//==================================================================================================
+//========================================== TYPEDEFS ==============================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Result of protothread function
+//------------------------------------------------------------------------------
+typedef enum pt_state_e {
+    PT_STATE_WAITING = 0,   // protothread waits for an event
+    PT_STATE_EXITED,        // protothread is finished
+} pt_state_t;
+
+//------------------------------------------------------------------------------
+// Event awaited by protothread
+//------------------------------------------------------------------------------
+typedef enum pt_wait_e {
+    PT_WAIT_NONE = 0,       // protothread is running or finished
+    PT_WAIT_TIMER,          // protothread waits for timeout
+    PT_WAIT_BUTTON,         // protothread waits for button event
+} pt_wait_t;
+
+//------------------------------------------------------------------------------
+// Protothread instance
+//------------------------------------------------------------------------------
+typedef struct pt_s pt_t;
+
+//------------------------------------------------------------------------------
+// Callback - Protothread function
+//
+// `pt_p`  - pointer to protothread instance
+// `arg_p` - pointer to application data, passed over pt_init function (can be NULL)
+//
+// Returns - PT_STATE_WAITING if protothread waits for event, PT_STATE_EXITED if protothread is finished
+//------------------------------------------------------------------------------
+typedef pt_state_t (*pt_func_t)(pt_t * pt_p, void * arg_p);
+
+//------------------------------------------------------------------------------
+// Protothread instance (fields are used by macros and must not be changed by application)
+//------------------------------------------------------------------------------
+struct pt_s {
+
+    // Settings
+    pt_func_t           func;           // protothread function
+    void*               arg_p;          // pointer to application data to be passed into protothread function
+    const swtimers_t*   swtimers_p;     // pointer to software timers driver instance
+    uint32_t            timer_idx;      // index of software timer to measure timeouts
+
+    // State
+    uint16_t            lc;             // local continuation - line of the last wait
+    uint8_t             wait;           // awaited event (pt_wait_t)
+    bool                is_exited;      // 'true' - if protothread is finished or stopped
+    uint8_t             button_mask;    // mask of awaited button events
+    uint8_t             button_event;   // received button event
+    uint16_t            button_idx;     // index of button emitted the received event
+};
+
+//==================================================================================================
+//================================ PUBLIC FUNCTIONS DECLARATIONS ===================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Init protothread
+//
+// `pt_p`       - pointer to protothread instance, can be uninitialized
+// `swtimers_p` - pointer to initialized software timers driver instance
+// `timer_idx`  - index of software timer to measure timeouts (bound to protothread, must not be used elsewhere)
+// `func`       - protothread function
+// `arg_p`      - pointer to application data to be passed into protothread function (can be NULL)
+//------------------------------------------------------------------------------
+void pt_init(pt_t * pt_p, const swtimers_t * swtimers_p, uint32_t timer_idx, pt_func_t func, void * arg_p);
+
+//------------------------------------------------------------------------------
+// Start protothread from the beginning
+// Protothread function is called immediately until the first wait
+// If protothread is already started - stop it and restart
+//
+// `pt_p` - pointer to initialized protothread instance
+//------------------------------------------------------------------------------
+void pt_start(pt_t * pt_p);
+
+//------------------------------------------------------------------------------
+// Stop protothread
+//
+// `pt_p` - pointer to initialized protothread instance
+//------------------------------------------------------------------------------
+void pt_stop(pt_t * pt_p);
+
+//------------------------------------------------------------------------------
+// Check if protothread is finished or stopped
+//
+// `pt_p` - pointer to initialized protothread instance
+//
+// Returns - 'true' if protothread is finished or stopped, 'false' otherwise
+//------------------------------------------------------------------------------
+bool pt_is_exited(const pt_t * pt_p);
+
+//------------------------------------------------------------------------------
+// Get the last button event received by PT_AWAIT_BUTTON()
+//
+// `pt_p`             - pointer to initialized protothread instance
+// `button_idx_out_p` - out - index of button emitted the event (can be NULL)
+//
+// Returns - button event (BUTTONS_NO_EVENT if there were no events)
+//------------------------------------------------------------------------------
+buttons_event_t pt_get_button_event(const pt_t * pt_p, uint32_t * button_idx_out_p);
+
+//------------------------------------------------------------------------------
+// Handler of button events to resume protothread waiting in PT_AWAIT_BUTTON()
+// Signature corresponds to buttons_handler_cb_t
+//
+// `button_idx` - index of button
+// `event`      - mask with button events
+// `arg_p`      - pointer to protothread instance (with type pt_t*)
+//------------------------------------------------------------------------------
+void pt_buttons_handler(uint32_t button_idx, buttons_event_t event, void * arg_p);
+
+//------------------------------------------------------------------------------
+// Internal functions used by macros
+//------------------------------------------------------------------------------
+void pt_wait_ms(pt_t * pt_p, uint32_t ms);
+void pt_wait_button(pt_t * pt_p, buttons_event_t event);
+
+//==================================================================================================
+//============================================ TESTS ===============================================
+//==================================================================================================
+
+//-----------------------------------------------------------------------------
+// Run unit-tests
+// Returns - number of failed test or 0 if all tests are successful
+//-----------------------------------------------------------------------------
+int32_t pt_tests(void);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // DRV_PT_H
@@ -6,6 +6,21 @@
 //
 // Driver uses a single hardware timer accessed over callback functions
 //
+// Work queue (drv_workqueue) can be attached to the driver to process deferred work items inside swtimers_task()
+// Hook can be attached to be called at the end of swtimers_task() after all handlers (e.g. to flush batched outputs)
+//
+// Lateness of handlers (ticks between expiration in ISR and handler call) and actual periods of periodic
+// timers can be collected into attached array of statistics
+//
+// Counters of activity (starts, expirations, handler calls, overruns, idle ticks) are always collected
+// and can be exported with swtimers_get_stats()
+//
+// Handlers called from ISR can be given budgets in cycles of a user-supplied counter, handlers which exceed
+// their budget are reported and counted, demoted to application loop or stopped (swtimers_set_watchdog())
+//
+// If DRV_PROF == 1 (drv_prof), cycles of ISR scan, swtimers_task() and each handler can be measured
+// If DRV_TRACE == 1 (drv_trace), start/stop/expiration of timers and handler calls can be traced
+//
 // All functions are reenterable:
 //  - driver doesn't use internal static data
 //  - driver's instance and table of timers are supposed to be stored externally
@@ -17,6 +32,10 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#include "drv_workqueue.h"
+#include "drv_prof.h"
+#include "drv_trace.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -26,14 +45,28 @@ extern "C" {
 //==================================================================================================
 
 //------------------------------------------------------------------------------
-// Size of hidden structure swtimers_timer_t
+// Size of hidden structure swtimers_timer_t (32-bit / 64-bit platforms)
 //------------------------------------------------------------------------------
+#if (UINTPTR_MAX == UINT32_MAX)
 #define SWTIMERS_SINGLE_TIMER_INSTANCE_SIZE (24)
+#else
+#define SWTIMERS_SINGLE_TIMER_INSTANCE_SIZE (40)
+#endif
 
 //------------------------------------------------------------------------------
-// Size of hidden structure swtimers_t
+// Size of hidden structure swtimers_t (32-bit / 64-bit platforms)
+// (each of DRV_PROF and DRV_TRACE adds one pointer)
 //------------------------------------------------------------------------------
-#define SWTIMERS_DRIVER_INSTANCE_SIZE (12)
+#if (UINTPTR_MAX == UINT32_MAX)
+#define SWTIMERS_DRIVER_INSTANCE_SIZE (76 + (4 * DRV_PROF) + (4 * DRV_TRACE))
+#else
+#define SWTIMERS_DRIVER_INSTANCE_SIZE (104 + (8 * DRV_PROF) + (8 * DRV_TRACE))
+#endif
+
+//------------------------------------------------------------------------------
+// Value returned by swtimers_next_expiry_ticks() if there are no started timers
+//------------------------------------------------------------------------------
+#define SWTIMERS_NO_EXPIRY (UINT32_MAX)
 
 //==================================================================================================
 //========================================== TYPEDEFS ==============================================
@@ -65,6 +98,13 @@ typedef void (*swtimers_handler_cb_t)(uint32_t timer_idx, void * arg_1_p, void *
 //------------------------------------------------------------------------------
 typedef void (*swtimers_handler_simple_cb_t)(void);
 
+//------------------------------------------------------------------------------
+// Callback - Hook at the end of swtimers_task() (called from application loop after all handlers)
+//
+// `arg_p` - pointer to application data, passed over swtimers_set_task_hook function (can be NULL)
+//------------------------------------------------------------------------------
+typedef void (*swtimers_task_hook_cb_t)(void * arg_p);
+
 //------------------------------------------------------------------------------
 // Callback - Enable interrupt from hardware timer (to allow swtimers_isr handler calls)
 // Callback - Disable interrupt from hardware timer (to allow swtimers_isr handler calls)
@@ -116,6 +156,82 @@ typedef struct swtimers_s {
     uint8_t data[SWTIMERS_DRIVER_INSTANCE_SIZE];
 } swtimers_t;
 
+//------------------------------------------------------------------------------
+// Lateness statistics of one timer (all fields are zero before the first handler call)
+//
+// Lateness - ticks from expiration of the timer in ISR until the call of its handler
+// (always 0 for handlers called from ISR, tick resolution for handlers called from application loop)
+// Period - ticks between two subsequent handler calls of periodic timer without restart
+//------------------------------------------------------------------------------
+typedef struct swtimers_lateness_s {
+    uint64_t    sum;            // sum of lateness in ticks (mean = sum / count)
+    uint32_t    count;          // number of handler calls
+    uint32_t    last;           // lateness of the last handler call in ticks
+    uint32_t    max;            // worst-case lateness in ticks (watermark)
+    uint32_t    period_min;     // minimal actual period in ticks (0 if there are no periods yet)
+    uint32_t    period_max;     // maximal actual period in ticks
+
+    // Internal state
+    uint32_t    expiry_tick;    // tick of the first expiration not handled yet
+    uint32_t    call_tick;      // tick of the last handler call
+    bool        is_called;      // 'true' - if handler has been called since the last start of the timer
+    uint8_t     align[3];
+} swtimers_lateness_t;
+
+//------------------------------------------------------------------------------
+// Counters of driver activity (wrap around at 2^32)
+//------------------------------------------------------------------------------
+typedef struct swtimers_stats_s {
+    uint32_t    started;        // number of timer starts
+    uint32_t    expired;        // number of timer expirations in ISR
+    uint32_t    dispatched;     // number of handler calls (from ISR and application loop)
+    uint32_t    overruns;       // number of expirations of timers with handler from loop while the previous call is still waiting
+    uint32_t    idle_isr;       // number of swtimers_isr()/swtimers_isr_ticks() calls without expirations
+    uint32_t    peak_active;    // maximal number of running timers seen in ISR (watermark)
+    uint32_t    over_budget;    // number of handler calls from ISR which exceeded their budget (see swtimers_set_watchdog())
+} swtimers_stats_t;
+
+//------------------------------------------------------------------------------
+// Action on handler called from ISR which has exceeded its budget
+//------------------------------------------------------------------------------
+typedef enum swtimers_budget_policy_e {
+    SWTIMERS_BUDGET_COUNT = 0,  // count and report only
+    SWTIMERS_BUDGET_DEMOTE,     // the next handler calls are done from application loop (until the next start of the timer)
+    SWTIMERS_BUDGET_DISABLE,    // stop the timer
+} swtimers_budget_policy_t;
+
+//------------------------------------------------------------------------------
+// Callback - Handler has exceeded its budget (called from ISR context after the handler and the policy action)
+//
+// `timer_idx` - index of timer
+// `cycles`    - duration of handler call in cycles
+// `arg_p`     - pointer to application data, passed over swtimers_watchdog_t structure
+//------------------------------------------------------------------------------
+typedef void (*swtimers_budget_cb_t)(uint32_t timer_idx, uint32_t cycles, void * arg_p);
+
+//------------------------------------------------------------------------------
+// Budgets of handlers called from ISR
+//------------------------------------------------------------------------------
+typedef struct swtimers_watchdog_s {
+    prof_cycles_cb_t            cycles_cb;      // Read cycle counter
+    const uint32_t*             budgets_p;      // Array of `num` budgets in cycles (0 - handler isn't checked)
+    swtimers_budget_policy_t    policy;         // Action on exceeded budget
+    swtimers_budget_cb_t        report_cb;      // Report of exceeded budget (can be NULL)
+    void*                       report_arg_p;   // Pointer to application data to be passed into report callback (can be NULL)
+} swtimers_watchdog_t;
+
+#if (DRV_PROF == 1)
+//------------------------------------------------------------------------------
+// Profiling statistics (see drv_prof.h)
+//------------------------------------------------------------------------------
+typedef struct swtimers_prof_s {
+    prof_cycles_cb_t    cycles_cb;      // Read cycle counter
+    prof_stats_t        isr;            // swtimers_isr()/swtimers_isr_ticks() scan including handlers called from ISR
+    prof_stats_t        task;           // swtimers_task() including work queue and handlers called from application loop
+    prof_stats_t*       handlers_p;     // Array of `num` statistics of each timer handler (can be NULL)
+} swtimers_prof_t;
+#endif
+
 //==================================================================================================
 //================================ PUBLIC FUNCTIONS DECLARATIONS ===================================
 //==================================================================================================
@@ -177,6 +293,7 @@ void swtimers_start_simple(const swtimers_t * inst_p, uint32_t idx, uint32_t ms,
 // Start single shot timer without handler
 //
 // If timer is already started - stop it and restart
+// Expiration is polled with swtimers_is_run(), it keeps swtimers_next_expiry_ticks() at 0 until swtimers_task()
 //
 // `inst_p`     - pointer to initialized driver instance
 // `idx`        - index of timer (must be 0 .. num-1)
@@ -184,6 +301,18 @@ void swtimers_start_simple(const swtimers_t * inst_p, uint32_t idx, uint32_t ms,
 //------------------------------------------------------------------------------
 void swtimers_start_no_handler(const swtimers_t * inst_p, uint32_t idx, uint32_t ms);
 
+//------------------------------------------------------------------------------
+// Restart timer with new threshold, keeping handler, mode and arguments of the last start
+// Cheaper than swtimers_start() for a timer which is re-armed repeatedly with the same handler
+//
+// If timer is already started - restart it from zero
+//
+// `inst_p`     - pointer to initialized driver instance
+// `idx`        - index of timer (must be 0 .. num-1)
+// `ms`         - threshold for timer in milliseconds (can be 0)
+//------------------------------------------------------------------------------
+void swtimers_restart(const swtimers_t * inst_p, uint32_t idx, uint32_t ms);
+
 //------------------------------------------------------------------------------
 // Stop timer
 //
@@ -223,6 +352,130 @@ void swtimers_stop_all(const swtimers_t * inst_p);
 //------------------------------------------------------------------------------
 bool swtimers_is_run(const swtimers_t * inst_p, uint32_t idx, uint32_t * time_ms_out_p);
 
+//------------------------------------------------------------------------------
+// Get number of ticks until the nearest timer expiration
+//
+// Value is maintained by swtimers_isr() and start functions, so the call doesn't scan the table of timers
+// Value is a lower bound - stopped timers are taken into account until the next swtimers_isr() call
+// Can be used to choose sleep duration of the application loop
+//
+// `inst_p` - pointer to initialized driver instance
+//
+// Returns - 0 if swtimers_task() has handlers to be called or timer without handler (*_FROM_LOOP) has expired
+//           and application loop hasn't called swtimers_task() since then,
+//           SWTIMERS_NO_EXPIRY if there are no started timers,
+//           number of swtimers_isr() calls until the nearest timer expiration otherwise
+//------------------------------------------------------------------------------
+uint32_t swtimers_next_expiry_ticks(const swtimers_t * inst_p);
+
+//------------------------------------------------------------------------------
+// Get time base of the driver - milliseconds of ticks passed into swtimers_isr()/swtimers_isr_ticks()
+//
+// Time advances while hardware timer is running (while any timer is started), wraps around at 2^32
+//
+// `inst_p` - pointer to initialized driver instance
+//
+// Returns - time in milliseconds
+//------------------------------------------------------------------------------
+uint32_t swtimers_get_time_ms(const swtimers_t * inst_p);
+
+//------------------------------------------------------------------------------
+// Get duration of one tick of hardware timer (resolution of all timers)
+//
+// `inst_p` - pointer to initialized driver instance
+//
+// Returns - tick in milliseconds
+//------------------------------------------------------------------------------
+uint32_t swtimers_get_tick_ms(const swtimers_t * inst_p);
+
+//------------------------------------------------------------------------------
+// Attach work queue to be processed inside swtimers_task()
+//
+// Work items are processed at the beginning of swtimers_task() before timer handlers
+// swtimers_next_expiry_ticks() returns 0 while the work queue is not empty
+//
+// `inst_p`      - pointer to initialized driver instance
+// `workqueue_p` - pointer to initialized work queue driver instance (can be NULL to detach)
+//------------------------------------------------------------------------------
+void swtimers_set_workqueue(const swtimers_t * inst_p, const workqueue_t * workqueue_p);
+
+//------------------------------------------------------------------------------
+// Attach hook to be called at the end of each swtimers_task() call
+//
+// Only one hook can be attached, the new one replaces the previous one
+//
+// `inst_p`  - pointer to initialized driver instance
+// `hook_cb` - hook callback (can be NULL to detach)
+// `arg_p`   - pointer to application data to be passed into hook (can be NULL)
+//------------------------------------------------------------------------------
+void swtimers_set_task_hook(const swtimers_t * inst_p, swtimers_task_hook_cb_t hook_cb, void * arg_p);
+
+//------------------------------------------------------------------------------
+// Attach array of lateness statistics
+//
+// Costs one subtraction and a few comparisons per handler call
+// To clear statistics - attach zero-initialized array again
+//
+// `inst_p`     - pointer to initialized driver instance
+// `lateness_p` - pointer to zero-initialized array of `num` statistics (can be NULL to detach)
+//------------------------------------------------------------------------------
+void swtimers_set_lateness(const swtimers_t * inst_p, swtimers_lateness_t * lateness_p);
+
+//------------------------------------------------------------------------------
+// Get lateness statistics of the timer
+//
+// `inst_p`         - pointer to initialized driver instance with attached lateness statistics
+// `idx`            - index of timer (must be 0 .. num-1)
+// `lateness_out_p` - out - copy of statistics
+//------------------------------------------------------------------------------
+void swtimers_get_lateness(const swtimers_t * inst_p, uint32_t idx, swtimers_lateness_t * lateness_out_p);
+
+//------------------------------------------------------------------------------
+// Get counters of driver activity
+//
+// Counters are updated without critical sections (each one has a single writer context),
+// snapshot and reset are done in one critical section, so no counts are lost between exports
+//
+// `inst_p`      - pointer to initialized driver instance
+// `stats_out_p` - out - snapshot of counters since init or the previous reset
+// `is_reset`    - 'true' - clear counters after taking snapshot
+//------------------------------------------------------------------------------
+void swtimers_get_stats(const swtimers_t * inst_p, swtimers_stats_t * stats_out_p, bool is_reset);
+
+//------------------------------------------------------------------------------
+// Attach budgets of handlers called from ISR
+//
+// Costs two readings of cycle counter per checked handler call
+// Handlers called from application loop aren't checked (they don't delay ticks of other timers)
+//
+// `inst_p`     - pointer to initialized driver instance
+// `watchdog_p` - pointer to budgets (can be NULL to detach), must be alive while it is attached
+//------------------------------------------------------------------------------
+void swtimers_set_watchdog(const swtimers_t * inst_p, const swtimers_watchdog_t * watchdog_p);
+
+#if (DRV_TRACE == 1)
+//------------------------------------------------------------------------------
+// Attach trace
+//
+// `inst_p`  - pointer to initialized driver instance
+// `trace_p` - pointer to initialized trace instance (can be NULL to detach)
+//------------------------------------------------------------------------------
+void swtimers_set_trace(const swtimers_t * inst_p, const trace_t * trace_p);
+#endif
+
+#if (DRV_PROF == 1)
+//------------------------------------------------------------------------------
+// Attach profiling statistics
+//
+// Statistics of ISR scan are updated from ISR context, the rest - from application loop
+// Should be called while hardware timer interrupt is disabled or before start of timers
+//
+// `inst_p` - pointer to initialized driver instance
+// `prof_p` - pointer to zero-initialized profiling statistics (can be NULL to detach)
+//------------------------------------------------------------------------------
+void swtimers_set_prof(const swtimers_t * inst_p, swtimers_prof_t * prof_p);
+#endif
+
 //------------------------------------------------------------------------------
 // Check all SW timers and call handlers if necessary
 //
@@ -245,6 +498,19 @@ void swtimers_task(const swtimers_t * inst_p);
 //------------------------------------------------------------------------------
 void swtimers_isr(const swtimers_t * inst_p);
 
+//------------------------------------------------------------------------------
+// ISR handler for hardware timer interrupt after several ticks
+//
+// To be called instead of swtimers_isr() by tickless time sources which skip ticks without expirations
+// (e.g. one-shot hardware timer programmed with swtimers_next_expiry_ticks())
+//
+// Each periodic timer calls its handler once even if several periods are passed
+//
+// `inst_p` - pointer to initialized driver instance
+// `ticks`  - number of ticks passed since the previous call (must be > 0)
+//------------------------------------------------------------------------------
+void swtimers_isr_ticks(const swtimers_t * inst_p, uint32_t ticks);
+
 //==================================================================================================
 //============================================ TESTS ===============================================
 //==================================================================================================
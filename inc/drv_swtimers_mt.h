@@ -0,0 +1,224 @@
+//**************************************************************************************************
+// Multi-threaded software timers engine for Linux
+//**************************************************************************************************
+// Thread-safe variant of drv_swtimers for hosts with many threads starting and stopping timers:
+//  - start/stop/restart functions can be called from any thread (including handlers)
+//  - commands are passed to the timer thread over lock-free MPSC queue (see drv_mpsc)
+//  - the timer thread owns all timers and applies commands at the beginning of each tick,
+//    at most `cmd_num` commands per tick - throughput of start/stop/restart is limited to
+//    cmd_num commands per tick_ms, when the queue is full start/stop/restart return 'false'
+//  - handlers of *_FROM_ISR modes are called from the timer thread
+//  - handlers of *_FROM_LOOP modes are called from a pool of worker threads,
+//    handlers of the same timer are always called from the same worker in order of expiration,
+//    the timer thread never waits for workers - when job queue of the worker is full the call is
+//    dropped and counted (see swtimers_mt_get_overruns()), periodic timer calls it on the next expiration
+//  - handler dispatched to worker isn't called if the timer was stopped or restarted before the call
+//
+// Timers are stored in a hashed timing wheel:
+//  - start, stop and restart cost doesn't depend on number of timers
+//  - each tick processes only timers in one slot of the wheel,
+//    number of slots should be comparable with number of simultaneously started timers
+//
+// Linux only - requires POSIX threads, semaphores and CLOCK_MONOTONIC
+//
+// All functions are reenterable:
+//  - driver doesn't use internal static data
+//  - driver's instance and all tables are supposed to be stored externally
+//**************************************************************************************************
+
+#ifndef DRV_SWTIMERS_MT_H
+#define DRV_SWTIMERS_MT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdalign.h>
+
+#include "drv_swtimers.h"
+#include "drv_mpsc.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//==================================================================================================
+//=========================================== MACROS ===============================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Size of hidden structure swtimers_mt_timer_t
+//------------------------------------------------------------------------------
+#define SWTIMERS_MT_SINGLE_TIMER_INSTANCE_SIZE (56)
+
+//------------------------------------------------------------------------------
+// Size of hidden structure swtimers_mt_worker_t
+//------------------------------------------------------------------------------
+#define SWTIMERS_MT_SINGLE_WORKER_INSTANCE_SIZE (320)
+
+//------------------------------------------------------------------------------
+// Size of hidden structure swtimers_mt_t
+//------------------------------------------------------------------------------
+#define SWTIMERS_MT_DRIVER_INSTANCE_SIZE (320)
+
+//------------------------------------------------------------------------------
+// Size of one cell of command queue in bytes
+//------------------------------------------------------------------------------
+#define SWTIMERS_MT_CMD_CELL_SIZE MPSC_CELL_SIZE(48)
+
+//------------------------------------------------------------------------------
+// Size of one cell of worker's job queue in bytes
+//------------------------------------------------------------------------------
+#define SWTIMERS_MT_JOB_CELL_SIZE MPSC_CELL_SIZE(40)
+
+//------------------------------------------------------------------------------
+// Value of empty slot of the timing wheel
+//------------------------------------------------------------------------------
+#define SWTIMERS_MT_NO_TIMER (UINT32_MAX)
+
+//==================================================================================================
+//========================================== TYPEDEFS ==============================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Single timer instance (structure is hidden in .c file)
+//------------------------------------------------------------------------------
+typedef struct swtimers_mt_timer_s {
+    alignas(8) uint8_t data[SWTIMERS_MT_SINGLE_TIMER_INSTANCE_SIZE];
+} swtimers_mt_timer_t;
+
+//------------------------------------------------------------------------------
+// Single worker thread instance (structure is hidden in .c file)
+//------------------------------------------------------------------------------
+typedef struct swtimers_mt_worker_s {
+    alignas(MPSC_CACHE_LINE_SIZE) uint8_t data[SWTIMERS_MT_SINGLE_WORKER_INSTANCE_SIZE];
+} swtimers_mt_worker_t;
+
+//------------------------------------------------------------------------------
+// Driver instance (structure is hidden in .c file)
+//------------------------------------------------------------------------------
+typedef struct swtimers_mt_s {
+    alignas(MPSC_CACHE_LINE_SIZE) uint8_t data[SWTIMERS_MT_DRIVER_INSTANCE_SIZE];
+} swtimers_mt_t;
+
+//------------------------------------------------------------------------------
+// Driver settings
+//------------------------------------------------------------------------------
+typedef struct swtimers_mt_config_s {
+    uint32_t                tick_ms;        // One tick of the timer thread in milliseconds (must be > 0)
+    uint32_t                num;            // Number of timers (must be < SWTIMERS_MT_NO_TIMER)
+    swtimers_mt_timer_t*    timers_table_p; // Pointer to array of timers with size = num
+    uint32_t                slots_num;      // Number of slots of the timing wheel (must be a power of 2)
+    uint32_t*               slots_table_p;  // Pointer to array of slots with size = slots_num
+    uint32_t                cmd_num;        // Number of cells in command queue (must be a power of 2), also maximal number of commands applied per tick
+    void*                   cmd_cells_p;    // Pointer to array with size = cmd_num * SWTIMERS_MT_CMD_CELL_SIZE bytes, aligned to 8 bytes
+    uint32_t                workers_num;    // Number of worker threads (must be > 0)
+    swtimers_mt_worker_t*   workers_table_p;// Pointer to array of workers with size = workers_num
+    uint32_t                job_num;        // Number of cells in job queue of each worker (must be a power of 2)
+    void*                   job_cells_p;    // Pointer to array with size = workers_num * job_num * SWTIMERS_MT_JOB_CELL_SIZE bytes, aligned to 8 bytes
+} swtimers_mt_config_t;
+
+//==================================================================================================
+//================================ PUBLIC FUNCTIONS DECLARATIONS ===================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Init driver and start the timer thread and worker threads
+//
+// `inst_p`   - pointer to driver instance, can be uninitialized
+// `config_p` - pointer to driver settings, structure can be released after the call
+//
+// Returns - 'true' if all threads are started, 'false' otherwise (driver stays uninitialized)
+//------------------------------------------------------------------------------
+bool swtimers_mt_init(swtimers_mt_t * inst_p, const swtimers_mt_config_t * config_p);
+
+//------------------------------------------------------------------------------
+// Stop all threads and deinit driver
+// Handlers which are dispatched to workers but not called yet are called before exit of workers
+//
+// Mustn't be called from handlers
+//
+// `inst_p` - pointer to driver instance, can be uninitialized
+//------------------------------------------------------------------------------
+void swtimers_mt_deinit(swtimers_mt_t * inst_p);
+
+//------------------------------------------------------------------------------
+// Start timer
+//
+// Can be called from any thread, command is applied by the timer thread at the next tick
+// If timer is already started - stop it and restart
+//
+// `inst_p`     - pointer to initialized driver instance
+// `idx`        - index of timer (must be 0 .. num-1)
+// `ms`         - threshold for timer in milliseconds (can be 0 to expire at the next tick)
+// `mode`       - single or periodical run, call handler from worker (FROM_LOOP) or from the timer thread (FROM_ISR)
+// `handler_cb` - pointer to handler callback (can be NULL)
+// `arg_1_p`    - pointer to application data to be passed into handler callback (can be NULL)
+// `arg_2_p`    - pointer to application data to be passed into handler callback (can be NULL)
+//
+// Returns - 'true' if command is queued, 'false' if command queue is full (cmd_num commands are pending)
+//------------------------------------------------------------------------------
+bool swtimers_mt_start(const swtimers_mt_t * inst_p, uint32_t idx, uint32_t ms, swtimers_mode_t mode,
+                       swtimers_handler_cb_t handler_cb, void * arg_1_p, void * arg_2_p);
+
+//------------------------------------------------------------------------------
+// Restart timer with settings of the last start
+//
+// Can be called from any thread, command is applied by the timer thread at the next tick
+//
+// `inst_p` - pointer to initialized driver instance
+// `idx`    - index of timer (must be 0 .. num-1)
+//
+// Returns - 'true' if command is queued, 'false' if command queue is full (cmd_num commands are pending)
+//------------------------------------------------------------------------------
+bool swtimers_mt_restart(const swtimers_mt_t * inst_p, uint32_t idx);
+
+//------------------------------------------------------------------------------
+// Stop timer
+//
+// Can be called from any thread, command is applied by the timer thread at the next tick
+//
+// `inst_p` - pointer to initialized driver instance
+// `idx`    - index of timer (must be 0 .. num-1)
+//
+// Returns - 'true' if command is queued, 'false' if command queue is full (cmd_num commands are pending)
+//------------------------------------------------------------------------------
+bool swtimers_mt_stop(const swtimers_mt_t * inst_p, uint32_t idx);
+
+//------------------------------------------------------------------------------
+// Check if timer is run
+//
+// Can be called from any thread, returns state after the last command applied by the timer thread
+//
+// `inst_p` - pointer to initialized driver instance
+// `idx`    - index of timer (must be 0 .. num-1)
+//
+// Returns - 'true' if timer is run, 'false' otherwise
+//------------------------------------------------------------------------------
+bool swtimers_mt_is_run(const swtimers_mt_t * inst_p, uint32_t idx);
+
+//------------------------------------------------------------------------------
+// Get number of handler calls dropped because job queue of worker is full
+//
+// Can be called from any thread, non-zero value means that job_num or workers_num is too small
+// for the handlers *_FROM_LOOP
+//
+// `inst_p` - pointer to initialized driver instance
+//
+// Returns - number of dropped calls since init modulo 2^32
+//------------------------------------------------------------------------------
+uint32_t swtimers_mt_get_overruns(const swtimers_mt_t * inst_p);
+
+//==================================================================================================
+//============================================ TESTS ===============================================
+//==================================================================================================
+
+//-----------------------------------------------------------------------------
+// Run unit-tests
+// Returns - number of failed test or 0 if all tests are successful
+//-----------------------------------------------------------------------------
+int32_t swtimers_mt_tests(void);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // DRV_SWTIMERS_MT_H
@@ -0,0 +1,193 @@
+//**************************************************************************************************
+// Parallel dispatch of software timers handlers with work stealing (host builds)
+//**************************************************************************************************
+// Depends on drv_swtimers:
+//  - timers are started with swtimers_par_start() instead of swtimers_start() (modes *_FROM_LOOP only)
+//  - swtimers_par_task() is called from application loop instead of swtimers_task()
+//
+// Handlers of timers expired on the same tick are called in parallel:
+//  - swtimers_task() only collects jobs of expired timers (handlers of other timers are called as usual)
+//  - jobs are partitioned between per-thread deques, idle threads steal jobs from other deques
+//  - the calling thread takes part in the work, swtimers_par_task() returns when all jobs are finished
+//  - jobs without group are parallel-safe and can be called in any order and at the same time
+//  - jobs of the same serial group are called one by one in order of timers indexes
+//
+// Handlers are called from several threads at the same time, start and stop of any timer (including own one)
+// from handler updates data shared by all timers of swtimers instance:
+//  - handlers can start and stop timers only if critical section callbacks of swtimers_hw_interface_t are
+//    thread-safe (e.g. drv_swtimers_posix with its recursive mutex)
+//  - with critical section which only masks interrupts (bare-metal ports, tests/sim) handlers must not call
+//    swtimers functions
+//
+// Requires POSIX threads and C11 atomics
+//
+// All functions are reenterable:
+//  - driver doesn't use internal static data
+//  - driver's instance, jobs and all tables are supposed to be stored externally
+//
+//**************************************************************************************************
+// Example
+//**************************************************************************************************
+//  swtimers_par_init(&par_inst, workers, WORKERS_NUM, units, TIMERS_NUM, groups, GROUPS_NUM);
+//
+//  swtimers_par_job_init(&jobs[i], app_handler, &app_data[i], NULL, SWTIMERS_PAR_NO_GROUP);
+//  swtimers_par_start(&par_inst, &timers_inst, i, 100, SWTIMERS_MODE_PERIODIC_FROM_LOOP, &jobs[i]);
+//
+//  for (;;) {
+//      swtimers_par_task(&par_inst, &timers_inst);
+//  }
+//
+//**************************************************************************************************
+
+#ifndef DRV_SWTIMERS_PAR_H
+#define DRV_SWTIMERS_PAR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdalign.h>
+
+#include "drv_swtimers.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//==================================================================================================
+//=========================================== MACROS ===============================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Size of hidden structure swtimers_par_job_t
+//------------------------------------------------------------------------------
+#define SWTIMERS_PAR_SINGLE_JOB_INSTANCE_SIZE (48)
+
+//------------------------------------------------------------------------------
+// Size of hidden structure swtimers_par_group_t
+//------------------------------------------------------------------------------
+#define SWTIMERS_PAR_SINGLE_GROUP_INSTANCE_SIZE (16)
+
+//------------------------------------------------------------------------------
+// Size of hidden structure swtimers_par_worker_t
+//------------------------------------------------------------------------------
+#define SWTIMERS_PAR_SINGLE_WORKER_INSTANCE_SIZE (192)
+
+//------------------------------------------------------------------------------
+// Size of hidden structure swtimers_par_t
+//------------------------------------------------------------------------------
+#define SWTIMERS_PAR_DRIVER_INSTANCE_SIZE (448)
+
+//------------------------------------------------------------------------------
+// Group of parallel-safe job
+//------------------------------------------------------------------------------
+#define SWTIMERS_PAR_NO_GROUP (UINT32_MAX)
+
+//==================================================================================================
+//========================================== TYPEDEFS ==============================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Job - handler of one timer (structure is hidden in .c file)
+//------------------------------------------------------------------------------
+typedef struct swtimers_par_job_s {
+    alignas(8) uint8_t data[SWTIMERS_PAR_SINGLE_JOB_INSTANCE_SIZE];
+} swtimers_par_job_t;
+
+//------------------------------------------------------------------------------
+// Serial group of jobs (structure is hidden in .c file)
+//------------------------------------------------------------------------------
+typedef struct swtimers_par_group_s {
+    alignas(8) uint8_t data[SWTIMERS_PAR_SINGLE_GROUP_INSTANCE_SIZE];
+} swtimers_par_group_t;
+
+//------------------------------------------------------------------------------
+// Worker thread (structure is hidden in .c file)
+//------------------------------------------------------------------------------
+typedef struct swtimers_par_worker_s {
+    alignas(64) uint8_t data[SWTIMERS_PAR_SINGLE_WORKER_INSTANCE_SIZE];
+} swtimers_par_worker_t;
+
+//------------------------------------------------------------------------------
+// Driver instance (structure is hidden in .c file)
+//------------------------------------------------------------------------------
+typedef struct swtimers_par_s {
+    alignas(64) uint8_t data[SWTIMERS_PAR_DRIVER_INSTANCE_SIZE];
+} swtimers_par_t;
+
+//==================================================================================================
+//================================ PUBLIC FUNCTIONS DECLARATIONS ===================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Init driver and start worker threads
+//
+// `inst_p`          - pointer to driver instance, can be uninitialized
+// `workers_table_p` - pointer to array of workers (can be NULL if `workers_num` is 0)
+// `workers_num`     - number of worker threads in addition to the calling thread
+// `units_table_p`   - pointer to array of pointers to jobs (one per timer which can be started with swtimers_par_start())
+// `units_num`       - size of units array - maximal number of jobs expired on the same tick
+// `groups_table_p`  - pointer to array of serial groups (can be NULL if `groups_num` is 0)
+// `groups_num`      - number of serial groups
+//
+// Returns - 'true' if all threads are started, 'false' otherwise (driver stays uninitialized)
+//------------------------------------------------------------------------------
+bool swtimers_par_init(swtimers_par_t * inst_p, swtimers_par_worker_t * workers_table_p, uint32_t workers_num,
+                       swtimers_par_job_t ** units_table_p, uint32_t units_num,
+                       swtimers_par_group_t * groups_table_p, uint32_t groups_num);
+
+//------------------------------------------------------------------------------
+// Stop worker threads and deinit driver
+//
+// `inst_p` - pointer to driver instance, can be uninitialized
+//------------------------------------------------------------------------------
+void swtimers_par_deinit(swtimers_par_t * inst_p);
+
+//------------------------------------------------------------------------------
+// Init job
+//
+// `job_p`      - pointer to job, can be uninitialized (structure must be alive while the timer is started)
+// `handler_cb` - pointer to handler callback
+// `arg_1_p`    - pointer to application data to be passed into handler callback (can be NULL)
+// `arg_2_p`    - pointer to application data to be passed into handler callback (can be NULL)
+// `group`      - index of serial group (0 .. groups_num-1) or SWTIMERS_PAR_NO_GROUP for parallel-safe handler
+//------------------------------------------------------------------------------
+void swtimers_par_job_init(swtimers_par_job_t * job_p, swtimers_handler_cb_t handler_cb, void * arg_1_p, void * arg_2_p, uint32_t group);
+
+//------------------------------------------------------------------------------
+// Start timer with handler called by parallel dispatch
+//
+// `inst_p`     - pointer to initialized driver instance
+// `swtimers_p` - pointer to initialized software timers driver instance
+// `idx`        - index of timer
+// `ms`         - threshold for timer in milliseconds (can be 0)
+// `mode`       - SWTIMERS_MODE_SINGLE_FROM_LOOP or SWTIMERS_MODE_PERIODIC_FROM_LOOP
+// `job_p`      - pointer to initialized job
+//------------------------------------------------------------------------------
+void swtimers_par_start(const swtimers_par_t * inst_p, const swtimers_t * swtimers_p, uint32_t idx, uint32_t ms,
+                        swtimers_mode_t mode, swtimers_par_job_t * job_p);
+
+//------------------------------------------------------------------------------
+// Process timers and call handlers of expired timers in parallel
+//
+// To be called periodically from main loop instead of swtimers_task()
+// Returns when all handlers are finished
+//
+// `inst_p`     - pointer to initialized driver instance
+// `swtimers_p` - pointer to initialized software timers driver instance
+//------------------------------------------------------------------------------
+void swtimers_par_task(const swtimers_par_t * inst_p, const swtimers_t * swtimers_p);
+
+//==================================================================================================
+//============================================ TESTS ===============================================
+//==================================================================================================
+
+//-----------------------------------------------------------------------------
+// Run unit-tests
+// Returns - number of failed test or 0 if all tests are successful
+//-----------------------------------------------------------------------------
+int32_t swtimers_par_tests(void);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // DRV_SWTIMERS_PAR_H
@@ -0,0 +1,148 @@
+//**************************************************************************************************
+// POSIX hardware backend for software timers (Linux)
+//**************************************************************************************************
+// Ready-made swtimers_hw_interface_t for Linux builds and host integration tests:
+//  - tick source is timerfd (CLOCK_MONOTONIC) read by a dedicated tick thread,
+//    the tick thread calls swtimers_isr_ticks() and acts as the timer interrupt
+//  - isr_disable_cb/isr_enable_cb lock/unlock a recursive mutex (futex-based, no system calls without contention),
+//    so handlers called from the tick thread can start and stop timers as they do from a real ISR
+//  - eventfd becomes readable when swtimers_task() has work (handlers *_FROM_LOOP or attached work queue),
+//    so the application loop can wait in poll()/epoll_wait() instead of busy polling
+//  - hw_start_cb/hw_stop_cb arm/disarm timerfd, the tick thread sleeps while there are no started timers
+//
+// Periodic mode - timerfd expires every tick
+// Tickless mode - timerfd is programmed as one-shot for the nearest expiration (swtimers_next_expiry_ticks()),
+//                 elapsed ticks are accounted at the beginning of each critical section
+//
+// Linux only - requires POSIX threads, timerfd and eventfd
+//
+// All functions are reenterable:
+//  - driver doesn't use internal static data
+//  - driver's instance is supposed to be stored externally
+//
+//**************************************************************************************************
+// Example
+//**************************************************************************************************
+//  swtimers_posix_init(&posix_inst, 1, false);
+//  swtimers_init(&timers_inst, swtimers_posix_get_hw_interface(&posix_inst), TIMERS_NUM, timers);
+//  swtimers_posix_start(&posix_inst, &timers_inst);
+//
+//  struct epoll_event ev = { .events = EPOLLIN };
+//  epoll_ctl(epfd, EPOLL_CTL_ADD, swtimers_posix_get_fd(&posix_inst), &ev);
+//
+//  for (;;) {
+//      epoll_wait(epfd, events, EVENTS_NUM, -1);
+//      swtimers_posix_ack(&posix_inst);
+//      swtimers_task(&timers_inst);
+//  }
+//
+//**************************************************************************************************
+
+#ifndef DRV_SWTIMERS_POSIX_H
+#define DRV_SWTIMERS_POSIX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdalign.h>
+
+#include "drv_swtimers.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//==================================================================================================
+//=========================================== MACROS ===============================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Size of hidden structure swtimers_posix_t
+//------------------------------------------------------------------------------
+#define SWTIMERS_POSIX_DRIVER_INSTANCE_SIZE (192)
+
+//==================================================================================================
+//========================================== TYPEDEFS ==============================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Driver instance (structure is hidden in .c file)
+//------------------------------------------------------------------------------
+typedef struct swtimers_posix_s {
+    alignas(8) uint8_t data[SWTIMERS_POSIX_DRIVER_INSTANCE_SIZE];
+} swtimers_posix_t;
+
+//==================================================================================================
+//================================ PUBLIC FUNCTIONS DECLARATIONS ===================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Init backend - create timerfd, eventfd and lock
+//
+// `inst_p`      - pointer to driver instance, can be uninitialized
+// `tick_ms`     - one tick in milliseconds (must be > 0)
+// `is_tickless` - 'true' - one-shot timerfd for the nearest expiration, 'false' - timerfd expires every tick
+//
+// Returns - 'true' if backend is initialized, 'false' if system resources can't be allocated
+//------------------------------------------------------------------------------
+bool swtimers_posix_init(swtimers_posix_t * inst_p, uint32_t tick_ms, bool is_tickless);
+
+//------------------------------------------------------------------------------
+// Deinit backend - stop tick thread and release system resources
+//
+// Mustn't be called from handlers
+//
+// `inst_p` - pointer to driver instance, can be uninitialized
+//------------------------------------------------------------------------------
+void swtimers_posix_deinit(swtimers_posix_t * inst_p);
+
+//------------------------------------------------------------------------------
+// Get hardware interface to be passed into swtimers_init()
+//
+// `inst_p` - pointer to initialized driver instance
+//
+// Returns - pointer to hardware interface stored in driver instance
+//------------------------------------------------------------------------------
+const swtimers_hw_interface_t * swtimers_posix_get_hw_interface(const swtimers_posix_t * inst_p);
+
+//------------------------------------------------------------------------------
+// Start tick thread
+//
+// `inst_p`     - pointer to initialized driver instance
+// `swtimers_p` - pointer to software timers driver instance initialized with interface of this backend
+//
+// Returns - 'true' if tick thread is started, 'false' otherwise
+//------------------------------------------------------------------------------
+bool swtimers_posix_start(const swtimers_posix_t * inst_p, const swtimers_t * swtimers_p);
+
+//------------------------------------------------------------------------------
+// Get file descriptor to wait for work of swtimers_task() in poll()/epoll_wait() (readable - EPOLLIN)
+//
+// `inst_p` - pointer to initialized driver instance
+//
+// Returns - eventfd descriptor
+//------------------------------------------------------------------------------
+int swtimers_posix_get_fd(const swtimers_posix_t * inst_p);
+
+//------------------------------------------------------------------------------
+// Acknowledge wake-up of application loop before swtimers_task() call
+// Work which appears after the call makes descriptor readable again
+//
+// `inst_p` - pointer to initialized driver instance
+//------------------------------------------------------------------------------
+void swtimers_posix_ack(const swtimers_posix_t * inst_p);
+
+//==================================================================================================
+//============================================ TESTS ===============================================
+//==================================================================================================
+
+//-----------------------------------------------------------------------------
+// Run unit-tests
+// Returns - number of failed test or 0 if all tests are successful
+//-----------------------------------------------------------------------------
+int32_t swtimers_posix_tests(void);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // DRV_SWTIMERS_POSIX_H
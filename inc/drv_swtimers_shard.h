@@ -0,0 +1,242 @@
+//**************************************************************************************************
+// Sharded software timers - one swtimers instance per core/thread with cross-shard mailboxes
+//**************************************************************************************************
+// Depends on drv_swtimers and drv_mpsc:
+//  - each shard is a separate swtimers_t with its own tick source, owned by one thread (core)
+//  - each shard has a lock-free mailbox for operations sent by other shards
+//
+// Timer handle encodes the shard and the index of timer within the shard (see SWTIMERS_SHARD_HANDLE)
+// Thread of the calling shard is passed explicitly into each function (there is no thread-local data):
+//  - start/stop of timer owned by the calling shard - direct call of swtimers driver (fast path)
+//  - start/stop of timer owned by another shard     - operation is pushed into the owner's mailbox
+//    and applied in the owner's swtimers_shard_task()
+//  - migration moves timer to another shard, the timer gets a new handle
+//
+// Functions must be called from the thread of `self_shard` (application loop or handlers *_FROM_LOOP)
+//
+// All functions are reenterable:
+//  - driver doesn't use internal static data
+//  - driver's instance, shards, timers and mailboxes are supposed to be stored externally
+//
+//**************************************************************************************************
+// Example
+//**************************************************************************************************
+//  swtimers_shard_init(&shard_inst, shards, CORES_NUM);
+//  swtimers_shard_attach(&shard_inst, core, &timers_inst[core], shard_timers[core], TIMERS_NUM,
+//                        mailbox_cells[core], MAILBOX_NUM);
+//
+//  // Thread of shard `core`
+//  swtimers_shard_start(&shard_inst, core, SWTIMERS_SHARD_HANDLE(other_core, 5), 100,
+//                       SWTIMERS_MODE_SINGLE_FROM_LOOP, app_handler, NULL, NULL);
+//  for (;;) {
+//      swtimers_shard_task(&shard_inst, core);
+//  }
+//
+//**************************************************************************************************
+
+#ifndef DRV_SWTIMERS_SHARD_H
+#define DRV_SWTIMERS_SHARD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdalign.h>
+
+#include "drv_swtimers.h"
+#include "drv_mpsc.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//==================================================================================================
+//=========================================== MACROS ===============================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Size of hidden structure swtimers_shard_timer_t (32-bit / 64-bit platforms)
+//------------------------------------------------------------------------------
+#if (UINTPTR_MAX == UINT32_MAX)
+#define SWTIMERS_SHARD_SINGLE_TIMER_INSTANCE_SIZE (20)
+#else
+#define SWTIMERS_SHARD_SINGLE_TIMER_INSTANCE_SIZE (32)
+#endif
+
+//------------------------------------------------------------------------------
+// Size of hidden structure swtimers_shard_slot_t
+//------------------------------------------------------------------------------
+#define SWTIMERS_SHARD_SINGLE_SLOT_INSTANCE_SIZE (256)
+
+//------------------------------------------------------------------------------
+// Size of hidden structure swtimers_shard_t (32-bit / 64-bit platforms)
+//------------------------------------------------------------------------------
+#if (UINTPTR_MAX == UINT32_MAX)
+#define SWTIMERS_SHARD_DRIVER_INSTANCE_SIZE (8)
+#else
+#define SWTIMERS_SHARD_DRIVER_INSTANCE_SIZE (16)
+#endif
+
+//------------------------------------------------------------------------------
+// Size of one cell of mailbox in bytes (32-bit / 64-bit platforms)
+//------------------------------------------------------------------------------
+#if (UINTPTR_MAX == UINT32_MAX)
+#define SWTIMERS_SHARD_MAILBOX_CELL_SIZE MPSC_CELL_SIZE(24)
+#else
+#define SWTIMERS_SHARD_MAILBOX_CELL_SIZE MPSC_CELL_SIZE(40)
+#endif
+
+//------------------------------------------------------------------------------
+// Timer handle - shard in the upper 8 bits, index of timer within the shard in the lower 24 bits
+//
+// `shard` - index of shard (0 .. 255)
+// `idx`   - index of timer within the shard (0 .. 2^24-1)
+// `h`     - timer handle
+//------------------------------------------------------------------------------
+#define SWTIMERS_SHARD_HANDLE(shard, idx)   ((((uint32_t)(shard)) << 24) | (((uint32_t)(idx)) & 0x00FFFFFFu))
+#define SWTIMERS_SHARD_GET_SHARD(h)         (((uint32_t)(h)) >> 24)
+#define SWTIMERS_SHARD_GET_IDX(h)           (((uint32_t)(h)) & 0x00FFFFFFu)
+
+//------------------------------------------------------------------------------
+// Maximal number of shards
+//------------------------------------------------------------------------------
+#define SWTIMERS_SHARD_MAX (256)
+
+//==================================================================================================
+//========================================== TYPEDEFS ==============================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Settings of the last start of timer, used for migration (structure is hidden in .c file)
+//------------------------------------------------------------------------------
+typedef struct swtimers_shard_timer_s {
+    alignas(sizeof(void*)) uint8_t data[SWTIMERS_SHARD_SINGLE_TIMER_INSTANCE_SIZE];
+} swtimers_shard_timer_t;
+
+//------------------------------------------------------------------------------
+// Single shard - swtimers instance and mailbox (structure is hidden in .c file)
+//------------------------------------------------------------------------------
+typedef struct swtimers_shard_slot_s {
+    alignas(MPSC_CACHE_LINE_SIZE) uint8_t data[SWTIMERS_SHARD_SINGLE_SLOT_INSTANCE_SIZE];
+} swtimers_shard_slot_t;
+
+//------------------------------------------------------------------------------
+// Driver instance (structure is hidden in .c file)
+//------------------------------------------------------------------------------
+typedef struct swtimers_shard_s {
+    alignas(sizeof(void*)) uint8_t data[SWTIMERS_SHARD_DRIVER_INSTANCE_SIZE];
+} swtimers_shard_t;
+
+//==================================================================================================
+//================================ PUBLIC FUNCTIONS DECLARATIONS ===================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Init driver
+//
+// `inst_p`         - pointer to driver instance, can be uninitialized
+// `slots_table_p`  - pointer to array of shards
+// `shards_num`     - number of shards (must be 1 .. SWTIMERS_SHARD_MAX)
+//------------------------------------------------------------------------------
+void swtimers_shard_init(swtimers_shard_t * inst_p, swtimers_shard_slot_t * slots_table_p, uint32_t shards_num);
+
+//------------------------------------------------------------------------------
+// Attach swtimers instance and mailbox to shard
+//
+// Must be called for all shards before any start/stop call
+//
+// `inst_p`         - pointer to initialized driver instance
+// `shard`          - index of shard (must be 0 .. shards_num-1)
+// `swtimers_p`     - pointer to initialized software timers driver instance owned by the shard
+// `timers_table_p` - pointer to array of timers settings with size = number of timers of swtimers instance
+// `num`            - number of timers of swtimers instance (must be <= 2^24)
+// `cells_p`        - pointer to array with size = cells_num * SWTIMERS_SHARD_MAILBOX_CELL_SIZE bytes, aligned to 8 bytes
+// `cells_num`      - number of cells in mailbox (must be a power of 2)
+//------------------------------------------------------------------------------
+void swtimers_shard_attach(const swtimers_shard_t * inst_p, uint32_t shard, const swtimers_t * swtimers_p,
+                           swtimers_shard_timer_t * timers_table_p, uint32_t num, void * cells_p, uint32_t cells_num);
+
+//------------------------------------------------------------------------------
+// Start timer
+//
+// If timer is already started - stop it and restart
+//
+// `inst_p`     - pointer to initialized driver instance
+// `self_shard` - index of the calling shard
+// `handle`     - timer handle (see SWTIMERS_SHARD_HANDLE)
+// `ms`         - threshold for timer in milliseconds (can be 0)
+// `mode`       - single or periodical run, call handler from application of from ISR (of the owner shard)
+// `handler_cb` - pointer to handler callback (can be NULL)
+// `arg_1_p`    - pointer to application data to be passed into handler callback (can be NULL)
+// `arg_2_p`    - pointer to application data to be passed into handler callback (can be NULL)
+//
+// Returns - 'true' if timer is started or operation is sent, 'false' if mailbox of the owner shard is full
+//------------------------------------------------------------------------------
+bool swtimers_shard_start(const swtimers_shard_t * inst_p, uint32_t self_shard, uint32_t handle, uint32_t ms,
+                          swtimers_mode_t mode, swtimers_handler_cb_t handler_cb, void * arg_1_p, void * arg_2_p);
+
+//------------------------------------------------------------------------------
+// Stop timer
+//
+// `inst_p`     - pointer to initialized driver instance
+// `self_shard` - index of the calling shard
+// `handle`     - timer handle (see SWTIMERS_SHARD_HANDLE)
+//
+// Returns - 'true' if timer is stopped or operation is sent, 'false' if mailbox of the owner shard is full
+//------------------------------------------------------------------------------
+bool swtimers_shard_stop(const swtimers_shard_t * inst_p, uint32_t self_shard, uint32_t handle);
+
+//------------------------------------------------------------------------------
+// Move timer owned by the calling shard to another shard
+//
+// Timer is stopped in the calling shard and started in the destination shard with settings of the last start:
+//  - single shot timer keeps the remaining time
+//  - periodic timer starts a new period
+// Stopped timer is moved without start
+//
+// `inst_p`     - pointer to initialized driver instance
+// `self_shard` - index of the calling shard (owner of the timer)
+// `handle`     - timer handle (see SWTIMERS_SHARD_HANDLE)
+// `dst_shard`  - index of the destination shard
+// `dst_idx`    - index of free timer within the destination shard
+//
+// Returns - new timer handle, or `handle` if mailbox of the destination shard is full (timer isn't moved)
+//------------------------------------------------------------------------------
+uint32_t swtimers_shard_migrate(const swtimers_shard_t * inst_p, uint32_t self_shard, uint32_t handle,
+                                uint32_t dst_shard, uint32_t dst_idx);
+
+//------------------------------------------------------------------------------
+// Check if timer owned by the calling shard is run
+//
+// `inst_p`     - pointer to initialized driver instance
+// `self_shard` - index of the calling shard (owner of the timer)
+// `handle`     - timer handle (see SWTIMERS_SHARD_HANDLE)
+//
+// Returns - 'true' if timer is run, 'false' otherwise
+//------------------------------------------------------------------------------
+bool swtimers_shard_is_run(const swtimers_shard_t * inst_p, uint32_t self_shard, uint32_t handle);
+
+//------------------------------------------------------------------------------
+// Apply operations received from other shards and process timers of the shard
+//
+// To be called periodically from application loop of the shard instead of swtimers_task()
+// At most `num` operations (number of timers of the shard) are applied per call, the rest is applied by the next call
+//
+// `inst_p`     - pointer to initialized driver instance
+// `self_shard` - index of the calling shard
+//------------------------------------------------------------------------------
+void swtimers_shard_task(const swtimers_shard_t * inst_p, uint32_t self_shard);
+
+//==================================================================================================
+//============================================ TESTS ===============================================
+//==================================================================================================
+
+//-----------------------------------------------------------------------------
+// Run unit-tests
+// Returns - number of failed test or 0 if all tests are successful
+//-----------------------------------------------------------------------------
+int32_t swtimers_shard_tests(void);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // DRV_SWTIMERS_SHARD_H
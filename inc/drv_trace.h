@@ -0,0 +1,179 @@
+//**************************************************************************************************
+// Binary event trace ring buffer
+//**************************************************************************************************
+// Flight recorder of drivers events - the newest records overwrite the oldest ones
+//
+// Each record is 8 bytes: 16-bit timestamp, event type, small argument, index of timer/LED/button, payload
+//  - timestamp is read with user-supplied callback (e.g. DWT->CYCCNT or microsecond counter)
+//  - only low 16 bits are stored, so timestamp of record is a delta from the previous record modulo 2^16
+//  - TRACE_EVT_SYNC record with full timestamp is inserted if there was no record for 2^15 units
+//
+// Drivers (drv_swtimers, drv_leds, drv_buttons) get trace hooks and *_set_trace() functions with DRV_TRACE == 1,
+// otherwise there are no hooks in the code and instances keep their usual size
+// DRV_TRACE must be defined in the same way for all translation units (e.g. with -DDRV_TRACE=1)
+//
+// trace_record() can be called from ISR and application loop, a slot is reserved with one atomic increment
+// (lock-free on Cortex-M3+ and hosts, Cortex-M0+ has no exclusive access instructions - compiler
+// support library may disable interrupts for the increment)
+//
+// Records can be taken from running system with trace_read() (e.g. to stream them over UART) or
+// the whole array can be dumped from RAM - tools/trace_decode converts them into Chrome trace JSON
+//
+// Requires C11 atomics
+//
+// All functions are reenterable:
+//  - driver doesn't use internal static data
+//  - trace instance and array of records are supposed to be stored externally
+//**************************************************************************************************
+
+#ifndef DRV_TRACE_H
+#define DRV_TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//==================================================================================================
+//=========================================== MACROS ===============================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Trace hooks of drivers: 0 - compiled out, 1 - compiled in
+//------------------------------------------------------------------------------
+#ifndef DRV_TRACE
+#define DRV_TRACE (0)
+#endif
+
+//------------------------------------------------------------------------------
+// Size of hidden structure trace_t (32-bit / 64-bit platforms)
+//------------------------------------------------------------------------------
+#if (UINTPTR_MAX == UINT32_MAX)
+#define TRACE_DRIVER_INSTANCE_SIZE (28)
+#else
+#define TRACE_DRIVER_INSTANCE_SIZE (40)
+#endif
+
+//------------------------------------------------------------------------------
+// Maximal value of record payload (larger values are saturated)
+//------------------------------------------------------------------------------
+#define TRACE_EXT_MAX (0xFFFFu)
+
+//==================================================================================================
+//========================================== TYPEDEFS ==============================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Event types (values are a part of binary format)
+//------------------------------------------------------------------------------
+typedef enum trace_event_e {
+    TRACE_EVT_SYNC              = 0,    // full timestamp: `idx` - upper 16 bits, `time` - lower 16 bits
+    TRACE_EVT_SWTIMERS_START    = 1,    // timer is started:   `idx` - timer, `arg` - mode, `ext` - period in milliseconds
+    TRACE_EVT_SWTIMERS_STOP     = 2,    // timer is stopped:   `idx` - timer
+    TRACE_EVT_SWTIMERS_EXPIRE   = 3,    // timer is expired in ISR: `idx` - timer
+    TRACE_EVT_SWTIMERS_CALL     = 4,    // handler is called:  `idx` - timer, `arg` - mode
+    TRACE_EVT_SWTIMERS_RETURN   = 5,    // handler returned:   `idx` - timer, `arg` - mode
+    TRACE_EVT_LEDS_WRITE        = 6,    // LED GPIO is written: `idx` - LED, `arg` - pin state, 2 - toggle
+    TRACE_EVT_BUTTONS_EDGE      = 7,    // raw edge of button: `idx` - button, `arg` - '1' pressed, '0' released
+    TRACE_EVT_BUTTONS_EVENT     = 8,    // event of button:    `idx` - button, `arg` - bit mask of buttons_event_t
+} trace_event_t;
+
+//------------------------------------------------------------------------------
+// Callback - Read timestamp
+// Counter must increase and wrap around at 2^32
+//
+// `timestamp_p` - pointer to timestamp source, passed over trace_init function (can be NULL)
+//
+// Returns - current timestamp
+//------------------------------------------------------------------------------
+typedef uint32_t (*trace_timestamp_cb_t)(void * timestamp_p);
+
+//------------------------------------------------------------------------------
+// Trace record (8 bytes, little-endian on all supported platforms)
+//------------------------------------------------------------------------------
+typedef struct trace_record_s {
+    uint16_t    time;       // low 16 bits of timestamp
+    uint8_t     event;      // event type (trace_event_t)
+    uint8_t     arg;        // small argument of event
+    uint16_t    idx;        // index of timer/LED/button
+    uint16_t    ext;        // payload of event (saturated at TRACE_EXT_MAX)
+} trace_record_t;
+
+//------------------------------------------------------------------------------
+// Driver instance (structure is hidden in .c file)
+//------------------------------------------------------------------------------
+typedef struct trace_s {
+    uint8_t data[TRACE_DRIVER_INSTANCE_SIZE];
+} trace_t;
+
+//==================================================================================================
+//================================ PUBLIC FUNCTIONS DECLARATIONS ===================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Init trace
+//
+// Writes TRACE_EVT_SYNC record with the current timestamp
+//
+// `inst_p`       - pointer to driver instance, can be uninitialized
+// `records_p`    - pointer to array of records
+// `size`         - number of records (must be power of 2)
+// `timestamp_cb` - read timestamp callback
+// `timestamp_p`  - pointer to timestamp source to be passed into callback (can be NULL)
+//------------------------------------------------------------------------------
+void trace_init(trace_t * inst_p, trace_record_t * records_p, uint32_t size, trace_timestamp_cb_t timestamp_cb, void * timestamp_p);
+
+//------------------------------------------------------------------------------
+// Add record
+//
+// `inst_p` - pointer to initialized driver instance (can be NULL - record is dropped)
+// `event`  - event type
+// `idx`    - index of timer/LED/button
+// `arg`    - small argument
+// `ext`    - payload (saturated at TRACE_EXT_MAX)
+//------------------------------------------------------------------------------
+void trace_record(const trace_t * inst_p, trace_event_t event, uint32_t idx, uint8_t arg, uint32_t ext);
+
+//------------------------------------------------------------------------------
+// Get number of records written since init
+//
+// Position of the oldest record in RAM dump of the array is (head % size) if head > size, 0 otherwise
+//
+// `inst_p` - pointer to initialized driver instance
+//
+// Returns - number of records (wraps around at 2^32)
+//------------------------------------------------------------------------------
+uint32_t trace_get_head(const trace_t * inst_p);
+
+//------------------------------------------------------------------------------
+// Read new records
+//
+// Copies records written since the previous call in chronological order
+// Should be called from a single context which doesn't preempt writers (e.g. from application loop)
+//
+// `inst_p`     - pointer to initialized driver instance
+// `out_p`      - out - array for records
+// `max_num`    - size of `out_p` array
+// `lost_out_p` - out - number of records overwritten before reading (can be NULL)
+//
+// Returns - number of copied records
+//------------------------------------------------------------------------------
+uint32_t trace_read(const trace_t * inst_p, trace_record_t * out_p, uint32_t max_num, uint32_t * lost_out_p);
+
+//==================================================================================================
+//============================================ TESTS ===============================================
+//==================================================================================================
+
+//-----------------------------------------------------------------------------
+// Run unit-tests
+// Returns - number of failed test or 0 if all tests are successful
+//-----------------------------------------------------------------------------
+int32_t trace_tests(void);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // DRV_TRACE_H
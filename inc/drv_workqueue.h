@@ -0,0 +1,168 @@
+//**************************************************************************************************
+// Work queue driver - deferring work from ISR context to application loop
+//**************************************************************************************************
+// workqueue_post() can be called from any context (ISR or application) to defer work item
+// workqueue_task() should be called periodically from application loop to call handlers of posted items
+// Work queue can be attached to software timers driver to be processed inside swtimers_task()
+//
+// Each priority level is a separate fixed-size ring of work items:
+//  - post and dispatch cost doesn't depend on number of items
+//  - items with higher priority are processed first, items with equal priority - in order of posting
+//
+// Driver uses critical section callbacks to protect rings from concurrent access
+//
+// All functions are reenterable:
+//  - driver doesn't use internal static data
+//  - driver's instance and table of work items are supposed to be stored externally
+//**************************************************************************************************
+
+#ifndef DRV_WORKQUEUE_H
+#define DRV_WORKQUEUE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//==================================================================================================
+//=========================================== MACROS ===============================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Size of hidden structure workqueue_item_t (32-bit / 64-bit platforms)
+//------------------------------------------------------------------------------
+#if (UINTPTR_MAX == UINT32_MAX)
+#define WORKQUEUE_SINGLE_ITEM_INSTANCE_SIZE (12)
+#else
+#define WORKQUEUE_SINGLE_ITEM_INSTANCE_SIZE (24)
+#endif
+
+//------------------------------------------------------------------------------
+// Size of hidden structure workqueue_t (32-bit / 64-bit platforms)
+//------------------------------------------------------------------------------
+#if (UINTPTR_MAX == UINT32_MAX)
+#define WORKQUEUE_DRIVER_INSTANCE_SIZE (24)
+#else
+#define WORKQUEUE_DRIVER_INSTANCE_SIZE (32)
+#endif
+
+//==================================================================================================
+//========================================== TYPEDEFS ==============================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Priority of work item
+//------------------------------------------------------------------------------
+typedef enum workqueue_prio_e {
+    WORKQUEUE_PRIO_HIGH = 0,    // processed first
+    WORKQUEUE_PRIO_NORMAL,      // processed after all items with high priority
+    WORKQUEUE_PRIO_LOW,         // processed after all items with high and normal priority
+    WORKQUEUE_PRIO_NUM,         // number of priority levels
+} workqueue_prio_t;
+
+//------------------------------------------------------------------------------
+// Callback - Work item handler (to be called from application context)
+// Handler can post new work items
+//
+// `arg_1_p`    - pointer to application data, passed over workqueue_post function (can be NULL)
+// `arg_2_p`    - pointer to application data, passed over workqueue_post function (can be NULL)
+//------------------------------------------------------------------------------
+typedef void (*workqueue_handler_cb_t)(void * arg_1_p, void * arg_2_p);
+
+//------------------------------------------------------------------------------
+// Callback - Disable all interrupts which can post work items
+// Callback - Enable all interrupts which can post work items
+//
+// `hw_p` - pointer to hardware driver, passed over workqueue_hw_interface_t structure (can be NULL)
+//------------------------------------------------------------------------------
+typedef void (*workqueue_isr_ctrl_cb_t)(void * hw_p);
+
+//------------------------------------------------------------------------------
+// Interface to hardware
+//------------------------------------------------------------------------------
+typedef struct workqueue_hw_interface_s {
+    void*                        hw_p;              // Pointer to hardware driver to be passed into callbacks (can be NULL)
+    workqueue_isr_ctrl_cb_t      isr_enable_cb;     // Enable interrupts which can post work items
+    workqueue_isr_ctrl_cb_t      isr_disable_cb;    // Disable interrupts which can post work items
+} workqueue_hw_interface_t;
+
+//------------------------------------------------------------------------------
+// Single work item instance (structure is hidden in .c file)
+//------------------------------------------------------------------------------
+typedef struct workqueue_item_s {
+    uint8_t data[WORKQUEUE_SINGLE_ITEM_INSTANCE_SIZE];
+} workqueue_item_t;
+
+//------------------------------------------------------------------------------
+// Driver instance (structure is hidden in .c file)
+//------------------------------------------------------------------------------
+typedef struct workqueue_s {
+    uint8_t data[WORKQUEUE_DRIVER_INSTANCE_SIZE];
+} workqueue_t;
+
+//==================================================================================================
+//================================ PUBLIC FUNCTIONS DECLARATIONS ===================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Init work queue driver
+//
+// `inst_p`         - pointer to driver instance, can be uninitialized
+// `hw_interface_p` - pointer to driver's hardware interface, structure must be alive
+//                    until deinitialization of the driver
+// `num`            - number of work items for each priority level (must be 1 .. 65535)
+// `items_table_p`  - pointer to volatile array of work items with size = WORKQUEUE_PRIO_NUM * num * sizeof(workqueue_item_t) bytes
+//------------------------------------------------------------------------------
+void workqueue_init(workqueue_t * inst_p, const workqueue_hw_interface_t * hw_interface_p, uint32_t num,
+                    volatile workqueue_item_t * items_table_p);
+
+//------------------------------------------------------------------------------
+// Deinit work queue driver
+// Drops all posted work items without calling handlers
+//
+// `inst_p` - pointer to driver instance, can be uninitialized
+//------------------------------------------------------------------------------
+void workqueue_deinit(workqueue_t * inst_p);
+
+//------------------------------------------------------------------------------
+// Post work item
+//
+// Can be called from ISR context
+//
+// `inst_p`     - pointer to initialized driver instance
+// `prio`       - priority of work item
+// `handler_cb` - pointer to handler callback
+// `arg_1_p`    - pointer to application data to be passed into handler callback (can be NULL)
+// `arg_2_p`    - pointer to application data to be passed into handler callback (can be NULL)
+//
+// Returns - 'true' if work item is posted, 'false' if ring of the priority level is full
+//------------------------------------------------------------------------------
+bool workqueue_post(const workqueue_t * inst_p, workqueue_prio_t prio, workqueue_handler_cb_t handler_cb,
+                    void * arg_1_p, void * arg_2_p);
+
+//------------------------------------------------------------------------------
+// Check if there are no posted work items
+//
+// `inst_p` - pointer to initialized driver instance
+//
+// Returns - 'true' if there are no posted work items, 'false' otherwise
+//------------------------------------------------------------------------------
+bool workqueue_is_empty(const workqueue_t * inst_p);
+
+//------------------------------------------------------------------------------
+// Call handlers of posted work items
+//
+// To be called periodically from main loop (or from swtimers_task if the work queue is attached to it)
+// Processes only the number of items posted before the call, so handlers reposting items can't block the loop
+//
+// `inst_p` - pointer to initialized driver instance
+//------------------------------------------------------------------------------
+void workqueue_task(const workqueue_t * inst_p);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // DRV_WORKQUEUE_H
@@ -40,7 +40,7 @@ typedef struct button_type {
     uint16_t            bouncing_ms;            // bouncing filter time (if 0 - bouncing filter is disabled)
     uint16_t            double_click_ms;        // minimal double click time (if 0 - "double click" event is not generated)
     uint16_t            hold_ms;                // hold time (if 0 - "hold" event is not generated)
-    buttons_check_t     check_type;             // check button state in ISR or using polling
+    uint8_t             check_type;             // check button state in ISR or using polling (buttons_check_t)
     bool                is_pressed_low;         // pressed-low or pressed-high button
     uint8_t             timer_id;               // id of software timer to measure timeouts
 
@@ -64,6 +64,19 @@ typedef struct buttons_instance_s {
     const buttons_hw_interface_t*       hw_p;               // pointer to hardware GPIO interface
     volatile buttons_button_instance_t* buttons_table_p;    // pointer to array of buttons
     uint32_t                            num;                // number of buttons
+    uint16_t                            polling_num;        // number of buttons checked in polling
+    volatile bool                       is_isr_pending;     // 'true' - if button state has been changed in ISR and wait to be processed
+    uint8_t                             align[1];
+    uint32_t                            poll_edges_cnt;     // number of raw edges found by polling (updated in application loop)
+    volatile uint32_t                   isr_edges_cnt;      // number of raw edges passed into buttons_isr() (updated in ISR)
+    uint32_t                            events_cnt;         // number of non-empty events (updated in application loop)
+#if (DRV_PROF == 1)
+    prof_cycles_cb_t                    prof_cycles_cb;     // read cycle counter (can be NULL)
+    prof_stats_t*                       prof_stats_p;       // pointer to profiling statistics of buttons_task() (can be NULL)
+#endif
+#if (DRV_TRACE == 1)
+    const trace_t*                      trace_p;            // pointer to attached trace of edges and events (can be NULL)
+#endif
 } buttons_instance_t;
 
 //------------------------------------------------------------------------------
@@ -133,19 +146,27 @@ void buttons_configure(const buttons_t * inst_p, uint32_t idx, uint32_t gpio_pin
                        const buttons_time_settings_t * times_p, buttons_handler_cb_t handler_cb, void * arg_p)
 {
     assert(inst_p != NULL);
-    const buttons_instance_t * buttons_inst_p = (const buttons_instance_t*)inst_p;
+    buttons_instance_t * buttons_inst_p = (buttons_instance_t*)inst_p;
     assert(idx < buttons_inst_p->num);
     volatile buttons_button_instance_t * button_p = &(buttons_inst_p->buttons_table_p[idx]);
     const buttons_hw_interface_t * hw_p = buttons_inst_p->hw_p;
 
     swtimers_stop(buttons_inst_p->swtimers_p, timer_id);
 
+    // Update number of polled buttons
+    if (button_p->check_type == BUTTONS_CHECK_IN_POLLING) {
+        buttons_inst_p->polling_num--;
+    }
+    if (check_type == BUTTONS_CHECK_IN_POLLING) {
+        buttons_inst_p->polling_num++;
+    }
+
     memset((buttons_button_instance_t*)button_p, 0x00, sizeof(buttons_button_instance_t));
 
     button_p->gpio_pin = gpio_pin;
     button_p->timer_id = timer_id;
     button_p->is_pressed_low = is_pressed_low;
-    button_p->check_type = check_type;
+    button_p->check_type = (uint8_t)check_type;
     button_p->handler_cb = handler_cb;
     button_p->arg_p = arg_p;
     button_p->bouncing_ms = times_p->bouncing_ms;
@@ -200,8 +221,19 @@ bool buttons_is_pressed_raw(const buttons_t * inst_p, uint32_t idx)
 void buttons_task(const buttons_t * inst_p)
 {
     assert(inst_p != NULL);
-    const buttons_instance_t * buttons_inst_p = (const buttons_instance_t*)inst_p;
+    buttons_instance_t * buttons_inst_p = (buttons_instance_t*)inst_p;
     assert(buttons_inst_p->num != 0);
+    const buttons_hw_interface_t * hw_p = buttons_inst_p->hw_p;
+#if (DRV_PROF == 1)
+    uint32_t prof_start = (buttons_inst_p->prof_stats_p != NULL) ? (buttons_inst_p->prof_cycles_cb()) : (0);
+#endif
+
+    // Critical section - changes made in ISR after this point will raise the flag again
+    if (buttons_inst_p->is_isr_pending) {
+        hw_p->isr_disable_cb(hw_p->hw_gpio_p);
+        buttons_inst_p->is_isr_pending = false;
+        hw_p->isr_enable_cb(hw_p->hw_gpio_p);
+    }
 
     for (size_t i = 0; i < buttons_inst_p->num; ++i) {
 
@@ -277,10 +309,24 @@ void buttons_task(const buttons_t * inst_p)
                !((event & BUTTONS_RELEASED) && (event & BUTTONS_DOUBLE))   ||
                !((event & BUTTONS_HOLD)     && (event & BUTTONS_DOUBLE)));
 
-        // Finally, call handler        if ((event != BUTTONS_NO_EVENT) && (button_p->handler_cb != NULL)) {
+        if (event != BUTTONS_NO_EVENT) {
+            buttons_inst_p->events_cnt++;
+#if (DRV_TRACE == 1)
+            trace_record(buttons_inst_p->trace_p, TRACE_EVT_BUTTONS_EVENT, i, (uint8_t)event, 0);
+#endif
+        }
+
+        // Finally, call handler
+        if ((event != BUTTONS_NO_EVENT) && (button_p->handler_cb != NULL)) {
             button_p->handler_cb(i, event, button_p->arg_p);
         }
     }
+
+#if (DRV_PROF == 1)
+    if (buttons_inst_p->prof_stats_p != NULL) {
+        prof_stats_add(buttons_inst_p->prof_stats_p, buttons_inst_p->prof_cycles_cb() - prof_start);
+    }
+#endif
 }
 
 //------------------------------------------------------------------------------
@@ -288,10 +334,10 @@ void buttons_task(const buttons_t * inst_p)
 //------------------------------------------------------------------------------
 void buttons_isr(const buttons_t * inst_p, uint32_t idx, bool gpio_state)
 {
-    const buttons_instance_t * buttons_inst_p = (const buttons_instance_t*)inst_p;
+    buttons_instance_t * buttons_inst_p = (buttons_instance_t*)inst_p;
     volatile buttons_button_instance_t * button_p = &(buttons_inst_p->buttons_table_p[idx]);
 
-    if (button_p->check_type == BUTTONS_CHECK_IN_ISR) {
+    if (button_p->check_type != BUTTONS_CHECK_IN_ISR) {
         return;
     }
 
@@ -299,9 +345,73 @@ void buttons_isr(const buttons_t * inst_p, uint32_t idx, bool gpio_state)
     if (button_p->is_pressed_raw != gpio_state) {
         button_p->is_pressed_raw = gpio_state;
         button_p->is_changed = true;
+        buttons_inst_p->is_isr_pending = true;
+        buttons_inst_p->isr_edges_cnt++;
+#if (DRV_TRACE == 1)
+        trace_record(buttons_inst_p->trace_p, TRACE_EVT_BUTTONS_EDGE, idx, (uint8_t)gpio_state, 0);
+#endif
     }
 }
 
+//------------------------------------------------------------------------------
+// Check if buttons can be left without buttons_task() calls until the next interrupt
+//------------------------------------------------------------------------------
+bool buttons_is_idle(const buttons_t * inst_p)
+{
+    assert(inst_p != NULL);
+    const buttons_instance_t * buttons_inst_p = (const buttons_instance_t*)inst_p;
+
+    return (buttons_inst_p->polling_num == 0) && (buttons_inst_p->is_isr_pending == false);
+}
+
+//------------------------------------------------------------------------------
+// Get counters of driver activity
+//------------------------------------------------------------------------------
+void buttons_get_stats(const buttons_t * inst_p, buttons_stats_t * stats_out_p, bool is_reset)
+{
+    assert((inst_p != NULL) && (stats_out_p != NULL));
+    buttons_instance_t * buttons_inst_p = (buttons_instance_t*)inst_p;
+    const buttons_hw_interface_t * hw_p = buttons_inst_p->hw_p;
+
+    // Critical section - edges are counted in ISR
+    hw_p->isr_disable_cb(hw_p->hw_gpio_p);
+    stats_out_p->edges = buttons_inst_p->poll_edges_cnt + buttons_inst_p->isr_edges_cnt;
+    stats_out_p->events = buttons_inst_p->events_cnt;
+    if (is_reset) {
+        buttons_inst_p->poll_edges_cnt = 0;
+        buttons_inst_p->isr_edges_cnt = 0;
+        buttons_inst_p->events_cnt = 0;
+    }
+    hw_p->isr_enable_cb(hw_p->hw_gpio_p);
+}
+
+#if (DRV_TRACE == 1)
+//------------------------------------------------------------------------------
+// Attach trace of raw edges and events
+//------------------------------------------------------------------------------
+void buttons_set_trace(const buttons_t * inst_p, const trace_t * trace_p)
+{
+    assert(inst_p != NULL);
+    buttons_instance_t * buttons_inst_p = (buttons_instance_t*)inst_p;
+
+    buttons_inst_p->trace_p = trace_p;
+}
+#endif
+
+#if (DRV_PROF == 1)
+//------------------------------------------------------------------------------
+// Attach profiling statistics of buttons_task()
+//------------------------------------------------------------------------------
+void buttons_set_prof(const buttons_t * inst_p, prof_cycles_cb_t cycles_cb, prof_stats_t * stats_p)
+{
+    assert(inst_p != NULL);
+    buttons_instance_t * buttons_inst_p = (buttons_instance_t*)inst_p;
+
+    buttons_inst_p->prof_cycles_cb = (stats_p != NULL) ? (cycles_cb) : (NULL);
+    buttons_inst_p->prof_stats_p = (cycles_cb != NULL) ? (stats_p) : (NULL);
+}
+#endif
+
 //==================================================================================================
 //================================ PRIVATE FUNCTIONS DEFINITIONS ===================================
 //==================================================================================================
@@ -325,6 +435,11 @@ static buttons_event_t buttons_process_changes(const buttons_instance_t * button
             button_p->is_pressed_raw = gpio_state;
             is_pressed_raw = button_p->is_pressed_raw;
             is_changed = true;
+            ((buttons_instance_t*)buttons_inst_p)->poll_edges_cnt++;
+#if (DRV_TRACE == 1)
+            trace_record(buttons_inst_p->trace_p, TRACE_EVT_BUTTONS_EDGE, (uint32_t)(button_p - buttons_inst_p->buttons_table_p),
+                         (uint8_t)is_pressed_raw, 0);
+#endif
         }
     }
     else if (button_p->check_type == BUTTONS_CHECK_IN_ISR) {
@@ -0,0 +1,323 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+//**************************************************************************************************
+// Cyclic executive - time-triggered activation of periodic tasks
+//**************************************************************************************************
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+
+#include "drv_cyclic.h"
+
+//==================================================================================================
+//========================================== TYPEDEFS ==============================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Driver instance
+//------------------------------------------------------------------------------
+typedef struct cyclic_instance_s {
+
+    // Settings
+    const swtimers_t*       swtimers_p;         // pointer to software timers driver instance
+    uint32_t                timer_idx;          // index of software timer to measure minor frames
+    const cyclic_task_t*    tasks_p;            // pointer to table of tasks
+    const uint32_t*         frames_table_p;     // pointer to array of frames - mask of tasks released in each frame
+    uint32_t                frames_num;         // number of frames in the hyperperiod
+    uint32_t                minor_ms;           // duration of the minor frame in milliseconds
+    cyclic_overrun_cb_t     overrun_cb;         // pointer to overrun report callback (can be NULL)
+    void*                   arg_p;              // pointer to application data to be passed into overrun report callback
+
+    // Written from ISR
+    volatile uint32_t       frame_idx;          // index of the next frame to be released
+    volatile uint32_t       release_seq;        // sequence number of the last released frame
+    volatile uint32_t       release_mask;       // mask of tasks of the last released frame
+    volatile uint32_t       overrun_cnt;        // number of frame overruns
+    volatile uint32_t       overrun_frame_idx;  // index of frame released at the last overrun
+
+    // Written from application loop
+    volatile uint32_t       done_seq;           // sequence number of the last finished frame
+    uint32_t                reported_cnt;       // number of overruns reported over callback
+} cyclic_instance_t;
+
+//------------------------------------------------------------------------------
+// Sanitizing
+//------------------------------------------------------------------------------
+static_assert(sizeof(cyclic_instance_t) == sizeof(cyclic_t), "Wrong structure size");
+
+//==================================================================================================
+//================================ PRIVATE FUNCTIONS DECLARATIONS ==================================
+//==================================================================================================
+
+static uint32_t cyclic_gcd(uint32_t a, uint32_t b);
+static void cyclic_release(cyclic_instance_t * cyclic_inst_p);
+static void cyclic_timer_handler(uint32_t timer_idx, void * inst_p, void * arg_p);
+
+//==================================================================================================
+//================================ PUBLIC FUNCTIONS DEFINITIONS ====================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Init cyclic executive and calculate the schedule
+//------------------------------------------------------------------------------
+bool cyclic_init(cyclic_t * inst_p, const swtimers_t * swtimers_p, uint32_t timer_idx,
+                 const cyclic_task_t * tasks_p, uint32_t tasks_num, uint32_t * frames_table_p, uint32_t frames_num,
+                 cyclic_overrun_cb_t overrun_cb, void * arg_p)
+{
+    assert((inst_p != NULL) && (swtimers_p != NULL) && (tasks_p != NULL) && (frames_table_p != NULL));
+    assert((tasks_num > 0) && (tasks_num <= CYCLIC_TASKS_MAX));
+
+    cyclic_instance_t * cyclic_inst_p = (cyclic_instance_t*)inst_p;
+
+    memset(cyclic_inst_p, 0x00, sizeof(cyclic_instance_t));
+
+    // Minor frame - GCD of all periods and offsets, hyperperiod - LCM of all periods
+    uint32_t minor_ms = 0;
+    uint64_t hyperperiod_ms = 1;
+    for (uint32_t i = 0; i < tasks_num; ++i) {
+        const cyclic_task_t * task_p = &tasks_p[i];
+        assert((task_p->task_cb != NULL) && (task_p->period_ms > 0) && (task_p->offset_ms < task_p->period_ms));
+
+        minor_ms = cyclic_gcd(minor_ms, task_p->period_ms);
+        minor_ms = cyclic_gcd(minor_ms, task_p->offset_ms);
+
+        hyperperiod_ms = (hyperperiod_ms / cyclic_gcd((uint32_t)hyperperiod_ms, task_p->period_ms)) * task_p->period_ms;
+        if (hyperperiod_ms > UINT32_MAX) {
+            return false;
+        }
+    }
+
+    // Frames are measured in whole ticks of software timers
+    uint32_t tick_ms = swtimers_get_tick_ms(swtimers_p);
+    assert((minor_ms != 0) && ((minor_ms % tick_ms) == 0));
+    (void)tick_ms;
+
+    uint32_t num = (uint32_t)CYCLIC_FRAMES_NUM(hyperperiod_ms, minor_ms);
+    if (num > frames_num) {
+        return false;
+    }
+
+    // Mask of tasks released at the beginning of each frame
+    for (uint32_t frame = 0; frame < num; ++frame) {
+        uint32_t time_ms = frame * minor_ms;
+        uint32_t mask = 0;
+        uint64_t budget_us = 0;
+
+        for (uint32_t i = 0; i < tasks_num; ++i) {
+            const cyclic_task_t * task_p = &tasks_p[i];
+            if ((((uint64_t)time_ms + task_p->period_ms - task_p->offset_ms) % task_p->period_ms) == 0) {
+                mask |= (1u << i);
+                budget_us += task_p->budget_us;
+            }
+        }
+
+        // Tasks of the frame must fit into the frame
+        assert(budget_us <= ((uint64_t)minor_ms * 1000u));
+        (void)budget_us;
+
+        frames_table_p[frame] = mask;
+    }
+
+    cyclic_inst_p->swtimers_p = swtimers_p;
+    cyclic_inst_p->timer_idx = timer_idx;
+    cyclic_inst_p->tasks_p = tasks_p;
+    cyclic_inst_p->frames_table_p = frames_table_p;
+    cyclic_inst_p->frames_num = num;
+    cyclic_inst_p->minor_ms = minor_ms;
+    cyclic_inst_p->overrun_cb = overrun_cb;
+    cyclic_inst_p->arg_p = arg_p;
+
+    swtimers_stop(swtimers_p, timer_idx);
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+// Deinit cyclic executive
+//------------------------------------------------------------------------------
+void cyclic_deinit(cyclic_t * inst_p)
+{
+    assert(inst_p != NULL);
+    cyclic_instance_t * cyclic_inst_p = (cyclic_instance_t*)inst_p;
+
+    // If not initialized
+    if (cyclic_inst_p->swtimers_p == NULL) {
+        return;
+    }
+
+    swtimers_stop(cyclic_inst_p->swtimers_p, cyclic_inst_p->timer_idx);
+
+    memset(cyclic_inst_p, 0x00, sizeof(cyclic_instance_t));
+}
+
+//------------------------------------------------------------------------------
+// Start cyclic executive from the frame 0
+//------------------------------------------------------------------------------
+void cyclic_start(const cyclic_t * inst_p)
+{
+    assert(inst_p != NULL);
+    cyclic_instance_t * cyclic_inst_p = (cyclic_instance_t*)inst_p;
+
+    swtimers_stop(cyclic_inst_p->swtimers_p, cyclic_inst_p->timer_idx);
+
+    cyclic_inst_p->frame_idx = 0;
+    cyclic_inst_p->release_mask = 0;
+    cyclic_inst_p->done_seq = cyclic_inst_p->release_seq;
+    cyclic_inst_p->overrun_cnt = 0;
+    cyclic_inst_p->overrun_frame_idx = 0;
+    cyclic_inst_p->reported_cnt = 0;
+
+    // Release frame 0 now, the next frames - from ISR
+    cyclic_release(cyclic_inst_p);
+
+    swtimers_start(cyclic_inst_p->swtimers_p, cyclic_inst_p->timer_idx, cyclic_inst_p->minor_ms,
+                   SWTIMERS_MODE_PERIODIC_FROM_ISR, &cyclic_timer_handler, cyclic_inst_p, NULL);
+}
+
+//------------------------------------------------------------------------------
+// Stop cyclic executive
+//------------------------------------------------------------------------------
+void cyclic_stop(const cyclic_t * inst_p)
+{
+    assert(inst_p != NULL);
+    cyclic_instance_t * cyclic_inst_p = (cyclic_instance_t*)inst_p;
+
+    swtimers_stop(cyclic_inst_p->swtimers_p, cyclic_inst_p->timer_idx);
+
+    // Drop released frame
+    cyclic_inst_p->done_seq = cyclic_inst_p->release_seq;
+}
+
+//------------------------------------------------------------------------------
+// Get parameters of the calculated schedule
+//------------------------------------------------------------------------------
+void cyclic_get_schedule(const cyclic_t * inst_p, uint32_t * minor_ms_out_p, uint32_t * frames_num_out_p)
+{
+    assert(inst_p != NULL);
+    const cyclic_instance_t * cyclic_inst_p = (const cyclic_instance_t*)inst_p;
+
+    if (minor_ms_out_p != NULL) {
+        *minor_ms_out_p = cyclic_inst_p->minor_ms;
+    }
+
+    if (frames_num_out_p != NULL) {
+        *frames_num_out_p = cyclic_inst_p->frames_num;
+    }
+}
+
+//------------------------------------------------------------------------------
+// Get number of frame overruns since start
+//------------------------------------------------------------------------------
+uint32_t cyclic_get_overruns(const cyclic_t * inst_p)
+{
+    assert(inst_p != NULL);
+    const cyclic_instance_t * cyclic_inst_p = (const cyclic_instance_t*)inst_p;
+
+    return cyclic_inst_p->overrun_cnt;
+}
+
+//------------------------------------------------------------------------------
+// Call released tasks and report overruns
+//------------------------------------------------------------------------------
+void cyclic_task(const cyclic_t * inst_p)
+{
+    assert(inst_p != NULL);
+    cyclic_instance_t * cyclic_inst_p = (cyclic_instance_t*)inst_p;
+
+    // Report overruns
+    uint32_t overrun_cnt = cyclic_inst_p->overrun_cnt;
+    if (overrun_cnt != cyclic_inst_p->reported_cnt) {
+        cyclic_inst_p->reported_cnt = overrun_cnt;
+        if (cyclic_inst_p->overrun_cb != NULL) {
+            cyclic_inst_p->overrun_cb(overrun_cnt, cyclic_inst_p->overrun_frame_idx, cyclic_inst_p->arg_p);
+        }
+    }
+
+    // Get the last released frame, retry if it was replaced by ISR during reading
+    uint32_t seq;
+    uint32_t mask;
+    do {
+        seq = cyclic_inst_p->release_seq;
+        mask = cyclic_inst_p->release_mask;
+    } while (seq != cyclic_inst_p->release_seq);
+
+    // If frame is already finished
+    if (seq == cyclic_inst_p->done_seq) {
+        return;
+    }
+
+    // Call tasks in order of the tasks table
+    for (uint32_t i = 0; mask != 0; ++i, mask >>= 1) {
+        if ((mask & 1u) != 0) {
+            const cyclic_task_t * task_p = &cyclic_inst_p->tasks_p[i];
+            task_p->task_cb(task_p->arg_p);
+        }
+    }
+
+    cyclic_inst_p->done_seq = seq;
+}
+
+//==================================================================================================
+//================================ PRIVATE FUNCTIONS DEFINITIONS ===================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Greatest common divisor
+//
+// `a` - the first number (can be 0)
+// `b` - the second number (can be 0)
+//
+// Returns - greatest common divisor of `a` and `b`, the other number if one of them is 0
+//------------------------------------------------------------------------------
+static uint32_t cyclic_gcd(uint32_t a, uint32_t b)
+{
+    while (b != 0) {
+        uint32_t rem = a % b;
+        a = b;
+        b = rem;
+    }
+
+    return a;
+}
+
+//------------------------------------------------------------------------------
+// Release tasks of the next frame
+//
+// Frame overrun - tasks of the previous frame haven't been finished before the next frame
+// Tasks of the frame which hasn't been taken by cyclic_task() are replaced by tasks of the next frame
+//
+// `cyclic_inst_p` - pointer to initialized driver instance
+//------------------------------------------------------------------------------
+static void cyclic_release(cyclic_instance_t * cyclic_inst_p)
+{
+    uint32_t frame_idx = cyclic_inst_p->frame_idx;
+
+    if ((cyclic_inst_p->release_mask != 0) && (cyclic_inst_p->done_seq != cyclic_inst_p->release_seq)) {
+        cyclic_inst_p->overrun_cnt++;
+        cyclic_inst_p->overrun_frame_idx = frame_idx;
+    }
+
+    cyclic_inst_p->release_mask = cyclic_inst_p->frames_table_p[frame_idx];
+    cyclic_inst_p->release_seq++;
+
+    frame_idx++;
+    cyclic_inst_p->frame_idx = (frame_idx == cyclic_inst_p->frames_num) ? (0) : (frame_idx);
+}
+
+//------------------------------------------------------------------------------
+// Internal handler of minor frame timer (called from ISR)
+// Signature corresponds to swtimers_handler_cb_t
+//
+// `timer_idx`  - timer index
+// `inst_p`     - pointer to driver instance (with type cyclic_instance_t*)
+// `arg_p`      - not used
+//------------------------------------------------------------------------------
+static void cyclic_timer_handler(uint32_t timer_idx, void * inst_p, void * arg_p)
+{
+    assert(inst_p != NULL);
+    (void)timer_idx;
+    (void)arg_p;
+
+    cyclic_release((cyclic_instance_t*)inst_p);
+}
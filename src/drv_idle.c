@@ -0,0 +1,45 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+//**************************************************************************************************
+// Idle helper for sleep-until-next-event application loops
+//**************************************************************************************************
+#include <stddef.h>
+#include <assert.h>
+
+#include "drv_idle.h"
+
+//==================================================================================================
+//================================ PUBLIC FUNCTIONS DEFINITIONS ====================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Get number of ticks until the nearest work of drivers
+//------------------------------------------------------------------------------
+uint32_t drv_next_wakeup(const swtimers_t * swtimers_p, const buttons_t * buttons_p)
+{
+    assert(swtimers_p != NULL);
+
+    if ((buttons_p != NULL) && (buttons_is_idle(buttons_p) == false)) {
+        return 0;
+    }
+
+    return swtimers_next_expiry_ticks(swtimers_p);
+}
+
+//------------------------------------------------------------------------------
+// Idle hook - sleep until the nearest work of drivers
+//------------------------------------------------------------------------------
+void drv_idle(const drv_idle_hw_interface_t * hw_interface_p, const swtimers_t * swtimers_p, const buttons_t * buttons_p)
+{
+    assert((hw_interface_p != NULL) && (hw_interface_p->sleep_cb != NULL));
+    assert((hw_interface_p->irq_disable_cb != NULL) && (hw_interface_p->irq_enable_cb != NULL));
+
+    // Critical section - interrupt after the check is left pending and wakes the core immediately
+    hw_interface_p->irq_disable_cb(hw_interface_p->hw_p);
+    uint32_t ticks = drv_next_wakeup(swtimers_p, buttons_p);
+    if (ticks != 0) {
+        hw_interface_p->sleep_cb(hw_interface_p->hw_p, ticks);
+    }
+    hw_interface_p->irq_enable_cb(hw_interface_p->hw_p);
+}
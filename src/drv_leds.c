@@ -14,6 +14,11 @@
 //=========================================== MACROS ===============================================
 //==================================================================================================
 
+#define LEDS_QUEUE_MAX (UINT16_MAX - 1) // maximal number of LEDs in engine mode
+#define LEDS_BAM_SLOTS (8)              // number of BAM slots (bits of brightness)
+#define LEDS_LEVEL_UNKNOWN (0xFF)       // state of LED isn't known
+#define LEDS_PATTERN_CTRL_MAX (256)     // maximal number of control operations of pattern between timed ones
+
 //==================================================================================================
 //========================================== TYPEDEFS ==============================================
 //==================================================================================================
@@ -25,30 +30,96 @@ typedef enum leds_blink_e {
     LED_BLINK_STATE_DISABLED = 0,   // No blinking
     LED_BLINK_STATE_PULSE,          // Pulse
     LED_BLINK_STATE_PAUSE,          // Pause or Delay or Wait
+    LED_BLINK_STATE_PATTERN,        // Pattern sequencer
+    LED_BLINK_STATE_GROUP,          // Member of running group
+    LED_BLINK_STATE_LAZY,           // Blinking calculated on sampling
 } leds_blink_t;
 
+//------------------------------------------------------------------------------
+// Modes of groups
+//------------------------------------------------------------------------------
+typedef enum leds_group_mode_e {
+    LEDS_GROUP_MODE_BLINK = 0,      // Blinking in phase
+    LEDS_GROUP_MODE_FADE,           // Fade from one level to another
+    LEDS_GROUP_MODE_BREATHE,        // Periodic fade in and fade out
+} leds_group_mode_t;
+
 //------------------------------------------------------------------------------
 // Single LED structure
 //------------------------------------------------------------------------------
 typedef struct led_instance_s {
 
-    // Settings
+    // Settings (blinking and pattern sequencer share the same memory)
+    union {
+        struct {
+            uint32_t    wait_ms;    // duration form the last blink in the series to the next series in milliseconds
+            uint32_t    pulse_ms;   // duration of blink pulses in milliseconds
+        };
+        const leds_op_t* pattern_p; // pattern program
+    };
     uint32_t        gpio_pin;       // GPIO pin to be used in gpio_toggle()/gpio_write() callbacks
-    uint32_t        wait_ms;        // duration form the last blink in the series to the next series in milliseconds
-    uint32_t        pulse_ms;       // duration of blink pulses in milliseconds
     uint32_t        pause_ms;       // duration of short pauses between pulses in one series in milliseconds
     uint32_t        timer_id;       // id of software timer to measure blinking time
-    uint8_t         series;         // number of pulses in one series
+    union {
+        uint8_t     series;         // number of pulses in one series
+        uint8_t     repeat_left;    // remaining passes of the current LEDS_OP_REPEAT block of pattern, 0 - no active block
+    };
     bool            is_active_high; // active-low or active-high GPIO connection
     bool            is_inverted;    // blinking inversion - if 'true'  LED is ON  during the "pulse", LED is OFF during "delay", "pause", "wait"
                                     //                      if 'false' LED is OFF during the "pulse", LED is  ON during "delay", "pause", "wait"
     // State
-    uint8_t         pulse_counter;  // counter for pulses in the current series
-    leds_blink_t    blink_state;    // current state of blinking in the series
-    uint8_t         align[3];
+    union {
+        uint8_t     pulse_counter;  // counter for pulses in the current series
+        uint8_t     pc;             // index of the next operation of pattern
+    };
+    uint8_t         blink_state;    // current state of blinking in the series (leds_blink_t)
+    uint8_t         level;          // shadow of LED state (the last written or pending) or LEDS_LEVEL_UNKNOWN
+    uint16_t        queue_pos;      // position in queue of engine + 1, 0 - LED isn't in queue
+    union {
+        uint32_t    deadline;       // time of the next switching in engine mode in milliseconds (wraps around)
+        uint32_t    start_ms;       // time of the first pulse in lazy mode in milliseconds (wraps around)
+    };
 
 } leds_led_instance_t;
 
+//------------------------------------------------------------------------------
+// Pending changes of GPIO port
+//------------------------------------------------------------------------------
+typedef struct leds_port_instance_s {
+    uint32_t        set_mask;       // pins to be set to logical one
+    uint32_t        clear_mask;     // pins to be set to logical zero
+} leds_port_instance_t;
+
+//------------------------------------------------------------------------------
+// Group of LEDs
+//------------------------------------------------------------------------------
+typedef struct leds_group_instance_s {
+    const uint16_t* members_p;      // array of LED numbers
+    uint32_t        members_num;    // number of LEDs
+    uint32_t        timer_id;       // id of software timer of the group
+    uint32_t        period_ms;      // duration of one series in milliseconds
+    uint32_t        pulse_ms;       // duration of pulses in milliseconds
+    uint32_t        pause_ms;       // duration of pauses between pulses in milliseconds
+    uint8_t         series;         // number of pulses in one series
+    bool            is_inverted;    // 'true' - LEDs are OFF during pulses
+    uint8_t         mode;           // mode of the group (leds_group_mode_t)
+    uint8_t         from;           // level at the beginning of fade
+    uint8_t         to;             // level at the end of fade
+    uint8_t         brightness;     // brightness written to members by the previous step of fading
+    uint8_t         align[2];
+    const uint8_t*  table_p;        // table of brightness values for levels of fading (NULL - brightness is equal to level)
+    uint32_t        start_ms;       // time of the beginning of fade in milliseconds (wraps around)
+    uint32_t        step_ms;        // period of brightness updates of fading in milliseconds
+} leds_group_instance_t;
+
+//------------------------------------------------------------------------------
+// BAM masks of GPIO port (read in ISR, updated word by word from application loop)
+//------------------------------------------------------------------------------
+typedef struct leds_bam_port_instance_s {
+    volatile uint32_t   slot_masks[LEDS_BAM_SLOTS]; // pin levels during slot of each bit of brightness
+    volatile uint32_t   pins;                       // pins of dimmed LEDs
+} leds_bam_port_instance_t;
+
 //------------------------------------------------------------------------------
 // Driver instance
 //------------------------------------------------------------------------------
@@ -57,12 +128,41 @@ typedef struct leds_instance_s {
     const leds_hw_interface_t*  hw_p;           // pointer to hardware GPIO interface
     leds_led_instance_t*        leds_table_p;   // pointer to array of LEDs
     uint32_t                    num;            // number of LEDs
+    uint32_t                    writes_cnt;     // number of gpio_write() calls
+    uint32_t                    toggles_cnt;    // number of gpio_toggle() calls
+    uint32_t                    steps_cnt;      // number of blinking state changes by software timers
+    uint32_t                    port_writes_cnt;// number of gpio_write_port() calls
+    uint32_t                    suppressed_cnt; // number of skipped writes of unchanged state
+    leds_port_instance_t*       ports_p;        // pointer to array of pending changes of ports (NULL - no batching)
+    uint32_t                    ports_num;      // number of ports
+    bool                        is_deferred;    // 'true' - inside software timer handler, writes are batched
+    bool                        is_engine_busy; // 'true' - inside engine handler
+    uint8_t                     bam_slot;       // current BAM slot (updated in ISR)
+    uint8_t                     bam_left;       // calls of leds_bam_isr() until the next BAM slot (updated in ISR)
+    uint16_t*                   queue_p;        // pointer to binary heap of LEDs indexes ordered by deadline (NULL - no engine)
+    uint32_t                    queue_num;      // number of LEDs in queue
+    uint32_t                    engine_timer;   // index of software timer of engine
+    uint32_t                    engine_base_ms; // engine time of the last start of engine timer in milliseconds
+    uint32_t                    engine_armed_ms;// duration of the last start of engine timer in milliseconds
+    leds_bam_port_instance_t*   bam_ports_p;    // pointer to array of BAM masks of ports (NULL - no dimming)
+    uint32_t                    bam_ports_num;  // number of BAM ports
+    uint32_t                    bam_timer;      // index of software timer of BAM or LEDS_BAM_EXTERNAL_ISR
+#if (DRV_PROF == 1)
+    prof_cycles_cb_t            prof_cycles_cb; // read cycle counter (can be NULL)
+    prof_stats_t*               prof_stats_p;   // pointer to profiling statistics of blinking processing (can be NULL)
+#endif
+#if (DRV_TRACE == 1)
+    const trace_t*              trace_p;        // pointer to attached trace of GPIO writes (can be NULL)
+#endif
 } leds_instance_t;
 
 //------------------------------------------------------------------------------
 // Sanitizing
 //------------------------------------------------------------------------------
 static_assert(sizeof(leds_led_instance_t) == sizeof(leds_led_t), "Wrong structure size");
+static_assert(sizeof(leds_port_instance_t) == sizeof(leds_port_t), "Wrong structure size");
+static_assert(sizeof(leds_bam_port_instance_t) == sizeof(leds_bam_port_t), "Wrong structure size");
+static_assert(sizeof(leds_group_instance_t) == sizeof(leds_group_t), "Wrong structure size");
 static_assert(sizeof(leds_instance_t) == sizeof(leds_t), "Wrong structure size");
 
 //==================================================================================================
@@ -72,6 +172,27 @@ static_assert(sizeof(leds_instance_t) == sizeof(leds_t), "Wrong structure size")
 static void leds_gpio_set(const leds_instance_t * inst_p, leds_led_instance_t * led_p, bool led_state);
 static void leds_gpio_toggle(const leds_instance_t * inst_p, leds_led_instance_t * led_p);
 static void leds_processing(uint32_t timer_idx, void * inst_p, void * led_p);
+static void leds_step(leds_instance_t * inst_p, leds_led_instance_t * led_p);
+static void leds_pattern_step(leds_instance_t * inst_p, leds_led_instance_t * led_p);
+static void leds_schedule(leds_instance_t * inst_p, leds_led_instance_t * led_p, uint32_t ms);
+static void leds_unschedule(leds_instance_t * inst_p, leds_led_instance_t * led_p);
+static void leds_engine_processing(uint32_t timer_idx, void * inst_p, void * arg_p);
+static void leds_engine_arm(leds_instance_t * inst_p, uint32_t now);
+static uint32_t leds_engine_now(const leds_instance_t * inst_p);
+static void leds_queue_fix(const leds_instance_t * inst_p, uint32_t pos);
+static void leds_queue_swap(const leds_instance_t * inst_p, uint32_t pos_1, uint32_t pos_2);
+static void leds_flush_hook(void * inst_p);
+static void leds_group_processing(uint32_t timer_idx, void * inst_p, void * group_p);
+static void leds_group_update(const leds_instance_t * inst_p, const leds_group_instance_t * group_p);
+static void leds_group_join(const leds_instance_t * inst_p, const leds_group_instance_t * group_p);
+static void leds_group_fade_start(const leds_instance_t * inst_p, leds_group_instance_t * group_p);
+static void leds_group_fade_update(const leds_instance_t * inst_p, leds_group_instance_t * group_p, bool is_forced);
+static bool leds_blink_phase(uint8_t series, uint32_t pulse_ms, uint32_t pause_ms, uint32_t period_ms, uint32_t time_ms,
+                             uint32_t * next_ms_out_p);
+static bool leds_lazy_write(const leds_instance_t * inst_p, leds_led_instance_t * led_p, uint32_t time_ms);
+static void leds_bam_write(const leds_instance_t * inst_p, leds_led_instance_t * led_p, uint8_t brightness);
+static void leds_bam_remove(const leds_instance_t * inst_p, const leds_led_instance_t * led_p);
+static void leds_bam_processing(uint32_t timer_idx, void * inst_p, void * arg_p);
 
 //==================================================================================================
 //==================================== PRIVATE STATIC DATA =========================================
@@ -105,6 +226,7 @@ void leds_init(leds_t * inst_p, const leds_hw_interface_t * hw_interface_p, uint
     // Stop all blinking LEDs
     for (size_t i = 0; i < leds_inst_p->num; ++i) {
         leds_inst_p->leds_table_p[i].blink_state = LED_BLINK_STATE_DISABLED;
+        leds_inst_p->leds_table_p[i].level = LEDS_LEVEL_UNKNOWN;
     }
 }
 
@@ -124,6 +246,15 @@ void leds_deinit(leds_t * inst_p)
     for (size_t i = 0; i < leds_inst_p->num; ++i) {
         leds_off(inst_p, i);
     }
+    if (leds_inst_p->ports_p != NULL) {
+        leds_set_batch(inst_p, NULL, 0);
+    }
+    if (leds_inst_p->queue_p != NULL) {
+        leds_set_engine(inst_p, 0, NULL);
+    }
+    if (leds_inst_p->bam_ports_p != NULL) {
+        leds_set_bam(inst_p, NULL, 0, LEDS_BAM_EXTERNAL_ISR);
+    }
 
     memset((leds_led_instance_t*)leds_inst_p->leds_table_p, 0x00, leds_inst_p->num * sizeof(leds_led_instance_t));
     memset(leds_inst_p, 0x00, sizeof(leds_instance_t));
@@ -135,14 +266,21 @@ void leds_deinit(leds_t * inst_p)
 void leds_set_pin(leds_t * inst_p, uint32_t idx, uint32_t pin_idx, uint32_t timer_idx, bool is_active_high)
 {
     assert(inst_p != NULL);
-    const leds_instance_t * leds_inst_p = (const  leds_instance_t*)inst_p;
+    leds_instance_t * leds_inst_p = (leds_instance_t*)inst_p;
     assert(idx < leds_inst_p->num);
     leds_led_instance_t * led_p = &(leds_inst_p->leds_table_p[idx]);
 
     led_p->gpio_pin = pin_idx;
     led_p->is_active_high = is_active_high;
     led_p->timer_id = timer_idx;
-    swtimers_stop(leds_inst_p->swtimers_p, timer_idx);
+    led_p->level = LEDS_LEVEL_UNKNOWN;
+    if (leds_inst_p->queue_p != NULL) {
+        led_p->blink_state = LED_BLINK_STATE_DISABLED;
+        leds_unschedule(leds_inst_p, led_p);
+    }
+    else {
+        swtimers_stop(leds_inst_p->swtimers_p, timer_idx);
+    }
 }
 
 //------------------------------------------------------------------------------
@@ -184,33 +322,36 @@ void leds_switch_toggle(const leds_t * inst_p, uint32_t idx)
 void leds_on(const leds_t * inst_p, uint32_t idx)
 {
     assert(inst_p != NULL);
-    const leds_instance_t * leds_inst_p = (const  leds_instance_t*)inst_p;
+    leds_instance_t * leds_inst_p = (leds_instance_t*)inst_p;
     assert(idx < leds_inst_p->num);
     leds_led_instance_t * led_p = &(leds_inst_p->leds_table_p[idx]);
 
     led_p->blink_state = LED_BLINK_STATE_DISABLED;
+    leds_unschedule(leds_inst_p, led_p);
     leds_gpio_set(leds_inst_p, led_p, true);
 }
 
 void leds_off(const leds_t * inst_p, uint32_t idx)
 {
     assert(inst_p != NULL);
-    const leds_instance_t * leds_inst_p = (const  leds_instance_t*)inst_p;
+    leds_instance_t * leds_inst_p = (leds_instance_t*)inst_p;
     assert(idx < leds_inst_p->num);
     leds_led_instance_t * led_p = &(leds_inst_p->leds_table_p[idx]);
 
     led_p->blink_state = LED_BLINK_STATE_DISABLED;
+    leds_unschedule(leds_inst_p, led_p);
     leds_gpio_set(leds_inst_p, led_p, false);
 }
 
 void leds_toggle(const leds_t * inst_p, uint32_t idx)
 {
     assert(inst_p != NULL);
-    const leds_instance_t * leds_inst_p = (const  leds_instance_t*)inst_p;
+    leds_instance_t * leds_inst_p = (leds_instance_t*)inst_p;
     assert(idx < leds_inst_p->num);
     leds_led_instance_t * led_p = &(leds_inst_p->leds_table_p[idx]);
 
     led_p->blink_state = LED_BLINK_STATE_DISABLED;
+    leds_unschedule(leds_inst_p, led_p);
     leds_gpio_toggle(leds_inst_p, led_p);
 }
 
@@ -237,7 +378,7 @@ void leds_blink_ext(const leds_t * inst_p, uint32_t idx, uint8_t series, uint32_
                     uint32_t period_ms, uint32_t delay_ms, bool is_inverted)
 {
     assert((inst_p != NULL) && (series != 0) && (pulse_ms != 0));
-    const leds_instance_t * leds_inst_p = (const  leds_instance_t*)inst_p;
+    leds_instance_t * leds_inst_p = (leds_instance_t*)inst_p;
     assert(idx < leds_inst_p->num);
     leds_led_instance_t * led_p = &(leds_inst_p->leds_table_p[idx]);
 
@@ -254,18 +395,477 @@ void leds_blink_ext(const leds_t * inst_p, uint32_t idx, uint8_t series, uint32_
     // Set initial state or delay state
     if (delay_ms != 0) {
         // Run timer for "delay"
-        swtimers_start(leds_inst_p->swtimers_p, led_p->timer_id, delay_ms, SWTIMERS_MODE_SINGLE_FROM_LOOP, &leds_processing, (void*)leds_inst_p, (void*)led_p);
+        leds_schedule(leds_inst_p, led_p, delay_ms);
         led_p->blink_state = LED_BLINK_STATE_PAUSE;
         leds_gpio_set(leds_inst_p, led_p, (is_inverted) ? true : false);
     }
     else {
         // Run timer for the first "pulse"
-        swtimers_start(leds_inst_p->swtimers_p, led_p->timer_id, pulse_ms, SWTIMERS_MODE_SINGLE_FROM_LOOP, &leds_processing, (void*)leds_inst_p, (void*)led_p);
+        leds_schedule(leds_inst_p, led_p, pulse_ms);
         led_p->blink_state = LED_BLINK_STATE_PULSE;
         leds_gpio_set(leds_inst_p, led_p, (is_inverted) ? false : true);
     }
 }
 
+//------------------------------------------------------------------------------
+// Run pattern program
+//------------------------------------------------------------------------------
+void leds_pattern(const leds_t * inst_p, uint32_t idx, const leds_op_t * pattern_p)
+{
+    assert((inst_p != NULL) && (pattern_p != NULL));
+    leds_instance_t * leds_inst_p = (leds_instance_t*)inst_p;
+    assert(idx < leds_inst_p->num);
+    leds_led_instance_t * led_p = &(leds_inst_p->leds_table_p[idx]);
+
+    leds_unschedule(leds_inst_p, led_p);
+    led_p->pattern_p = pattern_p;
+    led_p->pc = 0;
+    led_p->repeat_left = 0;
+    led_p->blink_state = LED_BLINK_STATE_PATTERN;
+
+    // The first step is done at once
+    leds_pattern_step(leds_inst_p, led_p);
+}
+
+//------------------------------------------------------------------------------
+// Init group of LEDs
+//------------------------------------------------------------------------------
+void leds_group_init(const leds_t * inst_p, leds_group_t * group_p, const uint16_t * members_p, uint32_t members_num, uint32_t timer_idx)
+{
+    assert((inst_p != NULL) && (group_p != NULL) && (members_p != NULL) && (members_num > 0));
+    const leds_instance_t * leds_inst_p = (const leds_instance_t*)inst_p;
+    leds_group_instance_t * group_inst_p = (leds_group_instance_t*)group_p;
+
+    memset(group_inst_p, 0x00, sizeof(leds_group_instance_t));
+    group_inst_p->members_p = members_p;
+    group_inst_p->members_num = members_num;
+    group_inst_p->timer_id = timer_idx;
+    swtimers_stop(leds_inst_p->swtimers_p, timer_idx);
+}
+
+//------------------------------------------------------------------------------
+// Run blink of all LEDs of the group
+//------------------------------------------------------------------------------
+void leds_group_blink(const leds_t * inst_p, leds_group_t * group_p, uint8_t series, uint32_t pulse_ms, uint32_t pause_ms,
+                      uint32_t period_ms, bool is_inverted)
+{
+    assert((inst_p != NULL) && (group_p != NULL) && (series != 0) && (pulse_ms != 0));
+    assert(period_ms >= (pulse_ms * series) + (pause_ms * (series - 1)));
+    leds_instance_t * leds_inst_p = (leds_instance_t*)inst_p;
+    leds_group_instance_t * group_inst_p = (leds_group_instance_t*)group_p;
+
+    group_inst_p->series = series;
+    group_inst_p->pulse_ms = pulse_ms;
+    group_inst_p->pause_ms = pause_ms;
+    group_inst_p->period_ms = period_ms;
+    group_inst_p->is_inverted = is_inverted;
+    group_inst_p->mode = LEDS_GROUP_MODE_BLINK;
+
+    leds_group_join(leds_inst_p, group_inst_p);
+    leds_group_update(leds_inst_p, group_inst_p);
+}
+
+//------------------------------------------------------------------------------
+// Run meander blink of all LEDs of the group
+//------------------------------------------------------------------------------
+void leds_group_meander(const leds_t * inst_p, leds_group_t * group_p, uint32_t duration_ms)
+{
+    leds_group_blink(inst_p, group_p, 1, duration_ms, duration_ms, 2 * duration_ms, false);
+}
+
+//------------------------------------------------------------------------------
+// Stop group
+//------------------------------------------------------------------------------
+void leds_group_stop(const leds_t * inst_p, leds_group_t * group_p)
+{
+    assert((inst_p != NULL) && (group_p != NULL));
+    const leds_instance_t * leds_inst_p = (const leds_instance_t*)inst_p;
+    const leds_group_instance_t * group_inst_p = (const leds_group_instance_t*)group_p;
+
+    swtimers_stop(leds_inst_p->swtimers_p, group_inst_p->timer_id);
+    for (uint32_t i = 0; i < group_inst_p->members_num; ++i) {
+        if (leds_inst_p->leds_table_p[group_inst_p->members_p[i]].blink_state == LED_BLINK_STATE_GROUP) {
+            leds_off(inst_p, group_inst_p->members_p[i]);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+// Run fade of all LEDs of the group
+//------------------------------------------------------------------------------
+void leds_group_fade(const leds_t * inst_p, leds_group_t * group_p, const uint8_t * table_p, uint8_t from, uint8_t to,
+                     uint32_t duration_ms, uint32_t step_ms)
+{
+    assert((inst_p != NULL) && (group_p != NULL) && (step_ms != 0) && (duration_ms <= (UINT32_MAX / 255)));
+    const leds_instance_t * leds_inst_p = (const leds_instance_t*)inst_p;
+    leds_group_instance_t * group_inst_p = (leds_group_instance_t*)group_p;
+    assert(leds_inst_p->bam_ports_p != NULL);
+
+    group_inst_p->mode = LEDS_GROUP_MODE_FADE;
+    group_inst_p->table_p = table_p;
+    group_inst_p->from = from;
+    group_inst_p->to = to;
+    group_inst_p->period_ms = duration_ms;
+    group_inst_p->step_ms = step_ms;
+    group_inst_p->start_ms = swtimers_get_time_ms(leds_inst_p->swtimers_p);
+
+    leds_group_fade_start(leds_inst_p, group_inst_p);
+}
+
+//------------------------------------------------------------------------------
+// Run breathing of all LEDs of the group
+//------------------------------------------------------------------------------
+void leds_group_breathe(const leds_t * inst_p, leds_group_t * group_p, const uint8_t * table_p, uint32_t period_ms, uint32_t step_ms)
+{
+    assert((inst_p != NULL) && (group_p != NULL) && (step_ms != 0) && (period_ms != 0) && (period_ms <= (UINT32_MAX / 510)));
+    const leds_instance_t * leds_inst_p = (const leds_instance_t*)inst_p;
+    leds_group_instance_t * group_inst_p = (leds_group_instance_t*)group_p;
+    assert(leds_inst_p->bam_ports_p != NULL);
+
+    group_inst_p->mode = LEDS_GROUP_MODE_BREATHE;
+    group_inst_p->table_p = table_p;
+    group_inst_p->period_ms = period_ms;
+    group_inst_p->step_ms = step_ms;
+
+    leds_group_fade_start(leds_inst_p, group_inst_p);
+}
+
+//------------------------------------------------------------------------------
+// Run blink without software timer
+//------------------------------------------------------------------------------
+void leds_blink_lazy(const leds_t * inst_p, uint32_t idx, uint8_t series, uint32_t pulse_ms, uint32_t pause_ms,
+                     uint32_t period_ms, uint32_t start_ms, bool is_inverted)
+{
+    assert((inst_p != NULL) && (series != 0) && (pulse_ms != 0));
+    leds_instance_t * leds_inst_p = (leds_instance_t*)inst_p;
+    assert(idx < leds_inst_p->num);
+    leds_led_instance_t * led_p = &(leds_inst_p->leds_table_p[idx]);
+    assert((period_ms == 0) || (period_ms >= (pulse_ms * series) + (pause_ms * (series - 1))));
+
+    leds_unschedule(leds_inst_p, led_p);
+    // Timer of LED in normal mode would step blinking of LED switched by leds_refresh()/leds_sample()
+    if (leds_inst_p->queue_p == NULL) {
+        swtimers_stop(leds_inst_p->swtimers_p, led_p->timer_id);
+    }
+    led_p->wait_ms = (period_ms == 0) ? (0) : (period_ms - (pulse_ms * series) - (pause_ms * (series - 1)));
+    led_p->pulse_ms = pulse_ms;
+    led_p->pause_ms = pause_ms;
+    led_p->series = series;
+    led_p->is_inverted = is_inverted;
+    led_p->start_ms = start_ms;
+    led_p->blink_state = LED_BLINK_STATE_LAZY;
+}
+
+//------------------------------------------------------------------------------
+// Calculate state of lazy blinking LED at arbitrary time
+//------------------------------------------------------------------------------
+bool leds_state_at(const leds_t * inst_p, uint32_t idx, uint32_t time_ms)
+{
+    assert(inst_p != NULL);
+    const leds_instance_t * leds_inst_p = (const leds_instance_t*)inst_p;
+    assert(idx < leds_inst_p->num);
+    const leds_led_instance_t * led_p = &(leds_inst_p->leds_table_p[idx]);
+    assert(led_p->blink_state == LED_BLINK_STATE_LAZY);
+
+    // Zero "wait" means single series, as in state machine of leds_step()
+    uint32_t series_ms = ((led_p->pulse_ms + led_p->pause_ms) * led_p->series) - led_p->pause_ms;
+    uint32_t period_ms = (led_p->wait_ms == 0) ? (0) : (series_ms + led_p->wait_ms);
+
+    return leds_blink_state_at(led_p->series, led_p->pulse_ms, led_p->pause_ms, period_ms, led_p->start_ms,
+                               led_p->is_inverted, time_ms, NULL);
+}
+
+//------------------------------------------------------------------------------
+// Calculate state of blinking at arbitrary time from blink parameters
+//------------------------------------------------------------------------------
+bool leds_blink_state_at(uint8_t series, uint32_t pulse_ms, uint32_t pause_ms, uint32_t period_ms, uint32_t start_ms,
+                         bool is_inverted, uint32_t time_ms, uint32_t * next_ms_out_p)
+{
+    assert((series != 0) && (pulse_ms != 0));
+    assert((period_ms == 0) || (period_ms >= (pulse_ms * series) + (pause_ms * (series - 1))));
+
+    uint32_t elapsed_ms = time_ms - start_ms;
+    uint32_t next_ms;
+    bool is_pulse;
+
+    // "delay" before start (signed difference)
+    if ((int32_t)elapsed_ms < 0) {
+        next_ms = start_ms - time_ms;
+        is_pulse = false;
+    } else {
+        is_pulse = leds_blink_phase(series, pulse_ms, pause_ms, period_ms, elapsed_ms, &next_ms);
+    }
+
+    if (next_ms_out_p != NULL) {
+        *next_ms_out_p = next_ms;
+    }
+
+    return is_pulse != is_inverted;
+}
+
+//------------------------------------------------------------------------------
+// Calculate state of lazy blinking LED and write GPIO if the state is changed
+//------------------------------------------------------------------------------
+bool leds_sample(const leds_t * inst_p, uint32_t idx, uint32_t time_ms)
+{
+    assert(inst_p != NULL);
+    const leds_instance_t * leds_inst_p = (const leds_instance_t*)inst_p;
+    assert(idx < leds_inst_p->num);
+
+    return leds_lazy_write(leds_inst_p, &(leds_inst_p->leds_table_p[idx]), time_ms);
+}
+
+//------------------------------------------------------------------------------
+// Write GPIO of all lazy blinking LEDs with changed state
+//------------------------------------------------------------------------------
+void leds_refresh(const leds_t * inst_p, uint32_t time_ms)
+{
+    assert(inst_p != NULL);
+    leds_instance_t * leds_inst_p = (leds_instance_t*)inst_p;
+
+    leds_inst_p->is_deferred = (leds_inst_p->ports_p != NULL);
+    for (uint32_t i = 0; i < leds_inst_p->num; ++i) {
+        if (leds_inst_p->leds_table_p[i].blink_state == LED_BLINK_STATE_LAZY) {
+            (void)leds_lazy_write(leds_inst_p, &(leds_inst_p->leds_table_p[i]), time_ms);
+        }
+    }
+    leds_inst_p->is_deferred = false;
+
+    if (leds_inst_p->ports_p != NULL) {
+        leds_flush(inst_p);
+    }
+}
+
+//------------------------------------------------------------------------------
+// Get counters of driver activity
+//------------------------------------------------------------------------------
+void leds_get_stats(const leds_t * inst_p, leds_stats_t * stats_out_p, bool is_reset)
+{
+    assert((inst_p != NULL) && (stats_out_p != NULL));
+    leds_instance_t * leds_inst_p = (leds_instance_t*)inst_p;
+
+    stats_out_p->writes = leds_inst_p->writes_cnt;
+    stats_out_p->toggles = leds_inst_p->toggles_cnt;
+    stats_out_p->blink_steps = leds_inst_p->steps_cnt;
+    stats_out_p->port_writes = leds_inst_p->port_writes_cnt;
+    stats_out_p->suppressed = leds_inst_p->suppressed_cnt;
+    if (is_reset) {
+        leds_inst_p->writes_cnt = 0;
+        leds_inst_p->toggles_cnt = 0;
+        leds_inst_p->steps_cnt = 0;
+        leds_inst_p->port_writes_cnt = 0;
+        leds_inst_p->suppressed_cnt = 0;
+    }
+}
+
+//------------------------------------------------------------------------------
+// Get shadow state of LED
+//------------------------------------------------------------------------------
+bool leds_get_state(const leds_t * inst_p, uint32_t idx, bool * is_on_out_p)
+{
+    assert((inst_p != NULL) && (is_on_out_p != NULL));
+    const leds_instance_t * leds_inst_p = (const leds_instance_t*)inst_p;
+    assert(idx < leds_inst_p->num);
+    const leds_led_instance_t * led_p = &(leds_inst_p->leds_table_p[idx]);
+
+    if (led_p->level == LEDS_LEVEL_UNKNOWN) {
+        return false;
+    }
+
+    *is_on_out_p = (led_p->level != 0);
+    return true;
+}
+
+//------------------------------------------------------------------------------
+// Enable batching of GPIO writes by ports
+//------------------------------------------------------------------------------
+void leds_set_batch(const leds_t * inst_p, leds_port_t * ports_p, uint32_t ports_num)
+{
+    assert(inst_p != NULL);
+    leds_instance_t * leds_inst_p = (leds_instance_t*)inst_p;
+    assert((ports_p == NULL) || ((ports_num > 0) && (leds_inst_p->hw_p->gpio_write_port != NULL)));
+
+    // Write changes pending in the previous array
+    leds_flush(inst_p);
+
+    if (ports_p != NULL) {
+        memset(ports_p, 0x00, ports_num * sizeof(leds_port_instance_t));
+        swtimers_set_task_hook(leds_inst_p->swtimers_p, &leds_flush_hook, leds_inst_p);
+    }
+    else if (leds_inst_p->ports_p != NULL) {
+        swtimers_set_task_hook(leds_inst_p->swtimers_p, NULL, NULL);
+    }
+
+    leds_inst_p->ports_p = (leds_port_instance_t*)ports_p;
+    leds_inst_p->ports_num = (ports_p != NULL) ? (ports_num) : (0);
+}
+
+//------------------------------------------------------------------------------
+// Enable engine mode
+//------------------------------------------------------------------------------
+void leds_set_engine(const leds_t * inst_p, uint32_t timer_idx, uint16_t * queue_p)
+{
+    assert(inst_p != NULL);
+    leds_instance_t * leds_inst_p = (leds_instance_t*)inst_p;
+    assert(leds_inst_p->num <= LEDS_QUEUE_MAX);
+
+    // Stop blinking of LEDs in queue of the previous engine
+    if (leds_inst_p->queue_p != NULL) {
+        swtimers_stop(leds_inst_p->swtimers_p, leds_inst_p->engine_timer);
+        for (uint32_t i = 0; i < leds_inst_p->queue_num; ++i) {
+            leds_led_instance_t * led_p = &leds_inst_p->leds_table_p[leds_inst_p->queue_p[i]];
+            led_p->blink_state = LED_BLINK_STATE_DISABLED;
+            led_p->queue_pos = 0;
+        }
+    }
+
+    leds_inst_p->queue_p = queue_p;
+    leds_inst_p->queue_num = 0;
+    leds_inst_p->engine_timer = timer_idx;
+    leds_inst_p->engine_base_ms = 0;
+    leds_inst_p->engine_armed_ms = 0;
+    if (queue_p != NULL) {
+        swtimers_stop(leds_inst_p->swtimers_p, timer_idx);
+    }
+}
+
+//------------------------------------------------------------------------------
+// Enable dimming with bit-angle modulation
+//------------------------------------------------------------------------------
+void leds_set_bam(const leds_t * inst_p, leds_bam_port_t * ports_p, uint32_t ports_num, uint32_t timer_idx)
+{
+    assert(inst_p != NULL);
+    leds_instance_t * leds_inst_p = (leds_instance_t*)inst_p;
+    assert((ports_p == NULL) || ((ports_num > 0) && (leds_inst_p->hw_p->gpio_write_port != NULL)));
+
+    // Stop the previous modulation, dimmed LEDs are turned OFF
+    if (leds_inst_p->bam_ports_p != NULL) {
+        if (leds_inst_p->bam_timer != LEDS_BAM_EXTERNAL_ISR) {
+            swtimers_stop(leds_inst_p->swtimers_p, leds_inst_p->bam_timer);
+        }
+        for (uint32_t i = 0; i < leds_inst_p->num; ++i) {
+            uint32_t pin = leds_inst_p->leds_table_p[i].gpio_pin;
+            if ((pin < LEDS_PORT_PIN(leds_inst_p->bam_ports_num, 0)) &&
+                ((leds_inst_p->bam_ports_p[pin / 32].pins & (1ul << (pin % 32))) != 0)) {
+                leds_off(inst_p, i);
+            }
+        }
+    }
+
+    leds_inst_p->bam_ports_p = NULL;
+    leds_inst_p->bam_ports_num = 0;
+    if (ports_p == NULL) {
+        return;
+    }
+
+    // The first call of leds_bam_isr() starts slot 0
+    memset(ports_p, 0x00, ports_num * sizeof(leds_bam_port_instance_t));
+    leds_inst_p->bam_slot = LEDS_BAM_SLOTS - 1;
+    leds_inst_p->bam_left = 0;
+    leds_inst_p->bam_timer = timer_idx;
+    leds_inst_p->bam_ports_num = ports_num;
+    leds_inst_p->bam_ports_p = (leds_bam_port_instance_t*)ports_p;
+    if (timer_idx != LEDS_BAM_EXTERNAL_ISR) {
+        swtimers_start(leds_inst_p->swtimers_p, timer_idx, swtimers_get_tick_ms(leds_inst_p->swtimers_p),
+                       SWTIMERS_MODE_PERIODIC_FROM_ISR, &leds_bam_processing, leds_inst_p, NULL);
+    }
+}
+
+//------------------------------------------------------------------------------
+// Set brightness of LED
+//------------------------------------------------------------------------------
+void leds_set_brightness(const leds_t * inst_p, uint32_t idx, uint8_t brightness)
+{
+    assert(inst_p != NULL);
+    leds_instance_t * leds_inst_p = (leds_instance_t*)inst_p;
+    assert((idx < leds_inst_p->num) && (leds_inst_p->bam_ports_p != NULL));
+    leds_led_instance_t * led_p = &(leds_inst_p->leds_table_p[idx]);
+
+    led_p->blink_state = LED_BLINK_STATE_DISABLED;
+    leds_unschedule(leds_inst_p, led_p);
+    leds_bam_write(leds_inst_p, led_p, brightness);
+}
+
+//------------------------------------------------------------------------------
+// Step of bit-angle modulation
+//------------------------------------------------------------------------------
+void leds_bam_isr(const leds_t * inst_p)
+{
+    assert(inst_p != NULL);
+    leds_instance_t * leds_inst_p = (leds_instance_t*)inst_p;
+    const leds_hw_interface_t * hw_p = leds_inst_p->hw_p;
+
+    if (leds_inst_p->bam_ports_p == NULL) {
+        return;
+    }
+
+    if (leds_inst_p->bam_left == 0) {
+        uint32_t slot = (leds_inst_p->bam_slot + 1u) % LEDS_BAM_SLOTS;
+
+        for (uint32_t i = 0; i < leds_inst_p->bam_ports_num; ++i) {
+            const leds_bam_port_instance_t * port_p = &leds_inst_p->bam_ports_p[i];
+            uint32_t pins = port_p->pins;
+
+            if (pins != 0) {
+                uint32_t set_mask = port_p->slot_masks[slot] & pins;
+                hw_p->gpio_write_port(hw_p->hw_gpio_p, i, set_mask, pins & ~set_mask);
+            }
+        }
+
+        leds_inst_p->bam_slot = (uint8_t)slot;
+        leds_inst_p->bam_left = (uint8_t)(1u << slot);
+    }
+
+    leds_inst_p->bam_left--;
+}
+
+//------------------------------------------------------------------------------
+// Write pending changes of all ports
+//------------------------------------------------------------------------------
+void leds_flush(const leds_t * inst_p)
+{
+    assert(inst_p != NULL);
+    leds_instance_t * leds_inst_p = (leds_instance_t*)inst_p;
+
+    for (uint32_t i = 0; i < leds_inst_p->ports_num; ++i) {
+        leds_port_instance_t * port_p = &leds_inst_p->ports_p[i];
+
+        if ((port_p->set_mask | port_p->clear_mask) != 0) {
+            leds_inst_p->hw_p->gpio_write_port(leds_inst_p->hw_p->hw_gpio_p, i, port_p->set_mask, port_p->clear_mask);
+            leds_inst_p->port_writes_cnt++;
+            port_p->set_mask = 0;
+            port_p->clear_mask = 0;
+        }
+    }
+}
+
+#if (DRV_TRACE == 1)
+//------------------------------------------------------------------------------
+// Attach trace of GPIO writes
+//------------------------------------------------------------------------------
+void leds_set_trace(const leds_t * inst_p, const trace_t * trace_p)
+{
+    assert(inst_p != NULL);
+    leds_instance_t * leds_inst_p = (leds_instance_t*)inst_p;
+
+    leds_inst_p->trace_p = trace_p;
+}
+#endif
+
+#if (DRV_PROF == 1)
+//------------------------------------------------------------------------------
+// Attach profiling statistics of blinking processing
+//------------------------------------------------------------------------------
+void leds_set_prof(const leds_t * inst_p, prof_cycles_cb_t cycles_cb, prof_stats_t * stats_p)
+{
+    assert(inst_p != NULL);
+    leds_instance_t * leds_inst_p = (leds_instance_t*)inst_p;
+
+    leds_inst_p->prof_cycles_cb = (stats_p != NULL) ? (cycles_cb) : (NULL);
+    leds_inst_p->prof_stats_p = (cycles_cb != NULL) ? (stats_p) : (NULL);
+}
+#endif
+
 //==================================================================================================
 //================================ PRIVATE FUNCTIONS DEFINITIONS ===================================
 //==================================================================================================
@@ -280,19 +880,75 @@ void leds_blink_ext(const leds_t * inst_p, uint32_t idx, uint8_t series, uint32_
 //------------------------------------------------------------------------------
 static void leds_gpio_set(const leds_instance_t * inst_p, leds_led_instance_t * led_p, bool led_state)
 {
-    inst_p->hw_p->gpio_write(inst_p->hw_p->hw_gpio_p, led_p->gpio_pin, (led_p->is_active_high) ? (led_state) : (!led_state));
+    bool pin_state = (led_p->is_active_high) ? (led_state) : (!led_state);
+    leds_port_instance_t * port_p = NULL;
+    uint32_t bit = 0;
+
+    leds_bam_remove(inst_p, led_p);
+    if (led_p->level == (uint8_t)led_state) {
+        ((leds_instance_t*)inst_p)->suppressed_cnt++;
+        return;
+    }
+    led_p->level = (uint8_t)led_state;
+
+    if (inst_p->ports_p != NULL) {
+        assert(led_p->gpio_pin < LEDS_PORT_PIN(inst_p->ports_num, 0));
+        port_p = &inst_p->ports_p[led_p->gpio_pin / 32];
+        bit = 1ul << (led_p->gpio_pin % 32);
+    }
+
+    // Pending change of the pin is replaced to keep order of writes
+    if ((port_p != NULL) && ((inst_p->is_deferred) || (((port_p->set_mask | port_p->clear_mask) & bit) != 0))) {
+        port_p->set_mask = (pin_state) ? (port_p->set_mask | bit) : (port_p->set_mask & ~bit);
+        port_p->clear_mask = (pin_state) ? (port_p->clear_mask & ~bit) : (port_p->clear_mask | bit);
+    }
+    else {
+        inst_p->hw_p->gpio_write(inst_p->hw_p->hw_gpio_p, led_p->gpio_pin, pin_state);
+        ((leds_instance_t*)inst_p)->writes_cnt++;
+    }
+
+#if (DRV_TRACE == 1)
+    trace_record(inst_p->trace_p, TRACE_EVT_LEDS_WRITE, (uint32_t)(led_p - inst_p->leds_table_p), (uint8_t)pin_state, 0);
+#endif
 }
 
 //------------------------------------------------------------------------------
 // Internal function for LED toggle
-// Calls hardware callback
+// Calls hardware callback, known state is toggled by write of the inverted shadow state
 //
 // `inst_p` - pointer to initialized driver instance
 // `led_p`  - pointer to initialized LED instance
 //------------------------------------------------------------------------------
 static void leds_gpio_toggle(const leds_instance_t * inst_p, leds_led_instance_t * led_p)
 {
+    if (led_p->level != LEDS_LEVEL_UNKNOWN) {
+        leds_gpio_set(inst_p, led_p, led_p->level == 0);
+        return;
+    }
+
+    leds_bam_remove(inst_p, led_p);
+
+    // Pending change of the pin is inverted
+    if (inst_p->ports_p != NULL) {
+        leds_port_instance_t * port_p = &inst_p->ports_p[led_p->gpio_pin / 32];
+        uint32_t bit = 1ul << (led_p->gpio_pin % 32);
+
+        if (((port_p->set_mask | port_p->clear_mask) & bit) != 0) {
+            port_p->set_mask ^= bit;
+            port_p->clear_mask ^= bit;
+#if (DRV_TRACE == 1)
+            trace_record(inst_p->trace_p, TRACE_EVT_LEDS_WRITE, (uint32_t)(led_p - inst_p->leds_table_p), 2, 0);
+#endif
+            return;
+        }
+    }
+
     inst_p->hw_p->gpio_toggle(inst_p->hw_p->hw_gpio_p, led_p->gpio_pin);
+    ((leds_instance_t*)inst_p)->toggles_cnt++;
+
+#if (DRV_TRACE == 1)
+    trace_record(inst_p->trace_p, TRACE_EVT_LEDS_WRITE, (uint32_t)(led_p - inst_p->leds_table_p), 2, 0);
+#endif
 }
 
 //------------------------------------------------------------------------------
@@ -306,42 +962,70 @@ static void leds_gpio_toggle(const leds_instance_t * inst_p, leds_led_instance_t
 static void leds_processing(uint32_t timer_idx, void * inst_p, void * led_p)
 {
     assert((inst_p != NULL) && (led_p != NULL));
+    (void)timer_idx;
     leds_instance_t * leds_inst_p = (leds_instance_t*)inst_p;
     leds_led_instance_t * led_inst_p = (leds_led_instance_t*)led_p;
+#if (DRV_PROF == 1)
+    uint32_t prof_start = (leds_inst_p->prof_stats_p != NULL) ? (leds_inst_p->prof_cycles_cb()) : (0);
+#endif
+
+    leds_inst_p->steps_cnt++;
+    leds_inst_p->is_deferred = (leds_inst_p->ports_p != NULL);
+    leds_step(leds_inst_p, led_inst_p);
+    leds_inst_p->is_deferred = false;
 
-    switch (led_inst_p->blink_state) {
+#if (DRV_PROF == 1)
+    if (leds_inst_p->prof_stats_p != NULL) {
+        prof_stats_add(leds_inst_p->prof_stats_p, leds_inst_p->prof_cycles_cb() - prof_start);
+    }
+#endif
+}
+
+//------------------------------------------------------------------------------
+// Internal function for switching of blinking LED to the next state
+//
+// `inst_p` - pointer to initialized driver instance
+// `led_p`  - pointer to initialized LED instance
+//------------------------------------------------------------------------------
+static void leds_step(leds_instance_t * inst_p, leds_led_instance_t * led_p)
+{
+    switch (led_p->blink_state) {
         case LED_BLINK_STATE_PAUSE:
-            leds_gpio_set(leds_inst_p, led_inst_p, (led_inst_p->is_inverted) ? false : true);
+            leds_gpio_set(inst_p, led_p, (led_p->is_inverted) ? false : true);
 
             // Run timer for "pulse"
-            swtimers_start(leds_inst_p->swtimers_p, timer_idx, led_inst_p->pulse_ms, SWTIMERS_MODE_SINGLE_FROM_LOOP, &leds_processing, leds_inst_p, led_p);
-            led_inst_p->blink_state = LED_BLINK_STATE_PULSE;
+            leds_schedule(inst_p, led_p, led_p->pulse_ms);
+            led_p->blink_state = LED_BLINK_STATE_PULSE;
             break;
 
         case LED_BLINK_STATE_PULSE:
-            leds_gpio_set(leds_inst_p, led_inst_p, (led_inst_p->is_inverted) ? true : false);
-            led_inst_p->pulse_counter++;
+            leds_gpio_set(inst_p, led_p, (led_p->is_inverted) ? true : false);
+            led_p->pulse_counter++;
 
             // If it was the last "pulse" in series
-            if (led_inst_p->pulse_counter == led_inst_p->series) {
-                led_inst_p->pulse_counter = 0;
-                if (led_inst_p->wait_ms != 0) {
+            if (led_p->pulse_counter == led_p->series) {
+                led_p->pulse_counter = 0;
+                if (led_p->wait_ms != 0) {
                     // Run timer for "wait" until the next series
-                    swtimers_start(leds_inst_p->swtimers_p, timer_idx, led_inst_p->wait_ms, SWTIMERS_MODE_SINGLE_FROM_LOOP, &leds_processing, leds_inst_p, led_p);
-                    led_inst_p->blink_state = LED_BLINK_STATE_PAUSE;
+                    leds_schedule(inst_p, led_p, led_p->wait_ms);
+                    led_p->blink_state = LED_BLINK_STATE_PAUSE;
                 }
                 else {
                     // Stop blinking
-                    led_inst_p->blink_state = LED_BLINK_STATE_DISABLED;
+                    led_p->blink_state = LED_BLINK_STATE_DISABLED;
                 }
             }
             else {
                 // Run timer for "pause"
-                swtimers_start(leds_inst_p->swtimers_p, timer_idx, led_inst_p->pause_ms, SWTIMERS_MODE_SINGLE_FROM_LOOP, &leds_processing, leds_inst_p, led_p);
-                led_inst_p->blink_state = LED_BLINK_STATE_PAUSE;
+                leds_schedule(inst_p, led_p, led_p->pause_ms);
+                led_p->blink_state = LED_BLINK_STATE_PAUSE;
             }
             break;
 
+        case LED_BLINK_STATE_PATTERN:
+            leds_pattern_step(inst_p, led_p);
+            break;
+
         case LED_BLINK_STATE_DISABLED:
             // Do nothing
             break;
@@ -352,4 +1036,513 @@ static void leds_processing(uint32_t timer_idx, void * inst_p, void * led_p)
     }
 }
 
+//------------------------------------------------------------------------------
+// Internal function for interpretation of pattern until the next timed operation
+// Program without reachable ON/OFF (e.g. only LEDS_OP_LOOP) is stopped as by LEDS_OP_END
+// after LEDS_PATTERN_CTRL_MAX control operations - valid program can't pass more of them in a row
+//
+// `inst_p` - pointer to initialized driver instance
+// `led_p`  - pointer to LED instance with running pattern
+//------------------------------------------------------------------------------
+static void leds_pattern_step(leds_instance_t * inst_p, leds_led_instance_t * led_p)
+{
+    for (uint32_t ctrl_cnt = 0; ctrl_cnt < LEDS_PATTERN_CTRL_MAX; ++ctrl_cnt) {
+        leds_op_t op = led_p->pattern_p[led_p->pc];
+        uint32_t arg = op & LEDS_OP_ARG_MASK;
+
+        switch (op & LEDS_OP_CODE_MASK) {
+            case LEDS_OP_CODE_OFF:
+            case LEDS_OP_CODE_ON:
+                assert(arg != 0);
+                leds_gpio_set(inst_p, led_p, (op & LEDS_OP_CODE_MASK) == LEDS_OP_CODE_ON);
+                led_p->pc++;
+                leds_schedule(inst_p, led_p, arg);
+                return;
+
+            case LEDS_OP_CODE_REPEAT:
+                // The block is passed (times + 1) times, counter is loaded on the first pass
+                if (led_p->repeat_left == 0) {
+                    led_p->repeat_left = (uint8_t)((arg >> 8) + 1u);
+                }
+                led_p->repeat_left--;
+                if (led_p->repeat_left != 0) {
+                    assert(((arg & 0xFFu) != 0) && ((arg & 0xFFu) <= led_p->pc));
+                    led_p->pc = (uint8_t)(led_p->pc - (arg & 0xFFu));
+                }
+                else {
+                    led_p->pc++;
+                }
+                break;
+
+            case LEDS_OP_CODE_CTRL:
+            default:
+                if (op == LEDS_OP_LOOP) {
+                    led_p->pc = 0;
+                    led_p->repeat_left = 0;
+                    break;
+                }
+                // LEDS_OP_END - LED stays in the last state
+                led_p->blink_state = LED_BLINK_STATE_DISABLED;
+                return;
+        }
+    }
+
+    // No timed operation is reached
+    led_p->blink_state = LED_BLINK_STATE_DISABLED;
+}
+
+//------------------------------------------------------------------------------
+// Internal function to run timer of LED
+// In engine mode the LED is put into queue, switching moments of blinking follow each other without drift
+//
+// `inst_p` - pointer to initialized driver instance
+// `led_p`  - pointer to initialized LED instance
+// `ms`     - time until the next switching in milliseconds
+//------------------------------------------------------------------------------
+static void leds_schedule(leds_instance_t * inst_p, leds_led_instance_t * led_p, uint32_t ms)
+{
+    if (inst_p->queue_p == NULL) {
+        swtimers_start(inst_p->swtimers_p, led_p->timer_id, ms, SWTIMERS_MODE_SINGLE_FROM_LOOP, &leds_processing, inst_p, led_p);
+        return;
+    }
+
+    // Inside engine handler the LED has just been taken from queue at its deadline
+    led_p->deadline = ((inst_p->is_engine_busy) ? (led_p->deadline) : (leds_engine_now(inst_p))) + ms;
+
+    if (led_p->queue_pos == 0) {
+        inst_p->queue_p[inst_p->queue_num] = (uint16_t)(led_p - inst_p->leds_table_p);
+        inst_p->queue_num++;
+        led_p->queue_pos = (uint16_t)inst_p->queue_num;
+    }
+    leds_queue_fix(inst_p, led_p->queue_pos - 1u);
+
+    // Engine timer is rearmed at the end of engine handler or if the LED is the nearest one
+    if ((inst_p->is_engine_busy == false) && (led_p->queue_pos == 1)) {
+        leds_engine_arm(inst_p, leds_engine_now(inst_p));
+    }
+}
+
+//------------------------------------------------------------------------------
+// Internal function to remove LED from queue of engine
+// Timer of LED in normal mode isn't stopped - its handler does nothing for LED without blinking
+//
+// `inst_p` - pointer to initialized driver instance
+// `led_p`  - pointer to initialized LED instance
+//------------------------------------------------------------------------------
+static void leds_unschedule(leds_instance_t * inst_p, leds_led_instance_t * led_p)
+{
+    if ((inst_p->queue_p == NULL) || (led_p->queue_pos == 0)) {
+        return;
+    }
+
+    uint32_t pos = led_p->queue_pos - 1u;
+    uint32_t last = inst_p->queue_num - 1u;
+
+    leds_queue_swap(inst_p, pos, last);
+    inst_p->queue_num--;
+    led_p->queue_pos = 0;
+    if (pos != last) {
+        leds_queue_fix(inst_p, pos);
+    }
+}
+
+//------------------------------------------------------------------------------
+// Internal function for processing of all LEDs in engine mode
+// Signature corresponds to swtimers_handler_cb_t
+//
+// `timer_idx` - timer index
+// `inst_p`    - pointer to initialized LED driver instance (with type leds_instance_t*)
+// `arg_p`     - not used
+//------------------------------------------------------------------------------
+static void leds_engine_processing(uint32_t timer_idx, void * inst_p, void * arg_p)
+{
+    assert(inst_p != NULL);
+    (void)timer_idx;
+    (void)arg_p;
+    leds_instance_t * leds_inst_p = (leds_instance_t*)inst_p;
+#if (DRV_PROF == 1)
+    uint32_t prof_start = (leds_inst_p->prof_stats_p != NULL) ? (leds_inst_p->prof_cycles_cb()) : (0);
+#endif
+
+    leds_inst_p->engine_base_ms += leds_inst_p->engine_armed_ms;
+    leds_inst_p->engine_armed_ms = 0;
+    leds_inst_p->is_engine_busy = true;
+    leds_inst_p->is_deferred = (leds_inst_p->ports_p != NULL);
+
+    // Switch all LEDs which are due, the nearest one is on top of the heap
+    while (leds_inst_p->queue_num != 0) {
+        leds_led_instance_t * led_p = &leds_inst_p->leds_table_p[leds_inst_p->queue_p[0]];
+        if ((int32_t)(led_p->deadline - leds_inst_p->engine_base_ms) > 0) {
+            break;
+        }
+        leds_unschedule(leds_inst_p, led_p);
+        leds_inst_p->steps_cnt++;
+        leds_step(leds_inst_p, led_p);
+    }
+
+    leds_inst_p->is_deferred = false;
+    leds_inst_p->is_engine_busy = false;
+    leds_engine_arm(leds_inst_p, leds_inst_p->engine_base_ms);
+
+#if (DRV_PROF == 1)
+    if (leds_inst_p->prof_stats_p != NULL) {
+        prof_stats_add(leds_inst_p->prof_stats_p, leds_inst_p->prof_cycles_cb() - prof_start);
+    }
+#endif
+}
+
+//------------------------------------------------------------------------------
+// Internal function to start engine timer until the nearest deadline (or to stop it if queue is empty)
+//
+// `inst_p` - pointer to initialized driver instance
+// `now`    - current engine time in milliseconds
+//------------------------------------------------------------------------------
+static void leds_engine_arm(leds_instance_t * inst_p, uint32_t now)
+{
+    inst_p->engine_base_ms = now;
+    if (inst_p->queue_num == 0) {
+        inst_p->engine_armed_ms = 0;
+        swtimers_stop(inst_p->swtimers_p, inst_p->engine_timer);
+        return;
+    }
+
+    int32_t left = (int32_t)(inst_p->leds_table_p[inst_p->queue_p[0]].deadline - now);
+    inst_p->engine_armed_ms = (left > 0) ? ((uint32_t)left) : (0);
+    swtimers_start(inst_p->swtimers_p, inst_p->engine_timer, inst_p->engine_armed_ms, SWTIMERS_MODE_SINGLE_FROM_LOOP,
+                   &leds_engine_processing, inst_p, NULL);
+}
+
+//------------------------------------------------------------------------------
+// Internal function to get current engine time
+//
+// `inst_p` - pointer to initialized driver instance
+//
+// Returns - engine time in milliseconds (wraps around)
+//------------------------------------------------------------------------------
+static uint32_t leds_engine_now(const leds_instance_t * inst_p)
+{
+    uint32_t elapsed_ms;
+
+    if (inst_p->is_engine_busy) {
+        return inst_p->engine_base_ms;
+    }
+    if (swtimers_is_run(inst_p->swtimers_p, inst_p->engine_timer, &elapsed_ms)) {
+        return inst_p->engine_base_ms + elapsed_ms;
+    }
+    return inst_p->engine_base_ms + inst_p->engine_armed_ms;
+}
+
+//------------------------------------------------------------------------------
+// Internal function to restore order of heap after change of deadline at given position
+//
+// `inst_p` - pointer to initialized driver instance
+// `pos`    - position in queue
+//------------------------------------------------------------------------------
+static void leds_queue_fix(const leds_instance_t * inst_p, uint32_t pos)
+{
+    const uint16_t * queue_p = inst_p->queue_p;
+    const leds_led_instance_t * table_p = inst_p->leds_table_p;
+
+    // Sift up
+    while ((pos > 0) && ((int32_t)(table_p[queue_p[pos]].deadline - table_p[queue_p[(pos - 1) / 2]].deadline) < 0)) {
+        leds_queue_swap(inst_p, pos, (pos - 1) / 2);
+        pos = (pos - 1) / 2;
+    }
+
+    // Sift down
+    for (;;) {
+        uint32_t min = pos;
+        uint32_t child = (2 * pos) + 1;
+
+        if ((child < inst_p->queue_num) && ((int32_t)(table_p[queue_p[child]].deadline - table_p[queue_p[min]].deadline) < 0)) {
+            min = child;
+        }
+        child++;
+        if ((child < inst_p->queue_num) && ((int32_t)(table_p[queue_p[child]].deadline - table_p[queue_p[min]].deadline) < 0)) {
+            min = child;
+        }
+        if (min == pos) {
+            break;
+        }
+        leds_queue_swap(inst_p, pos, min);
+        pos = min;
+    }
+}
+
+//------------------------------------------------------------------------------
+// Internal function to swap two LEDs in queue
+//
+// `inst_p` - pointer to initialized driver instance
+// `pos_1`  - position of the first LED in queue
+// `pos_2`  - position of the second LED in queue
+//------------------------------------------------------------------------------
+static void leds_queue_swap(const leds_instance_t * inst_p, uint32_t pos_1, uint32_t pos_2)
+{
+    uint16_t idx_1 = inst_p->queue_p[pos_1];
+    uint16_t idx_2 = inst_p->queue_p[pos_2];
+
+    inst_p->queue_p[pos_1] = idx_2;
+    inst_p->queue_p[pos_2] = idx_1;
+    inst_p->leds_table_p[idx_1].queue_pos = (uint16_t)(pos_2 + 1u);
+    inst_p->leds_table_p[idx_2].queue_pos = (uint16_t)(pos_1 + 1u);
+}
+
+//------------------------------------------------------------------------------
+// Internal function to flush pending changes at the end of swtimers_task()
+// Signature corresponds to swtimers_task_hook_cb_t
+//
+// `inst_p` - pointer to initialized LED driver instance (with type leds_instance_t*)
+//------------------------------------------------------------------------------
+static void leds_flush_hook(void * inst_p)
+{
+    assert(inst_p != NULL);
+    leds_flush((const leds_t*)inst_p);
+}
+
+//------------------------------------------------------------------------------
+// Internal function for switching of all members of group by software timer
+// Signature corresponds to swtimers_handler_cb_t
+//
+// `timer_idx` - timer index
+// `inst_p`    - pointer to initialized LED driver instance (with type leds_instance_t*)
+// `group_p`   - pointer to initialized group (with type leds_group_instance_t*)
+//------------------------------------------------------------------------------
+static void leds_group_processing(uint32_t timer_idx, void * inst_p, void * group_p)
+{
+    assert((inst_p != NULL) && (group_p != NULL));
+    (void)timer_idx;
+    leds_instance_t * leds_inst_p = (leds_instance_t*)inst_p;
+
+    leds_inst_p->steps_cnt++;
+    if (((const leds_group_instance_t*)group_p)->mode != LEDS_GROUP_MODE_BLINK) {
+        leds_group_fade_update(leds_inst_p, (leds_group_instance_t*)group_p, false);
+        return;
+    }
+
+    leds_inst_p->is_deferred = (leds_inst_p->ports_p != NULL);
+    leds_group_update(leds_inst_p, (const leds_group_instance_t*)group_p);
+    leds_inst_p->is_deferred = false;
+}
+
+//------------------------------------------------------------------------------
+// Internal function to set state of all members of group and to run timer until the next switching
+// State of LEDs is calculated from current time, so late calls don't shift the phase
+//
+// `inst_p`  - pointer to initialized driver instance
+// `group_p` - pointer to initialized group
+//------------------------------------------------------------------------------
+static void leds_group_update(const leds_instance_t * inst_p, const leds_group_instance_t * group_p)
+{
+    uint32_t next_ms;
+    bool is_pulse = leds_blink_phase(group_p->series, group_p->pulse_ms, group_p->pause_ms, group_p->period_ms,
+                                     swtimers_get_time_ms(inst_p->swtimers_p), &next_ms);
+
+    for (uint32_t i = 0; i < group_p->members_num; ++i) {
+        leds_led_instance_t * led_p = &inst_p->leds_table_p[group_p->members_p[i]];
+        if (led_p->blink_state == LED_BLINK_STATE_GROUP) {
+            leds_gpio_set(inst_p, led_p, is_pulse != group_p->is_inverted);
+        }
+    }
+
+    swtimers_start(inst_p->swtimers_p, group_p->timer_id, next_ms, SWTIMERS_MODE_SINGLE_FROM_LOOP,
+                   &leds_group_processing, (void*)inst_p, (void*)group_p);
+}
+
+//------------------------------------------------------------------------------
+// Internal function to take members of group out of their own blinking
+//
+// `inst_p`  - pointer to initialized driver instance
+// `group_p` - pointer to initialized group
+//------------------------------------------------------------------------------
+static void leds_group_join(const leds_instance_t * inst_p, const leds_group_instance_t * group_p)
+{
+    for (uint32_t i = 0; i < group_p->members_num; ++i) {
+        assert(group_p->members_p[i] < inst_p->num);
+        leds_led_instance_t * led_p = &inst_p->leds_table_p[group_p->members_p[i]];
+        leds_unschedule((leds_instance_t*)inst_p, led_p);
+        // Timer of LED in normal mode would step blinking of the member owned by the group
+        if (inst_p->queue_p == NULL) {
+            swtimers_stop(inst_p->swtimers_p, led_p->timer_id);
+        }
+        led_p->blink_state = LED_BLINK_STATE_GROUP;
+    }
+}
+
+//------------------------------------------------------------------------------
+// Internal function to start fading of group with parameters set by the caller
+//
+// `inst_p`  - pointer to initialized driver instance
+// `group_p` - pointer to initialized group
+//------------------------------------------------------------------------------
+static void leds_group_fade_start(const leds_instance_t * inst_p, leds_group_instance_t * group_p)
+{
+    leds_group_join(inst_p, group_p);
+
+    // Timer is started before the first update, which stops it if fade is already over
+    swtimers_start(inst_p->swtimers_p, group_p->timer_id, group_p->step_ms, SWTIMERS_MODE_PERIODIC_FROM_LOOP,
+                   &leds_group_processing, (void*)inst_p, (void*)group_p);
+    leds_group_fade_update(inst_p, group_p, true);
+}
+
+//------------------------------------------------------------------------------
+// Internal function to set brightness of all members of fading group from current time
+// Level is calculated from current time, so late calls don't shift the fade
+//
+// `inst_p`    - pointer to initialized driver instance
+// `group_p`   - pointer to initialized group in fading mode
+// `is_forced` - 'true' - members are written even if brightness isn't changed
+//------------------------------------------------------------------------------
+static void leds_group_fade_update(const leds_instance_t * inst_p, leds_group_instance_t * group_p, bool is_forced)
+{
+    uint32_t time_ms = swtimers_get_time_ms(inst_p->swtimers_p);
+    uint32_t level;
 
+    // Dimming is disabled, members are already turned OFF by leds_set_bam()
+    if (inst_p->bam_ports_p == NULL) {
+        swtimers_stop(inst_p->swtimers_p, group_p->timer_id);
+        return;
+    }
+
+    if (group_p->mode == LEDS_GROUP_MODE_BREATHE) {
+        // Triangle 0 .. 255 .. 0 over the period
+        level = ((time_ms % group_p->period_ms) * 510u) / group_p->period_ms;
+        level = (level > 255u) ? (510u - level) : (level);
+    }
+    else {
+        uint32_t elapsed_ms = time_ms - group_p->start_ms;
+
+        if (elapsed_ms >= group_p->period_ms) {
+            level = group_p->to;
+            swtimers_stop(inst_p->swtimers_p, group_p->timer_id);
+        }
+        else if (group_p->to >= group_p->from) {
+            level = group_p->from + (((uint32_t)(group_p->to - group_p->from) * elapsed_ms) / group_p->period_ms);
+        }
+        else {
+            level = group_p->from - (((uint32_t)(group_p->from - group_p->to) * elapsed_ms) / group_p->period_ms);
+        }
+    }
+
+    // The only lookup of the step, shared by all members
+    uint8_t brightness = (group_p->table_p != NULL) ? (group_p->table_p[level]) : ((uint8_t)level);
+    if ((brightness == group_p->brightness) && (!is_forced)) {
+        return;
+    }
+    group_p->brightness = brightness;
+
+    for (uint32_t i = 0; i < group_p->members_num; ++i) {
+        leds_led_instance_t * led_p = &inst_p->leds_table_p[group_p->members_p[i]];
+        if (led_p->blink_state == LED_BLINK_STATE_GROUP) {
+            leds_bam_write(inst_p, led_p, brightness);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+// Internal function to calculate position within blinking in closed form
+//
+// `series`        - number of pulses within one series
+// `pulse_ms`      - duration of "pulse" in milliseconds
+// `pause_ms`      - duration of "pause" between pulses in milliseconds
+// `period_ms`     - duration of one series in milliseconds (0 - single series)
+// `time_ms`       - time since the beginning of the first pulse in milliseconds
+// `next_ms_out_p` - out - time until the next switching in milliseconds, 0 - no more switching
+//
+// Returns - 'true' during the "pulse"
+//------------------------------------------------------------------------------
+static bool leds_blink_phase(uint8_t series, uint32_t pulse_ms, uint32_t pause_ms, uint32_t period_ms, uint32_t time_ms,
+                             uint32_t * next_ms_out_p)
+{
+    uint32_t step = pulse_ms + pause_ms;
+    uint32_t series_ms = (step * series) - pause_ms;
+    uint32_t phase = (period_ms == 0) ? (time_ms) : (time_ms % period_ms);
+    uint32_t pulse_idx = phase / step;
+
+    // Position within series - wait until the next series (or the end of single series), pulse or pause after pulse
+    if (phase >= series_ms) {
+        *next_ms_out_p = (period_ms == 0) ? (0) : (period_ms - phase);
+        return false;
+    }
+    if ((phase % step) < pulse_ms) {
+        *next_ms_out_p = (pulse_idx * step) + pulse_ms - phase;
+        return true;
+    }
+    *next_ms_out_p = ((pulse_idx + 1) * step) - phase;
+    return false;
+}
+
+//------------------------------------------------------------------------------
+// Internal function to write state of lazy blinking LED if it differs from the shadow state
+//
+// `inst_p`  - pointer to initialized driver instance
+// `led_p`   - pointer to LED instance in lazy mode
+// `time_ms` - current time in time base of leds_blink_lazy() call
+//
+// Returns - 'true' if LED is ON
+//------------------------------------------------------------------------------
+static bool leds_lazy_write(const leds_instance_t * inst_p, leds_led_instance_t * led_p, uint32_t time_ms)
+{
+    bool state = leds_state_at((const leds_t*)inst_p, (uint32_t)(led_p - inst_p->leds_table_p), time_ms);
+
+    // Repeated refreshes of unchanged state aren't counted as suppressed writes
+    if (led_p->level != (uint8_t)state) {
+        leds_gpio_set(inst_p, led_p, state);
+    }
+
+    return state;
+}
+
+//------------------------------------------------------------------------------
+// Internal function to put LED into dimming mode with given brightness
+//
+// `inst_p`     - pointer to initialized driver instance with enabled dimming
+// `led_p`      - pointer to initialized LED instance
+// `brightness` - brightness 0 (OFF) .. 255 (ON)
+//------------------------------------------------------------------------------
+static void leds_bam_write(const leds_instance_t * inst_p, leds_led_instance_t * led_p, uint8_t brightness)
+{
+    assert(led_p->gpio_pin < LEDS_PORT_PIN(inst_p->bam_ports_num, 0));
+    leds_bam_port_instance_t * port_p = &inst_p->bam_ports_p[led_p->gpio_pin / 32];
+    uint32_t bit = 1ul << (led_p->gpio_pin % 32);
+
+    // Pin level during slot of each bit of brightness, masks are updated before the pin is given to ISR
+    for (uint32_t slot = 0; slot < LEDS_BAM_SLOTS; ++slot) {
+        bool pin_state = (((brightness >> slot) & 1u) != 0) == led_p->is_active_high;
+        port_p->slot_masks[slot] = (pin_state) ? (port_p->slot_masks[slot] | bit) : (port_p->slot_masks[slot] & ~bit);
+    }
+    port_p->pins |= bit;
+    led_p->level = LEDS_LEVEL_UNKNOWN;
+}
+
+//------------------------------------------------------------------------------
+// Internal function to take LED out of dimming mode (the next write of the pin is done by the caller)
+//
+// `inst_p` - pointer to initialized driver instance
+// `led_p`  - pointer to initialized LED instance
+//------------------------------------------------------------------------------
+static void leds_bam_remove(const leds_instance_t * inst_p, const leds_led_instance_t * led_p)
+{
+    if ((inst_p->bam_ports_p == NULL) || (led_p->gpio_pin >= LEDS_PORT_PIN(inst_p->bam_ports_num, 0))) {
+        return;
+    }
+
+    // ISR doesn't write the pin after this point
+    inst_p->bam_ports_p[led_p->gpio_pin / 32].pins &= ~(1ul << (led_p->gpio_pin % 32));
+}
+
+//------------------------------------------------------------------------------
+// Internal function for bit-angle modulation by software timer
+// Signature corresponds to swtimers_handler_cb_t
+//
+// `timer_idx` - timer index
+// `inst_p`    - pointer to initialized LED driver instance (with type leds_instance_t*)
+// `arg_p`     - not used
+//------------------------------------------------------------------------------
+static void leds_bam_processing(uint32_t timer_idx, void * inst_p, void * arg_p)
+{
+    assert(inst_p != NULL);
+    (void)timer_idx;
+    (void)arg_p;
+
+    leds_bam_isr((const leds_t*)inst_p);
+}
@@ -0,0 +1,258 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+//**************************************************************************************************
+// Multiplexed LED matrix / shift register backend for LED control driver
+//**************************************************************************************************
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+
+#include "drv_leds_matrix.h"
+
+//==================================================================================================
+//========================================== TYPEDEFS ==============================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Driver instance
+//------------------------------------------------------------------------------
+typedef struct leds_matrix_instance_s {
+
+    // Settings
+    leds_hw_interface_t         hw;             // interface passed into leds_init() (hw_gpio_p - pointer to this instance)
+    leds_matrix_row_out_cb_t    row_out_cb;     // output of one row
+    void*                       hw_out_p;       // pointer to hardware driver to be passed into row_out_cb
+    const swtimers_t*           swtimers_p;     // pointer to software timers driver instance
+    uint8_t*                    buffers_p;      // two frames one after another
+    uint32_t                    rows;           // number of rows
+    uint32_t                    row_bytes;      // number of bytes in one row
+    uint32_t                    timer_id;       // index of software timer of refresh or LEDS_MATRIX_EXTERNAL_ISR
+
+    // State
+    volatile uint32_t           row;            // row to be output by the next leds_matrix_isr() call (updated in ISR)
+    volatile uint8_t            front;          // index of frame being output (updated in ISR)
+    volatile bool               is_swap_pending;// 'true' - back frame is committed, frames are swapped at the beginning of the next frame
+    volatile bool               is_copy_needed; // 'true' - frames are swapped, back frame must be updated from front frame before writes
+    bool                        is_dirty;       // 'true' - back frame is changed since the last commit
+} leds_matrix_instance_t;
+
+//------------------------------------------------------------------------------
+// Sanitizing
+//------------------------------------------------------------------------------
+static_assert(sizeof(leds_matrix_instance_t) == sizeof(leds_matrix_t), "Wrong structure size");
+
+//==================================================================================================
+//================================ PRIVATE FUNCTIONS DECLARATIONS ==================================
+//==================================================================================================
+
+static uint8_t * leds_matrix_locate(leds_matrix_instance_t * inst_p, uint32_t pin_idx, uint8_t * mask_out_p);
+static void leds_matrix_gpio_write(void * hw_gpio_p, uint32_t pin_idx, uint8_t pin_state);
+static void leds_matrix_gpio_toggle(void * hw_gpio_p, uint32_t pin_idx);
+static void leds_matrix_gpio_write_port(void * hw_gpio_p, uint32_t port_idx, uint32_t set_mask, uint32_t clear_mask);
+static void leds_matrix_processing(uint32_t timer_idx, void * inst_p, void * arg_p);
+
+//==================================================================================================
+//================================ PUBLIC FUNCTIONS DEFINITIONS ====================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Init backend
+//------------------------------------------------------------------------------
+void leds_matrix_init(leds_matrix_t * inst_p, leds_matrix_row_out_cb_t row_out_cb, void * hw_out_p, uint32_t rows,
+                      uint32_t row_bytes, uint8_t * buffers_p, const swtimers_t * swtimers_p, uint32_t timer_idx)
+{
+    assert((inst_p != NULL) && (row_out_cb != NULL) && (rows > 0) && (row_bytes > 0) && (buffers_p != NULL));
+    assert((swtimers_p != NULL) || (timer_idx == LEDS_MATRIX_EXTERNAL_ISR));
+    leds_matrix_instance_t * matrix_inst_p = (leds_matrix_instance_t*)inst_p;
+
+    memset(matrix_inst_p, 0x00, sizeof(leds_matrix_instance_t));
+    memset(buffers_p, 0x00, LEDS_MATRIX_BUFFER_SIZE(rows, row_bytes));
+
+    matrix_inst_p->hw.hw_gpio_p = matrix_inst_p;
+    matrix_inst_p->hw.gpio_write = &leds_matrix_gpio_write;
+    matrix_inst_p->hw.gpio_toggle = &leds_matrix_gpio_toggle;
+    matrix_inst_p->hw.gpio_write_port = &leds_matrix_gpio_write_port;
+    matrix_inst_p->row_out_cb = row_out_cb;
+    matrix_inst_p->hw_out_p = hw_out_p;
+    matrix_inst_p->swtimers_p = swtimers_p;
+    matrix_inst_p->buffers_p = buffers_p;
+    matrix_inst_p->rows = rows;
+    matrix_inst_p->row_bytes = row_bytes;
+    matrix_inst_p->timer_id = timer_idx;
+
+    if (timer_idx != LEDS_MATRIX_EXTERNAL_ISR) {
+        // One row per tick of software timers
+        swtimers_start(swtimers_p, timer_idx, swtimers_get_tick_ms(swtimers_p), SWTIMERS_MODE_PERIODIC_FROM_ISR,
+                       &leds_matrix_processing, matrix_inst_p, NULL);
+    }
+}
+
+//------------------------------------------------------------------------------
+// Deinit backend
+//------------------------------------------------------------------------------
+void leds_matrix_deinit(leds_matrix_t * inst_p)
+{
+    assert(inst_p != NULL);
+    leds_matrix_instance_t * matrix_inst_p = (leds_matrix_instance_t*)inst_p;
+
+    // If not initialized
+    if (matrix_inst_p->rows == 0) {
+        return;
+    }
+
+    if (matrix_inst_p->timer_id != LEDS_MATRIX_EXTERNAL_ISR) {
+        swtimers_stop(matrix_inst_p->swtimers_p, matrix_inst_p->timer_id);
+    }
+
+    memset(matrix_inst_p, 0x00, sizeof(leds_matrix_instance_t));
+}
+
+//------------------------------------------------------------------------------
+// Get hardware interface to be passed into leds_init()
+//------------------------------------------------------------------------------
+const leds_hw_interface_t * leds_matrix_get_hw_interface(const leds_matrix_t * inst_p)
+{
+    assert(inst_p != NULL);
+
+    return &((const leds_matrix_instance_t*)inst_p)->hw;
+}
+
+//------------------------------------------------------------------------------
+// Make changes of LEDs visible from the beginning of the next frame
+//------------------------------------------------------------------------------
+void leds_matrix_commit(const leds_matrix_t * inst_p)
+{
+    assert(inst_p != NULL);
+    leds_matrix_instance_t * matrix_inst_p = (leds_matrix_instance_t*)inst_p;
+
+    // Writes after commit but before swap still get into the frame to be shown
+    if (matrix_inst_p->is_dirty) {
+        matrix_inst_p->is_dirty = false;
+        matrix_inst_p->is_swap_pending = true;
+    }
+}
+
+//------------------------------------------------------------------------------
+// Output the next row
+//------------------------------------------------------------------------------
+void leds_matrix_isr(const leds_matrix_t * inst_p)
+{
+    assert(inst_p != NULL);
+    leds_matrix_instance_t * matrix_inst_p = (leds_matrix_instance_t*)inst_p;
+    uint32_t row = matrix_inst_p->row;
+
+    // Frames are swapped only between frames
+    if ((row == 0) && (matrix_inst_p->is_swap_pending)) {
+        matrix_inst_p->front ^= 1u;
+        matrix_inst_p->is_copy_needed = true;
+        matrix_inst_p->is_swap_pending = false;
+    }
+
+    uint32_t offset = ((matrix_inst_p->front * matrix_inst_p->rows) + row) * matrix_inst_p->row_bytes;
+    matrix_inst_p->row_out_cb(matrix_inst_p->hw_out_p, row, &matrix_inst_p->buffers_p[offset], matrix_inst_p->row_bytes);
+
+    matrix_inst_p->row = ((row + 1) == matrix_inst_p->rows) ? (0) : (row + 1);
+}
+
+//==================================================================================================
+//================================ PRIVATE FUNCTIONS DEFINITIONS ===================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Internal function to find bit of pin in the back frame
+// Back frame is brought up to date with front frame after swap
+//
+// `inst_p`     - pointer to initialized driver instance
+// `pin_idx`    - index of pin (LEDS_MATRIX_PIN())
+// `mask_out_p` - out - mask of the pin in the byte
+//
+// Returns - pointer to byte of the pin
+//------------------------------------------------------------------------------
+static uint8_t * leds_matrix_locate(leds_matrix_instance_t * inst_p, uint32_t pin_idx, uint8_t * mask_out_p)
+{
+    uint32_t frame_size = inst_p->rows * inst_p->row_bytes;
+    uint32_t row = pin_idx / (inst_p->row_bytes * 8);
+    uint32_t col = pin_idx % (inst_p->row_bytes * 8);
+    assert(row < inst_p->rows);
+
+    // Front is updated in ISR - the copy and the returned byte must refer to the same back frame
+    uint32_t front = inst_p->front;
+
+    if (inst_p->is_copy_needed) {
+        inst_p->is_copy_needed = false;
+        memcpy(&inst_p->buffers_p[(front ^ 1u) * frame_size], &inst_p->buffers_p[front * frame_size], frame_size);
+    }
+    inst_p->is_dirty = true;
+
+    // The first byte of row is shifted out first and gets into the last register of chain
+    *mask_out_p = (uint8_t)(1u << (col % 8));
+    return &inst_p->buffers_p[((front ^ 1u) * frame_size) + (row * inst_p->row_bytes) + (inst_p->row_bytes - 1 - (col / 8))];
+}
+
+//------------------------------------------------------------------------------
+// Internal function to set pin in the back frame
+// Signature corresponds to leds_gpio_write_cb_t
+//
+// `hw_gpio_p` - pointer to initialized driver instance (with type leds_matrix_instance_t*)
+// `pin_idx`   - index of pin
+// `pin_state` - pin state, '0' - logical zero, otherwise - logical one
+//------------------------------------------------------------------------------
+static void leds_matrix_gpio_write(void * hw_gpio_p, uint32_t pin_idx, uint8_t pin_state)
+{
+    uint8_t mask;
+    uint8_t * byte_p = leds_matrix_locate((leds_matrix_instance_t*)hw_gpio_p, pin_idx, &mask);
+
+    *byte_p = (pin_state != 0) ? (uint8_t)(*byte_p | mask) : (uint8_t)(*byte_p & ~mask);
+}
+
+//------------------------------------------------------------------------------
+// Internal function to toggle pin in the back frame
+// Signature corresponds to leds_gpio_toggle_cb_t
+//
+// `hw_gpio_p` - pointer to initialized driver instance (with type leds_matrix_instance_t*)
+// `pin_idx`   - index of pin
+//------------------------------------------------------------------------------
+static void leds_matrix_gpio_toggle(void * hw_gpio_p, uint32_t pin_idx)
+{
+    uint8_t mask;
+    uint8_t * byte_p = leds_matrix_locate((leds_matrix_instance_t*)hw_gpio_p, pin_idx, &mask);
+
+    *byte_p ^= mask;
+}
+
+//------------------------------------------------------------------------------
+// Internal function to write 32 pins of batched "port" (LEDS_PORT_PIN()) in the back frame
+// Signature corresponds to leds_gpio_write_port_cb_t
+//
+// `hw_gpio_p`  - pointer to initialized driver instance (with type leds_matrix_instance_t*)
+// `port_idx`   - index of port
+// `set_mask`   - pins to be set to logical one
+// `clear_mask` - pins to be set to logical zero
+//------------------------------------------------------------------------------
+static void leds_matrix_gpio_write_port(void * hw_gpio_p, uint32_t port_idx, uint32_t set_mask, uint32_t clear_mask)
+{
+    uint32_t mask = set_mask | clear_mask;
+
+    for (uint32_t bit = 0; mask != 0; ++bit, mask >>= 1) {
+        if ((mask & 1u) != 0) {
+            leds_matrix_gpio_write(hw_gpio_p, LEDS_PORT_PIN(port_idx, bit), (uint8_t)((set_mask >> bit) & 1u));
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+// Internal function for refresh by software timer
+// Signature corresponds to swtimers_handler_cb_t
+//
+// `timer_idx` - timer index
+// `inst_p`    - pointer to initialized driver instance (with type leds_matrix_instance_t*)
+// `arg_p`     - not used
+//------------------------------------------------------------------------------
+static void leds_matrix_processing(uint32_t timer_idx, void * inst_p, void * arg_p)
+{
+    (void)timer_idx;
+    (void)arg_p;
+
+    leds_matrix_isr((const leds_matrix_t*)inst_p);
+}
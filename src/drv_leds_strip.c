@@ -0,0 +1,335 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+//**************************************************************************************************
+// Addressable LED strip (WS2812-style) backend for LED control driver
+//**************************************************************************************************
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+
+#include "drv_leds_strip.h"
+
+#if (LEDS_STRIP_SIMD == 1) && defined(__SSE2__)
+#include <emmintrin.h>
+#define LEDS_STRIP_SSE2
+#elif (LEDS_STRIP_SIMD == 1) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define LEDS_STRIP_NEON
+#endif
+
+//==================================================================================================
+//=========================================== MACROS ===============================================
+//==================================================================================================
+
+#define LEDS_STRIP_PIXEL_BYTES (3)      // G, R, B
+
+// Line bits of nibble, the highest data bit is the first
+#define LEDS_STRIP_CODE_3BIT(n) ((uint16_t)(((((n) & 8u) ? 6u : 4u) << 9) | ((((n) & 4u) ? 6u : 4u) << 6) | \
+                                            ((((n) & 2u) ? 6u : 4u) << 3) |  (((n) & 1u) ? 6u : 4u)))
+#define LEDS_STRIP_CODE_4BIT(n) ((uint16_t)(((((n) & 8u) ? 0xEu : 0x8u) << 12) | ((((n) & 4u) ? 0xEu : 0x8u) << 8) | \
+                                            ((((n) & 2u) ? 0xEu : 0x8u) << 4)  |  (((n) & 1u) ? 0xEu : 0x8u)))
+#define LEDS_STRIP_NIBBLES(code) { code(0),  code(1),  code(2),  code(3),  code(4),  code(5),  code(6),  code(7),  \
+                                   code(8),  code(9),  code(10), code(11), code(12), code(13), code(14), code(15) }
+
+//==================================================================================================
+//========================================== TYPEDEFS ==============================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Driver instance
+//------------------------------------------------------------------------------
+typedef struct leds_strip_instance_s {
+    leds_hw_interface_t hw;             // interface passed into leds_init() (hw_gpio_p - pointer to this instance)
+    uint8_t*            frame_p;        // current pixels (G, R, B)
+    uint8_t*            colors_p;       // colors of pixels in ON state (G, R, B)
+    uint8_t*            states_p;       // bitmap of pin states
+    uint8_t*            dma_p;          // encoded bitstream
+    uint32_t            num;            // number of pixels
+    uint32_t            dirty_first;    // the first changed pixel (num - frame isn't changed)
+    uint32_t            dirty_last;     // the last changed pixel
+    uint32_t            format;         // line bits per data bit (leds_strip_format_t)
+} leds_strip_instance_t;
+
+//------------------------------------------------------------------------------
+// Sanitizing
+//------------------------------------------------------------------------------
+static_assert(sizeof(leds_strip_instance_t) == sizeof(leds_strip_t), "Wrong structure size");
+
+//==================================================================================================
+//================================ PRIVATE FUNCTIONS DECLARATIONS ==================================
+//==================================================================================================
+
+static void leds_strip_update(leds_strip_instance_t * inst_p, uint32_t idx);
+static void leds_strip_encode_3bit(const uint8_t * src_p, uint8_t * dst_p, uint32_t size);
+static void leds_strip_encode_4bit(const uint8_t * src_p, uint8_t * dst_p, uint32_t size);
+static void leds_strip_gpio_write(void * hw_gpio_p, uint32_t pin_idx, uint8_t pin_state);
+static void leds_strip_gpio_toggle(void * hw_gpio_p, uint32_t pin_idx);
+static void leds_strip_gpio_write_port(void * hw_gpio_p, uint32_t port_idx, uint32_t set_mask, uint32_t clear_mask);
+
+//==================================================================================================
+//=========================================== DATA =================================================
+//==================================================================================================
+
+static const uint16_t leds_strip_lut_3bit[16] = LEDS_STRIP_NIBBLES(LEDS_STRIP_CODE_3BIT);
+static const uint16_t leds_strip_lut_4bit[16] = LEDS_STRIP_NIBBLES(LEDS_STRIP_CODE_4BIT);
+
+//==================================================================================================
+//================================ PUBLIC FUNCTIONS DEFINITIONS ====================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Init backend
+//------------------------------------------------------------------------------
+void leds_strip_init(leds_strip_t * inst_p, uint32_t num, uint8_t * storage_p, uint8_t * dma_p, leds_strip_format_t format)
+{
+    assert((inst_p != NULL) && (num > 0) && (storage_p != NULL) && (dma_p != NULL));
+    assert((format == LEDS_STRIP_FORMAT_SPI_3BIT) || (format == LEDS_STRIP_FORMAT_SPI_4BIT));
+    leds_strip_instance_t * strip_inst_p = (leds_strip_instance_t*)inst_p;
+
+    memset(strip_inst_p, 0x00, sizeof(leds_strip_instance_t));
+    memset(storage_p, 0x00, LEDS_STRIP_STORAGE_SIZE(num));
+
+    strip_inst_p->hw.hw_gpio_p = strip_inst_p;
+    strip_inst_p->hw.gpio_write = &leds_strip_gpio_write;
+    strip_inst_p->hw.gpio_toggle = &leds_strip_gpio_toggle;
+    strip_inst_p->hw.gpio_write_port = &leds_strip_gpio_write_port;
+    strip_inst_p->frame_p = storage_p;
+    strip_inst_p->colors_p = &storage_p[LEDS_STRIP_PIXEL_BYTES * num];
+    strip_inst_p->states_p = &storage_p[2 * LEDS_STRIP_PIXEL_BYTES * num];
+    strip_inst_p->dma_p = dma_p;
+    strip_inst_p->num = num;
+    strip_inst_p->format = (uint32_t)format;
+
+    // DMA buffer isn't initialized yet
+    strip_inst_p->dirty_first = 0;
+    strip_inst_p->dirty_last = num - 1;
+}
+
+//------------------------------------------------------------------------------
+// Get hardware interface to be passed into leds_init()
+//------------------------------------------------------------------------------
+const leds_hw_interface_t * leds_strip_get_hw_interface(const leds_strip_t * inst_p)
+{
+    assert(inst_p != NULL);
+
+    return &((const leds_strip_instance_t*)inst_p)->hw;
+}
+
+//------------------------------------------------------------------------------
+// Set color of pixel in ON state
+//------------------------------------------------------------------------------
+void leds_strip_set_color(const leds_strip_t * inst_p, uint32_t idx, uint8_t red, uint8_t green, uint8_t blue)
+{
+    assert(inst_p != NULL);
+    leds_strip_instance_t * strip_inst_p = (leds_strip_instance_t*)inst_p;
+    assert(idx < strip_inst_p->num);
+    uint8_t * color_p = &strip_inst_p->colors_p[LEDS_STRIP_PIXEL_BYTES * idx];
+
+    color_p[0] = green;
+    color_p[1] = red;
+    color_p[2] = blue;
+    leds_strip_update(strip_inst_p, idx);
+}
+
+//------------------------------------------------------------------------------
+// Encode changed pixels into DMA buffer
+//------------------------------------------------------------------------------
+uint32_t leds_strip_encode(const leds_strip_t * inst_p)
+{
+    assert(inst_p != NULL);
+    leds_strip_instance_t * strip_inst_p = (leds_strip_instance_t*)inst_p;
+
+    if (strip_inst_p->dirty_first == strip_inst_p->num) {
+        return 0;
+    }
+
+    uint32_t count = strip_inst_p->dirty_last - strip_inst_p->dirty_first + 1;
+    uint32_t offset = LEDS_STRIP_PIXEL_BYTES * strip_inst_p->dirty_first;
+    const uint8_t * src_p = &strip_inst_p->frame_p[offset];
+    uint8_t * dst_p = &strip_inst_p->dma_p[offset * strip_inst_p->format];
+
+    if (strip_inst_p->format == LEDS_STRIP_FORMAT_SPI_3BIT) {
+        leds_strip_encode_3bit(src_p, dst_p, LEDS_STRIP_PIXEL_BYTES * count);
+    }
+    else {
+        leds_strip_encode_4bit(src_p, dst_p, LEDS_STRIP_PIXEL_BYTES * count);
+    }
+
+    strip_inst_p->dirty_first = strip_inst_p->num;
+    strip_inst_p->dirty_last = 0;
+
+    return count;
+}
+
+//==================================================================================================
+//================================ PRIVATE FUNCTIONS DEFINITIONS ===================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Internal function to set pixel from its state and color, changed pixel extends dirty range
+//
+// `inst_p` - pointer to initialized driver instance
+// `idx`    - pixel number
+//------------------------------------------------------------------------------
+static void leds_strip_update(leds_strip_instance_t * inst_p, uint32_t idx)
+{
+    static const uint8_t black[LEDS_STRIP_PIXEL_BYTES] = { 0 };
+    bool is_on = ((inst_p->states_p[idx / 8] >> (idx % 8)) & 1u) != 0;
+    const uint8_t * color_p = (is_on) ? (&inst_p->colors_p[LEDS_STRIP_PIXEL_BYTES * idx]) : (black);
+    uint8_t * pixel_p = &inst_p->frame_p[LEDS_STRIP_PIXEL_BYTES * idx];
+
+    if (memcmp(pixel_p, color_p, LEDS_STRIP_PIXEL_BYTES) == 0) {
+        return;
+    }
+
+    memcpy(pixel_p, color_p, LEDS_STRIP_PIXEL_BYTES);
+    if ((inst_p->dirty_first == inst_p->num) || (idx < inst_p->dirty_first)) {
+        inst_p->dirty_first = idx;
+    }
+    if (idx > inst_p->dirty_last) {
+        inst_p->dirty_last = idx;
+    }
+}
+
+//------------------------------------------------------------------------------
+// Internal function to expand each data bit into 3 line bits
+//
+// `src_p` - pointer to data bytes
+// `dst_p` - pointer to bitstream (3 bytes per data byte)
+// `size`  - number of data bytes
+//------------------------------------------------------------------------------
+static void leds_strip_encode_3bit(const uint8_t * src_p, uint8_t * dst_p, uint32_t size)
+{
+    for (uint32_t i = 0; i < size; ++i) {
+        uint32_t code = ((uint32_t)leds_strip_lut_3bit[src_p[i] >> 4] << 12) | leds_strip_lut_3bit[src_p[i] & 0x0Fu];
+
+        dst_p[0] = (uint8_t)(code >> 16);
+        dst_p[1] = (uint8_t)(code >> 8);
+        dst_p[2] = (uint8_t)code;
+        dst_p += 3;
+    }
+}
+
+//------------------------------------------------------------------------------
+// Internal function to expand each data bit into 4 line bits
+// Vector part makes line byte k of 16 data bytes at once (data bits 7-2k and 6-2k) and interleaves them
+//
+// `src_p` - pointer to data bytes
+// `dst_p` - pointer to bitstream (4 bytes per data byte)
+// `size`  - number of data bytes
+//------------------------------------------------------------------------------
+static void leds_strip_encode_4bit(const uint8_t * src_p, uint8_t * dst_p, uint32_t size)
+{
+    uint32_t i = 0;
+
+#if defined(LEDS_STRIP_SSE2)
+    const __m128i base = _mm_set1_epi8((char)0x88);
+    const __m128i code_hi = _mm_set1_epi8(0x60);
+    const __m128i code_lo = _mm_set1_epi8(0x06);
+
+    for (; (i + 16) <= size; i += 16) {
+        __m128i data = _mm_loadu_si128((const __m128i*)&src_p[i]);
+        __m128i line[4];
+
+        for (uint32_t k = 0; k < 4; ++k) {
+            __m128i bit_hi = _mm_set1_epi8((char)(0x80u >> (2 * k)));
+            __m128i bit_lo = _mm_set1_epi8((char)(0x40u >> (2 * k)));
+            __m128i is_hi = _mm_cmpeq_epi8(_mm_and_si128(data, bit_hi), bit_hi);
+            __m128i is_lo = _mm_cmpeq_epi8(_mm_and_si128(data, bit_lo), bit_lo);
+            line[k] = _mm_or_si128(base, _mm_or_si128(_mm_and_si128(is_hi, code_hi), _mm_and_si128(is_lo, code_lo)));
+        }
+
+        __m128i pairs_01_lo = _mm_unpacklo_epi8(line[0], line[1]);
+        __m128i pairs_01_hi = _mm_unpackhi_epi8(line[0], line[1]);
+        __m128i pairs_23_lo = _mm_unpacklo_epi8(line[2], line[3]);
+        __m128i pairs_23_hi = _mm_unpackhi_epi8(line[2], line[3]);
+        _mm_storeu_si128((__m128i*)&dst_p[4 * i], _mm_unpacklo_epi16(pairs_01_lo, pairs_23_lo));
+        _mm_storeu_si128((__m128i*)&dst_p[(4 * i) + 16], _mm_unpackhi_epi16(pairs_01_lo, pairs_23_lo));
+        _mm_storeu_si128((__m128i*)&dst_p[(4 * i) + 32], _mm_unpacklo_epi16(pairs_01_hi, pairs_23_hi));
+        _mm_storeu_si128((__m128i*)&dst_p[(4 * i) + 48], _mm_unpackhi_epi16(pairs_01_hi, pairs_23_hi));
+    }
+#elif defined(LEDS_STRIP_NEON)
+    const uint8x16_t base = vdupq_n_u8(0x88);
+    const uint8x16_t code_hi = vdupq_n_u8(0x60);
+    const uint8x16_t code_lo = vdupq_n_u8(0x06);
+
+    for (; (i + 16) <= size; i += 16) {
+        uint8x16_t data = vld1q_u8(&src_p[i]);
+        uint8x16x4_t line;
+
+        for (uint32_t k = 0; k < 4; ++k) {
+            uint8x16_t is_hi = vtstq_u8(data, vdupq_n_u8((uint8_t)(0x80u >> (2 * k))));
+            uint8x16_t is_lo = vtstq_u8(data, vdupq_n_u8((uint8_t)(0x40u >> (2 * k))));
+            line.val[k] = vorrq_u8(base, vorrq_u8(vandq_u8(is_hi, code_hi), vandq_u8(is_lo, code_lo)));
+        }
+
+        vst4q_u8(&dst_p[4 * i], line);
+    }
+#endif
+
+    for (; i < size; ++i) {
+        uint16_t lut_hi = leds_strip_lut_4bit[src_p[i] >> 4];
+        uint16_t lut_lo = leds_strip_lut_4bit[src_p[i] & 0x0Fu];
+
+        dst_p[(4 * i) + 0] = (uint8_t)(lut_hi >> 8);
+        dst_p[(4 * i) + 1] = (uint8_t)lut_hi;
+        dst_p[(4 * i) + 2] = (uint8_t)(lut_lo >> 8);
+        dst_p[(4 * i) + 3] = (uint8_t)lut_lo;
+    }
+}
+
+//------------------------------------------------------------------------------
+// Internal function to switch pixel
+// Signature corresponds to leds_gpio_write_cb_t
+//
+// `hw_gpio_p` - pointer to initialized driver instance (with type leds_strip_instance_t*)
+// `pin_idx`   - pixel number
+// `pin_state` - '0' - black, otherwise - color of pixel
+//------------------------------------------------------------------------------
+static void leds_strip_gpio_write(void * hw_gpio_p, uint32_t pin_idx, uint8_t pin_state)
+{
+    leds_strip_instance_t * inst_p = (leds_strip_instance_t*)hw_gpio_p;
+    assert(pin_idx < inst_p->num);
+    uint8_t mask = (uint8_t)(1u << (pin_idx % 8));
+    uint8_t * states_p = &inst_p->states_p[pin_idx / 8];
+
+    *states_p = (pin_state != 0) ? (uint8_t)(*states_p | mask) : (uint8_t)(*states_p & ~mask);
+    leds_strip_update(inst_p, pin_idx);
+}
+
+//------------------------------------------------------------------------------
+// Internal function to toggle pixel
+// Signature corresponds to leds_gpio_toggle_cb_t
+//
+// `hw_gpio_p` - pointer to initialized driver instance (with type leds_strip_instance_t*)
+// `pin_idx`   - pixel number
+//------------------------------------------------------------------------------
+static void leds_strip_gpio_toggle(void * hw_gpio_p, uint32_t pin_idx)
+{
+    leds_strip_instance_t * inst_p = (leds_strip_instance_t*)hw_gpio_p;
+    assert(pin_idx < inst_p->num);
+
+    inst_p->states_p[pin_idx / 8] ^= (uint8_t)(1u << (pin_idx % 8));
+    leds_strip_update(inst_p, pin_idx);
+}
+
+//------------------------------------------------------------------------------
+// Internal function to switch 32 pixels of batched "port" (LEDS_PORT_PIN())
+// Signature corresponds to leds_gpio_write_port_cb_t
+//
+// `hw_gpio_p`  - pointer to initialized driver instance (with type leds_strip_instance_t*)
+// `port_idx`   - index of port
+// `set_mask`   - pixels to be switched to color
+// `clear_mask` - pixels to be switched to black
+//------------------------------------------------------------------------------
+static void leds_strip_gpio_write_port(void * hw_gpio_p, uint32_t port_idx, uint32_t set_mask, uint32_t clear_mask)
+{
+    uint32_t mask = set_mask | clear_mask;
+
+    for (uint32_t bit = 0; mask != 0; ++bit, mask >>= 1) {
+        if ((mask & 1u) != 0) {
+            leds_strip_gpio_write(hw_gpio_p, LEDS_PORT_PIN(port_idx, bit), (uint8_t)((set_mask >> bit) & 1u));
+        }
+    }
+}
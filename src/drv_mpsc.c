@@ -0,0 +1,140 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+//**************************************************************************************************
+// Lock-free bounded multi-producer single-consumer queue
+//**************************************************************************************************
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+#include <stdatomic.h>
+
+#include "drv_mpsc.h"
+
+//==================================================================================================
+//========================================== TYPEDEFS ==============================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Header of cell, item is stored right after header
+//------------------------------------------------------------------------------
+typedef struct mpsc_cell_header_s {
+    _Atomic uint32_t    seq;            // sequence number: == position - free for producer, == position + 1 - ready for consumer
+    uint32_t            align;
+} mpsc_cell_header_t;
+
+//------------------------------------------------------------------------------
+// Queue instance
+//------------------------------------------------------------------------------
+typedef struct mpsc_instance_s {
+
+    // Settings
+    uint8_t*            cells_p;        // pointer to array of cells
+    uint32_t            mask;           // number of cells - 1
+    uint32_t            item_size;      // size of item in bytes
+    uint32_t            cell_size;      // size of cell in bytes
+
+    // Producers
+    alignas(MPSC_CACHE_LINE_SIZE) _Atomic uint32_t head;   // position of the next cell to be reserved by producer
+
+    // Consumer
+    alignas(MPSC_CACHE_LINE_SIZE) uint32_t tail;           // position of the next cell to be popped by consumer
+} mpsc_instance_t;
+
+//------------------------------------------------------------------------------
+// Sanitizing
+//------------------------------------------------------------------------------
+static_assert(sizeof(mpsc_cell_header_t) == MPSC_CELL_SIZE(0), "Wrong structure size");
+static_assert(sizeof(mpsc_instance_t) == sizeof(mpsc_t), "Wrong structure size");
+
+//==================================================================================================
+//================================ PUBLIC FUNCTIONS DEFINITIONS ====================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Init queue
+//------------------------------------------------------------------------------
+void mpsc_init(mpsc_t * inst_p, void * cells_p, uint32_t num, uint32_t item_size)
+{
+    assert((inst_p != NULL) && (cells_p != NULL) && (item_size > 0));
+    assert((num > 0) && ((num & (num - 1)) == 0));
+
+    mpsc_instance_t * mpsc_inst_p = (mpsc_instance_t*)inst_p;
+
+    memset(mpsc_inst_p, 0x00, sizeof(mpsc_instance_t));
+
+    mpsc_inst_p->cells_p = (uint8_t*)cells_p;
+    mpsc_inst_p->mask = num - 1;
+    mpsc_inst_p->item_size = item_size;
+    mpsc_inst_p->cell_size = MPSC_CELL_SIZE(item_size);
+
+    for (uint32_t pos = 0; pos < num; ++pos) {
+        mpsc_cell_header_t * cell_p = (mpsc_cell_header_t*)(mpsc_inst_p->cells_p + (pos * mpsc_inst_p->cell_size));
+        atomic_init(&cell_p->seq, pos);
+    }
+
+    atomic_init(&mpsc_inst_p->head, 0);
+}
+
+//------------------------------------------------------------------------------
+// Push copy of item into queue
+//------------------------------------------------------------------------------
+bool mpsc_push(const mpsc_t * inst_p, const void * item_p)
+{
+    assert((inst_p != NULL) && (item_p != NULL));
+    mpsc_instance_t * mpsc_inst_p = (mpsc_instance_t*)inst_p;
+
+    uint32_t pos = atomic_load_explicit(&mpsc_inst_p->head, memory_order_relaxed);
+    mpsc_cell_header_t * cell_p;
+
+    // Reserve cell
+    for (;;) {
+        cell_p = (mpsc_cell_header_t*)(mpsc_inst_p->cells_p + ((pos & mpsc_inst_p->mask) * mpsc_inst_p->cell_size));
+        uint32_t seq = atomic_load_explicit(&cell_p->seq, memory_order_acquire);
+        int32_t diff = (int32_t)(seq - pos);
+
+        if (diff == 0) {
+            // Cell is free - try to take it, `pos` is reloaded on failure
+            if (atomic_compare_exchange_weak_explicit(&mpsc_inst_p->head, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // Cell is still occupied by item of the previous lap
+            return false;
+        } else {
+            // Cell is taken by another producer
+            pos = atomic_load_explicit(&mpsc_inst_p->head, memory_order_relaxed);
+        }
+    }
+
+    // Fill cell and pass it to consumer
+    memcpy(cell_p + 1, item_p, mpsc_inst_p->item_size);
+    atomic_store_explicit(&cell_p->seq, pos + 1, memory_order_release);
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+// Pop the oldest item from queue
+//------------------------------------------------------------------------------
+bool mpsc_pop(const mpsc_t * inst_p, void * item_out_p)
+{
+    assert((inst_p != NULL) && (item_out_p != NULL));
+    mpsc_instance_t * mpsc_inst_p = (mpsc_instance_t*)inst_p;
+
+    uint32_t pos = mpsc_inst_p->tail;
+    mpsc_cell_header_t * cell_p = (mpsc_cell_header_t*)(mpsc_inst_p->cells_p + ((pos & mpsc_inst_p->mask) * mpsc_inst_p->cell_size));
+
+    // If cell isn't filled yet
+    if (atomic_load_explicit(&cell_p->seq, memory_order_acquire) != (pos + 1)) {
+        return false;
+    }
+
+    // Copy item and pass cell to producers of the next lap
+    memcpy(item_out_p, cell_p + 1, mpsc_inst_p->item_size);
+    atomic_store_explicit(&cell_p->seq, pos + mpsc_inst_p->mask + 1, memory_order_release);
+    mpsc_inst_p->tail = pos + 1;
+
+    return true;
+}
@@ -0,0 +1,133 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+//**************************************************************************************************
+// Cycle-count profiling statistics
+//**************************************************************************************************
+#include <stddef.h>
+#include <assert.h>
+
+#include "drv_prof.h"
+
+//==================================================================================================
+//================================ PRIVATE FUNCTIONS DECLARATIONS ==================================
+//==================================================================================================
+
+static void prof_stats_clear(prof_stats_t * stats_p);
+
+//==================================================================================================
+//================================ PUBLIC FUNCTIONS DEFINITIONS ====================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Add measurement
+//------------------------------------------------------------------------------
+void prof_stats_add(prof_stats_t * stats_p, uint32_t cycles)
+{
+    assert(stats_p != NULL);
+
+    // Odd sequence - reader repeats copying
+    stats_p->seq++;
+
+    if (stats_p->is_reset_pending) {
+        prof_stats_clear(stats_p);
+        stats_p->is_reset_pending = false;
+    }
+
+    if ((stats_p->count == 0) || (cycles < stats_p->min)) {
+        stats_p->min = cycles;
+    }
+    if (cycles > stats_p->max) {
+        stats_p->max = cycles;
+    }
+    stats_p->count++;
+    stats_p->sum += cycles;
+    stats_p->hist[prof_hist_bucket(cycles)]++;
+
+    stats_p->seq++;
+}
+
+//------------------------------------------------------------------------------
+// Get consistent snapshot of statistics
+//------------------------------------------------------------------------------
+void prof_stats_read(const prof_stats_t * stats_p, prof_stats_t * snapshot_p)
+{
+    assert((stats_p != NULL) && (snapshot_p != NULL));
+    uint32_t seq;
+
+    do {
+        seq = stats_p->seq;
+
+        snapshot_p->count = stats_p->count;
+        snapshot_p->min = stats_p->min;
+        snapshot_p->max = stats_p->max;
+        snapshot_p->sum = stats_p->sum;
+        for (size_t i = 0; i < PROF_HIST_SIZE; ++i) {
+            snapshot_p->hist[i] = stats_p->hist[i];
+        }
+    } while (((seq & 1u) != 0) || (seq != stats_p->seq));
+
+    snapshot_p->seq = seq;
+    snapshot_p->is_reset_pending = false;
+
+    // Statistics are already cleared for the reader
+    if (stats_p->is_reset_pending) {
+        prof_stats_clear(snapshot_p);
+    }
+}
+
+//------------------------------------------------------------------------------
+// Clear statistics
+//------------------------------------------------------------------------------
+void prof_stats_reset(prof_stats_t * stats_p)
+{
+    assert(stats_p != NULL);
+
+    stats_p->is_reset_pending = true;
+}
+
+//------------------------------------------------------------------------------
+// Get mean duration
+//------------------------------------------------------------------------------
+uint32_t prof_stats_mean(const prof_stats_t * snapshot_p)
+{
+    assert(snapshot_p != NULL);
+
+    return (snapshot_p->count != 0) ? ((uint32_t)(snapshot_p->sum / snapshot_p->count)) : (0);
+}
+
+//------------------------------------------------------------------------------
+// Get index of histogram bucket for duration
+//------------------------------------------------------------------------------
+uint32_t prof_hist_bucket(uint32_t cycles)
+{
+    uint32_t bucket = 0;
+
+    // Number of significant bits
+    while ((cycles != 0) && (bucket < (PROF_HIST_SIZE - 1))) {
+        cycles >>= 1;
+        bucket++;
+    }
+
+    return bucket;
+}
+
+//==================================================================================================
+//================================ PRIVATE FUNCTIONS DEFINITIONS ===================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Clear all measurements (sequence counter and reset request are kept)
+//
+// `stats_p` - pointer to statistics
+//------------------------------------------------------------------------------
+static void prof_stats_clear(prof_stats_t * stats_p)
+{
+    stats_p->count = 0;
+    stats_p->min = 0;
+    stats_p->max = 0;
+    stats_p->sum = 0;
+    for (size_t i = 0; i < PROF_HIST_SIZE; ++i) {
+        stats_p->hist[i] = 0;
+    }
+}
@@ -0,0 +1,185 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+//**************************************************************************************************
+// Protothreads - stackless cooperative coroutines based on software timers
+//**************************************************************************************************
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+
+#include "drv_pt.h"
+
+//==================================================================================================
+//================================ PRIVATE FUNCTIONS DECLARATIONS ==================================
+//==================================================================================================
+
+static void pt_run(pt_t * pt_p);
+static void pt_timer_handler(uint32_t timer_idx, void * pt_p, void * arg_p);
+
+//==================================================================================================
+//================================ PUBLIC FUNCTIONS DEFINITIONS ====================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Init protothread
+//------------------------------------------------------------------------------
+void pt_init(pt_t * pt_p, const swtimers_t * swtimers_p, uint32_t timer_idx, pt_func_t func, void * arg_p)
+{
+    assert((pt_p != NULL) && (swtimers_p != NULL) && (func != NULL));
+
+    memset(pt_p, 0x00, sizeof(pt_t));
+
+    pt_p->func = func;
+    pt_p->arg_p = arg_p;
+    pt_p->swtimers_p = swtimers_p;
+    pt_p->timer_idx = timer_idx;
+    pt_p->is_exited = true;
+
+    // Bind handler once, waits only re-arm the threshold
+    swtimers_start(swtimers_p, timer_idx, 0, SWTIMERS_MODE_SINGLE_FROM_LOOP, &pt_timer_handler, pt_p, NULL);
+    swtimers_stop(swtimers_p, timer_idx);
+}
+
+//------------------------------------------------------------------------------
+// Start protothread from the beginning
+//------------------------------------------------------------------------------
+void pt_start(pt_t * pt_p)
+{
+    assert((pt_p != NULL) && (pt_p->func != NULL));
+
+    swtimers_stop(pt_p->swtimers_p, pt_p->timer_idx);
+
+    pt_p->lc = 0;
+    pt_p->wait = PT_WAIT_NONE;
+    pt_p->is_exited = false;
+    pt_p->button_event = BUTTONS_NO_EVENT;
+
+    pt_run(pt_p);
+}
+
+//------------------------------------------------------------------------------
+// Stop protothread
+//------------------------------------------------------------------------------
+void pt_stop(pt_t * pt_p)
+{
+    assert(pt_p != NULL);
+
+    swtimers_stop(pt_p->swtimers_p, pt_p->timer_idx);
+
+    pt_p->lc = 0;
+    pt_p->wait = PT_WAIT_NONE;
+    pt_p->is_exited = true;
+}
+
+//------------------------------------------------------------------------------
+// Check if protothread is finished or stopped
+//------------------------------------------------------------------------------
+bool pt_is_exited(const pt_t * pt_p)
+{
+    assert(pt_p != NULL);
+
+    return pt_p->is_exited;
+}
+
+//------------------------------------------------------------------------------
+// Get the last button event received by PT_AWAIT_BUTTON()
+//------------------------------------------------------------------------------
+buttons_event_t pt_get_button_event(const pt_t * pt_p, uint32_t * button_idx_out_p)
+{
+    assert(pt_p != NULL);
+
+    if (button_idx_out_p != NULL) {
+        *button_idx_out_p = pt_p->button_idx;
+    }
+
+    return (buttons_event_t)pt_p->button_event;
+}
+
+//------------------------------------------------------------------------------
+// Handler of button events to resume protothread waiting in PT_AWAIT_BUTTON()
+//------------------------------------------------------------------------------
+void pt_buttons_handler(uint32_t button_idx, buttons_event_t event, void * arg_p)
+{
+    assert(arg_p != NULL);
+    pt_t * pt_p = (pt_t*)arg_p;
+
+    // If protothread doesn't wait for this event
+    if ((pt_p->wait != PT_WAIT_BUTTON) || ((event & pt_p->button_mask) == 0)) {
+        return;
+    }
+
+    pt_p->wait = PT_WAIT_NONE;
+    pt_p->button_event = (uint8_t)event;
+    pt_p->button_idx = (uint16_t)button_idx;
+
+    pt_run(pt_p);
+}
+
+//------------------------------------------------------------------------------
+// Re-arm timer to resume protothread after timeout (used by macros)
+//------------------------------------------------------------------------------
+void pt_wait_ms(pt_t * pt_p, uint32_t ms)
+{
+    assert(pt_p != NULL);
+
+    pt_p->wait = PT_WAIT_TIMER;
+    swtimers_restart(pt_p->swtimers_p, pt_p->timer_idx, ms);
+}
+
+//------------------------------------------------------------------------------
+// Set protothread waiting for button event (used by macros)
+//------------------------------------------------------------------------------
+void pt_wait_button(pt_t * pt_p, buttons_event_t event)
+{
+    assert((pt_p != NULL) && (event != BUTTONS_NO_EVENT));
+
+    pt_p->wait = PT_WAIT_BUTTON;
+    pt_p->button_mask = (uint8_t)event;
+    pt_p->button_event = BUTTONS_NO_EVENT;
+}
+
+//==================================================================================================
+//================================ PRIVATE FUNCTIONS DEFINITIONS ===================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Call protothread function until the next wait
+//
+// `pt_p` - pointer to initialized protothread instance
+//------------------------------------------------------------------------------
+static void pt_run(pt_t * pt_p)
+{
+    if (pt_p->is_exited) {
+        return;
+    }
+
+    if (pt_p->func(pt_p, pt_p->arg_p) == PT_STATE_EXITED) {
+        pt_p->wait = PT_WAIT_NONE;
+        pt_p->is_exited = true;
+    }
+}
+
+//------------------------------------------------------------------------------
+// Internal handler to resume protothread after timeout
+// Signature corresponds to swtimers_handler_cb_t
+//
+// `timer_idx`  - timer index
+// `pt_p`       - pointer to protothread instance (with type pt_t*)
+// `arg_p`      - not used
+//------------------------------------------------------------------------------
+static void pt_timer_handler(uint32_t timer_idx, void * pt_p, void * arg_p)
+{
+    assert(pt_p != NULL);
+    pt_t * pt_inst_p = (pt_t*)pt_p;
+    (void)timer_idx;
+    (void)arg_p;
+
+    // If protothread doesn't wait for timeout (stopped or restarted)
+    if (pt_inst_p->wait != PT_WAIT_TIMER) {
+        return;
+    }
+
+    pt_inst_p->wait = PT_WAIT_NONE;
+    pt_run(pt_inst_p);
+}
@@ -36,7 +36,7 @@ typedef struct swtimers_timer_instance_s {
     uint32_t        threshold;      // threshold for counter
     void*           arg_1_p;        // pointer to application data to be passed into handler (can be NULL)
     void*           arg_2_p;        // pointer to application data to be passed into handler (can be NULL)
-    swtimers_mode_t mode;           // single shot or periodic mode
+    uint8_t         mode;           // single shot or periodic mode (swtimers_mode_t)
     bool            is_simple;      // 'true' - if simple_cb should be called
 
     // State
@@ -53,6 +53,29 @@ typedef struct swtimers_instance_s {
     const swtimers_hw_interface_t*      hw_p;              // pointer to hardware timer interface
     volatile swtimers_timer_instance_t* timers_table_p;    // pointer to array of timers
     uint32_t                            num;               // number of timers
+    volatile uint32_t                   next_expiry;       // ticks until the nearest expiration (lower bound), updated in ISR and on start
+    volatile bool                       is_loop_pending;   // 'true' - if at least one handler is waiting to be called from swtimers_task
+    uint8_t                             align[3];
+    volatile uint32_t                   ticks;             // ticks passed into swtimers_isr_ticks() (wraps around)
+    volatile uint32_t                   started_cnt;       // number of timer starts (updated in critical section)
+    volatile uint32_t                   expired_cnt;       // number of expirations (updated in ISR)
+    volatile uint32_t                   isr_calls_cnt;     // number of handlers calls from ISR (updated in ISR)
+    volatile uint32_t                   loop_calls_cnt;    // number of handlers calls from application loop (updated in loop)
+    volatile uint32_t                   overruns_cnt;      // number of expirations while the previous handler call is still waiting (updated in ISR)
+    volatile uint32_t                   idle_isr_cnt;      // number of ISR calls without expirations (updated in ISR)
+    volatile uint32_t                   peak_active;       // maximal number of running timers seen in ISR (updated in ISR)
+    volatile uint32_t                   over_budget_cnt;   // number of handler calls from ISR over budget (updated in ISR)
+    const workqueue_t*                  workqueue_p;       // pointer to attached work queue driver instance (can be NULL)
+    swtimers_task_hook_cb_t             task_hook_cb;      // hook at the end of swtimers_task() (can be NULL)
+    void*                               task_hook_arg_p;   // argument of hook
+    swtimers_lateness_t*                lateness_p;        // pointer to attached array of lateness statistics (can be NULL)
+    const swtimers_watchdog_t*          watchdog_p;        // pointer to attached budgets of handlers called from ISR (can be NULL)
+#if (DRV_PROF == 1)
+    swtimers_prof_t*                    prof_p;            // pointer to attached profiling statistics (can be NULL)
+#endif
+#if (DRV_TRACE == 1)
+    const trace_t*                      trace_p;           // pointer to attached trace (can be NULL)
+#endif
 } swtimers_instance_t;
 
 //------------------------------------------------------------------------------
@@ -70,6 +93,14 @@ static void swtimers_stop_hw_timer(const swtimers_t * inst_p);
 static void swtimers_do_start(const swtimers_t * inst_p, uint32_t idx, uint32_t ms, swtimers_mode_t mode,
                               bool is_simple, swtimers_handler_cb_t handler_cb, swtimers_handler_simple_cb_t handler_simple_cb,
                               void * arg_1_p, void * arg_2_p);
+static uint32_t swtimers_ticks_left(uint32_t threshold, uint32_t counter);
+static void swtimers_call_handler(const swtimers_instance_t * swtimers_inst_p, volatile swtimers_timer_instance_t * swtimer_p, uint32_t idx);
+static void swtimers_call_isr_handler(swtimers_instance_t * swtimers_inst_p, volatile swtimers_timer_instance_t * swtimer_p, uint32_t idx);
+static void swtimers_lateness_update(swtimers_lateness_t * lateness_p, uint32_t tick, bool is_periodic);
+#if (DRV_PROF == 1)
+static uint32_t swtimers_prof_begin(const swtimers_instance_t * swtimers_inst_p);
+static void swtimers_prof_end(const swtimers_instance_t * swtimers_inst_p, prof_stats_t * stats_p, uint32_t start);
+#endif
 
 //==================================================================================================
 //==================================== PRIVATE STATIC DATA =========================================
@@ -102,6 +133,7 @@ void swtimers_init(swtimers_t * inst_p, const swtimers_hw_interface_t * hw_inter
     swtimers_inst_p->hw_p = hw_interface_p;
     swtimers_inst_p->timers_table_p = (volatile swtimers_timer_instance_t*)timers_table_p;
     swtimers_inst_p->num = num;
+    swtimers_inst_p->next_expiry = SWTIMERS_NO_EXPIRY;
 
     memset((swtimers_timer_instance_t*)swtimers_inst_p->timers_table_p, 0x00, num * sizeof(swtimers_timer_instance_t));
 
@@ -154,6 +186,44 @@ void swtimers_start_no_handler(const swtimers_t * inst_p, uint32_t idx, uint32_t
     swtimers_do_start(inst_p, idx, ms, SWTIMERS_MODE_SINGLE_FROM_LOOP, true, NULL, NULL, NULL, NULL);
 }
 
+//------------------------------------------------------------------------------
+// Restart timer with new threshold, keeping handler, mode and arguments
+//------------------------------------------------------------------------------
+void swtimers_restart(const swtimers_t * inst_p, uint32_t idx, uint32_t ms)
+{
+    assert(inst_p != NULL);
+    swtimers_instance_t * swtimers_inst_p = (swtimers_instance_t*)inst_p;
+    assert(idx < swtimers_inst_p->num);
+    volatile swtimers_timer_instance_t * swtimer_p = &(swtimers_inst_p->timers_table_p[idx]);
+    const swtimers_hw_interface_t * hw_p = swtimers_inst_p->hw_p;
+
+    // The first period after start isn't measured
+    if (swtimers_inst_p->lateness_p != NULL) {
+        swtimers_inst_p->lateness_p[idx].is_called = false;
+    }
+
+    uint32_t threshold = ms / hw_p->tick_ms;
+    uint32_t ticks_left = swtimers_ticks_left(threshold, 0);
+
+    // Critical section - re-arm timer
+    hw_p->isr_disable_cb(hw_p->hw_timer_p);
+    swtimer_p->threshold = threshold;
+    swtimer_p->counter = 0;
+    swtimer_p->is_waiting = false;
+    swtimer_p->is_run = true;
+    swtimers_inst_p->started_cnt++;
+    if (ticks_left < swtimers_inst_p->next_expiry) {
+        swtimers_inst_p->next_expiry = ticks_left;
+    }
+    hw_p->isr_enable_cb(hw_p->hw_timer_p);
+
+#if (DRV_TRACE == 1)
+    trace_record(swtimers_inst_p->trace_p, TRACE_EVT_SWTIMERS_START, idx, swtimer_p->mode, ms);
+#endif
+
+    swtimers_start_hw_timer(inst_p);
+}
+
 //------------------------------------------------------------------------------
 // Stop timer
 //------------------------------------------------------------------------------
@@ -167,11 +237,20 @@ void swtimers_stop(const swtimers_t * inst_p, uint32_t idx)
 
     // Critical section - stop timer
     hw_p->isr_disable_cb(hw_p->hw_timer_p);
+#if (DRV_TRACE == 1)
+    bool is_active = swtimer_p->is_run || swtimer_p->is_waiting;
+#endif
     swtimer_p->is_run = false;
     swtimer_p->is_waiting = false;
     swtimer_p->counter = 0;
     hw_p->isr_enable_cb(hw_p->hw_timer_p);
 
+#if (DRV_TRACE == 1)
+    if (is_active) {
+        trace_record(swtimers_inst_p->trace_p, TRACE_EVT_SWTIMERS_STOP, idx, 0, 0);
+    }
+#endif
+
     swtimers_stop_hw_timer(inst_p);
 }
 
@@ -210,26 +289,216 @@ bool swtimers_is_run(const swtimers_t * inst_p, uint32_t idx, uint32_t * time_ms
     hw_p->isr_enable_cb(hw_p->hw_timer_p);
 
     // If timer is run OR if timer is stopped but hash't been processed yet
-    if (is_run || is_waiting) {
-    	*time_ms_out_p = (counter * hw_p->tick_ms);
-        return true;
+    bool result = (is_run || is_waiting);
+
+    if (time_ms_out_p != NULL) {
+        *time_ms_out_p = (result) ? (counter * hw_p->tick_ms) : (0);
     }
-    else {
-    	*time_ms_out_p = 0;
-    	return false;
+
+    return result;
+}
+
+//------------------------------------------------------------------------------
+// Get number of ticks until the nearest timer expiration
+//------------------------------------------------------------------------------
+uint32_t swtimers_next_expiry_ticks(const swtimers_t * inst_p)
+{
+    assert(inst_p != NULL);
+    const swtimers_instance_t * swtimers_inst_p = (const swtimers_instance_t*)inst_p;
+    const swtimers_hw_interface_t * hw_p = swtimers_inst_p->hw_p;
+
+    // Critical section - get state
+    hw_p->isr_disable_cb(hw_p->hw_timer_p);
+    bool is_loop_pending = swtimers_inst_p->is_loop_pending;
+    uint32_t next_expiry = swtimers_inst_p->next_expiry;
+    hw_p->isr_enable_cb(hw_p->hw_timer_p);
+
+    if ((swtimers_inst_p->workqueue_p != NULL) && (workqueue_is_empty(swtimers_inst_p->workqueue_p) == false)) {
+        return 0;
+    }
+
+    return (is_loop_pending) ? (0) : (next_expiry);
+}
+
+//------------------------------------------------------------------------------
+// Get time base of the driver
+//------------------------------------------------------------------------------
+uint32_t swtimers_get_time_ms(const swtimers_t * inst_p)
+{
+    assert(inst_p != NULL);
+    const swtimers_instance_t * swtimers_inst_p = (const swtimers_instance_t*)inst_p;
+    const swtimers_hw_interface_t * hw_p = swtimers_inst_p->hw_p;
+
+    // Critical section - get state
+    hw_p->isr_disable_cb(hw_p->hw_timer_p);
+    uint32_t ticks = swtimers_inst_p->ticks;
+    hw_p->isr_enable_cb(hw_p->hw_timer_p);
+
+    return ticks * hw_p->tick_ms;
+}
+
+//------------------------------------------------------------------------------
+// Get duration of one tick of hardware timer
+//------------------------------------------------------------------------------
+uint32_t swtimers_get_tick_ms(const swtimers_t * inst_p)
+{
+    assert(inst_p != NULL);
+    const swtimers_instance_t * swtimers_inst_p = (const swtimers_instance_t*)inst_p;
+
+    return swtimers_inst_p->hw_p->tick_ms;
+}
+
+//------------------------------------------------------------------------------
+// Attach work queue to be processed inside swtimers_task()
+//------------------------------------------------------------------------------
+void swtimers_set_workqueue(const swtimers_t * inst_p, const workqueue_t * workqueue_p)
+{
+    assert(inst_p != NULL);
+    swtimers_instance_t * swtimers_inst_p = (swtimers_instance_t*)inst_p;
+
+    swtimers_inst_p->workqueue_p = workqueue_p;
+}
+
+//------------------------------------------------------------------------------
+// Attach hook to be called at the end of swtimers_task()
+//------------------------------------------------------------------------------
+void swtimers_set_task_hook(const swtimers_t * inst_p, swtimers_task_hook_cb_t hook_cb, void * arg_p)
+{
+    assert(inst_p != NULL);
+    swtimers_instance_t * swtimers_inst_p = (swtimers_instance_t*)inst_p;
+
+    swtimers_inst_p->task_hook_cb = hook_cb;
+    swtimers_inst_p->task_hook_arg_p = arg_p;
+}
+
+//------------------------------------------------------------------------------
+// Attach array of lateness statistics
+//------------------------------------------------------------------------------
+void swtimers_set_lateness(const swtimers_t * inst_p, swtimers_lateness_t * lateness_p)
+{
+    assert(inst_p != NULL);
+    swtimers_instance_t * swtimers_inst_p = (swtimers_instance_t*)inst_p;
+    const swtimers_hw_interface_t * hw_p = swtimers_inst_p->hw_p;
+
+    // Critical section - ISR stores expiration ticks into the array
+    hw_p->isr_disable_cb(hw_p->hw_timer_p);
+    swtimers_inst_p->lateness_p = lateness_p;
+    hw_p->isr_enable_cb(hw_p->hw_timer_p);
+}
+
+//------------------------------------------------------------------------------
+// Get lateness statistics of the timer
+//------------------------------------------------------------------------------
+void swtimers_get_lateness(const swtimers_t * inst_p, uint32_t idx, swtimers_lateness_t * lateness_out_p)
+{
+    assert((inst_p != NULL) && (lateness_out_p != NULL));
+    const swtimers_instance_t * swtimers_inst_p = (const swtimers_instance_t*)inst_p;
+    assert((swtimers_inst_p->lateness_p != NULL) && (idx < swtimers_inst_p->num));
+    const swtimers_hw_interface_t * hw_p = swtimers_inst_p->hw_p;
+
+    // Critical section - statistics of handlers called from ISR are updated in ISR
+    hw_p->isr_disable_cb(hw_p->hw_timer_p);
+    *lateness_out_p = swtimers_inst_p->lateness_p[idx];
+    hw_p->isr_enable_cb(hw_p->hw_timer_p);
+}
+
+//------------------------------------------------------------------------------
+// Get counters of driver activity
+//------------------------------------------------------------------------------
+void swtimers_get_stats(const swtimers_t * inst_p, swtimers_stats_t * stats_out_p, bool is_reset)
+{
+    assert((inst_p != NULL) && (stats_out_p != NULL));
+    swtimers_instance_t * swtimers_inst_p = (swtimers_instance_t*)inst_p;
+    const swtimers_hw_interface_t * hw_p = swtimers_inst_p->hw_p;
+
+    // Critical section - counters are updated in ISR
+    hw_p->isr_disable_cb(hw_p->hw_timer_p);
+    stats_out_p->started = swtimers_inst_p->started_cnt;
+    stats_out_p->expired = swtimers_inst_p->expired_cnt;
+    stats_out_p->dispatched = swtimers_inst_p->isr_calls_cnt + swtimers_inst_p->loop_calls_cnt;
+    stats_out_p->overruns = swtimers_inst_p->overruns_cnt;
+    stats_out_p->idle_isr = swtimers_inst_p->idle_isr_cnt;
+    stats_out_p->peak_active = swtimers_inst_p->peak_active;
+    stats_out_p->over_budget = swtimers_inst_p->over_budget_cnt;
+    if (is_reset) {
+        swtimers_inst_p->started_cnt = 0;
+        swtimers_inst_p->expired_cnt = 0;
+        swtimers_inst_p->isr_calls_cnt = 0;
+        swtimers_inst_p->loop_calls_cnt = 0;
+        swtimers_inst_p->overruns_cnt = 0;
+        swtimers_inst_p->idle_isr_cnt = 0;
+        swtimers_inst_p->peak_active = 0;
+        swtimers_inst_p->over_budget_cnt = 0;
     }
+    hw_p->isr_enable_cb(hw_p->hw_timer_p);
 }
 
+//------------------------------------------------------------------------------
+// Attach budgets of handlers called from ISR
+//------------------------------------------------------------------------------
+void swtimers_set_watchdog(const swtimers_t * inst_p, const swtimers_watchdog_t * watchdog_p)
+{
+    assert(inst_p != NULL);
+    assert((watchdog_p == NULL) || ((watchdog_p->cycles_cb != NULL) && (watchdog_p->budgets_p != NULL)));
+    swtimers_instance_t * swtimers_inst_p = (swtimers_instance_t*)inst_p;
+    const swtimers_hw_interface_t * hw_p = swtimers_inst_p->hw_p;
+
+    // Critical section - budgets are used in ISR
+    hw_p->isr_disable_cb(hw_p->hw_timer_p);
+    swtimers_inst_p->watchdog_p = watchdog_p;
+    hw_p->isr_enable_cb(hw_p->hw_timer_p);
+}
+
+#if (DRV_TRACE == 1)
+//------------------------------------------------------------------------------
+// Attach trace
+//------------------------------------------------------------------------------
+void swtimers_set_trace(const swtimers_t * inst_p, const trace_t * trace_p)
+{
+    assert(inst_p != NULL);
+    swtimers_instance_t * swtimers_inst_p = (swtimers_instance_t*)inst_p;
+
+    swtimers_inst_p->trace_p = trace_p;
+}
+#endif
+
+#if (DRV_PROF == 1)
+//------------------------------------------------------------------------------
+// Attach profiling statistics
+//------------------------------------------------------------------------------
+void swtimers_set_prof(const swtimers_t * inst_p, swtimers_prof_t * prof_p)
+{
+    assert(inst_p != NULL);
+    assert((prof_p == NULL) || (prof_p->cycles_cb != NULL));
+    swtimers_instance_t * swtimers_inst_p = (swtimers_instance_t*)inst_p;
+
+    swtimers_inst_p->prof_p = prof_p;
+}
+#endif
+
 //------------------------------------------------------------------------------
 // Check all timers and call handlers if necessary
 //------------------------------------------------------------------------------
 void swtimers_task(const swtimers_t * inst_p)
 {
     assert(inst_p != NULL);
-    const swtimers_instance_t * swtimers_inst_p = (const swtimers_instance_t*)inst_p;
+    swtimers_instance_t * swtimers_inst_p = (swtimers_instance_t*)inst_p;
     assert(swtimers_inst_p->num != 0);
     volatile swtimers_timer_instance_t * swtimer_p;
     const swtimers_hw_interface_t * hw_p = swtimers_inst_p->hw_p;
+#if (DRV_PROF == 1)
+    uint32_t prof_start = swtimers_prof_begin(swtimers_inst_p);
+#endif
+
+    // Critical section - handlers set as waiting after this point will raise the flag again
+    hw_p->isr_disable_cb(hw_p->hw_timer_p);
+    swtimers_inst_p->is_loop_pending = false;
+    hw_p->isr_enable_cb(hw_p->hw_timer_p);
+
+    // Process deferred work items
+    if (swtimers_inst_p->workqueue_p != NULL) {
+        workqueue_task(swtimers_inst_p->workqueue_p);
+    }
 
     for (size_t i = 0; i < swtimers_inst_p->num; ++i) {
         swtimer_p = &(swtimers_inst_p->timers_table_p[i]);
@@ -240,13 +509,8 @@ void swtimers_task(const swtimers_t * inst_p)
         hw_p->isr_enable_cb(hw_p->hw_timer_p);
 
         if (is_waiting) {
-            // Call handler
-            if ((swtimer_p->is_simple == true) && (swtimer_p->handler.simple_cb != NULL)) {
-                (swtimer_p->handler.simple_cb)();
-            }
-            else if ((swtimer_p->is_simple == false) && (swtimer_p->handler.full_cb != NULL)) {
-                (swtimer_p->handler.full_cb)(i, swtimer_p->arg_1_p, swtimer_p->arg_2_p);
-            }
+            swtimers_call_handler(swtimers_inst_p, swtimer_p, i);
+            swtimers_inst_p->loop_calls_cnt++;
 
             // Critical section - set state
             hw_p->isr_disable_cb(hw_p->hw_timer_p);
@@ -255,7 +519,17 @@ void swtimers_task(const swtimers_t * inst_p)
         }
     }
 
+    if (swtimers_inst_p->task_hook_cb != NULL) {
+        swtimers_inst_p->task_hook_cb(swtimers_inst_p->task_hook_arg_p);
+    }
+
     swtimers_stop_hw_timer(inst_p);
+
+#if (DRV_PROF == 1)
+    if (swtimers_inst_p->prof_p != NULL) {
+        swtimers_prof_end(swtimers_inst_p, &swtimers_inst_p->prof_p->task, prof_start);
+    }
+#endif
 }
 
 //------------------------------------------------------------------------------
@@ -263,7 +537,26 @@ void swtimers_task(const swtimers_t * inst_p)
 //------------------------------------------------------------------------------
 void swtimers_isr(const swtimers_t * inst_p)
 {
-    const swtimers_instance_t * swtimers_inst_p = (const swtimers_instance_t*)inst_p;
+    swtimers_isr_ticks(inst_p, 1);
+}
+
+//------------------------------------------------------------------------------
+// ISR handler for hardware timer interrupt after several ticks
+//------------------------------------------------------------------------------
+void swtimers_isr_ticks(const swtimers_t * inst_p, uint32_t ticks)
+{
+    assert(ticks > 0);
+    swtimers_instance_t * swtimers_inst_p = (swtimers_instance_t*)inst_p;
+    uint32_t next_expiry = SWTIMERS_NO_EXPIRY;
+    uint32_t active_num = 0;
+    uint32_t expired_num = 0;
+#if (DRV_PROF == 1)
+    uint32_t prof_start = swtimers_prof_begin(swtimers_inst_p);
+#endif
+
+    // Timers started from ISR handlers decrease this value, the rest is calculated during the scan
+    swtimers_inst_p->next_expiry = SWTIMERS_NO_EXPIRY;
+    swtimers_inst_p->ticks += ticks;
 
     for (size_t i = 0; i < swtimers_inst_p->num; ++i) {
     	volatile swtimers_timer_instance_t * swtimer_p = &(swtimers_inst_p->timers_table_p[i]);
@@ -271,10 +564,21 @@ void swtimers_isr(const swtimers_t * inst_p)
         if (swtimer_p->is_run == false) {
             continue;
         }
+        active_num++;
 
-        swtimer_p->counter++;
+        // Ticks after expiration (counter can't exceed threshold, so there is no overflow)
+        uint32_t overshoot = 0;
+        if ((swtimer_p->counter < swtimer_p->threshold) && (ticks < (swtimer_p->threshold - swtimer_p->counter))) {
+            swtimer_p->counter += ticks;
+        }
+        else {
+            overshoot = ticks - (swtimer_p->threshold - swtimer_p->counter);
+            swtimer_p->counter = swtimer_p->threshold;
+        }
 
         if (swtimer_p->counter < swtimer_p->threshold) {
+            uint32_t ticks_left = swtimers_ticks_left(swtimer_p->threshold, swtimer_p->counter);
+            next_expiry = (ticks_left < next_expiry) ? (ticks_left) : (next_expiry);
             continue;
         }
 
@@ -283,25 +587,60 @@ void swtimers_isr(const swtimers_t * inst_p)
             swtimer_p->is_run = false;
         }
         else {
-            // Drop periodical counter
-            swtimer_p->counter = 0;
+            // Drop periodical counter, keep phase if several periods are passed (missed expirations are merged)
+            swtimer_p->counter = (swtimer_p->threshold != 0) ? (overshoot % swtimer_p->threshold) : (0);
+
+            uint32_t ticks_left = swtimers_ticks_left(swtimer_p->threshold, swtimer_p->counter);
+            next_expiry = (ticks_left < next_expiry) ? (ticks_left) : (next_expiry);
         }
 
+        expired_num++;
+#if (DRV_TRACE == 1)
+        trace_record(swtimers_inst_p->trace_p, TRACE_EVT_SWTIMERS_EXPIRE, i, 0, 0);
+#endif
+
         // If handler exists - call handler from ISR context or set flag to call handler from application context
         if ((swtimer_p->handler.full_cb != NULL) || (swtimer_p->handler.simple_cb != NULL)) {
+            // Lateness is measured from the first expiration (if the previous one is still waiting - expirations are merged)
+            if ((swtimers_inst_p->lateness_p != NULL) && (swtimer_p->is_waiting == false)) {
+                swtimers_inst_p->lateness_p[i].expiry_tick = swtimers_inst_p->ticks - overshoot;
+            }
             if ((swtimer_p->mode == SWTIMERS_MODE_SINGLE_FROM_ISR) || (swtimer_p->mode == SWTIMERS_MODE_PERIODIC_FROM_ISR)) {
-                if (swtimer_p->is_simple) {
-                    (swtimer_p->handler.simple_cb)();
-                }
-                else {
-                    (swtimer_p->handler.full_cb)(i, swtimer_p->arg_1_p, swtimer_p->arg_2_p);
-                }
+                swtimers_call_isr_handler(swtimers_inst_p, swtimer_p, i);
+                swtimers_inst_p->isr_calls_cnt++;
             }
             else {
+                // Previous expiration is still waiting for the handler call
+                if (swtimer_p->is_waiting) {
+                    swtimers_inst_p->overruns_cnt++;
+                }
                 swtimer_p->is_waiting = true;
+                swtimers_inst_p->is_loop_pending = true;
             }
         }
+        // Expiration of timer without handler is polled by application loop (swtimers_is_run()) - loop must not sleep
+        else if ((swtimer_p->mode == SWTIMERS_MODE_SINGLE_FROM_LOOP) || (swtimer_p->mode == SWTIMERS_MODE_PERIODIC_FROM_LOOP)) {
+            swtimers_inst_p->is_loop_pending = true;
+        }
+    }
+
+    if (next_expiry < swtimers_inst_p->next_expiry) {
+        swtimers_inst_p->next_expiry = next_expiry;
+    }
+
+    swtimers_inst_p->expired_cnt += expired_num;
+    if (expired_num == 0) {
+        swtimers_inst_p->idle_isr_cnt++;
     }
+    if (active_num > swtimers_inst_p->peak_active) {
+        swtimers_inst_p->peak_active = active_num;
+    }
+
+#if (DRV_PROF == 1)
+    if (swtimers_inst_p->prof_p != NULL) {
+        swtimers_prof_end(swtimers_inst_p, &swtimers_inst_p->prof_p->isr, prof_start);
+    }
+#endif
 }
 
 //==================================================================================================
@@ -365,13 +704,18 @@ static void swtimers_do_start(const swtimers_t * inst_p, uint32_t idx, uint32_t
                               void * arg_1_p, void * arg_2_p)
 {
     assert(inst_p != NULL);
-    const swtimers_instance_t * swtimers_inst_p = (const swtimers_instance_t*)inst_p;
+    swtimers_instance_t * swtimers_inst_p = (swtimers_instance_t*)inst_p;
     assert(idx < swtimers_inst_p->num);
     volatile swtimers_timer_instance_t * swtimer_p = &(swtimers_inst_p->timers_table_p[idx]);
     const swtimers_hw_interface_t * hw_p = swtimers_inst_p->hw_p;
 
     swtimers_stop(inst_p, idx);
 
+    // The first period after start isn't measured
+    if (swtimers_inst_p->lateness_p != NULL) {
+        swtimers_inst_p->lateness_p[idx].is_called = false;
+    }
+
     swtimer_p->is_simple = is_simple;
     if (is_simple) {
         swtimer_p->handler.simple_cb = handler_simple_cb;
@@ -379,18 +723,179 @@ static void swtimers_do_start(const swtimers_t * inst_p, uint32_t idx, uint32_t
     else {
         swtimer_p->handler.full_cb = handler_cb;
     }
-    swtimer_p->mode = mode;
+    swtimer_p->mode = (uint8_t)mode;
     swtimer_p->arg_1_p = arg_1_p;
     swtimer_p->arg_2_p = arg_2_p;
     swtimer_p->threshold = ms / swtimers_inst_p->hw_p->tick_ms;
 
+    uint32_t ticks_left = swtimers_ticks_left(swtimer_p->threshold, 0);
+
     // Critical section - start timer
     hw_p->isr_disable_cb(hw_p->hw_timer_p);
     swtimer_p->is_run = true;
+    swtimers_inst_p->started_cnt++;
+    if (ticks_left < swtimers_inst_p->next_expiry) {
+        swtimers_inst_p->next_expiry = ticks_left;
+    }
     hw_p->isr_enable_cb(hw_p->hw_timer_p);
 
+#if (DRV_TRACE == 1)
+    trace_record(swtimers_inst_p->trace_p, TRACE_EVT_SWTIMERS_START, idx, (uint8_t)mode, ms);
+#endif
+
     swtimers_start_hw_timer(inst_p);
 }
 
+//------------------------------------------------------------------------------
+// Get number of swtimers_isr() calls until expiration of the timer
+//
+// `threshold` - threshold of the timer
+// `counter`   - current counter of the timer
+//------------------------------------------------------------------------------
+static uint32_t swtimers_ticks_left(uint32_t threshold, uint32_t counter)
+{
+    // Timer with zero threshold expires at the first tick
+    return (threshold > counter) ? (threshold - counter) : (1);
+}
+
+//------------------------------------------------------------------------------
+// Call handler of the timer (if exists)
+//
+// `swtimers_inst_p` - pointer to driver instance
+// `swtimer_p`       - pointer to timer
+// `idx`             - index of timer
+//------------------------------------------------------------------------------
+static void swtimers_call_handler(const swtimers_instance_t * swtimers_inst_p, volatile swtimers_timer_instance_t * swtimer_p, uint32_t idx)
+{
+#if (DRV_PROF == 1)
+    uint32_t prof_start = swtimers_prof_begin(swtimers_inst_p);
+#endif
+
+    if (swtimers_inst_p->lateness_p != NULL) {
+        bool is_periodic = (swtimer_p->mode == SWTIMERS_MODE_PERIODIC_FROM_LOOP) || (swtimer_p->mode == SWTIMERS_MODE_PERIODIC_FROM_ISR);
+        swtimers_lateness_update(&swtimers_inst_p->lateness_p[idx], swtimers_inst_p->ticks, is_periodic);
+    }
+
+#if (DRV_TRACE == 1)
+    trace_record(swtimers_inst_p->trace_p, TRACE_EVT_SWTIMERS_CALL, idx, swtimer_p->mode, 0);
+#endif
+
+    if ((swtimer_p->is_simple == true) && (swtimer_p->handler.simple_cb != NULL)) {
+        (swtimer_p->handler.simple_cb)();
+    }
+    else if ((swtimer_p->is_simple == false) && (swtimer_p->handler.full_cb != NULL)) {
+        (swtimer_p->handler.full_cb)(idx, swtimer_p->arg_1_p, swtimer_p->arg_2_p);
+    }
+
+#if (DRV_TRACE == 1)
+    trace_record(swtimers_inst_p->trace_p, TRACE_EVT_SWTIMERS_RETURN, idx, swtimer_p->mode, 0);
+#endif
+
+#if (DRV_PROF == 1)
+    if ((swtimers_inst_p->prof_p != NULL) && (swtimers_inst_p->prof_p->handlers_p != NULL)) {
+        swtimers_prof_end(swtimers_inst_p, &swtimers_inst_p->prof_p->handlers_p[idx], prof_start);
+    }
+#endif
+}
+
+//------------------------------------------------------------------------------
+// Call handler of the timer from ISR and check its budget
+//
+// `swtimers_inst_p` - pointer to driver instance
+// `swtimer_p`       - pointer to timer
+// `idx`             - index of timer
+//------------------------------------------------------------------------------
+static void swtimers_call_isr_handler(swtimers_instance_t * swtimers_inst_p, volatile swtimers_timer_instance_t * swtimer_p, uint32_t idx)
+{
+    const swtimers_watchdog_t * watchdog_p = swtimers_inst_p->watchdog_p;
 
+    if ((watchdog_p == NULL) || (watchdog_p->budgets_p[idx] == 0)) {
+        swtimers_call_handler(swtimers_inst_p, swtimer_p, idx);
+        return;
+    }
 
+    uint32_t start = watchdog_p->cycles_cb();
+    swtimers_call_handler(swtimers_inst_p, swtimer_p, idx);
+    uint32_t cycles = watchdog_p->cycles_cb() - start;
+
+    if (cycles <= watchdog_p->budgets_p[idx]) {
+        return;
+    }
+
+    swtimers_inst_p->over_budget_cnt++;
+
+    // Handler could restart the timer in another mode - only the timer still handled from ISR is affected
+    bool is_isr_mode = (swtimer_p->mode == SWTIMERS_MODE_SINGLE_FROM_ISR) || (swtimer_p->mode == SWTIMERS_MODE_PERIODIC_FROM_ISR);
+    if ((watchdog_p->policy == SWTIMERS_BUDGET_DEMOTE) && is_isr_mode) {
+        swtimer_p->mode = (swtimer_p->mode == SWTIMERS_MODE_SINGLE_FROM_ISR) ? (SWTIMERS_MODE_SINGLE_FROM_LOOP) : (SWTIMERS_MODE_PERIODIC_FROM_LOOP);
+    }
+    else if ((watchdog_p->policy == SWTIMERS_BUDGET_DISABLE) && is_isr_mode && swtimer_p->is_run) {
+        swtimer_p->is_run = false;
+        swtimer_p->counter = 0;
+#if (DRV_TRACE == 1)
+        trace_record(swtimers_inst_p->trace_p, TRACE_EVT_SWTIMERS_STOP, idx, 0, 0);
+#endif
+    }
+
+    if (watchdog_p->report_cb != NULL) {
+        watchdog_p->report_cb(idx, cycles, watchdog_p->report_arg_p);
+    }
+}
+
+//------------------------------------------------------------------------------
+// Update lateness statistics on handler call
+//
+// `lateness_p`  - pointer to statistics of the timer
+// `tick`        - current tick
+// `is_periodic` - 'true' if timer is periodic
+//------------------------------------------------------------------------------
+static void swtimers_lateness_update(swtimers_lateness_t * lateness_p, uint32_t tick, bool is_periodic)
+{
+    uint32_t lateness = tick - lateness_p->expiry_tick;
+
+    lateness_p->count++;
+    lateness_p->sum += lateness;
+    lateness_p->last = lateness;
+    if (lateness > lateness_p->max) {
+        lateness_p->max = lateness;
+    }
+
+    if (is_periodic && lateness_p->is_called) {
+        uint32_t period = tick - lateness_p->call_tick;
+        if ((lateness_p->period_min == 0) || (period < lateness_p->period_min)) {
+            lateness_p->period_min = period;
+        }
+        if (period > lateness_p->period_max) {
+            lateness_p->period_max = period;
+        }
+    }
+
+    lateness_p->call_tick = tick;
+    lateness_p->is_called = true;
+}
+
+#if (DRV_PROF == 1)
+//------------------------------------------------------------------------------
+// Start of profiled section
+//
+// `swtimers_inst_p` - pointer to driver instance
+//
+// Returns - current value of cycle counter, 0 if profiling statistics aren't attached
+//------------------------------------------------------------------------------
+static uint32_t swtimers_prof_begin(const swtimers_instance_t * swtimers_inst_p)
+{
+    return (swtimers_inst_p->prof_p != NULL) ? (swtimers_inst_p->prof_p->cycles_cb()) : (0);
+}
+
+//------------------------------------------------------------------------------
+// End of profiled section
+//
+// `swtimers_inst_p` - pointer to driver instance with attached profiling statistics
+// `stats_p`         - pointer to statistics of the section
+// `start`           - value of cycle counter at the start of the section
+//------------------------------------------------------------------------------
+static void swtimers_prof_end(const swtimers_instance_t * swtimers_inst_p, prof_stats_t * stats_p, uint32_t start)
+{
+    prof_stats_add(stats_p, swtimers_inst_p->prof_p->cycles_cb() - start);
+}
+#endif
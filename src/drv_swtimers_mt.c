@@ -0,0 +1,585 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+//**************************************************************************************************
+// Multi-threaded software timers engine for Linux
+//**************************************************************************************************
+#if defined(__linux__)
+
+#define _GNU_SOURCE
+
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+
+#include "drv_swtimers_mt.h"
+
+//==================================================================================================
+//========================================== TYPEDEFS ==============================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Command to the timer thread
+//------------------------------------------------------------------------------
+typedef enum swtimers_mt_op_e {
+    SWTIMERS_MT_OP_START,           // start timer with new settings
+    SWTIMERS_MT_OP_RESTART,         // start timer with settings of the last start
+    SWTIMERS_MT_OP_STOP,            // stop timer
+} swtimers_mt_op_t;
+
+typedef struct swtimers_mt_cmd_s {
+    swtimers_handler_cb_t   handler_cb;     // pointer to handler (can be NULL)
+    void*                   arg_1_p;        // pointer to application data to be passed into handler (can be NULL)
+    void*                   arg_2_p;        // pointer to application data to be passed into handler (can be NULL)
+    uint32_t                idx;            // index of timer
+    uint32_t                ms;             // threshold in milliseconds
+    uint8_t                 op;             // command (swtimers_mt_op_t)
+    uint8_t                 mode;           // timer mode (swtimers_mode_t)
+    uint8_t                 align[2];
+} swtimers_mt_cmd_t;
+
+//------------------------------------------------------------------------------
+// Handler call dispatched to worker thread
+//------------------------------------------------------------------------------
+typedef struct swtimers_mt_job_s {
+    swtimers_handler_cb_t   handler_cb;     // pointer to handler
+    void*                   arg_1_p;        // pointer to application data to be passed into handler (can be NULL)
+    void*                   arg_2_p;        // pointer to application data to be passed into handler (can be NULL)
+    uint32_t                idx;            // index of timer
+    uint32_t                gen;            // generation of timer at expiration
+} swtimers_mt_job_t;
+
+//------------------------------------------------------------------------------
+// Single timer instance
+//------------------------------------------------------------------------------
+typedef struct swtimers_mt_timer_instance_s {
+    swtimers_handler_cb_t   handler_cb;     // pointer to handler (can be NULL)
+    void*                   arg_1_p;        // pointer to application data to be passed into handler (can be NULL)
+    void*                   arg_2_p;        // pointer to application data to be passed into handler (can be NULL)
+    uint32_t                threshold;      // threshold in ticks (0 - timer has never been started)
+    uint32_t                rounds;         // number of wheel turns left before expiration
+    uint32_t                next;           // index of the next timer in the same slot
+    uint32_t                prev;           // index of the previous timer in the same slot
+    uint32_t                slot;           // index of slot of the wheel (SWTIMERS_MT_NO_TIMER - timer isn't in the wheel)
+    _Atomic uint32_t        gen;            // generation - changed by each command, invalidates dispatched jobs
+    _Atomic bool            is_run;         // 'true' - timer is started
+    uint8_t                 mode;           // timer mode (swtimers_mode_t)
+} swtimers_mt_timer_instance_t;
+
+//------------------------------------------------------------------------------
+// Single worker thread instance
+//------------------------------------------------------------------------------
+struct swtimers_mt_instance_s;
+
+typedef struct swtimers_mt_worker_instance_s {
+    mpsc_t                          jobs;       // queue of handler calls (producer - timer thread)
+    sem_t                           sem;        // number of posted jobs and stop requests
+    pthread_t                       thread;     // worker thread
+    struct swtimers_mt_instance_s*  inst_p;     // pointer to driver instance
+    bool                            is_started; // 'true' - thread is created
+} swtimers_mt_worker_instance_t;
+
+//------------------------------------------------------------------------------
+// Driver instance
+//------------------------------------------------------------------------------
+typedef struct swtimers_mt_instance_s {
+    mpsc_t                          cmds;           // queue of commands (consumer - timer thread)
+    swtimers_mt_timer_instance_t*   timers_p;       // pointer to array of timers
+    uint32_t                        num;            // number of timers
+    uint32_t                        tick_ms;        // one tick in milliseconds
+    uint32_t*                       slots_p;        // pointer to array of slots - index of the first timer in each slot
+    uint32_t                        slots_num;      // number of slots
+    uint32_t                        cursor;         // number of ticks since start modulo 2^32
+    swtimers_mt_worker_instance_t*  workers_p;      // pointer to array of workers
+    uint32_t                        workers_num;    // number of workers
+    uint32_t                        cmd_num;        // number of cells in command queue
+    _Atomic uint32_t                overruns;       // number of handler calls dropped because job queue of worker is full
+    pthread_t                       thread;         // timer thread
+    _Atomic bool                    is_stopping;    // 'true' - threads should exit
+    bool                            is_started;     // 'true' - timer thread is created
+} swtimers_mt_instance_t;
+
+//------------------------------------------------------------------------------
+// Sanitizing (sizes of system types depend on platform, public sizes are upper bounds)
+//------------------------------------------------------------------------------
+static_assert(MPSC_CELL_SIZE(sizeof(swtimers_mt_cmd_t)) <= SWTIMERS_MT_CMD_CELL_SIZE, "Wrong structure size");
+static_assert(MPSC_CELL_SIZE(sizeof(swtimers_mt_job_t)) <= SWTIMERS_MT_JOB_CELL_SIZE, "Wrong structure size");
+static_assert(sizeof(swtimers_mt_timer_instance_t) <= sizeof(swtimers_mt_timer_t), "Wrong structure size");
+static_assert(sizeof(swtimers_mt_worker_instance_t) <= sizeof(swtimers_mt_worker_t), "Wrong structure size");
+static_assert(sizeof(swtimers_mt_instance_t) <= sizeof(swtimers_mt_t), "Wrong structure size");
+
+//==================================================================================================
+//================================ PRIVATE FUNCTIONS DECLARATIONS ==================================
+//==================================================================================================
+
+static void swtimers_mt_stop_threads(swtimers_mt_instance_t * mt_inst_p);
+static bool swtimers_mt_post_cmd(const swtimers_mt_t * inst_p, const swtimers_mt_cmd_t * cmd_p);
+static void swtimers_mt_apply_cmd(swtimers_mt_instance_t * mt_inst_p, const swtimers_mt_cmd_t * cmd_p);
+static void swtimers_mt_link(swtimers_mt_instance_t * mt_inst_p, uint32_t idx, uint32_t ticks);
+static void swtimers_mt_unlink(swtimers_mt_instance_t * mt_inst_p, uint32_t idx);
+static void swtimers_mt_tick(swtimers_mt_instance_t * mt_inst_p);
+static void swtimers_mt_expire(swtimers_mt_instance_t * mt_inst_p, uint32_t idx);
+static void * swtimers_mt_timer_thread(void * arg_p);
+static void * swtimers_mt_worker_thread(void * arg_p);
+
+//==================================================================================================
+//================================ PUBLIC FUNCTIONS DEFINITIONS ====================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Init driver and start threads
+//------------------------------------------------------------------------------
+bool swtimers_mt_init(swtimers_mt_t * inst_p, const swtimers_mt_config_t * config_p)
+{
+    assert((inst_p != NULL) && (config_p != NULL));
+    assert((config_p->tick_ms > 0) && (config_p->num > 0) && (config_p->num < SWTIMERS_MT_NO_TIMER) && (config_p->timers_table_p != NULL));
+    assert((config_p->slots_num > 0) && ((config_p->slots_num & (config_p->slots_num - 1)) == 0) && (config_p->slots_table_p != NULL));
+    assert((config_p->cmd_num > 0) && (config_p->cmd_cells_p != NULL));
+    assert((config_p->workers_num > 0) && (config_p->workers_table_p != NULL) && (config_p->job_num > 0) && (config_p->job_cells_p != NULL));
+
+    swtimers_mt_instance_t * mt_inst_p = (swtimers_mt_instance_t*)inst_p;
+
+    memset(mt_inst_p, 0x00, sizeof(swtimers_mt_instance_t));
+
+    mt_inst_p->timers_p = (swtimers_mt_timer_instance_t*)config_p->timers_table_p;
+    mt_inst_p->num = config_p->num;
+    mt_inst_p->tick_ms = config_p->tick_ms;
+    mt_inst_p->slots_p = config_p->slots_table_p;
+    mt_inst_p->slots_num = config_p->slots_num;
+    mt_inst_p->workers_p = (swtimers_mt_worker_instance_t*)config_p->workers_table_p;
+    mt_inst_p->workers_num = config_p->workers_num;
+    mt_inst_p->cmd_num = config_p->cmd_num;
+    atomic_init(&mt_inst_p->overruns, 0);
+    atomic_init(&mt_inst_p->is_stopping, false);
+
+    mpsc_init(&mt_inst_p->cmds, config_p->cmd_cells_p, config_p->cmd_num, sizeof(swtimers_mt_cmd_t));
+
+    memset(mt_inst_p->timers_p, 0x00, config_p->num * sizeof(swtimers_mt_timer_t));
+    for (uint32_t idx = 0; idx < config_p->num; ++idx) {
+        swtimers_mt_timer_instance_t * timer_p = &mt_inst_p->timers_p[idx];
+        timer_p->slot = SWTIMERS_MT_NO_TIMER;
+        atomic_init(&timer_p->gen, 0);
+        atomic_init(&timer_p->is_run, false);
+    }
+
+    for (uint32_t slot = 0; slot < config_p->slots_num; ++slot) {
+        mt_inst_p->slots_p[slot] = SWTIMERS_MT_NO_TIMER;
+    }
+
+    // Workers
+    memset(mt_inst_p->workers_p, 0x00, config_p->workers_num * sizeof(swtimers_mt_worker_t));
+    for (uint32_t w = 0; w < config_p->workers_num; ++w) {
+        swtimers_mt_worker_instance_t * worker_p = &mt_inst_p->workers_p[w];
+        uint8_t * cells_p = (uint8_t*)config_p->job_cells_p + ((size_t)w * config_p->job_num * SWTIMERS_MT_JOB_CELL_SIZE);
+
+        mpsc_init(&worker_p->jobs, cells_p, config_p->job_num, sizeof(swtimers_mt_job_t));
+
+        // Worker without semaphore isn't marked by `inst_p`, its semaphore isn't destroyed
+        if (sem_init(&worker_p->sem, 0, 0) != 0) {
+            swtimers_mt_stop_threads(mt_inst_p);
+            memset(mt_inst_p, 0x00, sizeof(swtimers_mt_instance_t));
+            return false;
+        }
+        worker_p->inst_p = mt_inst_p;
+
+        if (pthread_create(&worker_p->thread, NULL, &swtimers_mt_worker_thread, worker_p) != 0) {
+            swtimers_mt_stop_threads(mt_inst_p);
+            memset(mt_inst_p, 0x00, sizeof(swtimers_mt_instance_t));
+            return false;
+        }
+        worker_p->is_started = true;
+    }
+
+    // Timer thread
+    if (pthread_create(&mt_inst_p->thread, NULL, &swtimers_mt_timer_thread, mt_inst_p) != 0) {
+        swtimers_mt_stop_threads(mt_inst_p);
+        memset(mt_inst_p, 0x00, sizeof(swtimers_mt_instance_t));
+        return false;
+    }
+    mt_inst_p->is_started = true;
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+// Stop all threads and deinit driver
+//------------------------------------------------------------------------------
+void swtimers_mt_deinit(swtimers_mt_t * inst_p)
+{
+    assert(inst_p != NULL);
+    swtimers_mt_instance_t * mt_inst_p = (swtimers_mt_instance_t*)inst_p;
+
+    // If not initialized
+    if (mt_inst_p->timers_p == NULL) {
+        return;
+    }
+
+    swtimers_mt_stop_threads(mt_inst_p);
+
+    memset(mt_inst_p->timers_p, 0x00, mt_inst_p->num * sizeof(swtimers_mt_timer_t));
+    memset(mt_inst_p->workers_p, 0x00, mt_inst_p->workers_num * sizeof(swtimers_mt_worker_t));
+    memset(mt_inst_p, 0x00, sizeof(swtimers_mt_instance_t));
+}
+
+//------------------------------------------------------------------------------
+// Start timer
+//------------------------------------------------------------------------------
+bool swtimers_mt_start(const swtimers_mt_t * inst_p, uint32_t idx, uint32_t ms, swtimers_mode_t mode,
+                       swtimers_handler_cb_t handler_cb, void * arg_1_p, void * arg_2_p)
+{
+    swtimers_mt_cmd_t cmd = {
+        .handler_cb = handler_cb,
+        .arg_1_p = arg_1_p,
+        .arg_2_p = arg_2_p,
+        .idx = idx,
+        .ms = ms,
+        .op = SWTIMERS_MT_OP_START,
+        .mode = (uint8_t)mode,
+    };
+
+    return swtimers_mt_post_cmd(inst_p, &cmd);
+}
+
+//------------------------------------------------------------------------------
+// Restart timer with settings of the last start
+//------------------------------------------------------------------------------
+bool swtimers_mt_restart(const swtimers_mt_t * inst_p, uint32_t idx)
+{
+    swtimers_mt_cmd_t cmd = {
+        .idx = idx,
+        .op = SWTIMERS_MT_OP_RESTART,
+    };
+
+    return swtimers_mt_post_cmd(inst_p, &cmd);
+}
+
+//------------------------------------------------------------------------------
+// Stop timer
+//------------------------------------------------------------------------------
+bool swtimers_mt_stop(const swtimers_mt_t * inst_p, uint32_t idx)
+{
+    swtimers_mt_cmd_t cmd = {
+        .idx = idx,
+        .op = SWTIMERS_MT_OP_STOP,
+    };
+
+    return swtimers_mt_post_cmd(inst_p, &cmd);
+}
+
+//------------------------------------------------------------------------------
+// Check if timer is run
+//------------------------------------------------------------------------------
+bool swtimers_mt_is_run(const swtimers_mt_t * inst_p, uint32_t idx)
+{
+    assert(inst_p != NULL);
+    swtimers_mt_instance_t * mt_inst_p = (swtimers_mt_instance_t*)inst_p;
+    assert(idx < mt_inst_p->num);
+
+    return atomic_load_explicit(&mt_inst_p->timers_p[idx].is_run, memory_order_acquire);
+}
+
+//------------------------------------------------------------------------------
+// Get number of handler calls dropped because job queue of worker is full
+//------------------------------------------------------------------------------
+uint32_t swtimers_mt_get_overruns(const swtimers_mt_t * inst_p)
+{
+    assert(inst_p != NULL);
+    swtimers_mt_instance_t * mt_inst_p = (swtimers_mt_instance_t*)inst_p;
+
+    return atomic_load_explicit(&mt_inst_p->overruns, memory_order_relaxed);
+}
+
+//==================================================================================================
+//================================ PRIVATE FUNCTIONS DEFINITIONS ===================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Stop and join all started threads, destroy semaphores of workers
+//
+// `mt_inst_p` - pointer to driver instance
+//------------------------------------------------------------------------------
+static void swtimers_mt_stop_threads(swtimers_mt_instance_t * mt_inst_p)
+{
+    atomic_store_explicit(&mt_inst_p->is_stopping, true, memory_order_release);
+
+    // Timer thread is the only producer of jobs, stop it first
+    if (mt_inst_p->is_started) {
+        pthread_join(mt_inst_p->thread, NULL);
+        mt_inst_p->is_started = false;
+    }
+
+    for (uint32_t w = 0; w < mt_inst_p->workers_num; ++w) {
+        swtimers_mt_worker_instance_t * worker_p = &mt_inst_p->workers_p[w];
+        if (worker_p->inst_p == NULL) {
+            break;
+        }
+
+        if (worker_p->is_started) {
+            sem_post(&worker_p->sem);
+            pthread_join(worker_p->thread, NULL);
+            worker_p->is_started = false;
+        }
+        sem_destroy(&worker_p->sem);
+    }
+}
+
+//------------------------------------------------------------------------------
+// Push command into command queue
+//
+// `inst_p` - pointer to initialized driver instance
+// `cmd_p`  - pointer to command
+//
+// Returns - 'true' if command is queued, 'false' if command queue is full
+//------------------------------------------------------------------------------
+static bool swtimers_mt_post_cmd(const swtimers_mt_t * inst_p, const swtimers_mt_cmd_t * cmd_p)
+{
+    assert(inst_p != NULL);
+    const swtimers_mt_instance_t * mt_inst_p = (const swtimers_mt_instance_t*)inst_p;
+    assert(cmd_p->idx < mt_inst_p->num);
+
+    return mpsc_push(&mt_inst_p->cmds, cmd_p);
+}
+
+//------------------------------------------------------------------------------
+// Apply command in the timer thread
+//
+// `mt_inst_p` - pointer to driver instance
+// `cmd_p`     - pointer to command
+//------------------------------------------------------------------------------
+static void swtimers_mt_apply_cmd(swtimers_mt_instance_t * mt_inst_p, const swtimers_mt_cmd_t * cmd_p)
+{
+    swtimers_mt_timer_instance_t * timer_p = &mt_inst_p->timers_p[cmd_p->idx];
+
+    // Restart of timer which has never been started
+    if ((cmd_p->op == SWTIMERS_MT_OP_RESTART) && (timer_p->threshold == 0)) {
+        return;
+    }
+
+    swtimers_mt_unlink(mt_inst_p, cmd_p->idx);
+
+    // Invalidate handler calls dispatched to workers
+    atomic_fetch_add_explicit(&timer_p->gen, 1, memory_order_release);
+
+    if (cmd_p->op == SWTIMERS_MT_OP_STOP) {
+        atomic_store_explicit(&timer_p->is_run, false, memory_order_release);
+        return;
+    }
+
+    if (cmd_p->op == SWTIMERS_MT_OP_START) {
+        uint32_t ticks = cmd_p->ms / mt_inst_p->tick_ms;
+
+        timer_p->handler_cb = cmd_p->handler_cb;
+        timer_p->arg_1_p = cmd_p->arg_1_p;
+        timer_p->arg_2_p = cmd_p->arg_2_p;
+        timer_p->threshold = (ticks == 0) ? (1) : (ticks);
+        timer_p->mode = cmd_p->mode;
+    }
+
+    swtimers_mt_link(mt_inst_p, cmd_p->idx, timer_p->threshold);
+    atomic_store_explicit(&timer_p->is_run, true, memory_order_release);
+}
+
+//------------------------------------------------------------------------------
+// Put timer into the wheel
+//
+// `mt_inst_p` - pointer to driver instance
+// `idx`       - index of timer which isn't in the wheel
+// `ticks`     - number of ticks until expiration (must be > 0)
+//------------------------------------------------------------------------------
+static void swtimers_mt_link(swtimers_mt_instance_t * mt_inst_p, uint32_t idx, uint32_t ticks)
+{
+    swtimers_mt_timer_instance_t * timer_p = &mt_inst_p->timers_p[idx];
+    uint32_t slot = (mt_inst_p->cursor + ticks) & (mt_inst_p->slots_num - 1);
+    uint32_t head = mt_inst_p->slots_p[slot];
+
+    timer_p->rounds = (ticks - 1) / mt_inst_p->slots_num;
+    timer_p->slot = slot;
+    timer_p->prev = SWTIMERS_MT_NO_TIMER;
+    timer_p->next = head;
+
+    if (head != SWTIMERS_MT_NO_TIMER) {
+        mt_inst_p->timers_p[head].prev = idx;
+    }
+    mt_inst_p->slots_p[slot] = idx;
+}
+
+//------------------------------------------------------------------------------
+// Remove timer from the wheel
+//
+// `mt_inst_p` - pointer to driver instance
+// `idx`       - index of timer (can be out of the wheel)
+//------------------------------------------------------------------------------
+static void swtimers_mt_unlink(swtimers_mt_instance_t * mt_inst_p, uint32_t idx)
+{
+    swtimers_mt_timer_instance_t * timer_p = &mt_inst_p->timers_p[idx];
+
+    if (timer_p->slot == SWTIMERS_MT_NO_TIMER) {
+        return;
+    }
+
+    if (timer_p->prev != SWTIMERS_MT_NO_TIMER) {
+        mt_inst_p->timers_p[timer_p->prev].next = timer_p->next;
+    } else {
+        mt_inst_p->slots_p[timer_p->slot] = timer_p->next;
+    }
+
+    if (timer_p->next != SWTIMERS_MT_NO_TIMER) {
+        mt_inst_p->timers_p[timer_p->next].prev = timer_p->prev;
+    }
+
+    timer_p->slot = SWTIMERS_MT_NO_TIMER;
+}
+
+//------------------------------------------------------------------------------
+// Advance the wheel by one tick and expire timers of the current slot
+//
+// `mt_inst_p` - pointer to driver instance
+//------------------------------------------------------------------------------
+static void swtimers_mt_tick(swtimers_mt_instance_t * mt_inst_p)
+{
+    mt_inst_p->cursor++;
+
+    uint32_t idx = mt_inst_p->slots_p[mt_inst_p->cursor & (mt_inst_p->slots_num - 1)];
+    while (idx != SWTIMERS_MT_NO_TIMER) {
+        swtimers_mt_timer_instance_t * timer_p = &mt_inst_p->timers_p[idx];
+
+        // Periodic timer can be relinked into the same slot, take the next one before expiration
+        uint32_t next = timer_p->next;
+
+        if (timer_p->rounds != 0) {
+            timer_p->rounds--;
+        } else {
+            swtimers_mt_expire(mt_inst_p, idx);
+        }
+
+        idx = next;
+    }
+}
+
+//------------------------------------------------------------------------------
+// Expire timer - relink periodic timer, call or dispatch handler
+//
+// `mt_inst_p` - pointer to driver instance
+// `idx`       - index of timer in the current slot
+//------------------------------------------------------------------------------
+static void swtimers_mt_expire(swtimers_mt_instance_t * mt_inst_p, uint32_t idx)
+{
+    swtimers_mt_timer_instance_t * timer_p = &mt_inst_p->timers_p[idx];
+    swtimers_mode_t mode = (swtimers_mode_t)timer_p->mode;
+
+    swtimers_mt_unlink(mt_inst_p, idx);
+
+    if ((mode == SWTIMERS_MODE_PERIODIC_FROM_LOOP) || (mode == SWTIMERS_MODE_PERIODIC_FROM_ISR)) {
+        swtimers_mt_link(mt_inst_p, idx, timer_p->threshold);
+    } else {
+        atomic_store_explicit(&timer_p->is_run, false, memory_order_release);
+    }
+
+    if (timer_p->handler_cb == NULL) {
+        return;
+    }
+
+    if ((mode == SWTIMERS_MODE_SINGLE_FROM_ISR) || (mode == SWTIMERS_MODE_PERIODIC_FROM_ISR)) {
+        timer_p->handler_cb(idx, timer_p->arg_1_p, timer_p->arg_2_p);
+        return;
+    }
+
+    // The same worker for all calls of the timer keeps order of calls
+    swtimers_mt_worker_instance_t * worker_p = &mt_inst_p->workers_p[idx % mt_inst_p->workers_num];
+    swtimers_mt_job_t job = {
+        .handler_cb = timer_p->handler_cb,
+        .arg_1_p = timer_p->arg_1_p,
+        .arg_2_p = timer_p->arg_2_p,
+        .idx = idx,
+        .gen = atomic_load_explicit(&timer_p->gen, memory_order_relaxed),
+    };
+
+    // Worker is overloaded - drop the call, the timer thread must not wait for workers
+    if (!mpsc_push(&worker_p->jobs, &job)) {
+        atomic_fetch_add_explicit(&mt_inst_p->overruns, 1, memory_order_relaxed);
+        return;
+    }
+    sem_post(&worker_p->sem);
+}
+
+//------------------------------------------------------------------------------
+// Timer thread - apply commands and advance the wheel once per tick
+//
+// `arg_p` - pointer to driver instance (with type swtimers_mt_instance_t*)
+//
+// Returns - NULL
+//------------------------------------------------------------------------------
+static void * swtimers_mt_timer_thread(void * arg_p)
+{
+    swtimers_mt_instance_t * mt_inst_p = (swtimers_mt_instance_t*)arg_p;
+    struct timespec next;
+
+    clock_gettime(CLOCK_MONOTONIC, &next);
+
+    while (!atomic_load_explicit(&mt_inst_p->is_stopping, memory_order_acquire)) {
+
+        // Absolute deadlines - ticks don't drift, late ticks are caught up without sleeping
+        next.tv_nsec += (long)(mt_inst_p->tick_ms % 1000u) * 1000000L;
+        next.tv_sec += (time_t)(mt_inst_p->tick_ms / 1000u);
+        if (next.tv_nsec >= 1000000000L) {
+            next.tv_nsec -= 1000000000L;
+            next.tv_sec++;
+        }
+
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL) == EINTR) {
+        }
+
+        // Commands posted during the tick, the number is limited to not delay expiration of timers
+        swtimers_mt_cmd_t cmd;
+        for (uint32_t i = 0; (i < mt_inst_p->cmd_num) && mpsc_pop(&mt_inst_p->cmds, &cmd); ++i) {
+            swtimers_mt_apply_cmd(mt_inst_p, &cmd);
+        }
+
+        swtimers_mt_tick(mt_inst_p);
+    }
+
+    return NULL;
+}
+
+//------------------------------------------------------------------------------
+// Worker thread - call dispatched handlers
+//
+// `arg_p` - pointer to worker instance (with type swtimers_mt_worker_instance_t*)
+//
+// Returns - NULL
+//------------------------------------------------------------------------------
+static void * swtimers_mt_worker_thread(void * arg_p)
+{
+    swtimers_mt_worker_instance_t * worker_p = (swtimers_mt_worker_instance_t*)arg_p;
+    swtimers_mt_instance_t * mt_inst_p = worker_p->inst_p;
+    swtimers_mt_job_t job;
+
+    for (;;) {
+        while (sem_wait(&worker_p->sem) != 0) {
+        }
+
+        if (!mpsc_pop(&worker_p->jobs, &job)) {
+            // Semaphore is posted without a job only on exit
+            if (atomic_load_explicit(&mt_inst_p->is_stopping, memory_order_acquire)) {
+                break;
+            }
+            continue;
+        }
+
+        // If timer is stopped or restarted after expiration
+        if (atomic_load_explicit(&mt_inst_p->timers_p[job.idx].gen, memory_order_acquire) != job.gen) {
+            continue;
+        }
+
+        job.handler_cb(job.idx, job.arg_1_p, job.arg_2_p);
+    }
+
+    return NULL;
+}
+
+#endif // defined(__linux__)
@@ -0,0 +1,494 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+//**************************************************************************************************
+// Parallel dispatch of software timers handlers with work stealing (host builds)
+//**************************************************************************************************
+#if defined(__linux__)
+
+#define _GNU_SOURCE
+
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+#include <sched.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "drv_swtimers_par.h"
+
+//==================================================================================================
+//========================================== TYPEDEFS ==============================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Job - handler of one timer
+//------------------------------------------------------------------------------
+typedef struct swtimers_par_job_instance_s {
+    swtimers_handler_cb_t                   handler_cb; // pointer to handler
+    void*                                   arg_1_p;    // pointer to application data to be passed into handler (can be NULL)
+    void*                                   arg_2_p;    // pointer to application data to be passed into handler (can be NULL)
+    struct swtimers_par_job_instance_s*     next_p;     // next job of the same serial group expired on the same tick
+    uint32_t                                group;      // index of serial group or SWTIMERS_PAR_NO_GROUP
+    uint32_t                                timer_idx;  // index of expired timer
+} swtimers_par_job_instance_t;
+
+//------------------------------------------------------------------------------
+// Serial group - chain of jobs expired on the same tick, called as one unit
+//------------------------------------------------------------------------------
+typedef struct swtimers_par_group_instance_s {
+    swtimers_par_job_instance_t*    head_p;     // the first job of the chain (NULL - no jobs)
+    swtimers_par_job_instance_t*    tail_p;     // the last job of the chain
+} swtimers_par_group_instance_t;
+
+//------------------------------------------------------------------------------
+// Deque of units - owner takes units from bottom, thieves steal units from top
+// Units are placed before the run, so there are no pushes during the run
+//------------------------------------------------------------------------------
+typedef struct swtimers_par_deque_s {
+    alignas(64) _Atomic int32_t     top;        // index of the next unit to be stolen
+    alignas(64) _Atomic int32_t     bottom;     // index after the next unit to be taken by owner
+} swtimers_par_deque_t;
+
+//------------------------------------------------------------------------------
+// Worker thread
+//------------------------------------------------------------------------------
+struct swtimers_par_instance_s;
+
+typedef struct swtimers_par_worker_instance_s {
+    swtimers_par_deque_t                deque;      // units of the worker
+    pthread_t                           thread;     // worker thread
+    struct swtimers_par_instance_s*     inst_p;     // pointer to driver instance
+    uint32_t                            idx;        // index of worker
+    bool                                is_started; // 'true' - thread is created
+} swtimers_par_worker_instance_t;
+
+//------------------------------------------------------------------------------
+// Driver instance
+//------------------------------------------------------------------------------
+typedef struct swtimers_par_instance_s {
+    swtimers_par_deque_t                deque;          // units of the calling thread
+    pthread_mutex_t                     lock;           // protects generation and stop request
+    pthread_cond_t                      cond;           // signals new generation to workers
+    swtimers_par_worker_instance_t*     workers_p;      // pointer to array of workers
+    uint32_t                            workers_num;    // number of workers
+    uint32_t                            units_max;      // size of units array
+    swtimers_par_job_instance_t**       units_pp;       // pointer to array of units - the first jobs of chains
+    swtimers_par_group_instance_t*      groups_p;       // pointer to array of serial groups
+    uint32_t                            groups_num;     // number of serial groups
+    uint32_t                            units_num;      // number of units collected on the current tick
+    uint32_t                            generation;     // number of parallel runs
+    bool                                is_stopping;    // 'true' - workers should exit
+    _Atomic uint32_t                    pending;        // number of units which are not finished in the current run
+    _Atomic uint32_t                    active;         // number of workers which haven't left the current run
+} swtimers_par_instance_t;
+
+//------------------------------------------------------------------------------
+// Sanitizing (sizes of system types depend on platform, public sizes are upper bounds)
+//------------------------------------------------------------------------------
+static_assert(sizeof(swtimers_par_job_instance_t) <= sizeof(swtimers_par_job_t), "Wrong structure size");
+static_assert(sizeof(swtimers_par_group_instance_t) <= sizeof(swtimers_par_group_t), "Wrong structure size");
+static_assert(sizeof(swtimers_par_worker_instance_t) <= sizeof(swtimers_par_worker_t), "Wrong structure size");
+static_assert(sizeof(swtimers_par_instance_t) <= sizeof(swtimers_par_t), "Wrong structure size");
+
+//==================================================================================================
+//================================ PRIVATE FUNCTIONS DECLARATIONS ==================================
+//==================================================================================================
+
+static void swtimers_par_collect(uint32_t timer_idx, void * inst_p, void * job_p);
+static void swtimers_par_run(swtimers_par_instance_t * par_inst_p);
+static void swtimers_par_run_unit(swtimers_par_job_instance_t * job_p);
+static swtimers_par_deque_t * swtimers_par_get_deque(swtimers_par_instance_t * par_inst_p, uint32_t idx);
+static swtimers_par_job_instance_t * swtimers_par_take(swtimers_par_instance_t * par_inst_p, swtimers_par_deque_t * deque_p);
+static swtimers_par_job_instance_t * swtimers_par_steal(swtimers_par_instance_t * par_inst_p, swtimers_par_deque_t * deque_p);
+static void swtimers_par_participate(swtimers_par_instance_t * par_inst_p, uint32_t self_idx);
+static void swtimers_par_stop_workers(swtimers_par_instance_t * par_inst_p);
+static void * swtimers_par_worker_thread(void * arg_p);
+
+//==================================================================================================
+//================================ PUBLIC FUNCTIONS DEFINITIONS ====================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Init driver and start worker threads
+//------------------------------------------------------------------------------
+bool swtimers_par_init(swtimers_par_t * inst_p, swtimers_par_worker_t * workers_table_p, uint32_t workers_num,
+                       swtimers_par_job_t ** units_table_p, uint32_t units_num,
+                       swtimers_par_group_t * groups_table_p, uint32_t groups_num)
+{
+    assert((inst_p != NULL) && ((workers_num == 0) || (workers_table_p != NULL)));
+    assert((units_table_p != NULL) && (units_num > 0) && (units_num <= INT32_MAX));
+    assert((groups_num == 0) || (groups_table_p != NULL));
+
+    swtimers_par_instance_t * par_inst_p = (swtimers_par_instance_t*)inst_p;
+
+    memset(par_inst_p, 0x00, sizeof(swtimers_par_instance_t));
+
+    pthread_mutex_init(&par_inst_p->lock, NULL);
+    pthread_cond_init(&par_inst_p->cond, NULL);
+    par_inst_p->workers_p = (swtimers_par_worker_instance_t*)workers_table_p;
+    par_inst_p->workers_num = workers_num;
+    par_inst_p->units_pp = (swtimers_par_job_instance_t**)units_table_p;
+    par_inst_p->units_max = units_num;
+    par_inst_p->groups_p = (swtimers_par_group_instance_t*)groups_table_p;
+    par_inst_p->groups_num = groups_num;
+    atomic_init(&par_inst_p->pending, 0);
+    atomic_init(&par_inst_p->active, 0);
+
+    if (groups_num != 0) {
+        memset(groups_table_p, 0x00, groups_num * sizeof(swtimers_par_group_t));
+    }
+
+    if (workers_num != 0) {
+        memset(workers_table_p, 0x00, workers_num * sizeof(swtimers_par_worker_t));
+    }
+
+    for (uint32_t w = 0; w < workers_num; ++w) {
+        swtimers_par_worker_instance_t * worker_p = &par_inst_p->workers_p[w];
+        worker_p->inst_p = par_inst_p;
+        worker_p->idx = w;
+
+        if (pthread_create(&worker_p->thread, NULL, &swtimers_par_worker_thread, worker_p) != 0) {
+            swtimers_par_stop_workers(par_inst_p);
+            memset(par_inst_p, 0x00, sizeof(swtimers_par_instance_t));
+            return false;
+        }
+        worker_p->is_started = true;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+// Stop worker threads and deinit driver
+//------------------------------------------------------------------------------
+void swtimers_par_deinit(swtimers_par_t * inst_p)
+{
+    assert(inst_p != NULL);
+    swtimers_par_instance_t * par_inst_p = (swtimers_par_instance_t*)inst_p;
+
+    // If not initialized
+    if (par_inst_p->units_pp == NULL) {
+        return;
+    }
+
+    swtimers_par_stop_workers(par_inst_p);
+
+    memset(par_inst_p, 0x00, sizeof(swtimers_par_instance_t));
+}
+
+//------------------------------------------------------------------------------
+// Init job
+//------------------------------------------------------------------------------
+void swtimers_par_job_init(swtimers_par_job_t * job_p, swtimers_handler_cb_t handler_cb, void * arg_1_p, void * arg_2_p, uint32_t group)
+{
+    assert((job_p != NULL) && (handler_cb != NULL));
+    swtimers_par_job_instance_t * job_inst_p = (swtimers_par_job_instance_t*)job_p;
+
+    memset(job_inst_p, 0x00, sizeof(swtimers_par_job_instance_t));
+
+    job_inst_p->handler_cb = handler_cb;
+    job_inst_p->arg_1_p = arg_1_p;
+    job_inst_p->arg_2_p = arg_2_p;
+    job_inst_p->group = group;
+}
+
+//------------------------------------------------------------------------------
+// Start timer with handler called by parallel dispatch
+//------------------------------------------------------------------------------
+void swtimers_par_start(const swtimers_par_t * inst_p, const swtimers_t * swtimers_p, uint32_t idx, uint32_t ms,
+                        swtimers_mode_t mode, swtimers_par_job_t * job_p)
+{
+    assert((inst_p != NULL) && (swtimers_p != NULL) && (job_p != NULL));
+    assert((mode == SWTIMERS_MODE_SINGLE_FROM_LOOP) || (mode == SWTIMERS_MODE_PERIODIC_FROM_LOOP));
+    assert((((const swtimers_par_job_instance_t*)job_p)->group == SWTIMERS_PAR_NO_GROUP) ||
+           (((const swtimers_par_job_instance_t*)job_p)->group < ((const swtimers_par_instance_t*)inst_p)->groups_num));
+
+    swtimers_start(swtimers_p, idx, ms, mode, &swtimers_par_collect, (void*)inst_p, job_p);
+}
+
+//------------------------------------------------------------------------------
+// Process timers and call handlers of expired timers in parallel
+//------------------------------------------------------------------------------
+void swtimers_par_task(const swtimers_par_t * inst_p, const swtimers_t * swtimers_p)
+{
+    assert((inst_p != NULL) && (swtimers_p != NULL));
+    swtimers_par_instance_t * par_inst_p = (swtimers_par_instance_t*)inst_p;
+
+    // Collect jobs of expired timers
+    swtimers_task(swtimers_p);
+
+    if (par_inst_p->units_num == 0) {
+        return;
+    }
+
+    swtimers_par_run(par_inst_p);
+
+    // Release chains of serial groups
+    for (uint32_t i = 0; i < par_inst_p->units_num; ++i) {
+        uint32_t group = par_inst_p->units_pp[i]->group;
+        if (group != SWTIMERS_PAR_NO_GROUP) {
+            par_inst_p->groups_p[group].head_p = NULL;
+            par_inst_p->groups_p[group].tail_p = NULL;
+        }
+    }
+    par_inst_p->units_num = 0;
+}
+
+//==================================================================================================
+//================================ PRIVATE FUNCTIONS DEFINITIONS ===================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Internal handler of timers - collect job to be called in parallel
+// Signature corresponds to swtimers_handler_cb_t
+//
+// `timer_idx`  - timer index
+// `inst_p`     - pointer to driver instance (with type swtimers_par_instance_t*)
+// `job_p`      - pointer to job (with type swtimers_par_job_instance_t*)
+//------------------------------------------------------------------------------
+static void swtimers_par_collect(uint32_t timer_idx, void * inst_p, void * job_p)
+{
+    assert((inst_p != NULL) && (job_p != NULL));
+    swtimers_par_instance_t * par_inst_p = (swtimers_par_instance_t*)inst_p;
+    swtimers_par_job_instance_t * job_inst_p = (swtimers_par_job_instance_t*)job_p;
+
+    job_inst_p->timer_idx = timer_idx;
+    job_inst_p->next_p = NULL;
+
+    // Job of serial group is appended to the chain of the group, the chain is one unit
+    if (job_inst_p->group != SWTIMERS_PAR_NO_GROUP) {
+        swtimers_par_group_instance_t * group_p = &par_inst_p->groups_p[job_inst_p->group];
+        if (group_p->head_p != NULL) {
+            group_p->tail_p->next_p = job_inst_p;
+            group_p->tail_p = job_inst_p;
+            return;
+        }
+        group_p->head_p = job_inst_p;
+        group_p->tail_p = job_inst_p;
+    }
+
+    assert(par_inst_p->units_num < par_inst_p->units_max);
+    par_inst_p->units_pp[par_inst_p->units_num++] = job_inst_p;
+}
+
+//------------------------------------------------------------------------------
+// Call all collected units and wait for their finish
+//
+// `par_inst_p` - pointer to driver instance
+//------------------------------------------------------------------------------
+static void swtimers_par_run(swtimers_par_instance_t * par_inst_p)
+{
+    uint32_t units_num = par_inst_p->units_num;
+    uint32_t participants_num = par_inst_p->workers_num + 1;
+
+    // Waking up workers costs more than a single unit
+    if ((units_num == 1) || (par_inst_p->workers_num == 0)) {
+        for (uint32_t i = 0; i < units_num; ++i) {
+            swtimers_par_run_unit(par_inst_p->units_pp[i]);
+        }
+        return;
+    }
+
+    // Partition units into equal contiguous parts, the calling thread is the last participant
+    for (uint32_t p = 0; p < participants_num; ++p) {
+        swtimers_par_deque_t * deque_p = swtimers_par_get_deque(par_inst_p, p);
+        atomic_store_explicit(&deque_p->top, (int32_t)(((uint64_t)units_num * p) / participants_num), memory_order_relaxed);
+        atomic_store_explicit(&deque_p->bottom, (int32_t)(((uint64_t)units_num * (p + 1)) / participants_num), memory_order_relaxed);
+    }
+    atomic_store_explicit(&par_inst_p->pending, units_num, memory_order_relaxed);
+    atomic_store_explicit(&par_inst_p->active, par_inst_p->workers_num, memory_order_relaxed);
+
+    pthread_mutex_lock(&par_inst_p->lock);
+    par_inst_p->generation++;
+    pthread_cond_broadcast(&par_inst_p->cond);
+    pthread_mutex_unlock(&par_inst_p->lock);
+
+    swtimers_par_participate(par_inst_p, par_inst_p->workers_num);
+
+    // Deques are reused by the next run - wait until all workers leave this one
+    while (atomic_load_explicit(&par_inst_p->active, memory_order_acquire) != 0) {
+        sched_yield();
+    }
+}
+
+//------------------------------------------------------------------------------
+// Call handlers of unit - the job and the rest of its serial group chain
+//
+// `job_p` - pointer to the first job of the unit
+//------------------------------------------------------------------------------
+static void swtimers_par_run_unit(swtimers_par_job_instance_t * job_p)
+{
+    while (job_p != NULL) {
+        // Take the next job before the call, handler can restart its timer
+        swtimers_par_job_instance_t * next_p = job_p->next_p;
+        job_p->handler_cb(job_p->timer_idx, job_p->arg_1_p, job_p->arg_2_p);
+        job_p = next_p;
+    }
+}
+
+//------------------------------------------------------------------------------
+// Get deque of participant
+//
+// `par_inst_p` - pointer to driver instance
+// `idx`        - index of participant (workers_num - the calling thread)
+//
+// Returns - pointer to deque
+//------------------------------------------------------------------------------
+static swtimers_par_deque_t * swtimers_par_get_deque(swtimers_par_instance_t * par_inst_p, uint32_t idx)
+{
+    return (idx < par_inst_p->workers_num) ? (&par_inst_p->workers_p[idx].deque) : (&par_inst_p->deque);
+}
+
+//------------------------------------------------------------------------------
+// Take unit from bottom of own deque (Chase-Lev)
+//
+// `par_inst_p` - pointer to driver instance
+// `deque_p`    - pointer to deque of the calling participant
+//
+// Returns - pointer to unit or NULL if deque is empty
+//------------------------------------------------------------------------------
+static swtimers_par_job_instance_t * swtimers_par_take(swtimers_par_instance_t * par_inst_p, swtimers_par_deque_t * deque_p)
+{
+    int32_t bottom = atomic_load_explicit(&deque_p->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&deque_p->bottom, bottom, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    int32_t top = atomic_load_explicit(&deque_p->top, memory_order_relaxed);
+
+    if (top > bottom) {
+        atomic_store_explicit(&deque_p->bottom, bottom + 1, memory_order_relaxed);
+        return NULL;
+    }
+
+    swtimers_par_job_instance_t * job_p = par_inst_p->units_pp[bottom];
+
+    // The last unit - race with thieves
+    if (top == bottom) {
+        if (!atomic_compare_exchange_strong_explicit(&deque_p->top, &top, top + 1, memory_order_seq_cst, memory_order_relaxed)) {
+            job_p = NULL;
+        }
+        atomic_store_explicit(&deque_p->bottom, bottom + 1, memory_order_relaxed);
+    }
+
+    return job_p;
+}
+
+//------------------------------------------------------------------------------
+// Steal unit from top of another deque (Chase-Lev)
+//
+// `par_inst_p` - pointer to driver instance
+// `deque_p`    - pointer to deque of victim
+//
+// Returns - pointer to unit or NULL if deque is empty or another thread has taken the unit
+//------------------------------------------------------------------------------
+static swtimers_par_job_instance_t * swtimers_par_steal(swtimers_par_instance_t * par_inst_p, swtimers_par_deque_t * deque_p)
+{
+    int32_t top = atomic_load_explicit(&deque_p->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    int32_t bottom = atomic_load_explicit(&deque_p->bottom, memory_order_acquire);
+
+    if (top >= bottom) {
+        return NULL;
+    }
+
+    swtimers_par_job_instance_t * job_p = par_inst_p->units_pp[top];
+
+    if (!atomic_compare_exchange_strong_explicit(&deque_p->top, &top, top + 1, memory_order_seq_cst, memory_order_relaxed)) {
+        return NULL;
+    }
+
+    return job_p;
+}
+
+//------------------------------------------------------------------------------
+// Call units of own deque, then steal units of other participants until all units are finished
+//
+// `par_inst_p` - pointer to driver instance
+// `self_idx`   - index of the calling participant
+//------------------------------------------------------------------------------
+static void swtimers_par_participate(swtimers_par_instance_t * par_inst_p, uint32_t self_idx)
+{
+    uint32_t participants_num = par_inst_p->workers_num + 1;
+    swtimers_par_deque_t * own_p = swtimers_par_get_deque(par_inst_p, self_idx);
+
+    for (;;) {
+        swtimers_par_job_instance_t * job_p = swtimers_par_take(par_inst_p, own_p);
+
+        for (uint32_t k = 1; (job_p == NULL) && (k < participants_num); ++k) {
+            job_p = swtimers_par_steal(par_inst_p, swtimers_par_get_deque(par_inst_p, (self_idx + k) % participants_num));
+        }
+
+        if (job_p != NULL) {
+            swtimers_par_run_unit(job_p);
+            atomic_fetch_sub_explicit(&par_inst_p->pending, 1, memory_order_acq_rel);
+            continue;
+        }
+
+        // Nothing to steal - the rest of units are being called by other participants
+        if (atomic_load_explicit(&par_inst_p->pending, memory_order_acquire) == 0) {
+            break;
+        }
+        sched_yield();
+    }
+}
+
+//------------------------------------------------------------------------------
+// Stop and join all started workers
+//
+// `par_inst_p` - pointer to driver instance
+//------------------------------------------------------------------------------
+static void swtimers_par_stop_workers(swtimers_par_instance_t * par_inst_p)
+{
+    pthread_mutex_lock(&par_inst_p->lock);
+    par_inst_p->is_stopping = true;
+    pthread_cond_broadcast(&par_inst_p->cond);
+    pthread_mutex_unlock(&par_inst_p->lock);
+
+    for (uint32_t w = 0; w < par_inst_p->workers_num; ++w) {
+        swtimers_par_worker_instance_t * worker_p = &par_inst_p->workers_p[w];
+        if (worker_p->is_started) {
+            pthread_join(worker_p->thread, NULL);
+            worker_p->is_started = false;
+        }
+    }
+
+    pthread_cond_destroy(&par_inst_p->cond);
+    pthread_mutex_destroy(&par_inst_p->lock);
+}
+
+//------------------------------------------------------------------------------
+// Worker thread - take part in each parallel run
+//
+// `arg_p` - pointer to worker instance (with type swtimers_par_worker_instance_t*)
+//
+// Returns - NULL
+//------------------------------------------------------------------------------
+static void * swtimers_par_worker_thread(void * arg_p)
+{
+    swtimers_par_worker_instance_t * worker_p = (swtimers_par_worker_instance_t*)arg_p;
+    swtimers_par_instance_t * par_inst_p = worker_p->inst_p;
+    uint32_t generation = 0;
+
+    pthread_mutex_lock(&par_inst_p->lock);
+    for (;;) {
+        while ((par_inst_p->generation == generation) && (par_inst_p->is_stopping == false)) {
+            pthread_cond_wait(&par_inst_p->cond, &par_inst_p->lock);
+        }
+
+        if (par_inst_p->is_stopping) {
+            break;
+        }
+        generation = par_inst_p->generation;
+        pthread_mutex_unlock(&par_inst_p->lock);
+
+        swtimers_par_participate(par_inst_p, worker_p->idx);
+        atomic_fetch_sub_explicit(&par_inst_p->active, 1, memory_order_release);
+
+        pthread_mutex_lock(&par_inst_p->lock);
+    }
+    pthread_mutex_unlock(&par_inst_p->lock);
+
+    return NULL;
+}
+
+#endif // defined(__linux__)
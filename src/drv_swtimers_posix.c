@@ -0,0 +1,461 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+//**************************************************************************************************
+// POSIX hardware backend for software timers (Linux)
+//**************************************************************************************************
+#if defined(__linux__)
+
+#define _GNU_SOURCE
+
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/timerfd.h>
+#include <sys/eventfd.h>
+
+#include "drv_swtimers_posix.h"
+
+//==================================================================================================
+//========================================== TYPEDEFS ==============================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Driver instance
+//------------------------------------------------------------------------------
+typedef struct swtimers_posix_instance_s {
+
+    // Settings
+    swtimers_hw_interface_t hw;             // interface passed into swtimers_init() (hw_timer_p - pointer to this instance)
+    const swtimers_t*       swtimers_p;     // pointer to software timers driver instance
+    uint64_t                tick_ns;        // one tick in nanoseconds
+    int                     timer_fd;       // tick source
+    int                     event_fd;       // wake-up of application loop
+    bool                    is_tickless;    // 'true' - timerfd is programmed for the nearest expiration
+
+    // State (protected by lock)
+    bool                    is_started;     // 'true' - timerfd is armed by hw_start_cb
+    bool                    is_dirty;       // 'true' - swtimers_isr_ticks() was called in the current critical section
+    uint32_t                depth;          // nesting of critical sections
+    uint64_t                base_ns;        // tickless - time of the last accounted tick
+    uint64_t                armed_ns;       // tickless - deadline programmed into timerfd (0 - disarmed)
+    pthread_mutex_t         lock;           // critical section - recursive, calls from handlers are nested
+
+    // Threads
+    pthread_t               thread;         // tick thread
+    bool                    is_thread;      // 'true' - tick thread is created
+    _Atomic bool            is_signaled;    // 'true' - eventfd is written and not acknowledged yet
+    _Atomic bool            is_stopping;    // 'true' - tick thread should exit
+} swtimers_posix_instance_t;
+
+//------------------------------------------------------------------------------
+// Sanitizing (sizes of system types depend on platform, public size is upper bound)
+//------------------------------------------------------------------------------
+static_assert(sizeof(swtimers_posix_instance_t) <= sizeof(swtimers_posix_t), "Wrong structure size");
+
+//==================================================================================================
+//================================ PRIVATE FUNCTIONS DECLARATIONS ==================================
+//==================================================================================================
+
+static uint64_t swtimers_posix_now_ns(void);
+static void swtimers_posix_arm(swtimers_posix_instance_t * posix_inst_p, uint64_t deadline_ns, uint64_t interval_ns);
+static void swtimers_posix_catch_up(swtimers_posix_instance_t * posix_inst_p);
+static void swtimers_posix_rearm(swtimers_posix_instance_t * posix_inst_p);
+static void swtimers_posix_signal(swtimers_posix_instance_t * posix_inst_p);
+static void swtimers_posix_isr_disable(void * hw_timer_p);
+static void swtimers_posix_isr_enable(void * hw_timer_p);
+static void swtimers_posix_hw_start(void * hw_timer_p);
+static void swtimers_posix_hw_stop(void * hw_timer_p);
+static bool swtimers_posix_hw_is_started(void * hw_timer_p);
+static void * swtimers_posix_thread(void * arg_p);
+
+//==================================================================================================
+//================================ PUBLIC FUNCTIONS DEFINITIONS ====================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Init backend
+//------------------------------------------------------------------------------
+bool swtimers_posix_init(swtimers_posix_t * inst_p, uint32_t tick_ms, bool is_tickless)
+{
+    assert((inst_p != NULL) && (tick_ms > 0));
+    swtimers_posix_instance_t * posix_inst_p = (swtimers_posix_instance_t*)inst_p;
+
+    memset(posix_inst_p, 0x00, sizeof(swtimers_posix_instance_t));
+
+    posix_inst_p->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    posix_inst_p->event_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if ((posix_inst_p->timer_fd < 0) || (posix_inst_p->event_fd < 0)) {
+        if (posix_inst_p->timer_fd >= 0) {
+            close(posix_inst_p->timer_fd);
+        }
+        if (posix_inst_p->event_fd >= 0) {
+            close(posix_inst_p->event_fd);
+        }
+        memset(posix_inst_p, 0x00, sizeof(swtimers_posix_instance_t));
+        return false;
+    }
+
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&posix_inst_p->lock, &attr);
+    pthread_mutexattr_destroy(&attr);
+
+    posix_inst_p->tick_ns = (uint64_t)tick_ms * 1000000u;
+    posix_inst_p->is_tickless = is_tickless;
+    atomic_init(&posix_inst_p->is_signaled, false);
+    atomic_init(&posix_inst_p->is_stopping, false);
+
+    posix_inst_p->hw.hw_timer_p = posix_inst_p;
+    posix_inst_p->hw.isr_enable_cb = &swtimers_posix_isr_enable;
+    posix_inst_p->hw.isr_disable_cb = &swtimers_posix_isr_disable;
+    posix_inst_p->hw.hw_start_cb = &swtimers_posix_hw_start;
+    posix_inst_p->hw.hw_stop_cb = &swtimers_posix_hw_stop;
+    posix_inst_p->hw.hw_is_started_cb = &swtimers_posix_hw_is_started;
+    posix_inst_p->hw.tick_ms = tick_ms;
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+// Deinit backend
+//------------------------------------------------------------------------------
+void swtimers_posix_deinit(swtimers_posix_t * inst_p)
+{
+    assert(inst_p != NULL);
+    swtimers_posix_instance_t * posix_inst_p = (swtimers_posix_instance_t*)inst_p;
+
+    // If not initialized
+    if (posix_inst_p->hw.hw_timer_p == NULL) {
+        return;
+    }
+
+    if (posix_inst_p->is_thread) {
+        // Wake up tick thread blocked on disarmed timerfd
+        atomic_store_explicit(&posix_inst_p->is_stopping, true, memory_order_release);
+        swtimers_posix_arm(posix_inst_p, 1, 0);
+        pthread_join(posix_inst_p->thread, NULL);
+    }
+
+    close(posix_inst_p->timer_fd);
+    close(posix_inst_p->event_fd);
+    pthread_mutex_destroy(&posix_inst_p->lock);
+
+    memset(posix_inst_p, 0x00, sizeof(swtimers_posix_instance_t));
+}
+
+//------------------------------------------------------------------------------
+// Get hardware interface to be passed into swtimers_init()
+//------------------------------------------------------------------------------
+const swtimers_hw_interface_t * swtimers_posix_get_hw_interface(const swtimers_posix_t * inst_p)
+{
+    assert(inst_p != NULL);
+    const swtimers_posix_instance_t * posix_inst_p = (const swtimers_posix_instance_t*)inst_p;
+
+    return &posix_inst_p->hw;
+}
+
+//------------------------------------------------------------------------------
+// Start tick thread
+//------------------------------------------------------------------------------
+bool swtimers_posix_start(const swtimers_posix_t * inst_p, const swtimers_t * swtimers_p)
+{
+    assert((inst_p != NULL) && (swtimers_p != NULL));
+    swtimers_posix_instance_t * posix_inst_p = (swtimers_posix_instance_t*)inst_p;
+    assert(posix_inst_p->is_thread == false);
+
+    pthread_mutex_lock(&posix_inst_p->lock);
+    posix_inst_p->swtimers_p = swtimers_p;
+    pthread_mutex_unlock(&posix_inst_p->lock);
+
+    if (pthread_create(&posix_inst_p->thread, NULL, &swtimers_posix_thread, posix_inst_p) != 0) {
+        return false;
+    }
+    posix_inst_p->is_thread = true;
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+// Get file descriptor to wait for work of swtimers_task()
+//------------------------------------------------------------------------------
+int swtimers_posix_get_fd(const swtimers_posix_t * inst_p)
+{
+    assert(inst_p != NULL);
+    const swtimers_posix_instance_t * posix_inst_p = (const swtimers_posix_instance_t*)inst_p;
+
+    return posix_inst_p->event_fd;
+}
+
+//------------------------------------------------------------------------------
+// Acknowledge wake-up of application loop
+//------------------------------------------------------------------------------
+void swtimers_posix_ack(const swtimers_posix_t * inst_p)
+{
+    assert(inst_p != NULL);
+    swtimers_posix_instance_t * posix_inst_p = (swtimers_posix_instance_t*)inst_p;
+    uint64_t value;
+
+    // Read before clearing the flag - signal raised in between doesn't write eventfd, but its work is done by
+    // the following swtimers_task(), signal raised after clearing writes eventfd again and isn't lost
+    (void)read(posix_inst_p->event_fd, &value, sizeof(value));
+    atomic_store_explicit(&posix_inst_p->is_signaled, false, memory_order_seq_cst);
+}
+
+//==================================================================================================
+//================================ PRIVATE FUNCTIONS DEFINITIONS ===================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Get monotonic time
+//
+// Returns - CLOCK_MONOTONIC time in nanoseconds
+//------------------------------------------------------------------------------
+static uint64_t swtimers_posix_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t)ts.tv_sec * 1000000000u) + (uint64_t)ts.tv_nsec;
+}
+
+//------------------------------------------------------------------------------
+// Program timerfd
+//
+// `posix_inst_p` - pointer to driver instance
+// `deadline_ns`  - absolute CLOCK_MONOTONIC time of the first expiration (0 - disarm)
+// `interval_ns`  - period of the next expirations (0 - one-shot)
+//------------------------------------------------------------------------------
+static void swtimers_posix_arm(swtimers_posix_instance_t * posix_inst_p, uint64_t deadline_ns, uint64_t interval_ns)
+{
+    struct itimerspec its = {
+        .it_interval = { .tv_sec = (time_t)(interval_ns / 1000000000u), .tv_nsec = (long)(interval_ns % 1000000000u) },
+        .it_value    = { .tv_sec = (time_t)(deadline_ns / 1000000000u), .tv_nsec = (long)(deadline_ns % 1000000000u) },
+    };
+
+    timerfd_settime(posix_inst_p->timer_fd, TFD_TIMER_ABSTIME, &its, NULL);
+}
+
+//------------------------------------------------------------------------------
+// Tickless - account ticks passed since the previous call (called under lock)
+//
+// Timers started in the critical section count ticks from now, not from the last expiration of timerfd
+//
+// `posix_inst_p` - pointer to driver instance
+//------------------------------------------------------------------------------
+static void swtimers_posix_catch_up(swtimers_posix_instance_t * posix_inst_p)
+{
+    if ((posix_inst_p->is_started == false) || (posix_inst_p->swtimers_p == NULL)) {
+        return;
+    }
+
+    uint64_t ticks = (swtimers_posix_now_ns() - posix_inst_p->base_ns) / posix_inst_p->tick_ns;
+    if (ticks == 0) {
+        return;
+    }
+
+    ticks = (ticks > UINT32_MAX) ? (UINT32_MAX) : (ticks);
+    posix_inst_p->base_ns += ticks * posix_inst_p->tick_ns;
+    posix_inst_p->is_dirty = true;
+
+    swtimers_isr_ticks(posix_inst_p->swtimers_p, (uint32_t)ticks);
+}
+
+//------------------------------------------------------------------------------
+// Tickless - program timerfd for the nearest expiration (called under lock)
+//
+// `posix_inst_p` - pointer to driver instance
+//------------------------------------------------------------------------------
+static void swtimers_posix_rearm(swtimers_posix_instance_t * posix_inst_p)
+{
+    if ((posix_inst_p->is_started == false) || (posix_inst_p->swtimers_p == NULL)) {
+        return;
+    }
+
+    uint32_t ticks = swtimers_next_expiry_ticks(posix_inst_p->swtimers_p);
+    uint64_t deadline_ns = 0;
+
+    if (ticks != SWTIMERS_NO_EXPIRY) {
+        // Handlers are pending - the nearest expiration is unknown, check at the next tick
+        ticks = (ticks == 0) ? (1) : (ticks);
+        deadline_ns = posix_inst_p->base_ns + ((uint64_t)ticks * posix_inst_p->tick_ns);
+    }
+
+    if (deadline_ns != posix_inst_p->armed_ns) {
+        posix_inst_p->armed_ns = deadline_ns;
+        swtimers_posix_arm(posix_inst_p, deadline_ns, 0);
+    }
+}
+
+//------------------------------------------------------------------------------
+// Wake up application loop if swtimers_task() has work (called under lock)
+//
+// `posix_inst_p` - pointer to driver instance
+//------------------------------------------------------------------------------
+static void swtimers_posix_signal(swtimers_posix_instance_t * posix_inst_p)
+{
+    if (swtimers_next_expiry_ticks(posix_inst_p->swtimers_p) != 0) {
+        return;
+    }
+
+    // Write only once until acknowledge
+    if (atomic_exchange_explicit(&posix_inst_p->is_signaled, true, memory_order_seq_cst) == false) {
+        uint64_t value = 1;
+        (void)write(posix_inst_p->event_fd, &value, sizeof(value));
+    }
+}
+
+//------------------------------------------------------------------------------
+// Callback - Enter critical section
+// Signature corresponds to swtimers_isr_ctrl_cb_t
+//
+// `hw_timer_p` - pointer to driver instance (with type swtimers_posix_instance_t*)
+//------------------------------------------------------------------------------
+static void swtimers_posix_isr_disable(void * hw_timer_p)
+{
+    swtimers_posix_instance_t * posix_inst_p = (swtimers_posix_instance_t*)hw_timer_p;
+
+    pthread_mutex_lock(&posix_inst_p->lock);
+    posix_inst_p->depth++;
+
+    if ((posix_inst_p->depth == 1) && posix_inst_p->is_tickless) {
+        swtimers_posix_catch_up(posix_inst_p);
+    }
+}
+
+//------------------------------------------------------------------------------
+// Callback - Leave critical section
+// Signature corresponds to swtimers_isr_ctrl_cb_t
+//
+// `hw_timer_p` - pointer to driver instance (with type swtimers_posix_instance_t*)
+//------------------------------------------------------------------------------
+static void swtimers_posix_isr_enable(void * hw_timer_p)
+{
+    swtimers_posix_instance_t * posix_inst_p = (swtimers_posix_instance_t*)hw_timer_p;
+
+    if (posix_inst_p->depth == 1) {
+        if (posix_inst_p->is_tickless) {
+            swtimers_posix_rearm(posix_inst_p);
+        }
+
+        if (posix_inst_p->is_dirty) {
+            posix_inst_p->is_dirty = false;
+            swtimers_posix_signal(posix_inst_p);
+        }
+    }
+
+    posix_inst_p->depth--;
+    pthread_mutex_unlock(&posix_inst_p->lock);
+}
+
+//------------------------------------------------------------------------------
+// Callback - Start tick source
+// Signature corresponds to swtimers_hw_ctrl_cb_t
+//
+// `hw_timer_p` - pointer to driver instance (with type swtimers_posix_instance_t*)
+//------------------------------------------------------------------------------
+static void swtimers_posix_hw_start(void * hw_timer_p)
+{
+    swtimers_posix_instance_t * posix_inst_p = (swtimers_posix_instance_t*)hw_timer_p;
+
+    pthread_mutex_lock(&posix_inst_p->lock);
+    if (posix_inst_p->is_started == false) {
+        posix_inst_p->is_started = true;
+        posix_inst_p->base_ns = swtimers_posix_now_ns();
+
+        if (posix_inst_p->is_tickless) {
+            posix_inst_p->armed_ns = 0;
+            swtimers_posix_rearm(posix_inst_p);
+        } else {
+            swtimers_posix_arm(posix_inst_p, posix_inst_p->base_ns + posix_inst_p->tick_ns, posix_inst_p->tick_ns);
+        }
+    }
+    pthread_mutex_unlock(&posix_inst_p->lock);
+}
+
+//------------------------------------------------------------------------------
+// Callback - Stop tick source
+// Signature corresponds to swtimers_hw_ctrl_cb_t
+//
+// `hw_timer_p` - pointer to driver instance (with type swtimers_posix_instance_t*)
+//------------------------------------------------------------------------------
+static void swtimers_posix_hw_stop(void * hw_timer_p)
+{
+    swtimers_posix_instance_t * posix_inst_p = (swtimers_posix_instance_t*)hw_timer_p;
+
+    pthread_mutex_lock(&posix_inst_p->lock);
+
+    // Timer could be started from the tick thread after the check of swtimers driver
+    bool is_idle = (posix_inst_p->swtimers_p == NULL) ||
+                   (swtimers_next_expiry_ticks(posix_inst_p->swtimers_p) == SWTIMERS_NO_EXPIRY);
+
+    if (posix_inst_p->is_started && is_idle) {
+        posix_inst_p->is_started = false;
+        posix_inst_p->armed_ns = 0;
+        swtimers_posix_arm(posix_inst_p, 0, 0);
+    }
+    pthread_mutex_unlock(&posix_inst_p->lock);
+}
+
+//------------------------------------------------------------------------------
+// Callback - Check if tick source is started
+// Signature corresponds to swtimers_hw_is_started_cb_t
+//
+// `hw_timer_p` - pointer to driver instance (with type swtimers_posix_instance_t*)
+//
+// Returns - 'true' if timerfd is armed by hw_start_cb
+//------------------------------------------------------------------------------
+static bool swtimers_posix_hw_is_started(void * hw_timer_p)
+{
+    swtimers_posix_instance_t * posix_inst_p = (swtimers_posix_instance_t*)hw_timer_p;
+
+    pthread_mutex_lock(&posix_inst_p->lock);
+    bool is_started = posix_inst_p->is_started;
+    pthread_mutex_unlock(&posix_inst_p->lock);
+
+    return is_started;
+}
+
+//------------------------------------------------------------------------------
+// Tick thread - acts as interrupt of hardware timer
+//
+// `arg_p` - pointer to driver instance (with type swtimers_posix_instance_t*)
+//
+// Returns - NULL
+//------------------------------------------------------------------------------
+static void * swtimers_posix_thread(void * arg_p)
+{
+    swtimers_posix_instance_t * posix_inst_p = (swtimers_posix_instance_t*)arg_p;
+
+    for (;;) {
+        uint64_t expirations = 0;
+        ssize_t res = read(posix_inst_p->timer_fd, &expirations, sizeof(expirations));
+
+        if (atomic_load_explicit(&posix_inst_p->is_stopping, memory_order_acquire)) {
+            break;
+        }
+
+        if ((res != (ssize_t)sizeof(expirations)) || (expirations == 0)) {
+            continue;
+        }
+
+        // Tickless - elapsed ticks are accounted on entry, timerfd is reprogrammed on exit
+        swtimers_posix_isr_disable(posix_inst_p);
+        if ((posix_inst_p->is_tickless == false) && posix_inst_p->is_started) {
+            expirations = (expirations > UINT32_MAX) ? (UINT32_MAX) : (expirations);
+            posix_inst_p->is_dirty = true;
+            swtimers_isr_ticks(posix_inst_p->swtimers_p, (uint32_t)expirations);
+        }
+        swtimers_posix_isr_enable(posix_inst_p);
+    }
+
+    return NULL;
+}
+
+#endif // defined(__linux__)
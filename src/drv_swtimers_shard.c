@@ -0,0 +1,300 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+//**************************************************************************************************
+// Sharded software timers - one swtimers instance per core/thread with cross-shard mailboxes
+//**************************************************************************************************
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+
+#include "drv_swtimers_shard.h"
+
+//==================================================================================================
+//========================================== TYPEDEFS ==============================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Operation sent to the owner shard
+//------------------------------------------------------------------------------
+typedef enum swtimers_shard_op_e {
+    SWTIMERS_SHARD_OP_START,        // start timer
+    SWTIMERS_SHARD_OP_STOP,         // stop timer
+} swtimers_shard_op_t;
+
+typedef struct swtimers_shard_msg_s {
+    swtimers_handler_cb_t   handler_cb;     // pointer to handler (can be NULL)
+    void*                   arg_1_p;        // pointer to application data to be passed into handler (can be NULL)
+    void*                   arg_2_p;        // pointer to application data to be passed into handler (can be NULL)
+    uint32_t                idx;            // index of timer within the owner shard
+    uint32_t                ms;             // threshold in milliseconds
+    uint8_t                 op;             // operation (swtimers_shard_op_t)
+    uint8_t                 mode;           // timer mode (swtimers_mode_t)
+    uint8_t                 align[2];
+} swtimers_shard_msg_t;
+
+//------------------------------------------------------------------------------
+// Settings of the last start of timer
+//------------------------------------------------------------------------------
+typedef struct swtimers_shard_timer_instance_s {
+    swtimers_handler_cb_t   handler_cb;     // pointer to handler (can be NULL)
+    void*                   arg_1_p;        // pointer to application data to be passed into handler (can be NULL)
+    void*                   arg_2_p;        // pointer to application data to be passed into handler (can be NULL)
+    uint32_t                ms;             // threshold in milliseconds
+    uint8_t                 mode;           // timer mode (swtimers_mode_t)
+} swtimers_shard_timer_instance_t;
+
+//------------------------------------------------------------------------------
+// Single shard
+//------------------------------------------------------------------------------
+typedef struct swtimers_shard_slot_instance_s {
+    mpsc_t                              mailbox;        // operations from other shards
+    const swtimers_t*                   swtimers_p;     // timers owned by the shard
+    swtimers_shard_timer_instance_t*    timers_p;       // settings of timers
+    uint32_t                            num;            // number of timers
+} swtimers_shard_slot_instance_t;
+
+//------------------------------------------------------------------------------
+// Driver instance
+//------------------------------------------------------------------------------
+typedef struct swtimers_shard_instance_s {
+    swtimers_shard_slot_instance_t*     slots_p;        // array of shards
+    uint32_t                            shards_num;     // number of shards
+} swtimers_shard_instance_t;
+
+//------------------------------------------------------------------------------
+// Sanitizing
+//------------------------------------------------------------------------------
+static_assert(sizeof(swtimers_shard_msg_t) <= (SWTIMERS_SHARD_MAILBOX_CELL_SIZE - MPSC_CELL_SIZE(0)), "Wrong structure size");
+static_assert(sizeof(swtimers_shard_timer_instance_t) == sizeof(swtimers_shard_timer_t), "Wrong structure size");
+static_assert(sizeof(swtimers_shard_slot_instance_t) == sizeof(swtimers_shard_slot_t), "Wrong structure size");
+static_assert(sizeof(swtimers_shard_instance_t) == sizeof(swtimers_shard_t), "Wrong structure size");
+
+//==================================================================================================
+//============================== PRIVATE FUNCTIONS DECLARATIONS ====================================
+//==================================================================================================
+
+static swtimers_shard_slot_instance_t * swtimers_shard_get_slot(const swtimers_shard_t * inst_p, uint32_t shard);
+static void swtimers_shard_apply_start(swtimers_shard_slot_instance_t * slot_p, uint32_t idx, uint32_t ms,
+                                       swtimers_mode_t mode, swtimers_handler_cb_t handler_cb, void * arg_1_p, void * arg_2_p);
+
+//==================================================================================================
+//================================ PUBLIC FUNCTIONS DEFINITIONS ====================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Init driver
+//------------------------------------------------------------------------------
+void swtimers_shard_init(swtimers_shard_t * inst_p, swtimers_shard_slot_t * slots_table_p, uint32_t shards_num)
+{
+    assert((inst_p != NULL) && (slots_table_p != NULL));
+    assert((shards_num > 0) && (shards_num <= SWTIMERS_SHARD_MAX));
+
+    swtimers_shard_instance_t * shard_inst_p = (swtimers_shard_instance_t*)inst_p;
+
+    memset(slots_table_p, 0x00, sizeof(swtimers_shard_slot_t) * shards_num);
+
+    shard_inst_p->slots_p = (swtimers_shard_slot_instance_t*)slots_table_p;
+    shard_inst_p->shards_num = shards_num;
+}
+
+//------------------------------------------------------------------------------
+// Attach swtimers instance and mailbox to shard
+//------------------------------------------------------------------------------
+void swtimers_shard_attach(const swtimers_shard_t * inst_p, uint32_t shard, const swtimers_t * swtimers_p,
+                           swtimers_shard_timer_t * timers_table_p, uint32_t num, void * cells_p, uint32_t cells_num)
+{
+    assert((swtimers_p != NULL) && (timers_table_p != NULL) && (cells_p != NULL));
+    assert((num > 0) && (num <= (SWTIMERS_SHARD_GET_IDX(UINT32_MAX) + 1)));
+
+    swtimers_shard_slot_instance_t * slot_p = swtimers_shard_get_slot(inst_p, shard);
+
+    memset(timers_table_p, 0x00, sizeof(swtimers_shard_timer_t) * num);
+
+    slot_p->swtimers_p = swtimers_p;
+    slot_p->timers_p = (swtimers_shard_timer_instance_t*)timers_table_p;
+    slot_p->num = num;
+
+    mpsc_init(&slot_p->mailbox, cells_p, cells_num, sizeof(swtimers_shard_msg_t));
+}
+
+//------------------------------------------------------------------------------
+// Start timer
+//------------------------------------------------------------------------------
+bool swtimers_shard_start(const swtimers_shard_t * inst_p, uint32_t self_shard, uint32_t handle, uint32_t ms,
+                          swtimers_mode_t mode, swtimers_handler_cb_t handler_cb, void * arg_1_p, void * arg_2_p)
+{
+    swtimers_shard_slot_instance_t * slot_p = swtimers_shard_get_slot(inst_p, SWTIMERS_SHARD_GET_SHARD(handle));
+    uint32_t idx = SWTIMERS_SHARD_GET_IDX(handle);
+    assert(idx < slot_p->num);
+
+    // Fast path - timer is owned by the calling shard
+    if (SWTIMERS_SHARD_GET_SHARD(handle) == self_shard) {
+        swtimers_shard_apply_start(slot_p, idx, ms, mode, handler_cb, arg_1_p, arg_2_p);
+        return true;
+    }
+
+    swtimers_shard_msg_t msg = {
+        .handler_cb = handler_cb,
+        .arg_1_p = arg_1_p,
+        .arg_2_p = arg_2_p,
+        .idx = idx,
+        .ms = ms,
+        .op = (uint8_t)SWTIMERS_SHARD_OP_START,
+        .mode = (uint8_t)mode,
+    };
+
+    return mpsc_push(&slot_p->mailbox, &msg);
+}
+
+//------------------------------------------------------------------------------
+// Stop timer
+//------------------------------------------------------------------------------
+bool swtimers_shard_stop(const swtimers_shard_t * inst_p, uint32_t self_shard, uint32_t handle)
+{
+    swtimers_shard_slot_instance_t * slot_p = swtimers_shard_get_slot(inst_p, SWTIMERS_SHARD_GET_SHARD(handle));
+    uint32_t idx = SWTIMERS_SHARD_GET_IDX(handle);
+    assert(idx < slot_p->num);
+
+    // Fast path - timer is owned by the calling shard
+    if (SWTIMERS_SHARD_GET_SHARD(handle) == self_shard) {
+        swtimers_stop(slot_p->swtimers_p, idx);
+        return true;
+    }
+
+    swtimers_shard_msg_t msg = {
+        .idx = idx,
+        .op = (uint8_t)SWTIMERS_SHARD_OP_STOP,
+    };
+
+    return mpsc_push(&slot_p->mailbox, &msg);
+}
+
+//------------------------------------------------------------------------------
+// Move timer owned by the calling shard to another shard
+//------------------------------------------------------------------------------
+uint32_t swtimers_shard_migrate(const swtimers_shard_t * inst_p, uint32_t self_shard, uint32_t handle,
+                                uint32_t dst_shard, uint32_t dst_idx)
+{
+    assert(SWTIMERS_SHARD_GET_SHARD(handle) == self_shard);
+
+    swtimers_shard_slot_instance_t * slot_p = swtimers_shard_get_slot(inst_p, self_shard);
+    swtimers_shard_slot_instance_t * dst_slot_p = swtimers_shard_get_slot(inst_p, dst_shard);
+    uint32_t idx = SWTIMERS_SHARD_GET_IDX(handle);
+    uint32_t new_handle = SWTIMERS_SHARD_HANDLE(dst_shard, dst_idx);
+    assert((idx < slot_p->num) && (dst_idx < dst_slot_p->num));
+
+    const swtimers_shard_timer_instance_t * timer_p = &slot_p->timers_p[idx];
+    swtimers_mode_t mode = (swtimers_mode_t)timer_p->mode;
+    uint32_t elapsed_ms = 0;
+
+    // Stopped timer - nothing to start in the destination shard
+    if (swtimers_is_run(slot_p->swtimers_p, idx, &elapsed_ms) == false) {
+        return new_handle;
+    }
+
+    // Single shot timer keeps the remaining time, periodic timer starts a new period
+    uint32_t ms = timer_p->ms;
+    if ((mode == SWTIMERS_MODE_SINGLE_FROM_ISR) || (mode == SWTIMERS_MODE_SINGLE_FROM_LOOP)) {
+        ms = (elapsed_ms < ms) ? (ms - elapsed_ms) : (0);
+    }
+
+    if (dst_shard == self_shard) {
+        swtimers_stop(slot_p->swtimers_p, idx);
+        swtimers_shard_apply_start(slot_p, dst_idx, ms, mode, timer_p->handler_cb, timer_p->arg_1_p, timer_p->arg_2_p);
+        return new_handle;
+    }
+
+    swtimers_shard_msg_t msg = {
+        .handler_cb = timer_p->handler_cb,
+        .arg_1_p = timer_p->arg_1_p,
+        .arg_2_p = timer_p->arg_2_p,
+        .idx = dst_idx,
+        .ms = ms,
+        .op = (uint8_t)SWTIMERS_SHARD_OP_START,
+        .mode = (uint8_t)mode,
+    };
+
+    // Timer stays in the calling shard if the destination mailbox is full
+    if (mpsc_push(&dst_slot_p->mailbox, &msg) == false) {
+        return handle;
+    }
+
+    swtimers_stop(slot_p->swtimers_p, idx);
+
+    return new_handle;
+}
+
+//------------------------------------------------------------------------------
+// Check if timer owned by the calling shard is run
+//------------------------------------------------------------------------------
+bool swtimers_shard_is_run(const swtimers_shard_t * inst_p, uint32_t self_shard, uint32_t handle)
+{
+    assert(SWTIMERS_SHARD_GET_SHARD(handle) == self_shard);
+
+    swtimers_shard_slot_instance_t * slot_p = swtimers_shard_get_slot(inst_p, self_shard);
+    uint32_t elapsed_ms;
+
+    return swtimers_is_run(slot_p->swtimers_p, SWTIMERS_SHARD_GET_IDX(handle), &elapsed_ms);
+}
+
+//------------------------------------------------------------------------------
+// Apply operations received from other shards and process timers of the shard
+//------------------------------------------------------------------------------
+void swtimers_shard_task(const swtimers_shard_t * inst_p, uint32_t self_shard)
+{
+    swtimers_shard_slot_instance_t * slot_p = swtimers_shard_get_slot(inst_p, self_shard);
+    swtimers_shard_msg_t msg;
+
+    // Apply at most `num` operations - senders can't starve the shard, the rest is applied by the next call
+    for (uint32_t cnt = 0; cnt < slot_p->num; ++cnt) {
+        if (mpsc_pop(&slot_p->mailbox, &msg) == false) {
+            break;
+        }
+
+        assert(msg.idx < slot_p->num);
+
+        if (msg.op == (uint8_t)SWTIMERS_SHARD_OP_START) {
+            swtimers_shard_apply_start(slot_p, msg.idx, msg.ms, (swtimers_mode_t)msg.mode,
+                                       msg.handler_cb, msg.arg_1_p, msg.arg_2_p);
+        }
+        else {
+            swtimers_stop(slot_p->swtimers_p, msg.idx);
+        }
+    }
+
+    swtimers_task(slot_p->swtimers_p);
+}
+
+//==================================================================================================
+//=============================== PRIVATE FUNCTIONS DEFINITIONS ====================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Get shard by index
+//------------------------------------------------------------------------------
+static swtimers_shard_slot_instance_t * swtimers_shard_get_slot(const swtimers_shard_t * inst_p, uint32_t shard)
+{
+    assert(inst_p != NULL);
+    const swtimers_shard_instance_t * shard_inst_p = (const swtimers_shard_instance_t*)inst_p;
+    assert(shard < shard_inst_p->shards_num);
+
+    return &shard_inst_p->slots_p[shard];
+}
+
+//------------------------------------------------------------------------------
+// Remember settings and start timer of the calling shard
+//------------------------------------------------------------------------------
+static void swtimers_shard_apply_start(swtimers_shard_slot_instance_t * slot_p, uint32_t idx, uint32_t ms,
+                                       swtimers_mode_t mode, swtimers_handler_cb_t handler_cb, void * arg_1_p, void * arg_2_p)
+{
+    swtimers_shard_timer_instance_t * timer_p = &slot_p->timers_p[idx];
+
+    timer_p->handler_cb = handler_cb;
+    timer_p->arg_1_p = arg_1_p;
+    timer_p->arg_2_p = arg_2_p;
+    timer_p->ms = ms;
+    timer_p->mode = (uint8_t)mode;
+
+    swtimers_start(slot_p->swtimers_p, idx, ms, mode, handler_cb, arg_1_p, arg_2_p);
+}
@@ -0,0 +1,166 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+//**************************************************************************************************
+// Binary event trace ring buffer
+//**************************************************************************************************
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+#include <stdatomic.h>
+
+#include "drv_trace.h"
+
+//==================================================================================================
+//=========================================== MACROS ===============================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Gap between records which requires TRACE_EVT_SYNC record (decoder unwraps signed 16-bit deltas)
+//------------------------------------------------------------------------------
+#define TRACE_SYNC_GAP (0x8000u)
+
+//==================================================================================================
+//========================================== TYPEDEFS ==============================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Driver instance
+//------------------------------------------------------------------------------
+typedef struct trace_instance_s {
+    trace_record_t*         records_p;      // pointer to array of records
+    trace_timestamp_cb_t    timestamp_cb;   // read timestamp callback
+    void*                   timestamp_p;    // pointer to timestamp source (can be NULL)
+    uint32_t                mask;           // number of records - 1
+    _Atomic uint32_t        head;           // number of reserved records
+    volatile uint32_t       last_time;      // timestamp of the last record
+    uint32_t                read_pos;       // position of the next record to be read by trace_read()
+} trace_instance_t;
+
+//------------------------------------------------------------------------------
+// Sanitizing
+//------------------------------------------------------------------------------
+static_assert(sizeof(trace_record_t) == 8, "Wrong structure size");
+static_assert(sizeof(trace_instance_t) == sizeof(trace_t), "Wrong structure size");
+
+//==================================================================================================
+//================================ PRIVATE FUNCTIONS DECLARATIONS ==================================
+//==================================================================================================
+
+static void trace_write(trace_instance_t * trace_inst_p, uint32_t time, trace_event_t event, uint32_t idx, uint8_t arg, uint32_t ext);
+
+//==================================================================================================
+//================================ PUBLIC FUNCTIONS DEFINITIONS ====================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Init trace
+//------------------------------------------------------------------------------
+void trace_init(trace_t * inst_p, trace_record_t * records_p, uint32_t size, trace_timestamp_cb_t timestamp_cb, void * timestamp_p)
+{
+    assert((inst_p != NULL) && (records_p != NULL) && (timestamp_cb != NULL));
+    assert((size > 0) && ((size & (size - 1)) == 0));
+
+    trace_instance_t * trace_inst_p = (trace_instance_t*)inst_p;
+
+    memset(trace_inst_p, 0x00, sizeof(trace_instance_t));
+    memset(records_p, 0x00, size * sizeof(trace_record_t));
+
+    trace_inst_p->records_p = records_p;
+    trace_inst_p->timestamp_cb = timestamp_cb;
+    trace_inst_p->timestamp_p = timestamp_p;
+    trace_inst_p->mask = size - 1;
+    atomic_init(&trace_inst_p->head, 0);
+
+    uint32_t time = timestamp_cb(timestamp_p);
+    trace_write(trace_inst_p, time, TRACE_EVT_SYNC, time >> 16, 0, 0);
+}
+
+//------------------------------------------------------------------------------
+// Add record
+//------------------------------------------------------------------------------
+void trace_record(const trace_t * inst_p, trace_event_t event, uint32_t idx, uint8_t arg, uint32_t ext)
+{
+    if (inst_p == NULL) {
+        return;
+    }
+
+    trace_instance_t * trace_inst_p = (trace_instance_t*)inst_p;
+    uint32_t time = trace_inst_p->timestamp_cb(trace_inst_p->timestamp_p);
+
+    // Concurrent writers can insert extra synchronization, it is harmless
+    if ((uint32_t)(time - trace_inst_p->last_time) >= TRACE_SYNC_GAP) {
+        trace_write(trace_inst_p, time, TRACE_EVT_SYNC, time >> 16, 0, 0);
+    }
+
+    trace_write(trace_inst_p, time, event, idx, arg, ext);
+}
+
+//------------------------------------------------------------------------------
+// Get number of records written since init
+//------------------------------------------------------------------------------
+uint32_t trace_get_head(const trace_t * inst_p)
+{
+    assert(inst_p != NULL);
+    trace_instance_t * trace_inst_p = (trace_instance_t*)inst_p;
+
+    return atomic_load_explicit(&trace_inst_p->head, memory_order_acquire);
+}
+
+//------------------------------------------------------------------------------
+// Read new records
+//------------------------------------------------------------------------------
+uint32_t trace_read(const trace_t * inst_p, trace_record_t * out_p, uint32_t max_num, uint32_t * lost_out_p)
+{
+    assert((inst_p != NULL) && (out_p != NULL));
+    trace_instance_t * trace_inst_p = (trace_instance_t*)inst_p;
+
+    uint32_t head = atomic_load_explicit(&trace_inst_p->head, memory_order_acquire);
+    uint32_t lost = 0;
+
+    // Skip overwritten records
+    if ((head - trace_inst_p->read_pos) > (trace_inst_p->mask + 1)) {
+        lost = head - trace_inst_p->read_pos - (trace_inst_p->mask + 1);
+        trace_inst_p->read_pos = head - (trace_inst_p->mask + 1);
+    }
+
+    uint32_t num = 0;
+    while ((num < max_num) && (trace_inst_p->read_pos != head)) {
+        out_p[num++] = trace_inst_p->records_p[trace_inst_p->read_pos & trace_inst_p->mask];
+        trace_inst_p->read_pos++;
+    }
+
+    if (lost_out_p != NULL) {
+        *lost_out_p = lost;
+    }
+
+    return num;
+}
+
+//==================================================================================================
+//================================ PRIVATE FUNCTIONS DEFINITIONS ===================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Reserve slot and write record
+//
+// `trace_inst_p` - pointer to driver instance
+// `time`         - timestamp
+// `event`        - event type
+// `idx`          - index of timer/LED/button
+// `arg`          - small argument
+// `ext`          - payload
+//------------------------------------------------------------------------------
+static void trace_write(trace_instance_t * trace_inst_p, uint32_t time, trace_event_t event, uint32_t idx, uint8_t arg, uint32_t ext)
+{
+    uint32_t pos = atomic_fetch_add_explicit(&trace_inst_p->head, 1, memory_order_relaxed);
+    trace_record_t * record_p = &trace_inst_p->records_p[pos & trace_inst_p->mask];
+
+    record_p->time = (uint16_t)time;
+    record_p->event = (uint8_t)event;
+    record_p->arg = arg;
+    record_p->idx = (uint16_t)idx;
+    record_p->ext = (uint16_t)((ext < TRACE_EXT_MAX) ? (ext) : (TRACE_EXT_MAX));
+
+    trace_inst_p->last_time = time;
+}
@@ -0,0 +1,192 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+//**************************************************************************************************
+// Work queue driver - deferring work from ISR context to application loop
+//**************************************************************************************************
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+
+#include "drv_workqueue.h"
+
+//==================================================================================================
+//========================================== TYPEDEFS ==============================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Single work item structure
+//------------------------------------------------------------------------------
+typedef struct workqueue_item_instance_s {
+    workqueue_handler_cb_t  handler_cb;     // pointer to handler
+    void*                   arg_1_p;        // pointer to application data to be passed into handler (can be NULL)
+    void*                   arg_2_p;        // pointer to application data to be passed into handler (can be NULL)
+} workqueue_item_instance_t;
+
+//------------------------------------------------------------------------------
+// Ring of work items with the same priority
+//------------------------------------------------------------------------------
+typedef struct workqueue_ring_s {
+    uint16_t                head;           // index of the oldest posted item within the ring
+    uint16_t                count;          // number of posted items
+} workqueue_ring_t;
+
+//------------------------------------------------------------------------------
+// Driver instance
+//------------------------------------------------------------------------------
+typedef struct workqueue_instance_s {
+    const workqueue_hw_interface_t*     hw_p;                       // pointer to hardware interface
+    volatile workqueue_item_instance_t* items_table_p;              // pointer to array of work items (rings follow each other)
+    uint32_t                            num;                        // number of work items for each priority level
+    volatile workqueue_ring_t           rings[WORKQUEUE_PRIO_NUM];  // rings of work items
+} workqueue_instance_t;
+
+//------------------------------------------------------------------------------
+// Sanitizing
+//------------------------------------------------------------------------------
+static_assert(sizeof(workqueue_item_instance_t) == sizeof(workqueue_item_t), "Wrong structure size");
+static_assert(sizeof(workqueue_instance_t) == sizeof(workqueue_t), "Wrong structure size");
+
+//==================================================================================================
+//================================ PUBLIC FUNCTIONS DEFINITIONS ====================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Init driver
+//------------------------------------------------------------------------------
+void workqueue_init(workqueue_t * inst_p, const workqueue_hw_interface_t * hw_interface_p, uint32_t num,
+                    volatile workqueue_item_t * items_table_p)
+{
+    assert((inst_p != NULL) && (hw_interface_p != NULL) && (num > 0) && (num <= UINT16_MAX) && (items_table_p != NULL));
+    assert((hw_interface_p->isr_disable_cb != NULL) && (hw_interface_p->isr_enable_cb != NULL));
+
+    workqueue_instance_t * workqueue_inst_p = (workqueue_instance_t*)inst_p;
+
+    memset(workqueue_inst_p, 0x00, sizeof(workqueue_instance_t));
+
+    workqueue_inst_p->hw_p = hw_interface_p;
+    workqueue_inst_p->items_table_p = (volatile workqueue_item_instance_t*)items_table_p;
+    workqueue_inst_p->num = num;
+
+    memset((workqueue_item_instance_t*)workqueue_inst_p->items_table_p, 0x00, WORKQUEUE_PRIO_NUM * num * sizeof(workqueue_item_instance_t));
+}
+
+//------------------------------------------------------------------------------
+// Deinit driver
+//------------------------------------------------------------------------------
+void workqueue_deinit(workqueue_t * inst_p)
+{
+    assert(inst_p != NULL);
+    workqueue_instance_t * workqueue_inst_p = (workqueue_instance_t*)inst_p;
+
+    // If not initialized
+    if (workqueue_inst_p->num == 0) {
+        return;
+    }
+
+    memset((workqueue_item_instance_t*)workqueue_inst_p->items_table_p, 0x00, WORKQUEUE_PRIO_NUM * workqueue_inst_p->num * sizeof(workqueue_item_instance_t));
+    memset(workqueue_inst_p, 0x00, sizeof(workqueue_instance_t));
+}
+
+//------------------------------------------------------------------------------
+// Post work item
+//------------------------------------------------------------------------------
+bool workqueue_post(const workqueue_t * inst_p, workqueue_prio_t prio, workqueue_handler_cb_t handler_cb,
+                    void * arg_1_p, void * arg_2_p)
+{
+    assert((inst_p != NULL) && (prio < WORKQUEUE_PRIO_NUM) && (handler_cb != NULL));
+    workqueue_instance_t * workqueue_inst_p = (workqueue_instance_t*)inst_p;
+    volatile workqueue_ring_t * ring_p = &(workqueue_inst_p->rings[prio]);
+    const workqueue_hw_interface_t * hw_p = workqueue_inst_p->hw_p;
+    bool is_posted = false;
+
+    // Critical section - reserve and fill item
+    hw_p->isr_disable_cb(hw_p->hw_p);
+    if (ring_p->count < workqueue_inst_p->num) {
+        uint32_t pos = ring_p->head + ring_p->count;
+        if (pos >= workqueue_inst_p->num) {
+            pos -= workqueue_inst_p->num;
+        }
+
+        volatile workqueue_item_instance_t * item_p = &(workqueue_inst_p->items_table_p[(prio * workqueue_inst_p->num) + pos]);
+        item_p->handler_cb = handler_cb;
+        item_p->arg_1_p = arg_1_p;
+        item_p->arg_2_p = arg_2_p;
+
+        ring_p->count++;
+        is_posted = true;
+    }
+    hw_p->isr_enable_cb(hw_p->hw_p);
+
+    return is_posted;
+}
+
+//------------------------------------------------------------------------------
+// Check if there are no posted work items
+//------------------------------------------------------------------------------
+bool workqueue_is_empty(const workqueue_t * inst_p)
+{
+    assert(inst_p != NULL);
+    const workqueue_instance_t * workqueue_inst_p = (const workqueue_instance_t*)inst_p;
+
+    for (size_t prio = 0; prio < WORKQUEUE_PRIO_NUM; ++prio) {
+        if (workqueue_inst_p->rings[prio].count != 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+// Call handlers of posted work items
+//------------------------------------------------------------------------------
+void workqueue_task(const workqueue_t * inst_p)
+{
+    assert(inst_p != NULL);
+    workqueue_instance_t * workqueue_inst_p = (workqueue_instance_t*)inst_p;
+    const workqueue_hw_interface_t * hw_p = workqueue_inst_p->hw_p;
+
+    // Critical section - get number of items posted before the call
+    hw_p->isr_disable_cb(hw_p->hw_p);
+    uint32_t budget = 0;
+    for (size_t prio = 0; prio < WORKQUEUE_PRIO_NUM; ++prio) {
+        budget += workqueue_inst_p->rings[prio].count;
+    }
+    hw_p->isr_enable_cb(hw_p->hw_p);
+
+    while (budget != 0) {
+        budget--;
+
+        workqueue_handler_cb_t handler_cb = NULL;
+        void * arg_1_p = NULL;
+        void * arg_2_p = NULL;
+
+        // Critical section - take the oldest item with the highest priority
+        hw_p->isr_disable_cb(hw_p->hw_p);
+        for (size_t prio = 0; prio < WORKQUEUE_PRIO_NUM; ++prio) {
+            volatile workqueue_ring_t * ring_p = &(workqueue_inst_p->rings[prio]);
+            if (ring_p->count == 0) {
+                continue;
+            }
+
+            volatile workqueue_item_instance_t * item_p = &(workqueue_inst_p->items_table_p[(prio * workqueue_inst_p->num) + ring_p->head]);
+            handler_cb = item_p->handler_cb;
+            arg_1_p = item_p->arg_1_p;
+            arg_2_p = item_p->arg_2_p;
+
+            uint32_t head = ring_p->head + 1u;
+            ring_p->head = (head == workqueue_inst_p->num) ? (0) : ((uint16_t)head);
+            ring_p->count--;
+            break;
+        }
+        hw_p->isr_enable_cb(hw_p->hw_p);
+
+        // If all items are already processed
+        if (handler_cb == NULL) {
+            break;
+        }
+
+        handler_cb(arg_1_p, arg_2_p);
+    }
+}
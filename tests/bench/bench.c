@@ -0,0 +1,505 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+//**************************************************************************************************
+// Host microbenchmarks for hot paths of swtimers, leds and buttons drivers
+//**************************************************************************************************
+// Each benchmark is run for every table size N = 1 .. 100000 (decades) and every fraction of
+// active timers/LEDs/buttons (0%, 1%, 10%, 100%), results are ns/op and cycles/op
+//
+// Usage: drv_bench [--csv] [--max-n=N] [--min-ms=MS]
+//  --csv      - CSV output instead of JSON
+//  --max-n    - the largest table size (default 100000)
+//  --min-ms   - minimal measurement time of one result in milliseconds (default 20)
+//
+// Cycles are read with TSC on x86, on other platforms cycles/op is 0
+//**************************************************************************************************
+#define _POSIX_C_SOURCE 200809L
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "drv_swtimers.h"
+#include "drv_leds.h"
+#include "drv_buttons.h"
+
+//==================================================================================================
+//=========================================== MACROS ===============================================
+//==================================================================================================
+
+#define BENCH_MAX_N_DEFAULT     (100000)
+#define BENCH_MIN_MS_DEFAULT    (20)
+#define BENCH_LONG_MS           (0x7FFFFFFFu)
+
+//==================================================================================================
+//========================================== TYPEDEFS ==============================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Context of one measurement - drivers with N items, `active_num` of them are active
+//------------------------------------------------------------------------------
+typedef struct bench_ctx_s {
+    uint32_t                n;              // size of tables
+    uint32_t                active_num;     // number of active items
+    uint64_t                pos;            // position of round-robin operations
+
+    swtimers_t              swtimers_inst;
+    swtimers_timer_t*       timers_p;
+    leds_t                  leds_inst;
+    leds_led_t*             leds_p;
+    buttons_t               buttons_inst;
+    buttons_button_t*       buttons_p;
+    uint8_t*                pins_p;         // virtual GPIO
+    uint64_t                handler_cnt;    // number of handlers calls
+} bench_ctx_t;
+
+//------------------------------------------------------------------------------
+// Benchmark - setup drivers, run `iters` operations, free tables
+//------------------------------------------------------------------------------
+typedef struct bench_case_s {
+    const char*     name_p;                                     // name of benchmark
+    void            (*setup_cb)(bench_ctx_t * ctx_p);           // init drivers and start active items
+    void            (*run_cb)(bench_ctx_t * ctx_p, uint64_t iters);
+    void            (*teardown_cb)(bench_ctx_t * ctx_p);
+} bench_case_t;
+
+//==================================================================================================
+//================================ PRIVATE FUNCTIONS DECLARATIONS ==================================
+//==================================================================================================
+
+static void bench_measure(const bench_case_t * case_p, uint32_t n, uint32_t active_pct, uint32_t min_ms, bool is_csv, bool is_first);
+static uint64_t bench_ns(void);
+static uint64_t bench_cycles(void);
+
+static void bench_swtimers_setup(bench_ctx_t * ctx_p);
+static void bench_swtimers_setup_busy(bench_ctx_t * ctx_p);
+static void bench_swtimers_teardown(bench_ctx_t * ctx_p);
+static void bench_swtimers_isr_run(bench_ctx_t * ctx_p, uint64_t iters);
+static void bench_swtimers_task_run(bench_ctx_t * ctx_p, uint64_t iters);
+static void bench_swtimers_tick_run(bench_ctx_t * ctx_p, uint64_t iters);
+static void bench_swtimers_start_stop_run(bench_ctx_t * ctx_p, uint64_t iters);
+static void bench_leds_setup(bench_ctx_t * ctx_p);
+static void bench_leds_setup_busy(bench_ctx_t * ctx_p);
+static void bench_leds_teardown(bench_ctx_t * ctx_p);
+static void bench_leds_blink_run(bench_ctx_t * ctx_p, uint64_t iters);
+static void bench_buttons_setup(bench_ctx_t * ctx_p);
+static void bench_buttons_teardown(bench_ctx_t * ctx_p);
+static void bench_buttons_task_run(bench_ctx_t * ctx_p, uint64_t iters);
+
+static void bench_handler(uint32_t timer_idx, void * arg_1_p, void * arg_2_p);
+static void bench_isr_ctrl(void * hw_p);
+static void bench_hw_start(void * hw_p);
+static void bench_hw_stop(void * hw_p);
+static bool bench_hw_is_started(void * hw_p);
+static void bench_gpio_write(void * hw_gpio_p, uint32_t pin_idx, uint8_t pin_state);
+static void bench_gpio_toggle(void * hw_gpio_p, uint32_t pin_idx);
+static bool bench_gpio_read(void * hw_gpio_p, uint32_t pin_idx);
+
+//==================================================================================================
+//==================================== PRIVATE STATIC DATA =========================================
+//==================================================================================================
+
+static bool bench_is_hw_started;
+static bench_ctx_t bench_ctx;
+
+static const swtimers_hw_interface_t bench_swtimers_hw = {
+    .hw_timer_p = NULL,
+    .isr_enable_cb = bench_isr_ctrl,
+    .isr_disable_cb = bench_isr_ctrl,
+    .hw_start_cb = bench_hw_start,
+    .hw_stop_cb = bench_hw_stop,
+    .hw_is_started_cb = bench_hw_is_started,
+    .tick_ms = 1
+};
+
+static const leds_hw_interface_t bench_leds_hw = {
+    .hw_gpio_p = &bench_ctx,
+    .gpio_write = bench_gpio_write,
+    .gpio_toggle = bench_gpio_toggle,
+};
+
+static const buttons_hw_interface_t bench_buttons_hw = {
+    .hw_gpio_p = &bench_ctx,
+    .isr_enable_cb = bench_isr_ctrl,
+    .isr_disable_cb = bench_isr_ctrl,
+    .gpio_read = bench_gpio_read,
+};
+
+//------------------------------------------------------------------------------
+// Benchmarks
+//  swtimers_isr        - one swtimers_isr() call, active timers are counting and don't expire
+//  swtimers_task       - one swtimers_task() call without expired timers
+//  swtimers_tick       - swtimers_isr() + swtimers_task(), all active timers expire and call handlers
+//  swtimers_start_stop - swtimers_start() + swtimers_stop() of inactive timer
+//  leds_blink_ext      - leds_blink_ext() call, active LEDs are blinking
+//  leds_tick           - swtimers_isr() + swtimers_task(), all active LEDs are switched by leds_processing()
+//  buttons_task        - buttons_task() call, pins of active buttons are bouncing
+//------------------------------------------------------------------------------
+static const bench_case_t bench_cases[] = {
+    { "swtimers_isr",        bench_swtimers_setup,      bench_swtimers_isr_run,        bench_swtimers_teardown },
+    { "swtimers_task",       bench_swtimers_setup,      bench_swtimers_task_run,       bench_swtimers_teardown },
+    { "swtimers_tick",       bench_swtimers_setup_busy, bench_swtimers_tick_run,       bench_swtimers_teardown },
+    { "swtimers_start_stop", bench_swtimers_setup,      bench_swtimers_start_stop_run, bench_swtimers_teardown },
+    { "leds_blink_ext",      bench_leds_setup,          bench_leds_blink_run,          bench_leds_teardown },
+    { "leds_tick",           bench_leds_setup_busy,     bench_swtimers_tick_run,       bench_leds_teardown },
+    { "buttons_task",        bench_buttons_setup,       bench_buttons_task_run,        bench_buttons_teardown },
+};
+
+static const uint32_t bench_active_pcts[] = { 0, 1, 10, 100 };
+
+//==================================================================================================
+//================================ PUBLIC FUNCTIONS DEFINITIONS ====================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Run all benchmarks
+//------------------------------------------------------------------------------
+int main(int argc, char * argv[])
+{
+    bool is_csv = false;
+    uint32_t max_n = BENCH_MAX_N_DEFAULT;
+    uint32_t min_ms = BENCH_MIN_MS_DEFAULT;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--csv") == 0) {
+            is_csv = true;
+        }
+        else if (strncmp(argv[i], "--max-n=", 8) == 0) {
+            max_n = (uint32_t)strtoul(argv[i] + 8, NULL, 10);
+        }
+        else if (strncmp(argv[i], "--min-ms=", 9) == 0) {
+            min_ms = (uint32_t)strtoul(argv[i] + 9, NULL, 10);
+        }
+        else {
+            fprintf(stderr, "Usage: %s [--csv] [--max-n=N] [--min-ms=MS]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (is_csv) {
+        printf("bench,n,active_pct,iters,ns_per_op,cycles_per_op\n");
+    }
+    else {
+        printf("{\n  \"suite\": \"common_drivers\",\n  \"pointer_bits\": %u,\n  \"results\": [\n", (unsigned)(8 * sizeof(void*)));
+    }
+
+    bool is_first = true;
+    for (size_t c = 0; c < sizeof(bench_cases) / sizeof(bench_cases[0]); ++c) {
+        for (uint32_t n = 1; n <= max_n; n *= 10) {
+            for (size_t a = 0; a < sizeof(bench_active_pcts) / sizeof(bench_active_pcts[0]); ++a) {
+                // 1% of a small table is the same as 0% or 10%
+                if ((n * bench_active_pcts[a] < 100) && (bench_active_pcts[a] != 0) && (bench_active_pcts[a] != 100)) {
+                    continue;
+                }
+                bench_measure(&bench_cases[c], n, bench_active_pcts[a], min_ms, is_csv, is_first);
+                is_first = false;
+            }
+        }
+    }
+
+    if (is_csv == false) {
+        printf("\n  ]\n}\n");
+    }
+
+    return 0;
+}
+
+//==================================================================================================
+//================================ PRIVATE FUNCTIONS DEFINITIONS ===================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Measure one benchmark - drivers are set up once, number of operations is doubled until
+// measurement takes `min_ms`
+//------------------------------------------------------------------------------
+static void bench_measure(const bench_case_t * case_p, uint32_t n, uint32_t active_pct, uint32_t min_ms, bool is_csv, bool is_first)
+{
+    bench_ctx_t * ctx_p = &bench_ctx;
+    uint64_t iters = 1;
+    uint64_t ns;
+    uint64_t cycles;
+
+    memset(ctx_p, 0x00, sizeof(bench_ctx_t));
+    ctx_p->n = n;
+    ctx_p->active_num = (uint32_t)(((uint64_t)n * active_pct) / 100);
+    case_p->setup_cb(ctx_p);
+
+    // Warm-up
+    case_p->run_cb(ctx_p, 1);
+
+    for (;;) {
+        uint64_t ns_start = bench_ns();
+        uint64_t cycles_start = bench_cycles();
+        case_p->run_cb(ctx_p, iters);
+        cycles = bench_cycles() - cycles_start;
+        ns = bench_ns() - ns_start;
+
+        if ((ns >= (uint64_t)min_ms * 1000000u) || (iters >= (1ull << 40))) {
+            break;
+        }
+        iters *= 2;
+    }
+
+    case_p->teardown_cb(ctx_p);
+
+    double ns_per_op = (double)ns / (double)iters;
+    double cycles_per_op = (double)cycles / (double)iters;
+
+    if (is_csv) {
+        printf("%s,%u,%u,%llu,%.3f,%.3f\n", case_p->name_p, (unsigned)n, (unsigned)active_pct,
+               (unsigned long long)iters, ns_per_op, cycles_per_op);
+    }
+    else {
+        printf("%s    { \"bench\": \"%s\", \"n\": %u, \"active_pct\": %u, \"iters\": %llu, \"ns_per_op\": %.3f, \"cycles_per_op\": %.3f }",
+               (is_first) ? "" : ",\n", case_p->name_p, (unsigned)n, (unsigned)active_pct,
+               (unsigned long long)iters, ns_per_op, cycles_per_op);
+    }
+    fflush(stdout);
+}
+
+//------------------------------------------------------------------------------
+// Monotonic time in nanoseconds
+//------------------------------------------------------------------------------
+static uint64_t bench_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000u) + (uint64_t)ts.tv_nsec;
+}
+
+//------------------------------------------------------------------------------
+// CPU cycles (TSC on x86, 0 otherwise)
+//------------------------------------------------------------------------------
+static uint64_t bench_cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+//------------------------------------------------------------------------------
+// swtimers - active timers are started with long period
+//------------------------------------------------------------------------------
+static void bench_swtimers_setup(bench_ctx_t * ctx_p)
+{
+    bench_is_hw_started = false;
+    ctx_p->timers_p = calloc(ctx_p->n, sizeof(swtimers_timer_t));
+    assert(ctx_p->timers_p != NULL);
+
+    swtimers_init(&ctx_p->swtimers_inst, &bench_swtimers_hw, ctx_p->n, ctx_p->timers_p);
+
+    // The last timer is kept for start/stop benchmark
+    uint32_t active_num = (ctx_p->active_num < ctx_p->n) ? (ctx_p->active_num) : (ctx_p->n - 1);
+    for (uint32_t i = 0; i < active_num; ++i) {
+        swtimers_start(&ctx_p->swtimers_inst, i, BENCH_LONG_MS, SWTIMERS_MODE_PERIODIC_FROM_LOOP, bench_handler, ctx_p, NULL);
+    }
+}
+
+//------------------------------------------------------------------------------
+// swtimers - active timers expire every tick
+//------------------------------------------------------------------------------
+static void bench_swtimers_setup_busy(bench_ctx_t * ctx_p)
+{
+    bench_is_hw_started = false;
+    ctx_p->timers_p = calloc(ctx_p->n, sizeof(swtimers_timer_t));
+    assert(ctx_p->timers_p != NULL);
+
+    swtimers_init(&ctx_p->swtimers_inst, &bench_swtimers_hw, ctx_p->n, ctx_p->timers_p);
+
+    for (uint32_t i = 0; i < ctx_p->active_num; ++i) {
+        swtimers_start(&ctx_p->swtimers_inst, i, 1, SWTIMERS_MODE_PERIODIC_FROM_LOOP, bench_handler, ctx_p, NULL);
+    }
+}
+
+//------------------------------------------------------------------------------
+// Tables are just freed - deinit functions stop items one by one and are quadratic on large tables
+//------------------------------------------------------------------------------
+static void bench_swtimers_teardown(bench_ctx_t * ctx_p)
+{
+    free(ctx_p->timers_p);
+}
+
+static void bench_swtimers_isr_run(bench_ctx_t * ctx_p, uint64_t iters)
+{
+    for (uint64_t i = 0; i < iters; ++i) {
+        swtimers_isr(&ctx_p->swtimers_inst);
+    }
+}
+
+static void bench_swtimers_task_run(bench_ctx_t * ctx_p, uint64_t iters)
+{
+    for (uint64_t i = 0; i < iters; ++i) {
+        swtimers_task(&ctx_p->swtimers_inst);
+    }
+}
+
+static void bench_swtimers_tick_run(bench_ctx_t * ctx_p, uint64_t iters)
+{
+    for (uint64_t i = 0; i < iters; ++i) {
+        swtimers_isr(&ctx_p->swtimers_inst);
+        swtimers_task(&ctx_p->swtimers_inst);
+    }
+}
+
+static void bench_swtimers_start_stop_run(bench_ctx_t * ctx_p, uint64_t iters)
+{
+    uint32_t idx = ctx_p->n - 1;
+
+    for (uint64_t i = 0; i < iters; ++i) {
+        swtimers_start(&ctx_p->swtimers_inst, idx, BENCH_LONG_MS, SWTIMERS_MODE_SINGLE_FROM_LOOP, bench_handler, ctx_p, NULL);
+        swtimers_stop(&ctx_p->swtimers_inst, idx);
+    }
+}
+
+//------------------------------------------------------------------------------
+// leds - each LED uses own timer, active LEDs are blinking
+//------------------------------------------------------------------------------
+static void bench_leds_setup(bench_ctx_t * ctx_p)
+{
+    bench_is_hw_started = false;
+    ctx_p->timers_p = calloc(ctx_p->n, sizeof(swtimers_timer_t));
+    ctx_p->leds_p = calloc(ctx_p->n, sizeof(leds_led_t));
+    ctx_p->pins_p = calloc(ctx_p->n, sizeof(uint8_t));
+    assert((ctx_p->timers_p != NULL) && (ctx_p->leds_p != NULL) && (ctx_p->pins_p != NULL));
+
+    swtimers_init(&ctx_p->swtimers_inst, &bench_swtimers_hw, ctx_p->n, ctx_p->timers_p);
+    leds_init(&ctx_p->leds_inst, &bench_leds_hw, ctx_p->n, ctx_p->leds_p, &ctx_p->swtimers_inst);
+
+    for (uint32_t i = 0; i < ctx_p->n; ++i) {
+        leds_set_pin(&ctx_p->leds_inst, i, i, i, true);
+    }
+    for (uint32_t i = 0; i < ctx_p->active_num; ++i) {
+        leds_meander(&ctx_p->leds_inst, i, BENCH_LONG_MS / 2);
+    }
+}
+
+//------------------------------------------------------------------------------
+// leds - active LEDs are switched every tick
+//------------------------------------------------------------------------------
+static void bench_leds_setup_busy(bench_ctx_t * ctx_p)
+{
+    uint32_t active_num = ctx_p->active_num;
+
+    ctx_p->active_num = 0;
+    bench_leds_setup(ctx_p);
+    ctx_p->active_num = active_num;
+
+    for (uint32_t i = 0; i < ctx_p->active_num; ++i) {
+        leds_meander(&ctx_p->leds_inst, i, 1);
+    }
+}
+
+static void bench_leds_teardown(bench_ctx_t * ctx_p)
+{
+    free(ctx_p->timers_p);
+    free(ctx_p->leds_p);
+    free(ctx_p->pins_p);
+}
+
+static void bench_leds_blink_run(bench_ctx_t * ctx_p, uint64_t iters)
+{
+    for (uint64_t i = 0; i < iters; ++i) {
+        leds_blink_ext(&ctx_p->leds_inst, (uint32_t)(ctx_p->pos++ % ctx_p->n), 2, 100, 100, 1000, 0, false);
+    }
+}
+
+//------------------------------------------------------------------------------
+// buttons - all buttons are polled, pins of active buttons change every call
+// (index of timer is 8-bit, so buttons of large tables share timers)
+//------------------------------------------------------------------------------
+static void bench_buttons_setup(bench_ctx_t * ctx_p)
+{
+    static const buttons_time_settings_t times = {
+        .bouncing_ms = 20,
+        .double_click_ms = 300,
+        .hold_ms = 1000,
+    };
+
+    bench_is_hw_started = false;
+    ctx_p->timers_p = calloc(ctx_p->n, sizeof(swtimers_timer_t));
+    ctx_p->buttons_p = calloc(ctx_p->n, sizeof(buttons_button_t));
+    ctx_p->pins_p = calloc(ctx_p->n, sizeof(uint8_t));
+    assert((ctx_p->timers_p != NULL) && (ctx_p->buttons_p != NULL) && (ctx_p->pins_p != NULL));
+
+    swtimers_init(&ctx_p->swtimers_inst, &bench_swtimers_hw, ctx_p->n, ctx_p->timers_p);
+    buttons_init(&ctx_p->buttons_inst, &bench_buttons_hw, ctx_p->n, ctx_p->buttons_p, &ctx_p->swtimers_inst);
+
+    for (uint32_t i = 0; i < ctx_p->n; ++i) {
+        buttons_configure(&ctx_p->buttons_inst, i, i, (uint8_t)i, false, BUTTONS_CHECK_IN_POLLING, &times, NULL, NULL);
+    }
+}
+
+static void bench_buttons_teardown(bench_ctx_t * ctx_p)
+{
+    free(ctx_p->timers_p);
+    free(ctx_p->buttons_p);
+    free(ctx_p->pins_p);
+}
+
+static void bench_buttons_task_run(bench_ctx_t * ctx_p, uint64_t iters)
+{
+    for (uint64_t i = 0; i < iters; ++i) {
+        for (uint32_t b = 0; b < ctx_p->active_num; ++b) {
+            ctx_p->pins_p[b] ^= 1;
+        }
+        buttons_task(&ctx_p->buttons_inst);
+    }
+}
+
+//------------------------------------------------------------------------------
+// Stubs of hardware and handlers
+//------------------------------------------------------------------------------
+static void bench_handler(uint32_t timer_idx, void * arg_1_p, void * arg_2_p)
+{
+    (void)timer_idx;
+    (void)arg_2_p;
+    ((bench_ctx_t*)arg_1_p)->handler_cnt++;
+}
+
+static void bench_isr_ctrl(void * hw_p)
+{
+    (void)hw_p;
+}
+
+static void bench_hw_start(void * hw_p)
+{
+    (void)hw_p;
+    bench_is_hw_started = true;
+}
+
+static void bench_hw_stop(void * hw_p)
+{
+    (void)hw_p;
+    bench_is_hw_started = false;
+}
+
+static bool bench_hw_is_started(void * hw_p)
+{
+    (void)hw_p;
+    return bench_is_hw_started;
+}
+
+static void bench_gpio_write(void * hw_gpio_p, uint32_t pin_idx, uint8_t pin_state)
+{
+    ((bench_ctx_t*)hw_gpio_p)->pins_p[pin_idx] = pin_state;
+}
+
+static void bench_gpio_toggle(void * hw_gpio_p, uint32_t pin_idx)
+{
+    ((bench_ctx_t*)hw_gpio_p)->pins_p[pin_idx] ^= 1;
+}
+
+static bool bench_gpio_read(void * hw_gpio_p, uint32_t pin_idx)
+{
+    return (((bench_ctx_t*)hw_gpio_p)->pins_p[pin_idx] != 0);
+}
@@ -0,0 +1,329 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+//**************************************************************************************************
+// TESTS for buttons driver, run on virtual-time simulation of hardware
+//**************************************************************************************************
+
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+
+#include "drv_buttons.h"
+#include "sim.h"
+
+//==================================================================================================
+//============================================ TESTS ===============================================
+//==================================================================================================
+
+//-----------------------------------------------------------------------------
+// Additional test functions
+//-----------------------------------------------------------------------------
+static int32_t buttons_test_cycle_1(uint32_t cycle, buttons_check_t check_type);
+static int32_t buttons_test_cycle_2(uint32_t cycle, buttons_check_t check_type);
+static int32_t buttons_test_cycle_3(uint32_t cycle, buttons_check_t check_type);
+static int32_t buttons_test_cycle_4(uint32_t cycle);
+
+static void buttons_test_setup(uint32_t buttons_num, buttons_check_t check_type, const sim_record_t * wave_p, uint32_t wave_num);
+static void buttons_test_teardown(void);
+static int32_t buttons_test_events_check(const uint32_t * times_p, const buttons_event_t * events_p, uint32_t num);
+static void buttons_test_handler(uint32_t button_idx, buttons_event_t event, void * arg_p);
+static void buttons_test_input(void * arg_p, uint32_t pin_idx, uint8_t pin_state);
+static void buttons_test_loop(void * arg_p);
+
+//-----------------------------------------------------------------------------
+// Additional test data
+//-----------------------------------------------------------------------------
+#define BUTTONS_TEST_BUTTONS_NUM    (100)
+#define BUTTONS_TEST_EVENTS_NUM     (16)
+#define BUTTONS_TEST_CLICKS_NUM     (360)
+#define BUTTONS_TEST_WAVE_NUM       (BUTTONS_TEST_BUTTONS_NUM * BUTTONS_TEST_CLICKS_NUM * 2)
+
+static const buttons_time_settings_t test_times = {
+    .bouncing_ms = 20,
+    .double_click_ms = 300,
+    .hold_ms = 1000,
+};
+
+// Simulation
+static sim_t test_sim;
+static sim_pin_t test_pins[BUTTONS_TEST_BUTTONS_NUM];
+static sim_record_t test_wave[BUTTONS_TEST_WAVE_NUM];
+
+// Instances
+static swtimers_t test_swtimers_inst;
+static swtimers_timer_t test_timers[BUTTONS_TEST_BUTTONS_NUM];
+static buttons_t test_inst;
+static buttons_button_t test_buttons[BUTTONS_TEST_BUTTONS_NUM];
+
+// Events
+static uint8_t test_app_data;
+static uint32_t test_events_cnt;
+static uint32_t test_events_times[BUTTONS_TEST_EVENTS_NUM];
+static buttons_event_t test_events[BUTTONS_TEST_EVENTS_NUM];
+static uint32_t test_button_events_cnt[BUTTONS_TEST_BUTTONS_NUM];
+
+//-----------------------------------------------------------------------------
+// Run unit-tests
+//-----------------------------------------------------------------------------
+int32_t buttons_tests(void)
+{
+    int32_t res;
+
+    // Test cycles 1 .. 3 - polling and ISR
+    for (uint32_t i = 0; i < 2; i++) {
+        buttons_check_t check_type = (i == 0) ? BUTTONS_CHECK_IN_POLLING : BUTTONS_CHECK_IN_ISR;
+
+        res = buttons_test_cycle_1(1000 + 100 * i, check_type); // res 1000 - 1999
+        if (res != 0) {
+            return res;
+        }
+
+        res = buttons_test_cycle_2(2000 + 100 * i, check_type); // res 2000 - 2999
+        if (res != 0) {
+            return res;
+        }
+
+        res = buttons_test_cycle_3(3000 + 100 * i, check_type); // res 3000 - 3999
+        if (res != 0) {
+            return res;
+        }
+    }
+
+    // Test cycle 4
+    res = buttons_test_cycle_4(4000); // res 4000 - 4999
+    if (res != 0) {
+        return res;
+    }
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Test cycle 1 - bouncing filter, single click
+//-----------------------------------------------------------------------------
+static int32_t buttons_test_cycle_1(uint32_t cycle, buttons_check_t check_type)
+{
+    static const sim_record_t wave[] = {
+        { .time_ms = 100, .pin_state = 1 }, { .time_ms = 103, .pin_state = 0 }, { .time_ms = 105, .pin_state = 1 },
+        { .time_ms = 400, .pin_state = 0 }, { .time_ms = 402, .pin_state = 1 }, { .time_ms = 404, .pin_state = 0 },
+    };
+    static const uint32_t times[] = { 125, 424 };
+    static const buttons_event_t events[] = { BUTTONS_PRESSED, BUTTONS_RELEASED };
+    int32_t res;
+
+    buttons_test_setup(1, check_type, wave, sizeof(wave) / sizeof(wave[0]));
+
+    // TEST - bouncing press
+    sim_run(&test_sim, 110, buttons_test_loop, NULL);
+    // CHECK - raw state is changed, state after filter isn't changed
+    if ((buttons_is_pressed_raw(&test_inst, 0) != true) || (buttons_is_pressed(&test_inst, 0) != false) || (test_events_cnt != 0)) {
+        return cycle + 10;
+    }
+
+    // TEST - click
+    sim_run(&test_sim, 2000, buttons_test_loop, NULL);
+    // CHECK
+    res = buttons_test_events_check(times, events, sizeof(times) / sizeof(times[0]));
+    if (res != 0) {
+        return cycle + 20 + res;
+    }
+    if ((buttons_is_pressed(&test_inst, 0) != false) || buttons_is_idle(&test_inst) != (check_type == BUTTONS_CHECK_IN_ISR)) {
+        return cycle + 30;
+    }
+
+    // CHECK - each raw edge is counted, bouncing is filtered out of events
+    buttons_stats_t stats;
+    buttons_get_stats(&test_inst, &stats, true);
+    if ((stats.edges != 6) || (stats.events != 2)) {
+        return cycle + 40;
+    }
+    buttons_get_stats(&test_inst, &stats, false);
+    if ((stats.edges != 0) || (stats.events != 0)) {
+        return cycle + 50;
+    }
+
+    buttons_test_teardown();
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Test cycle 2 - hold
+//-----------------------------------------------------------------------------
+static int32_t buttons_test_cycle_2(uint32_t cycle, buttons_check_t check_type)
+{
+    static const sim_record_t wave[] = {
+        { .time_ms = 100, .pin_state = 1 }, { .time_ms = 2000, .pin_state = 0 },
+    };
+    static const uint32_t times[] = { 120, 1120, 2020 };
+    static const buttons_event_t events[] = { BUTTONS_PRESSED, BUTTONS_HOLD, BUTTONS_RELEASED };
+    int32_t res;
+
+    buttons_test_setup(1, check_type, wave, sizeof(wave) / sizeof(wave[0]));
+
+    // TEST - long press
+    sim_run(&test_sim, 3000, buttons_test_loop, NULL);
+    // CHECK
+    res = buttons_test_events_check(times, events, sizeof(times) / sizeof(times[0]));
+    if (res != 0) {
+        return cycle + 10 + res;
+    }
+
+    buttons_test_teardown();
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Test cycle 3 - double click, then two independent clicks
+//-----------------------------------------------------------------------------
+static int32_t buttons_test_cycle_3(uint32_t cycle, buttons_check_t check_type)
+{
+    static const sim_record_t wave[] = {
+        { .time_ms = 100, .pin_state = 1 }, { .time_ms = 200, .pin_state = 0 },
+        { .time_ms = 350, .pin_state = 1 }, { .time_ms = 450, .pin_state = 0 },
+        { .time_ms = 2000, .pin_state = 1 }, { .time_ms = 2100, .pin_state = 0 },
+        { .time_ms = 2500, .pin_state = 1 }, { .time_ms = 2600, .pin_state = 0 },
+    };
+    static const uint32_t times[] = { 120, 220, 370, 470, 2020, 2120, 2520, 2620 };
+    static const buttons_event_t events[] = {
+        BUTTONS_PRESSED, BUTTONS_RELEASED, BUTTONS_PRESSED | BUTTONS_DOUBLE, BUTTONS_RELEASED,
+        BUTTONS_PRESSED, BUTTONS_RELEASED, BUTTONS_PRESSED, BUTTONS_RELEASED,
+    };
+    int32_t res;
+
+    buttons_test_setup(1, check_type, wave, sizeof(wave) / sizeof(wave[0]));
+
+    // TEST - clicks
+    sim_run(&test_sim, 3000, buttons_test_loop, NULL);
+    // CHECK
+    res = buttons_test_events_check(times, events, sizeof(times) / sizeof(times[0]));
+    if (res != 0) {
+        return cycle + 10 + res;
+    }
+
+    buttons_test_teardown();
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Test cycle 4 - one hour of device time with many buttons clicked every 10 seconds
+//-----------------------------------------------------------------------------
+static int32_t buttons_test_cycle_4(uint32_t cycle)
+{
+    // Click of button `i` starts at 50 * i milliseconds of each 10 seconds and lasts 25 milliseconds
+    uint32_t pos = 0;
+    for (uint32_t k = 0; k < BUTTONS_TEST_CLICKS_NUM; k++) {
+        for (uint32_t i = 0; i < BUTTONS_TEST_BUTTONS_NUM; i++) {
+            uint64_t time_ms = (10000ull * k) + (50ull * i) + 1;
+            test_wave[pos++] = (sim_record_t){ .time_ms = time_ms, .pin_idx = i, .pin_state = 1 };
+            test_wave[pos++] = (sim_record_t){ .time_ms = time_ms + 25, .pin_idx = i, .pin_state = 0 };
+        }
+    }
+
+    buttons_test_setup(BUTTONS_TEST_BUTTONS_NUM, BUTTONS_CHECK_IN_POLLING, test_wave, BUTTONS_TEST_WAVE_NUM);
+
+    // TEST - clicks
+    sim_run(&test_sim, 10000ull * BUTTONS_TEST_CLICKS_NUM, buttons_test_loop, NULL);
+    // CHECK - "press" and "release" of each click
+    for (uint32_t i = 0; i < BUTTONS_TEST_BUTTONS_NUM; i++) {
+        if (test_button_events_cnt[i] != 2 * BUTTONS_TEST_CLICKS_NUM) {
+            return cycle + 10;
+        }
+    }
+    // CHECK - time jumps between edges and timeouts only
+    if (test_sim.steps_cnt > 4ull * BUTTONS_TEST_WAVE_NUM) {
+        return cycle + 20;
+    }
+
+    buttons_test_teardown();
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Init simulation and drivers, button `i` uses GPIO pin `i` and timer `i`
+//-----------------------------------------------------------------------------
+static void buttons_test_setup(uint32_t buttons_num, buttons_check_t check_type, const sim_record_t * wave_p, uint32_t wave_num)
+{
+    assert(buttons_num <= BUTTONS_TEST_BUTTONS_NUM);
+
+    test_events_cnt = 0;
+    memset(test_button_events_cnt, 0x00, sizeof(test_button_events_cnt));
+
+    sim_init(&test_sim, 1, test_pins, buttons_num, NULL, 0);
+    sim_set_waveform(&test_sim, wave_p, wave_num, buttons_test_input, NULL);
+    swtimers_init(&test_swtimers_inst, sim_get_swtimers_hw(&test_sim), buttons_num, test_timers);
+    sim_attach_swtimers(&test_sim, &test_swtimers_inst);
+    buttons_init(&test_inst, sim_get_buttons_hw(&test_sim), buttons_num, test_buttons, &test_swtimers_inst);
+
+    for (uint32_t i = 0; i < buttons_num; i++) {
+        buttons_configure(&test_inst, i, i, (uint8_t)i, false, check_type, &test_times, buttons_test_handler, &test_app_data);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Deinit drivers
+//-----------------------------------------------------------------------------
+static void buttons_test_teardown(void)
+{
+    buttons_deinit(&test_inst);
+    swtimers_deinit(&test_swtimers_inst);
+}
+
+//-----------------------------------------------------------------------------
+// Check events of button 0 and moments of virtual time when they are generated
+//-----------------------------------------------------------------------------
+static int32_t buttons_test_events_check(const uint32_t * times_p, const buttons_event_t * events_p, uint32_t num)
+{
+    if (test_events_cnt != num) {
+        return 1;
+    }
+
+    for (uint32_t i = 0; i < num; i++) {
+        if (test_events[i] != events_p[i]) {
+            return 2;
+        }
+        if (test_events_times[i] != times_p[i]) {
+            return 3;
+        }
+    }
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static void buttons_test_handler(uint32_t button_idx, buttons_event_t event, void * arg_p)
+{
+    (void)arg_p;
+    assert((arg_p == &test_app_data) && (button_idx < BUTTONS_TEST_BUTTONS_NUM));
+
+    test_button_events_cnt[button_idx]++;
+
+    if ((button_idx == 0) && (test_events_cnt < BUTTONS_TEST_EVENTS_NUM)) {
+        test_events_times[test_events_cnt] = (uint32_t)sim_get_time_ms(&test_sim);
+        test_events[test_events_cnt] = event;
+        test_events_cnt++;
+    }
+}
+
+//-----------------------------------------------------------------------------
+// GPIO interrupt - passes changes into buttons checked in ISR
+//-----------------------------------------------------------------------------
+static void buttons_test_input(void * arg_p, uint32_t pin_idx, uint8_t pin_state)
+{
+    (void)arg_p;
+    buttons_isr(&test_inst, pin_idx, pin_state != 0);
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static void buttons_test_loop(void * arg_p)
+{
+    (void)arg_p;
+    swtimers_task(&test_swtimers_inst);
+    buttons_task(&test_inst);
+}
@@ -0,0 +1,307 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+//**************************************************************************************************
+// TESTS for cyclic executive, run on virtual-time simulation of hardware
+//**************************************************************************************************
+
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+
+#include "drv_cyclic.h"
+#include "sim.h"
+
+//==================================================================================================
+//============================================ TESTS ===============================================
+//==================================================================================================
+
+//-----------------------------------------------------------------------------
+// Additional test functions
+//-----------------------------------------------------------------------------
+static int32_t cyclic_test_cycle_1(uint32_t cycle);
+static int32_t cyclic_test_cycle_2(uint32_t cycle);
+static int32_t cyclic_test_cycle_3(uint32_t cycle);
+
+static void cyclic_test_task(void * arg_p);
+static void cyclic_test_overrun(uint32_t overrun_cnt, uint32_t frame_idx, void * arg_p);
+static bool cyclic_test_setup(void);
+static void cyclic_test_teardown(void);
+static void cyclic_test_loop(void * arg_p);
+
+//-----------------------------------------------------------------------------
+// Additional test data
+//-----------------------------------------------------------------------------
+#define CYCLIC_TEST_TASKS_NUM   (3)
+#define CYCLIC_TEST_FRAMES_NUM  (4)
+#define CYCLIC_TEST_CALLS_NUM   (16)
+
+// Task ids are passed as arguments of tasks
+static const uint8_t test_ids[CYCLIC_TEST_TASKS_NUM] = { 0, 1, 2 };
+
+// A - 10 ms, B - 20 ms with offset 5 ms, C - 20 ms
+// Minor frame = 5 ms, hyperperiod = 20 ms
+static const cyclic_task_t test_tasks[CYCLIC_TEST_TASKS_NUM] = {
+    { .task_cb = cyclic_test_task, .arg_p = (void*)&test_ids[0], .period_ms = 10, .offset_ms = 0, .budget_us = 2000 },
+    { .task_cb = cyclic_test_task, .arg_p = (void*)&test_ids[1], .period_ms = 20, .offset_ms = 5, .budget_us = 5000 },
+    { .task_cb = cyclic_test_task, .arg_p = (void*)&test_ids[2], .period_ms = 20, .offset_ms = 0, .budget_us = 3000 },
+};
+
+// Coprime periods - hyperperiod exceeds UINT32_MAX ms
+static const cyclic_task_t test_long_tasks[CYCLIC_TEST_TASKS_NUM] = {
+    { .task_cb = cyclic_test_task, .arg_p = (void*)&test_ids[0], .period_ms = 65521, .offset_ms = 0, .budget_us = 0 },
+    { .task_cb = cyclic_test_task, .arg_p = (void*)&test_ids[1], .period_ms = 65519, .offset_ms = 0, .budget_us = 0 },
+    { .task_cb = cyclic_test_task, .arg_p = (void*)&test_ids[2], .period_ms = 65537, .offset_ms = 0, .budget_us = 0 },
+};
+
+// Simulation
+static sim_t test_sim;
+static sim_pin_t test_pins[1];
+
+// Instances
+static swtimers_t test_swtimers_inst;
+static swtimers_timer_t test_timers[1];
+static cyclic_t test_inst;
+static uint32_t test_frames[CYCLIC_TEST_FRAMES_NUM + 1];
+
+// Calls of tasks - id and virtual time
+static uint8_t test_calls_ids[CYCLIC_TEST_CALLS_NUM];
+static uint32_t test_calls_times[CYCLIC_TEST_CALLS_NUM];
+static uint32_t test_calls_cnt;
+
+// Overrun reports
+static uint8_t test_app_data;
+static uint32_t test_reports_cnt;
+static uint32_t test_report_overruns;
+static uint32_t test_report_frame_idx;
+
+//-----------------------------------------------------------------------------
+// Run unit-tests
+//-----------------------------------------------------------------------------
+int32_t cyclic_tests(void)
+{
+    int32_t res;
+
+    // Test cycle 1
+    res = cyclic_test_cycle_1(1000); // res 1000 - 1999
+    if (res != 0) {
+        return res;
+    }
+
+    // Test cycle 2
+    res = cyclic_test_cycle_2(2000); // res 2000 - 2999
+    if (res != 0) {
+        return res;
+    }
+
+    // Test cycle 3
+    res = cyclic_test_cycle_3(3000); // res 3000 - 3999
+    if (res != 0) {
+        return res;
+    }
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Test cycle 1 - frames table and order of releases
+//-----------------------------------------------------------------------------
+static int32_t cyclic_test_cycle_1(uint32_t cycle)
+{
+    static const uint32_t frames[CYCLIC_TEST_FRAMES_NUM] = { 0x05, 0x02, 0x01, 0x00 };
+    static const uint8_t ids[] = { 0, 2, 1, 0, 0, 2, 1, 0, 0, 2 };
+    static const uint32_t times[] = { 0, 0, 5, 10, 20, 20, 25, 30, 40, 40 };
+    uint32_t minor_ms;
+    uint32_t frames_num;
+
+    if (!cyclic_test_setup()) {
+        return cycle + 5;
+    }
+
+    // CHECK - schedule
+    cyclic_get_schedule(&test_inst, &minor_ms, &frames_num);
+    if ((minor_ms != 5) || (frames_num != CYCLIC_TEST_FRAMES_NUM) || (memcmp(test_frames, frames, sizeof(frames)) != 0)) {
+        return cycle + 10;
+    }
+    // CHECK - frames table isn't written beyond the schedule
+    if (test_frames[CYCLIC_TEST_FRAMES_NUM] != UINT32_MAX) {
+        return cycle + 20;
+    }
+
+    // TEST - two hyperperiods, tasks of the same frame are called in order of the tasks table
+    cyclic_start(&test_inst);
+    sim_run(&test_sim, 44, cyclic_test_loop, NULL);
+    // CHECK
+    if ((test_calls_cnt != sizeof(ids)) || (memcmp(test_calls_ids, ids, sizeof(ids)) != 0) ||
+        (memcmp(test_calls_times, times, sizeof(times)) != 0)) {
+        return cycle + 30;
+    }
+    // CHECK
+    if ((cyclic_get_overruns(&test_inst) != 0) || (test_reports_cnt != 0)) {
+        return cycle + 40;
+    }
+
+    // TEST - released frame is dropped on stop
+    sim_run(&test_sim, 1, NULL, NULL);
+    cyclic_stop(&test_inst);
+    sim_run(&test_sim, 100, cyclic_test_loop, NULL);
+    // CHECK
+    if ((test_calls_cnt != sizeof(ids)) || (swtimers_is_run(&test_swtimers_inst, 0, NULL) != false)) {
+        return cycle + 50;
+    }
+
+    cyclic_test_teardown();
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Test cycle 2 - overruns
+//-----------------------------------------------------------------------------
+static int32_t cyclic_test_cycle_2(uint32_t cycle)
+{
+    if (!cyclic_test_setup()) {
+        return cycle + 5;
+    }
+    cyclic_start(&test_inst);
+
+    // TEST - application loop is blocked for 4 frames
+    sim_run(&test_sim, 20, NULL, NULL);
+    // CHECK - frames 1, 2, 3 replaced not finished frames, frame 0 replaced empty frame 3
+    if ((cyclic_get_overruns(&test_inst) != 3) || (test_calls_cnt != 0) || (test_reports_cnt != 0)) {
+        return cycle + 10;
+    }
+
+    // TEST - application loop is unblocked
+    cyclic_task(&test_inst);
+    // CHECK - overruns are reported once, only the last released frame is called
+    if ((test_reports_cnt != 1) || (test_report_overruns != 3) || (test_report_frame_idx != 3) ||
+        (test_calls_cnt != 2) || (test_calls_ids[0] != 0) || (test_calls_ids[1] != 2)) {
+        return cycle + 20;
+    }
+
+    // TEST - loop in time
+    sim_run(&test_sim, 40, cyclic_test_loop, NULL);
+    // CHECK - no new overruns
+    if ((cyclic_get_overruns(&test_inst) != 3) || (test_reports_cnt != 1) || (test_calls_cnt != 2 + 8)) {
+        return cycle + 30;
+    }
+
+    // TEST - restart resets overruns
+    cyclic_start(&test_inst);
+    // CHECK
+    if (cyclic_get_overruns(&test_inst) != 0) {
+        return cycle + 40;
+    }
+
+    cyclic_test_teardown();
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Test cycle 3 - schedule which doesn't fit
+//-----------------------------------------------------------------------------
+static int32_t cyclic_test_cycle_3(uint32_t cycle)
+{
+    if (!cyclic_test_setup()) {
+        return cycle + 5;
+    }
+    cyclic_deinit(&test_inst);
+    memset(test_frames, 0xFF, sizeof(test_frames));
+
+    // TEST - frames table is shorter than the schedule
+    bool is_init = cyclic_init(&test_inst, &test_swtimers_inst, 0, test_tasks, CYCLIC_TEST_TASKS_NUM,
+                               test_frames, CYCLIC_TEST_FRAMES_NUM - 1, cyclic_test_overrun, &test_app_data);
+    // CHECK - driver isn't initialized, frames table isn't written
+    if (is_init || (test_frames[0] != UINT32_MAX) || (test_frames[CYCLIC_TEST_FRAMES_NUM - 1] != UINT32_MAX)) {
+        return cycle + 10;
+    }
+
+    // TEST - hyperperiod overflow
+    is_init = cyclic_init(&test_inst, &test_swtimers_inst, 0, test_long_tasks, CYCLIC_TEST_TASKS_NUM,
+                          test_frames, CYCLIC_TEST_FRAMES_NUM + 1, cyclic_test_overrun, &test_app_data);
+    // CHECK
+    if (is_init || (test_frames[0] != UINT32_MAX)) {
+        return cycle + 20;
+    }
+
+    // TEST - deinit of not initialized driver
+    cyclic_deinit(&test_inst);
+    sim_run(&test_sim, 10, NULL, NULL);
+    // CHECK - timer isn't touched
+    if (swtimers_is_run(&test_swtimers_inst, 0, NULL) != false) {
+        return cycle + 30;
+    }
+
+    cyclic_test_teardown();
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Periodic task - saves id and virtual time of the call
+//-----------------------------------------------------------------------------
+static void cyclic_test_task(void * arg_p)
+{
+    assert(arg_p != NULL);
+
+    if (test_calls_cnt < CYCLIC_TEST_CALLS_NUM) {
+        test_calls_ids[test_calls_cnt] = *(const uint8_t*)arg_p;
+        test_calls_times[test_calls_cnt] = (uint32_t)sim_get_time_ms(&test_sim);
+    }
+    test_calls_cnt++;
+}
+
+//-----------------------------------------------------------------------------
+// Frame overrun report
+//-----------------------------------------------------------------------------
+static void cyclic_test_overrun(uint32_t overrun_cnt, uint32_t frame_idx, void * arg_p)
+{
+    (void)arg_p;
+    assert(arg_p == &test_app_data);
+
+    test_reports_cnt++;
+    test_report_overruns = overrun_cnt;
+    test_report_frame_idx = frame_idx;
+}
+
+//-----------------------------------------------------------------------------
+// Init simulation and drivers
+//
+// Returns - 'true' if cyclic executive is initialized
+//-----------------------------------------------------------------------------
+static bool cyclic_test_setup(void)
+{
+    test_calls_cnt = 0;
+    test_reports_cnt = 0;
+    test_report_overruns = 0;
+    test_report_frame_idx = UINT32_MAX;
+    memset(test_frames, 0xFF, sizeof(test_frames));
+
+    sim_init(&test_sim, 1, test_pins, 1, NULL, 0);
+    swtimers_init(&test_swtimers_inst, sim_get_swtimers_hw(&test_sim), 1, test_timers);
+    sim_attach_swtimers(&test_sim, &test_swtimers_inst);
+
+    return cyclic_init(&test_inst, &test_swtimers_inst, 0, test_tasks, CYCLIC_TEST_TASKS_NUM,
+                       test_frames, CYCLIC_TEST_FRAMES_NUM + 1, cyclic_test_overrun, &test_app_data);
+}
+
+//-----------------------------------------------------------------------------
+// Deinit drivers
+//-----------------------------------------------------------------------------
+static void cyclic_test_teardown(void)
+{
+    cyclic_deinit(&test_inst);
+    swtimers_deinit(&test_swtimers_inst);
+}
+
+//-----------------------------------------------------------------------------
+// Application loop
+//-----------------------------------------------------------------------------
+static void cyclic_test_loop(void * arg_p)
+{
+    (void)arg_p;
+    swtimers_task(&test_swtimers_inst);
+    cyclic_task(&test_inst);
+}
@@ -0,0 +1,222 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+//**************************************************************************************************
+// TESTS for idle helper, run on virtual-time simulation of hardware
+//**************************************************************************************************
+
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+
+#include "drv_idle.h"
+#include "drv_workqueue.h"
+#include "sim.h"
+
+//==================================================================================================
+//============================================ TESTS ===============================================
+//==================================================================================================
+
+//-----------------------------------------------------------------------------
+// Additional test functions
+//-----------------------------------------------------------------------------
+static int32_t idle_test_cycle_1(uint32_t cycle);
+
+static void idle_test_irq_disable(void * hw_p);
+static void idle_test_irq_enable(void * hw_p);
+static void idle_test_sleep(void * hw_p, uint32_t ticks);
+static void idle_test_work(void * arg_1_p, void * arg_2_p);
+static void idle_test_loop(void * arg_p);
+
+//-----------------------------------------------------------------------------
+// Additional test data
+//-----------------------------------------------------------------------------
+#define IDLE_TEST_TIMERS_NUM    (3)
+#define IDLE_TEST_ITEMS_NUM     (2)
+#define IDLE_TEST_NO_SLEEP      (UINT32_MAX - 1)    // sleep callback isn't called
+
+static const buttons_time_settings_t test_times = {
+    .bouncing_ms = 20,
+    .double_click_ms = 300,
+    .hold_ms = 1000,
+};
+
+// Simulation
+static sim_t test_sim;
+static sim_pin_t test_pins[1];
+
+// Instances
+static swtimers_t test_swtimers_inst;
+static swtimers_timer_t test_timers[IDLE_TEST_TIMERS_NUM];
+static buttons_t test_buttons_inst;
+static buttons_button_t test_buttons[1];
+static workqueue_t test_workqueue;
+static workqueue_item_t test_work_items[WORKQUEUE_PRIO_NUM * IDLE_TEST_ITEMS_NUM];
+static workqueue_hw_interface_t test_workqueue_hw;
+
+// Fake core - interrupts state and the last sleep
+static bool test_is_irq_disabled;
+static uint32_t test_sleep_ticks;
+static uint32_t test_sleep_cnt;
+static uint32_t test_work_cnt;
+
+static const drv_idle_hw_interface_t test_idle_hw = {
+    .hw_p = &test_sleep_ticks,
+    .irq_disable_cb = idle_test_irq_disable,
+    .irq_enable_cb = idle_test_irq_enable,
+    .sleep_cb = idle_test_sleep,
+};
+
+//-----------------------------------------------------------------------------
+// Run unit-tests
+//-----------------------------------------------------------------------------
+int32_t drv_idle_tests(void)
+{
+    int32_t res;
+
+    // Test cycle 1
+    res = idle_test_cycle_1(1000); // res 1000 - 1999
+    if (res != 0) {
+        return res;
+    }
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Test cycle 1 - sleep duration with timers, unprocessed button changes and work items
+//-----------------------------------------------------------------------------
+static int32_t idle_test_cycle_1(uint32_t cycle)
+{
+    sim_init(&test_sim, 1, test_pins, 1, NULL, 0);
+    swtimers_init(&test_swtimers_inst, sim_get_swtimers_hw(&test_sim), IDLE_TEST_TIMERS_NUM, test_timers);
+    sim_attach_swtimers(&test_sim, &test_swtimers_inst);
+    buttons_init(&test_buttons_inst, sim_get_buttons_hw(&test_sim), 1, test_buttons, &test_swtimers_inst);
+    buttons_configure(&test_buttons_inst, 0, 0, 2, false, BUTTONS_CHECK_IN_ISR, &test_times, NULL, NULL);
+
+    // Work queue shares critical section of the simulated timer
+    test_workqueue_hw.hw_p = sim_get_swtimers_hw(&test_sim)->hw_timer_p;
+    test_workqueue_hw.isr_enable_cb = sim_get_swtimers_hw(&test_sim)->isr_enable_cb;
+    test_workqueue_hw.isr_disable_cb = sim_get_swtimers_hw(&test_sim)->isr_disable_cb;
+    workqueue_init(&test_workqueue, &test_workqueue_hw, IDLE_TEST_ITEMS_NUM, test_work_items);
+    swtimers_set_workqueue(&test_swtimers_inst, &test_workqueue);
+    test_sleep_cnt = 0;
+    test_work_cnt = 0;
+
+    // TEST - nothing is started, only an interrupt can wake up
+    test_sleep_ticks = IDLE_TEST_NO_SLEEP;
+    drv_idle(&test_idle_hw, &test_swtimers_inst, &test_buttons_inst);
+    // CHECK
+    if ((drv_next_wakeup(&test_swtimers_inst, &test_buttons_inst) != DRV_WAKEUP_NEVER) ||
+        (test_sleep_ticks != DRV_WAKEUP_NEVER) || (test_sleep_cnt != 1) || (test_is_irq_disabled != false)) {
+        return cycle + 10;
+    }
+
+    // TEST - sleep until the nearest timer
+    swtimers_start_no_handler(&test_swtimers_inst, 0, 30);
+    swtimers_start_no_handler(&test_swtimers_inst, 1, 50);
+    sim_run(&test_sim, 10, idle_test_loop, NULL);
+    drv_idle(&test_idle_hw, &test_swtimers_inst, &test_buttons_inst);
+    // CHECK
+    if ((test_sleep_ticks != 20) || (test_sleep_cnt != 2) || (drv_next_wakeup(&test_swtimers_inst, NULL) != 20)) {
+        return cycle + 20;
+    }
+
+    // TEST - posted work item doesn't let the core sleep until swtimers_task()
+    workqueue_post(&test_workqueue, WORKQUEUE_PRIO_NORMAL, idle_test_work, NULL, NULL);
+    test_sleep_ticks = IDLE_TEST_NO_SLEEP;
+    drv_idle(&test_idle_hw, &test_swtimers_inst, &test_buttons_inst);
+    // CHECK
+    if ((drv_next_wakeup(&test_swtimers_inst, NULL) != 0) || (test_sleep_ticks != IDLE_TEST_NO_SLEEP) || (test_sleep_cnt != 2)) {
+        return cycle + 30;
+    }
+    swtimers_task(&test_swtimers_inst);
+    // CHECK
+    if ((test_work_cnt != 1) || (drv_next_wakeup(&test_swtimers_inst, &test_buttons_inst) != 20)) {
+        return cycle + 40;
+    }
+
+    // TEST - change of button from ISR isn't processed yet
+    buttons_isr(&test_buttons_inst, 0, true);
+    drv_idle(&test_idle_hw, &test_swtimers_inst, &test_buttons_inst);
+    // CHECK - button is ignored without its instance
+    if ((drv_next_wakeup(&test_swtimers_inst, &test_buttons_inst) != 0) || (test_sleep_cnt != 2) ||
+        (drv_next_wakeup(&test_swtimers_inst, NULL) != 20)) {
+        return cycle + 50;
+    }
+    buttons_task(&test_buttons_inst);
+    // CHECK - bouncing filter timer is the nearest expiration
+    if (drv_next_wakeup(&test_swtimers_inst, &test_buttons_inst) != test_times.bouncing_ms) {
+        return cycle + 60;
+    }
+
+    // TEST - bouncing filter timer (without handler) expires after buttons_task() and before the check of idle
+    swtimers_stop(&test_swtimers_inst, 0);
+    swtimers_stop(&test_swtimers_inst, 1);
+    sim_run(&test_sim, test_times.bouncing_ms, NULL, NULL);
+    test_sleep_ticks = IDLE_TEST_NO_SLEEP;
+    drv_idle(&test_idle_hw, &test_swtimers_inst, &test_buttons_inst);
+    // CHECK - the core doesn't sleep until the expiration is processed
+    if ((drv_next_wakeup(&test_swtimers_inst, &test_buttons_inst) != 0) || (test_sleep_ticks != IDLE_TEST_NO_SLEEP) ||
+        (buttons_is_pressed(&test_buttons_inst, 0) != false)) {
+        return cycle + 70;
+    }
+    swtimers_task(&test_swtimers_inst);
+    buttons_task(&test_buttons_inst);
+    // CHECK - press is debounced, hold timer is the nearest expiration
+    if ((buttons_is_pressed(&test_buttons_inst, 0) != true) ||
+        (drv_next_wakeup(&test_swtimers_inst, &test_buttons_inst) != test_times.hold_ms)) {
+        return cycle + 80;
+    }
+
+    buttons_deinit(&test_buttons_inst);
+    swtimers_set_workqueue(&test_swtimers_inst, NULL);
+    workqueue_deinit(&test_workqueue);
+    swtimers_deinit(&test_swtimers_inst);
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Fake core callbacks - sleep must be called with disabled interrupts
+//-----------------------------------------------------------------------------
+static void idle_test_irq_disable(void * hw_p)
+{
+    (void)hw_p;
+    assert((hw_p == &test_sleep_ticks) && (test_is_irq_disabled == false));
+    test_is_irq_disabled = true;
+}
+
+static void idle_test_irq_enable(void * hw_p)
+{
+    (void)hw_p;
+    assert((hw_p == &test_sleep_ticks) && (test_is_irq_disabled == true));
+    test_is_irq_disabled = false;
+}
+
+static void idle_test_sleep(void * hw_p, uint32_t ticks)
+{
+    (void)hw_p;
+    assert((hw_p == &test_sleep_ticks) && (test_is_irq_disabled == true));
+    test_sleep_ticks = ticks;
+    test_sleep_cnt++;
+}
+
+//-----------------------------------------------------------------------------
+// Work item handler
+//-----------------------------------------------------------------------------
+static void idle_test_work(void * arg_1_p, void * arg_2_p)
+{
+    (void)arg_1_p;
+    (void)arg_2_p;
+    test_work_cnt++;
+}
+
+//-----------------------------------------------------------------------------
+// Application loop
+//-----------------------------------------------------------------------------
+static void idle_test_loop(void * arg_p)
+{
+    (void)arg_p;
+    swtimers_task(&test_swtimers_inst);
+}
@@ -0,0 +1,1241 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+//**************************************************************************************************
+// TESTS for LED control driver, run on virtual-time simulation of hardware
+//**************************************************************************************************
+
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+
+#include "drv_leds.h"
+#include "drv_leds_matrix.h"
+#include "drv_leds_strip.h"
+#include "sim.h"
+
+//==================================================================================================
+//============================================ TESTS ===============================================
+//==================================================================================================
+
+//-----------------------------------------------------------------------------
+// Additional test functions
+//-----------------------------------------------------------------------------
+static int32_t leds_test_cycle_1(uint32_t cycle);
+static int32_t leds_test_cycle_2(uint32_t cycle);
+static int32_t leds_test_cycle_3(uint32_t cycle);
+static int32_t leds_test_cycle_4(uint32_t cycle);
+static int32_t leds_test_cycle_5(uint32_t cycle);
+static int32_t leds_test_cycle_6(uint32_t cycle);
+static int32_t leds_test_cycle_7(uint32_t cycle);
+static int32_t leds_test_cycle_8(uint32_t cycle);
+static int32_t leds_test_cycle_9(uint32_t cycle);
+static int32_t leds_test_cycle_10(uint32_t cycle);
+static int32_t leds_test_cycle_11(uint32_t cycle);
+static int32_t leds_test_cycle_12(uint32_t cycle);
+static int32_t leds_test_cycle_13(uint32_t cycle);
+static int32_t leds_test_cycle_14(uint32_t cycle);
+
+static void leds_test_setup(uint32_t tick_ms, uint32_t leds_num);
+static void leds_test_teardown(void);
+static int32_t leds_test_history_check(uint32_t pin_idx, const uint32_t * times_p, uint32_t num, uint8_t first_state);
+static void leds_test_loop(void * arg_p);
+static void leds_test_bam_loop(void * arg_p);
+static void leds_test_matrix_loop(void * arg_p);
+static void leds_test_row_out(void * hw_out_p, uint32_t row_idx, const uint8_t * data_p, uint32_t size);
+static bool leds_test_strip_check(uint32_t num, uint32_t format, bool is_changed);
+
+//-----------------------------------------------------------------------------
+// Additional test data
+//-----------------------------------------------------------------------------
+#define LEDS_TEST_LEDS_NUM      (200)
+#define LEDS_TEST_HISTORY_SIZE  (64)
+#define LEDS_TEST_HOUR_MS       (3600ul * 1000ul)
+#define LEDS_TEST_BATCH_NUM     (40)
+#define LEDS_TEST_PORTS_NUM     (2)
+#define LEDS_TEST_BAM_NUM       (6)
+#define LEDS_TEST_BAM_CYCLE     (255)
+#define LEDS_TEST_MATRIX_ROWS   (4)
+#define LEDS_TEST_MATRIX_BYTES  (2)
+#define LEDS_TEST_MATRIX_NUM    (LEDS_TEST_MATRIX_ROWS * LEDS_TEST_MATRIX_BYTES * 8)
+#define LEDS_TEST_STRIP_NUM     (37)
+
+// Simulation
+static sim_t test_sim;
+static sim_pin_t test_pins[LEDS_TEST_LEDS_NUM];
+static sim_record_t test_history[LEDS_TEST_HISTORY_SIZE];
+
+// Instances
+static swtimers_t test_swtimers_inst;
+static swtimers_timer_t test_timers[LEDS_TEST_LEDS_NUM];
+static leds_t test_inst;
+static leds_led_t test_leds[LEDS_TEST_LEDS_NUM];
+static leds_port_t test_ports[LEDS_TEST_PORTS_NUM];
+static uint16_t test_queue[LEDS_TEST_LEDS_NUM];
+static leds_bam_port_t test_bam_ports[1];
+static uint32_t test_on_ms[LEDS_TEST_BAM_NUM];
+static uint64_t test_sample_ms;
+static leds_group_t test_groups[2];
+static leds_matrix_t test_matrix;
+static uint8_t test_frames[LEDS_MATRIX_BUFFER_SIZE(LEDS_TEST_MATRIX_ROWS, LEDS_TEST_MATRIX_BYTES)];
+static uint8_t test_rows[LEDS_TEST_MATRIX_ROWS][LEDS_TEST_MATRIX_BYTES];
+static uint32_t test_rows_cnt;
+static uint32_t test_last_changes;
+static leds_strip_t test_strip;
+static uint8_t test_strip_storage[LEDS_STRIP_STORAGE_SIZE(LEDS_TEST_STRIP_NUM)];
+static uint8_t test_strip_dma[LEDS_STRIP_DMA_SIZE(LEDS_TEST_STRIP_NUM, LEDS_STRIP_FORMAT_SPI_4BIT)];
+
+//-----------------------------------------------------------------------------
+// Run unit-tests
+//-----------------------------------------------------------------------------
+int32_t leds_tests(void)
+{
+    int32_t res;
+
+    // Test cycle 1
+    res = leds_test_cycle_1(1000); // res 1000 - 1999
+    if (res != 0) {
+        return res;
+    }
+
+    // Test cycle 2
+    res = leds_test_cycle_2(2000); // res 2000 - 2999
+    if (res != 0) {
+        return res;
+    }
+
+    // Test cycle 3
+    res = leds_test_cycle_3(3000); // res 3000 - 3999
+    if (res != 0) {
+        return res;
+    }
+
+    // Test cycle 4
+    res = leds_test_cycle_4(4000); // res 4000 - 4999
+    if (res != 0) {
+        return res;
+    }
+
+    // Test cycle 5
+    res = leds_test_cycle_5(5000); // res 5000 - 5999
+    if (res != 0) {
+        return res;
+    }
+
+    // Test cycle 6
+    res = leds_test_cycle_6(6000); // res 6000 - 6999
+    if (res != 0) {
+        return res;
+    }
+
+    // Test cycle 7
+    res = leds_test_cycle_7(7000); // res 7000 - 7999
+    if (res != 0) {
+        return res;
+    }
+
+    // Test cycle 8
+    res = leds_test_cycle_8(8000); // res 8000 - 8999
+    if (res != 0) {
+        return res;
+    }
+
+    // Test cycle 9
+    res = leds_test_cycle_9(9000); // res 9000 - 9999
+    if (res != 0) {
+        return res;
+    }
+
+    // Test cycle 10
+    res = leds_test_cycle_10(10000); // res 10000 - 10999
+    if (res != 0) {
+        return res;
+    }
+
+    // Test cycle 11
+    res = leds_test_cycle_11(11000); // res 11000 - 11999
+    if (res != 0) {
+        return res;
+    }
+
+    // Test cycle 12
+    res = leds_test_cycle_12(12000); // res 12000 - 12999
+    if (res != 0) {
+        return res;
+    }
+
+    // Test cycle 13
+    res = leds_test_cycle_13(13000); // res 13000 - 13999
+    if (res != 0) {
+        return res;
+    }
+
+    // Test cycle 14
+    res = leds_test_cycle_14(14000); // res 14000 - 14999
+    if (res != 0) {
+        return res;
+    }
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Test cycle 1 - manual ON/OFF/toggle of active-high and active-low LEDs
+//-----------------------------------------------------------------------------
+static int32_t leds_test_cycle_1(uint32_t cycle)
+{
+    leds_test_setup(1, 2);
+
+    // TEST - ON
+    leds_on(&test_inst, 0);
+    leds_on(&test_inst, 1);
+    // CHECK
+    if ((sim_get_pin(&test_sim, 0) != 1) || (sim_get_pin(&test_sim, 1) != 0)) {
+        return cycle + 10;
+    }
+
+    // TEST - toggle
+    leds_toggle(&test_inst, 0);
+    leds_switch_toggle(&test_inst, 1);
+    // CHECK
+    if ((sim_get_pin(&test_sim, 0) != 0) || (sim_get_pin(&test_sim, 1) != 1)) {
+        return cycle + 20;
+    }
+
+    // TEST - OFF (LED 1 is already OFF, write is suppressed)
+    leds_switch_on(&test_inst, 0);
+    leds_off(&test_inst, 1);
+    // CHECK
+    if ((sim_get_pin(&test_sim, 0) != 1) || (sim_get_pin(&test_sim, 1) != 1)) {
+        return cycle + 30;
+    }
+
+    // TEST - time goes, nothing changes
+    sim_run(&test_sim, 1000, leds_test_loop, NULL);
+    // CHECK - no timers, so time jumps to the end at once
+    if ((test_sim.history_cnt != 5) || (test_sim.steps_cnt != 1) || (test_sim.ticks_cnt != 0)) {
+        return cycle + 40;
+    }
+    if ((sim_get_pin(&test_sim, 0) != 1) || (sim_get_pin(&test_sim, 1) != 1)) {
+        return cycle + 50;
+    }
+
+    // TEST - counters of GPIO calls, reset (toggles of known state are writes)
+    leds_stats_t stats;
+    leds_get_stats(&test_inst, &stats, true);
+    // CHECK
+    if ((stats.writes != 5) || (stats.toggles != 0) || (stats.suppressed != 1) || (stats.blink_steps != 0)) {
+        return cycle + 52;
+    }
+    leds_get_stats(&test_inst, &stats, false);
+    if ((stats.writes != 0) || (stats.toggles != 0)) {
+        return cycle + 54;
+    }
+
+    // TEST - deinit turns LEDs OFF
+    leds_test_teardown();
+    // CHECK
+    if ((sim_get_pin(&test_sim, 0) != 0) || (sim_get_pin(&test_sim, 1) != 1)) {
+        return cycle + 60;
+    }
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Test cycle 2 - timings of blinking with series, delay and inversion
+//-----------------------------------------------------------------------------
+static int32_t leds_test_cycle_2(uint32_t cycle)
+{
+    // "delay" 200, "pulse" 100, "pause" 50, "wait" 1000 - 100 * 2 - 50 = 750
+    static const uint32_t blink_times[] = { 0, 200, 300, 350, 450, 1200, 1300, 1350, 1450, 2200 };
+    // "pulse" 250, "pause" 250
+    static const uint32_t meander_times[] = { 0, 250, 500, 750, 1000, 1250, 1500, 1750, 2000, 2250 };
+    int32_t res;
+
+    leds_test_setup(1, 3);
+
+    // TEST - blink
+    leds_blink_ext(&test_inst, 0, 2, 100, 50, 1000, 200, false);
+    leds_blink_ext(&test_inst, 1, 2, 100, 50, 1000, 200, true);
+    leds_meander(&test_inst, 2, 250);
+    sim_run(&test_sim, 2300, leds_test_loop, NULL);
+    // CHECK
+    res = leds_test_history_check(0, blink_times, sizeof(blink_times) / sizeof(blink_times[0]), 0);
+    if (res != 0) {
+        return cycle + 10 + res;
+    }
+    res = leds_test_history_check(1, blink_times, sizeof(blink_times) / sizeof(blink_times[0]), 1);
+    if (res != 0) {
+        return cycle + 20 + res;
+    }
+    res = leds_test_history_check(2, meander_times, sizeof(meander_times) / sizeof(meander_times[0]), 1);
+    if (res != 0) {
+        return cycle + 30 + res;
+    }
+
+    // TEST - single series
+    leds_off(&test_inst, 2);
+    test_sim.history_cnt = 0;
+    leds_blink(&test_inst, 2, 3, 10, 10, 0);
+    sim_run(&test_sim, 1000, leds_test_loop, NULL);
+    // CHECK - 3 pulses, then LED stays OFF and timer is stopped
+    if ((test_sim.pins_p[2].last_ms != 2300 + 50) || (sim_get_pin(&test_sim, 2) != 0)) {
+        return cycle + 40;
+    }
+
+    // TEST - switch OFF inside the pulse doesn't stop blinking
+    test_sim.history_cnt = 0;
+    leds_blink(&test_inst, 2, 1, 100, 0, 200);
+    sim_run(&test_sim, 50, leds_test_loop, NULL);
+    leds_switch_off(&test_inst, 2);
+    sim_run(&test_sim, 200, leds_test_loop, NULL);
+    // CHECK - OFF at the end of pulse is suppressed, ON at the next pulse
+    if ((sim_find_record(&test_sim, 2, 1)->time_ms != 3300 + 50) || (sim_find_record(&test_sim, 2, 2)->time_ms != 3300 + 200)) {
+        return cycle + 50;
+    }
+
+    leds_test_teardown();
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Test cycle 3 - tick of hardware timer is 10 milliseconds
+//-----------------------------------------------------------------------------
+static int32_t leds_test_cycle_3(uint32_t cycle)
+{
+    static const uint32_t blink_times[] = { 0, 100, 300, 400, 600, 700, 900 };
+    int32_t res;
+
+    leds_test_setup(10, 1);
+
+    // TEST - blink
+    leds_blink(&test_inst, 0, 1, 100, 0, 300);
+    sim_run(&test_sim, 1000, leds_test_loop, NULL);
+    // CHECK
+    res = leds_test_history_check(0, blink_times, sizeof(blink_times) / sizeof(blink_times[0]), 1);
+    if (res != 0) {
+        return cycle + 10 + res;
+    }
+    if (test_sim.ticks_cnt != 1000 / 10) {
+        return cycle + 20;
+    }
+
+    leds_test_teardown();
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Test cycle 4 - one hour of device time with many LEDs
+//-----------------------------------------------------------------------------
+static int32_t leds_test_cycle_4(uint32_t cycle)
+{
+    leds_test_setup(1, LEDS_TEST_LEDS_NUM);
+
+    // TEST - meanders with durations 100 .. 1000 milliseconds
+    for (uint32_t i = 0; i < LEDS_TEST_LEDS_NUM; i++) {
+        leds_meander(&test_inst, i, 100 * (1 + (i % 10)));
+    }
+    sim_run(&test_sim, LEDS_TEST_HOUR_MS, leds_test_loop, NULL);
+
+    // CHECK - number of switches and final state of each LED
+    uint32_t switches_sum = 0;
+    for (uint32_t i = 0; i < LEDS_TEST_LEDS_NUM; i++) {
+        uint32_t switches = LEDS_TEST_HOUR_MS / (100 * (1 + (i % 10)));
+        switches_sum += switches;
+        if (test_pins[i].writes_cnt != switches + 1) {
+            return cycle + 10;
+        }
+        if (sim_get_pin(&test_sim, i) != (((switches % 2) == 0) ? 1 : 0)) {
+            return cycle + 20;
+        }
+    }
+
+    // CHECK - time jumps between deadlines only
+    if ((test_sim.steps_cnt > (LEDS_TEST_HOUR_MS / 100)) || (test_sim.ticks_cnt != LEDS_TEST_HOUR_MS)) {
+        return cycle + 30;
+    }
+
+    // CHECK - each switch is one blinking step and one write
+    leds_stats_t stats;
+    leds_get_stats(&test_inst, &stats, false);
+    if ((stats.blink_steps != switches_sum) || (stats.writes != (switches_sum + LEDS_TEST_LEDS_NUM)) || (stats.toggles != 0)) {
+        return cycle + 40;
+    }
+
+    leds_test_teardown();
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Test cycle 5 - batched writes of LEDs in two ports
+//-----------------------------------------------------------------------------
+static int32_t leds_test_cycle_5(uint32_t cycle)
+{
+    leds_stats_t stats;
+
+    leds_test_setup(1, LEDS_TEST_BATCH_NUM);
+    leds_set_batch(&test_inst, test_ports, LEDS_TEST_PORTS_NUM);
+
+    // TEST - synchronous meanders, manual calls are written at once
+    for (uint32_t i = 0; i < LEDS_TEST_BATCH_NUM; i++) {
+        leds_meander(&test_inst, i, 100);
+    }
+    sim_run(&test_sim, 1050, leds_test_loop, NULL);
+    leds_get_stats(&test_inst, &stats, true);
+    // CHECK - one port write per port on each step
+    if ((stats.writes != LEDS_TEST_BATCH_NUM) || (stats.port_writes != 10 * LEDS_TEST_PORTS_NUM) ||
+        (stats.blink_steps != 10 * LEDS_TEST_BATCH_NUM)) {
+        return cycle + 10;
+    }
+    for (uint32_t i = 0; i < LEDS_TEST_BATCH_NUM; i++) {
+        if ((test_pins[i].writes_cnt != 11) || (test_pins[i].last_ms != 1000) || (sim_get_pin(&test_sim, i) != 1)) {
+            return cycle + 20;
+        }
+    }
+
+    // TEST - only changed ports are written
+    leds_off(&test_inst, 0);
+    leds_on(&test_inst, 0);
+    leds_toggle(&test_inst, 39);
+    leds_meander(&test_inst, 1, 30);
+    for (uint32_t i = 2; i < LEDS_TEST_BATCH_NUM; i++) {
+        leds_off(&test_inst, i);
+    }
+    sim_run(&test_sim, 100, leds_test_loop, NULL);
+    leds_get_stats(&test_inst, &stats, true);
+    // CHECK - LED 1 is switched 3 times in port 0, start of meander of LED 1 and OFF of LED 39 are suppressed
+    if ((stats.writes != LEDS_TEST_BATCH_NUM) || (stats.toggles != 0) || (stats.suppressed != 2) || (stats.port_writes != 3)) {
+        return cycle + 30;
+    }
+    if ((sim_get_pin(&test_sim, 0) != 1) || (sim_get_pin(&test_sim, 1) != 0) || (sim_get_pin(&test_sim, 39) != 0)) {
+        return cycle + 40;
+    }
+
+    // TEST - batching is disabled
+    leds_set_batch(&test_inst, NULL, 0);
+    sim_run(&test_sim, 100, leds_test_loop, NULL);
+    leds_get_stats(&test_inst, &stats, true);
+    // CHECK
+    if ((stats.writes != 3) || (stats.port_writes != 0) || (stats.blink_steps != 3)) {
+        return cycle + 50;
+    }
+
+    leds_test_teardown();
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Test cycle 6 - engine mode, all LEDs share one software timer
+//-----------------------------------------------------------------------------
+static int32_t leds_test_cycle_6(uint32_t cycle)
+{
+    // The same timings as in test cycle 2
+    static const uint32_t blink_times[] = { 0, 200, 300, 350, 450, 1200, 1300, 1350, 1450, 2200 };
+    static const uint32_t meander_times[] = { 0, 250, 500, 750, 1000, 1250, 1500, 1750, 2000, 2250 };
+    swtimers_stats_t swtimers_stats;
+    int32_t res;
+
+    sim_init(&test_sim, 1, test_pins, LEDS_TEST_LEDS_NUM, test_history, LEDS_TEST_HISTORY_SIZE);
+    swtimers_init(&test_swtimers_inst, sim_get_swtimers_hw(&test_sim), 1, test_timers);
+    sim_attach_swtimers(&test_sim, &test_swtimers_inst);
+    leds_init(&test_inst, sim_get_leds_hw(&test_sim), LEDS_TEST_LEDS_NUM, test_leds, &test_swtimers_inst);
+    leds_set_engine(&test_inst, 0, test_queue);
+    for (uint32_t i = 0; i < LEDS_TEST_LEDS_NUM; i++) {
+        leds_set_pin(&test_inst, i, i, 0, true);
+    }
+
+    // TEST - blink
+    leds_blink_ext(&test_inst, 0, 2, 100, 50, 1000, 200, false);
+    leds_blink_ext(&test_inst, 1, 2, 100, 50, 1000, 200, true);
+    leds_meander(&test_inst, 2, 250);
+    sim_run(&test_sim, 2300, leds_test_loop, NULL);
+    // CHECK
+    res = leds_test_history_check(0, blink_times, sizeof(blink_times) / sizeof(blink_times[0]), 0);
+    if (res != 0) {
+        return cycle + 10 + res;
+    }
+    res = leds_test_history_check(1, blink_times, sizeof(blink_times) / sizeof(blink_times[0]), 1);
+    if (res != 0) {
+        return cycle + 20 + res;
+    }
+    res = leds_test_history_check(2, meander_times, sizeof(meander_times) / sizeof(meander_times[0]), 1);
+    if (res != 0) {
+        return cycle + 30 + res;
+    }
+
+    // TEST - restart in the middle of engine period, stop of all LEDs
+    leds_blink(&test_inst, 2, 1, 10, 0, 0);
+    sim_run(&test_sim, 5, leds_test_loop, NULL);
+    leds_meander(&test_inst, 3, 7);
+    sim_run(&test_sim, 10, leds_test_loop, NULL);
+    // CHECK
+    if ((test_pins[2].last_ms != 2300 + 10) || (test_pins[3].last_ms != 2305 + 7) || (sim_get_pin(&test_sim, 2) != 0)) {
+        return cycle + 40;
+    }
+    leds_off(&test_inst, 0);
+    leds_off(&test_inst, 1);
+    leds_off(&test_inst, 3);
+    sim_run(&test_sim, 10, leds_test_loop, NULL);
+    if (swtimers_is_run(&test_swtimers_inst, 0, NULL) != false) {
+        return cycle + 50;
+    }
+
+    // TEST - one hour, meanders with durations 100 .. 1000 milliseconds
+    leds_stats_t stats;
+    leds_get_stats(&test_inst, &stats, true);
+    swtimers_get_stats(&test_swtimers_inst, &swtimers_stats, true);
+    for (uint32_t i = 0; i < LEDS_TEST_LEDS_NUM; i++) {
+        test_pins[i].writes_cnt = 0;
+        leds_meander(&test_inst, i, 100 * (1 + (i % 10)));
+    }
+    sim_run(&test_sim, LEDS_TEST_HOUR_MS, leds_test_loop, NULL);
+    // CHECK - number of switches and final state of each LED
+    uint32_t switches_sum = 0;
+    for (uint32_t i = 0; i < LEDS_TEST_LEDS_NUM; i++) {
+        uint32_t switches = LEDS_TEST_HOUR_MS / (100 * (1 + (i % 10)));
+        switches_sum += switches;
+        if (test_pins[i].writes_cnt != switches + 1) {
+            return cycle + 60;
+        }
+        if (sim_get_pin(&test_sim, i) != (((switches % 2) == 0) ? 1 : 0)) {
+            return cycle + 70;
+        }
+    }
+    // CHECK - each switch is one blinking step, one timer for all LEDs
+    leds_get_stats(&test_inst, &stats, false);
+    swtimers_get_stats(&test_swtimers_inst, &swtimers_stats, false);
+    if ((stats.blink_steps != switches_sum) || (swtimers_stats.peak_active != 1) || (swtimers_stats.dispatched != LEDS_TEST_HOUR_MS / 100)) {
+        return cycle + 80;
+    }
+
+    leds_deinit(&test_inst);
+    if (swtimers_is_run(&test_swtimers_inst, 0, NULL) != false) {
+        return cycle + 90;
+    }
+    swtimers_deinit(&test_swtimers_inst);
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Test cycle 7 - dimming with bit-angle modulation by ISR-mode software timer
+//  LED 5 is active-low, the last timer is used for modulation
+//-----------------------------------------------------------------------------
+static int32_t leds_test_cycle_7(uint32_t cycle)
+{
+    static const uint8_t brightness[LEDS_TEST_BAM_NUM] = { 0, 255, 128, 1, 85, 200 };
+
+    leds_test_setup(1, LEDS_TEST_BAM_NUM + 1);
+    leds_set_pin(&test_inst, 5, 5, 5, false);
+    leds_set_bam(&test_inst, test_bam_ports, 1, LEDS_TEST_BAM_NUM);
+    memset(test_on_ms, 0x00, sizeof(test_on_ms));
+    test_sample_ms = 0;
+
+    // TEST - four BAM cycles
+    for (uint32_t i = 0; i < LEDS_TEST_BAM_NUM; i++) {
+        leds_set_brightness(&test_inst, i, brightness[i]);
+    }
+    sim_run(&test_sim, 4 * LEDS_TEST_BAM_CYCLE, leds_test_bam_loop, NULL);
+    // CHECK - ON time is proportional to brightness, one port write per slot
+    for (uint32_t i = 0; i < LEDS_TEST_BAM_NUM; i++) {
+        if (test_on_ms[i] != 4u * brightness[i]) {
+            return cycle + 10;
+        }
+        if (test_pins[i].writes_cnt != 4 * 8) {
+            return cycle + 20;
+        }
+    }
+
+    // TEST - ON leaves dimming mode
+    leds_on(&test_inst, 2);
+    sim_run(&test_sim, LEDS_TEST_BAM_CYCLE, leds_test_bam_loop, NULL);
+    // CHECK
+    if ((test_pins[2].writes_cnt != 4 * 8 + 1) || (sim_get_pin(&test_sim, 2) != 1) || (test_pins[1].writes_cnt != 5 * 8)) {
+        return cycle + 30;
+    }
+
+    // TEST - disabling of dimming turns dimmed LEDs OFF
+    leds_set_bam(&test_inst, NULL, 0, 0);
+    sim_run(&test_sim, LEDS_TEST_BAM_CYCLE, leds_test_bam_loop, NULL);
+    // CHECK
+    if ((swtimers_is_run(&test_swtimers_inst, LEDS_TEST_BAM_NUM, NULL) != false) ||
+        (sim_get_pin(&test_sim, 1) != 0) || (sim_get_pin(&test_sim, 2) != 1) || (sim_get_pin(&test_sim, 5) != 1)) {
+        return cycle + 40;
+    }
+
+    leds_test_teardown();
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Test cycle 8 - pattern sequencer
+//-----------------------------------------------------------------------------
+static int32_t leds_test_cycle_8(uint32_t cycle)
+{
+    // Three short pulses, one long pulse, stop
+    static const leds_op_t pattern_1[] = {
+        LEDS_OP_ON(100), LEDS_OP_OFF(100), LEDS_OP_REPEAT(2, 2),
+        LEDS_OP_ON(300), LEDS_OP_OFF(100), LEDS_OP_END,
+    };
+    static const uint32_t pattern_1_times[] = { 0, 100, 200, 300, 400, 500, 600, 900 };
+    // Heartbeat - two pulses, pause, forever
+    static const leds_op_t pattern_2[] = {
+        LEDS_OP_ON(50), LEDS_OP_OFF(100), LEDS_OP_ON(50), LEDS_OP_OFF(300), LEDS_OP_LOOP,
+    };
+    static const uint32_t pattern_2_times[] = { 0, 50, 150, 200, 500, 550, 650, 700, 1000, 1050 };
+    // No timed operation
+    static const leds_op_t pattern_3[] = {
+        LEDS_OP_LOOP,
+    };
+    int32_t res;
+
+    leds_test_setup(1, 3);
+
+    // TEST - patterns with repeat, end and loop
+    leds_pattern(&test_inst, 0, pattern_1);
+    leds_pattern(&test_inst, 1, pattern_2);
+    leds_pattern(&test_inst, 2, pattern_2);
+    sim_run(&test_sim, 1100, leds_test_loop, NULL);
+    // CHECK
+    res = leds_test_history_check(0, pattern_1_times, sizeof(pattern_1_times) / sizeof(pattern_1_times[0]), 1);
+    if (res != 0) {
+        return cycle + 10 + res;
+    }
+    if ((sim_find_record(&test_sim, 0, 8) != NULL) || (swtimers_is_run(&test_swtimers_inst, 0, NULL) != false)) {
+        return cycle + 20;
+    }
+    res = leds_test_history_check(2, pattern_2_times, sizeof(pattern_2_times) / sizeof(pattern_2_times[0]), 1);
+    if (res != 0) {
+        return cycle + 30 + res;
+    }
+
+    // TEST - pattern is restarted and then replaced by blinking
+    test_sim.history_cnt = 0;
+    leds_pattern(&test_inst, 0, pattern_1);
+    sim_run(&test_sim, 250, leds_test_loop, NULL);
+    leds_pattern(&test_inst, 0, pattern_1);
+    sim_run(&test_sim, 250, leds_test_loop, NULL);
+    leds_meander(&test_inst, 0, 200);
+    sim_run(&test_sim, 250, leds_test_loop, NULL);
+    // CHECK - 3 + 3 pattern switches, then meander (both restarts in ON state are suppressed)
+    if ((test_pins[0].last_ms != 1100 + 500 + 200) || (sim_get_pin(&test_sim, 0) != 0) ||
+        (sim_find_record(&test_sim, 0, 4)->time_ms != 1100 + 250 + 200)) {
+        return cycle + 40;
+    }
+
+    // TEST - program without timed operation replaces blinking
+    leds_pattern(&test_inst, 0, pattern_3);
+    uint32_t last_ms = test_pins[0].last_ms;
+    sim_run(&test_sim, 500, leds_test_loop, NULL);
+    // CHECK - the program is stopped, LED stays in the last state
+    if ((test_pins[0].last_ms != last_ms) || (sim_get_pin(&test_sim, 0) != 0)) {
+        return cycle + 50;
+    }
+
+    leds_test_teardown();
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Test cycle 9 - groups of LEDs, LEDs 0 .. 3 are in two groups with timers 4 and 5
+//-----------------------------------------------------------------------------
+static int32_t leds_test_cycle_9(uint32_t cycle)
+{
+    static const uint16_t members_1[] = { 0, 1, 2 };
+    static const uint16_t members_2[] = { 3 };
+    static const uint16_t members_3[] = { 0 };
+    static const uint32_t group_times[] = { 0, 100, 200, 300, 400 };
+    static const uint32_t late_times[] = { 50, 100, 200, 300, 400 };
+    leds_stats_t stats;
+    int32_t res;
+
+    leds_test_setup(1, 6);
+    leds_set_batch(&test_inst, test_ports, 1);
+    leds_group_init(&test_inst, &test_groups[0], members_1, 3, 4);
+    leds_group_init(&test_inst, &test_groups[1], members_2, 1, 5);
+
+    // TEST - the second group is started later, but it is in phase with the first one
+    leds_group_meander(&test_inst, &test_groups[0], 100);
+    sim_run(&test_sim, 50, leds_test_loop, NULL);
+    leds_group_meander(&test_inst, &test_groups[1], 100);
+    sim_run(&test_sim, 350, leds_test_loop, NULL);
+    leds_get_stats(&test_inst, &stats, true);
+    // CHECK - one port write per switching of the group
+    res = leds_test_history_check(2, group_times, sizeof(group_times) / sizeof(group_times[0]), 1);
+    if (res != 0) {
+        return cycle + 10 + res;
+    }
+    res = leds_test_history_check(3, late_times, sizeof(late_times) / sizeof(late_times[0]), 1);
+    if (res != 0) {
+        return cycle + 20 + res;
+    }
+    if ((stats.port_writes != 4) || (stats.writes != 3 + 1) || (stats.blink_steps != 8)) {
+        return cycle + 30;
+    }
+
+    // TEST - member leaves the group, inverted blink with series (OFF 400 .. 410, ON 410 .. 430, OFF 430 .. 440, ON 440 .. 500)
+    leds_on(&test_inst, 1);
+    leds_group_blink(&test_inst, &test_groups[1], 2, 10, 20, 100, true);
+    sim_run(&test_sim, 200, leds_test_loop, NULL);
+    // CHECK
+    if ((sim_get_pin(&test_sim, 1) != 1) || (test_pins[1].last_ms != 400) || (test_pins[0].last_ms != 600)) {
+        return cycle + 40;
+    }
+    if ((test_pins[3].last_ms != 600) || (sim_get_pin(&test_sim, 3) != 0) || (sim_find_record(&test_sim, 3, 10)->time_ms != 510)) {
+        return cycle + 50;
+    }
+
+    // TEST - stop
+    leds_group_stop(&test_inst, &test_groups[0]);
+    sim_run(&test_sim, 200, leds_test_loop, NULL);
+    // CHECK
+    if ((swtimers_is_run(&test_swtimers_inst, 4, NULL) != false) || (sim_get_pin(&test_sim, 0) != 0) || (sim_get_pin(&test_sim, 1) != 1)) {
+        return cycle + 60;
+    }
+
+    // TEST - blinking LED joins group (timer of LED is armed)
+    leds_meander(&test_inst, 0, 100);
+    sim_run(&test_sim, 10, leds_test_loop, NULL);
+    leds_group_init(&test_inst, &test_groups[1], members_3, 1, 5);
+    leds_group_meander(&test_inst, &test_groups[1], 100);
+    // CHECK - own blinking of the member is stopped
+    if (swtimers_is_run(&test_swtimers_inst, 0, NULL) != false) {
+        return cycle + 70;
+    }
+    sim_run(&test_sim, 300, leds_test_loop, NULL);
+    // CHECK - the member is switched by the group
+    if (test_pins[0].last_ms <= 810) {
+        return cycle + 80;
+    }
+
+    leds_test_teardown();
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Test cycle 10 - lazy blinking, state in closed form and writes on sampling only
+//-----------------------------------------------------------------------------
+static int32_t leds_test_cycle_10(uint32_t cycle)
+{
+    // Timings of test cycle 2: "delay" 200, "pulse" 100, "pause" 50, "wait" 750
+    static const uint32_t on_times[] = { 200, 299, 350, 449, 1200, 1350, 100200 };
+    static const uint32_t off_times[] = { 0, 199, 300, 349, 450, 1199, 1300, 100199 };
+    leds_stats_t stats;
+
+    leds_test_setup(1, 3);
+    leds_set_batch(&test_inst, test_ports, 1);
+
+    // TEST - state at arbitrary time
+    leds_blink_lazy(&test_inst, 0, 2, 100, 50, 1000, 200, false);
+    // Single inverted pulse across wrapping of time
+    leds_blink_lazy(&test_inst, 1, 1, 100, 0, 0, UINT32_MAX - 50, true);
+    // CHECK
+    for (uint32_t i = 0; i < sizeof(on_times) / sizeof(on_times[0]); ++i) {
+        if (leds_state_at(&test_inst, 0, on_times[i]) != true) {
+            return cycle + 10;
+        }
+    }
+    for (uint32_t i = 0; i < sizeof(off_times) / sizeof(off_times[0]); ++i) {
+        if (leds_state_at(&test_inst, 0, off_times[i]) != false) {
+            return cycle + 20;
+        }
+    }
+    if ((leds_state_at(&test_inst, 1, UINT32_MAX - 51) != true) || (leds_state_at(&test_inst, 1, 20) != false) ||
+        (leds_state_at(&test_inst, 1, 49) != true) || (leds_state_at(&test_inst, 1, 1000000) != true)) {
+        return cycle + 30;
+    }
+
+    // TEST - no timers and no writes until refresh
+    sim_run(&test_sim, 1000, leds_test_loop, NULL);
+    leds_get_stats(&test_inst, &stats, true);
+    // CHECK
+    if ((test_sim.ticks_cnt != 0) || (stats.writes != 0) || (stats.port_writes != 0) || (sim_get_pin(&test_sim, 0) != 0)) {
+        return cycle + 40;
+    }
+
+    // TEST - refresh writes both LEDs by one port write, the second refresh writes nothing
+    leds_refresh(&test_inst, 250);
+    leds_refresh(&test_inst, 260);
+    leds_get_stats(&test_inst, &stats, true);
+    // CHECK
+    if ((sim_get_pin(&test_sim, 0) != 1) || (sim_get_pin(&test_sim, 1) != 1) || (sim_get_pin(&test_sim, 2) != 0)) {
+        return cycle + 50;
+    }
+    if ((stats.port_writes != 1) || (stats.writes != 0)) {
+        return cycle + 60;
+    }
+
+    // TEST - sampling writes only changed LED
+    bool is_on_1 = leds_sample(&test_inst, 0, 320);
+    bool is_on_2 = leds_sample(&test_inst, 1, 320);
+    leds_get_stats(&test_inst, &stats, true);
+    // CHECK
+    if ((is_on_1 != false) || (is_on_2 != true) || (sim_get_pin(&test_sim, 0) != 0) || (stats.writes != 1)) {
+        return cycle + 70;
+    }
+
+    // TEST - LED leaves lazy mode
+    leds_on(&test_inst, 0);
+    leds_refresh(&test_inst, 300);
+    // CHECK
+    if (sim_get_pin(&test_sim, 0) != 1) {
+        return cycle + 80;
+    }
+
+    // TEST - blinking LED enters lazy mode (timer of LED is armed)
+    leds_meander(&test_inst, 2, 100);
+    sim_run(&test_sim, 10, leds_test_loop, NULL);
+    leds_blink_lazy(&test_inst, 2, 1, 100, 0, 200, 0, false);
+    // CHECK - own blinking of the LED is stopped
+    if (swtimers_is_run(&test_swtimers_inst, 2, NULL) != false) {
+        return cycle + 90;
+    }
+    sim_run(&test_sim, 300, leds_test_loop, NULL);
+    // CHECK - the LED isn't switched without refresh
+    if (test_pins[2].last_ms > 1010) {
+        return cycle + 100;
+    }
+
+    // TEST - the same timings from blink parameters without LED instance
+    uint32_t next_ms[4];
+    bool states[4] = {
+        leds_blink_state_at(2, 100, 50, 1000, 200, false, 0, &next_ms[0]),
+        leds_blink_state_at(2, 100, 50, 1000, 200, false, 260, &next_ms[1]),
+        leds_blink_state_at(2, 100, 50, 1000, 200, false, 460, &next_ms[2]),
+        leds_blink_state_at(1, 100, 0, 0, UINT32_MAX - 50, true, 1000000, &next_ms[3]),
+    };
+    // CHECK - state and time until the next switching ("delay", "pulse", "wait", end of single series)
+    if ((states[0] != false) || (states[1] != true) || (states[2] != false) || (states[3] != true) ||
+        (next_ms[0] != 200) || (next_ms[1] != 40) || (next_ms[2] != 740) || (next_ms[3] != 0)) {
+        return cycle + 110;
+    }
+    // CHECK - the same as lazy blinking LED
+    for (uint32_t i = 0; i < sizeof(on_times) / sizeof(on_times[0]); ++i) {
+        if (leds_blink_state_at(2, 100, 50, 1000, 200, false, on_times[i], NULL) != true) {
+            return cycle + 120;
+        }
+    }
+    for (uint32_t i = 0; i < sizeof(off_times) / sizeof(off_times[0]); ++i) {
+        if (leds_blink_state_at(2, 100, 50, 1000, 200, false, off_times[i], NULL) != false) {
+            return cycle + 120;
+        }
+    }
+
+    leds_test_teardown();
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Test cycle 11 - shadow state, suppressed writes and toggles
+//-----------------------------------------------------------------------------
+static int32_t leds_test_cycle_11(uint32_t cycle)
+{
+    leds_stats_t stats;
+    bool is_on = false;
+
+    leds_test_setup(1, 3);
+
+    // TEST - state is unknown after leds_set_pin(), toggle is done by hardware
+    bool is_known = leds_get_state(&test_inst, 0, &is_on);
+    leds_toggle(&test_inst, 0);
+    leds_get_stats(&test_inst, &stats, true);
+    // CHECK
+    if ((is_known != false) || (leds_get_state(&test_inst, 0, &is_on) != false) || (stats.toggles != 1) || (stats.writes != 0)) {
+        return cycle + 10;
+    }
+
+    // TEST - repeated writes are suppressed, toggle of known state is a write
+    leds_on(&test_inst, 0);
+    leds_on(&test_inst, 0);
+    leds_switch_on(&test_inst, 0);
+    leds_toggle(&test_inst, 0);
+    leds_get_stats(&test_inst, &stats, true);
+    // CHECK
+    if ((leds_get_state(&test_inst, 0, &is_on) != true) || (is_on != false) || (sim_get_pin(&test_sim, 0) != 0)) {
+        return cycle + 20;
+    }
+    if ((stats.writes != 2) || (stats.toggles != 0) || (stats.suppressed != 2)) {
+        return cycle + 30;
+    }
+
+    // TEST - new pin of LED has unknown state
+    leds_set_pin(&test_inst, 0, 2, 0, true);
+    leds_off(&test_inst, 0);
+    leds_get_stats(&test_inst, &stats, true);
+    // CHECK
+    if ((stats.writes != 1) || (stats.suppressed != 0) || (test_pins[2].writes_cnt != 1)) {
+        return cycle + 40;
+    }
+
+    leds_test_teardown();
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Test cycle 12 - LED matrix 4 x 16, LED `i` is in row i / 16 and column i % 16, refresh uses the last timer
+//-----------------------------------------------------------------------------
+static int32_t leds_test_cycle_12(uint32_t cycle)
+{
+    sim_init(&test_sim, 1, test_pins, 1, test_history, LEDS_TEST_HISTORY_SIZE);
+    swtimers_init(&test_swtimers_inst, sim_get_swtimers_hw(&test_sim), LEDS_TEST_MATRIX_NUM + 1, test_timers);
+    sim_attach_swtimers(&test_sim, &test_swtimers_inst);
+    leds_matrix_init(&test_matrix, &leds_test_row_out, NULL, LEDS_TEST_MATRIX_ROWS, LEDS_TEST_MATRIX_BYTES, test_frames,
+                     &test_swtimers_inst, LEDS_TEST_MATRIX_NUM);
+    leds_init(&test_inst, leds_matrix_get_hw_interface(&test_matrix), LEDS_TEST_MATRIX_NUM, test_leds, &test_swtimers_inst);
+    for (uint32_t i = 0; i < LEDS_TEST_MATRIX_NUM; i++) {
+        leds_set_pin(&test_inst, i, LEDS_MATRIX_PIN(i / 16, i % 16, LEDS_TEST_MATRIX_BYTES), i, true);
+    }
+    memset(test_rows, 0x00, sizeof(test_rows));
+    test_rows_cnt = 0;
+    test_last_changes = 0;
+
+    // TEST - one row per tick, columns 0 .. 7 are in the last byte
+    leds_on(&test_inst, 0);
+    leds_on(&test_inst, 16 + 13);
+    sim_run(&test_sim, 8, leds_test_matrix_loop, NULL);
+    // CHECK
+    if ((test_rows_cnt != 8) || (test_rows[0][0] != 0x00) || (test_rows[0][1] != 0x01) ||
+        (test_rows[1][0] != 0x20) || (test_rows[1][1] != 0x00)) {
+        return cycle + 10;
+    }
+
+    // TEST - changes are invisible until commit
+    leds_off(&test_inst, 0);
+    sim_run(&test_sim, 8, leds_test_loop, NULL);
+    // CHECK
+    if (test_rows[0][1] != 0x01) {
+        return cycle + 20;
+    }
+    sim_run(&test_sim, 8, leds_test_matrix_loop, NULL);
+    if (test_rows[0][1] != 0x00) {
+        return cycle + 30;
+    }
+
+    // TEST - blinking of all LEDs is unchanged, LED 63 is the highest bit of the first byte of the last row
+    for (uint32_t i = 0; i < LEDS_TEST_MATRIX_NUM; i++) {
+        leds_meander(&test_inst, i, 20);
+    }
+    sim_run(&test_sim, 400, leds_test_matrix_loop, NULL);
+    // CHECK - frame is whole, one row per tick
+    if ((test_rows_cnt != 8 + 8 + 8 + 400) || (test_last_changes != 20)) {
+        return cycle + 40;
+    }
+    for (uint32_t row = 1; row < LEDS_TEST_MATRIX_ROWS; row++) {
+        if (memcmp(test_rows[row], test_rows[0], LEDS_TEST_MATRIX_BYTES) != 0) {
+            return cycle + 50;
+        }
+    }
+
+    leds_deinit(&test_inst);
+    leds_matrix_deinit(&test_matrix);
+    swtimers_deinit(&test_swtimers_inst);
+
+    // TEST - refresh with tick of software timers 2 ms
+    sim_init(&test_sim, 2, test_pins, 1, test_history, LEDS_TEST_HISTORY_SIZE);
+    swtimers_init(&test_swtimers_inst, sim_get_swtimers_hw(&test_sim), LEDS_TEST_MATRIX_NUM + 1, test_timers);
+    sim_attach_swtimers(&test_sim, &test_swtimers_inst);
+    leds_matrix_init(&test_matrix, &leds_test_row_out, NULL, LEDS_TEST_MATRIX_ROWS, LEDS_TEST_MATRIX_BYTES, test_frames,
+                     &test_swtimers_inst, LEDS_TEST_MATRIX_NUM);
+    test_rows_cnt = 0;
+    sim_run(&test_sim, 16, NULL, NULL);
+    // CHECK - one row per tick
+    if (test_rows_cnt != 8) {
+        return cycle + 60;
+    }
+
+    leds_matrix_deinit(&test_matrix);
+    swtimers_deinit(&test_swtimers_inst);
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Test cycle 13 - addressable LED strip, LED `i` is pixel `i`, bitstream is checked against bit-by-bit expansion
+// (37 pixels - vectorized encoder has a tail)
+//-----------------------------------------------------------------------------
+static int32_t leds_test_cycle_13(uint32_t cycle)
+{
+    static const uint32_t formats[] = { LEDS_STRIP_FORMAT_SPI_4BIT, LEDS_STRIP_FORMAT_SPI_3BIT };
+
+    for (uint32_t f = 0; f < sizeof(formats) / sizeof(formats[0]); f++) {
+        sim_init(&test_sim, 1, test_pins, 1, test_history, LEDS_TEST_HISTORY_SIZE);
+        swtimers_init(&test_swtimers_inst, sim_get_swtimers_hw(&test_sim), LEDS_TEST_STRIP_NUM, test_timers);
+        sim_attach_swtimers(&test_sim, &test_swtimers_inst);
+        leds_strip_init(&test_strip, LEDS_TEST_STRIP_NUM, test_strip_storage, test_strip_dma, (leds_strip_format_t)formats[f]);
+        leds_init(&test_inst, leds_strip_get_hw_interface(&test_strip), LEDS_TEST_STRIP_NUM, test_leds, &test_swtimers_inst);
+        for (uint32_t i = 0; i < LEDS_TEST_STRIP_NUM; i++) {
+            leds_set_pin(&test_inst, i, i, i, true);
+            leds_strip_set_color(&test_strip, i, (uint8_t)(i * 7), (uint8_t)(0xA5 ^ i), (uint8_t)(255 - i));
+        }
+
+        // TEST - the whole frame is encoded after init, colors don't change black pixels
+        memset(test_strip_dma, 0xFF, sizeof(test_strip_dma));
+        // CHECK
+        if ((leds_strip_encode(&test_strip) != LEDS_TEST_STRIP_NUM) || (leds_strip_encode(&test_strip) != 0) ||
+            !leds_test_strip_check(LEDS_TEST_STRIP_NUM, formats[f], false)) {
+            return cycle + 10;
+        }
+
+        // TEST - only range of changed pixels is encoded
+        leds_on(&test_inst, 3);
+        uint32_t count_1 = leds_strip_encode(&test_strip);
+        leds_on(&test_inst, 30);
+        leds_on(&test_inst, 10);
+        uint32_t count_2 = leds_strip_encode(&test_strip);
+        // CHECK
+        if ((count_1 != 1) || (count_2 != 21) || !leds_test_strip_check(LEDS_TEST_STRIP_NUM, formats[f], false)) {
+            return cycle + 20;
+        }
+
+        // TEST - color of pixel which is ON is changed at once, pixel 11 is OFF
+        leds_strip_set_color(&test_strip, 10, 1, 2, 3);
+        leds_strip_set_color(&test_strip, 11, 1, 2, 3);
+        // CHECK
+        if ((leds_strip_encode(&test_strip) != 1) || !leds_test_strip_check(LEDS_TEST_STRIP_NUM, formats[f], true)) {
+            return cycle + 30;
+        }
+
+        // TEST - blinking of all pixels
+        for (uint32_t i = 0; i < LEDS_TEST_STRIP_NUM; i++) {
+            leds_meander(&test_inst, i, 10 + i);
+        }
+        sim_run(&test_sim, 100, leds_test_loop, NULL);
+        // CHECK
+        if ((leds_strip_encode(&test_strip) == 0) || !leds_test_strip_check(LEDS_TEST_STRIP_NUM, formats[f], true)) {
+            return cycle + 40;
+        }
+
+        leds_deinit(&test_inst);
+        swtimers_deinit(&test_swtimers_inst);
+    }
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Test cycle 14 - fading of groups with curve tables, LEDs 0, 1 and LED 2 are in groups with timers 3 and 4
+//  brightness is checked as ON time within 255 ms while it is constant
+//-----------------------------------------------------------------------------
+static int32_t leds_test_cycle_14(uint32_t cycle)
+{
+    static const uint8_t gamma_table[256] = { LEDS_CURVE_TABLE(LEDS_CURVE_GAMMA) };
+    static const uint8_t cie_table[256] = { LEDS_CURVE_TABLE(LEDS_CURVE_CIE) };
+    static const uint16_t members_1[] = { 0, 1 };
+    static const uint16_t members_2[] = { 2 };
+    leds_stats_t stats;
+
+    // TEST - curves are monotonic, reference values of float curves
+    for (uint32_t i = 0; i < 255; i++) {
+        if ((gamma_table[i] > gamma_table[i + 1]) || (cie_table[i] > cie_table[i + 1])) {
+            return cycle + 10;
+        }
+    }
+    if ((gamma_table[0] != 0) || (gamma_table[64] != 13) || (gamma_table[128] != 56) || (gamma_table[255] != 255) ||
+        (cie_table[0] != 0) || (cie_table[20] != 2) || (cie_table[64] != 11) || (cie_table[127] != 47) || (cie_table[255] != 255)) {
+        return cycle + 20;
+    }
+
+    leds_test_setup(1, LEDS_TEST_BAM_NUM + 1);
+    leds_set_bam(&test_inst, test_bam_ports, 1, LEDS_TEST_BAM_NUM);
+    leds_group_init(&test_inst, &test_groups[0], members_1, 2, 3);
+    leds_group_init(&test_inst, &test_groups[1], members_2, 1, 4);
+    test_sample_ms = 0;
+
+    // TEST - fade in and fade out with two steps, brightness in the middle
+    leds_group_fade(&test_inst, &test_groups[0], cie_table, 0, 255, 2550, 1275);
+    leds_group_fade(&test_inst, &test_groups[1], gamma_table, 255, 0, 2550, 1275);
+    sim_run(&test_sim, 1280, leds_test_bam_loop, NULL);
+    memset(test_on_ms, 0x00, sizeof(test_on_ms));
+    sim_run(&test_sim, LEDS_TEST_BAM_CYCLE, leds_test_bam_loop, NULL);
+    // CHECK
+    if ((test_on_ms[0] != cie_table[127]) || (test_on_ms[1] != cie_table[127]) || (test_on_ms[2] != gamma_table[128])) {
+        return cycle + 30;
+    }
+
+    // TEST - member leaves the group, fade is over
+    leds_on(&test_inst, 1);
+    sim_run(&test_sim, 2560 - 1280 - LEDS_TEST_BAM_CYCLE, leds_test_bam_loop, NULL);
+    memset(test_on_ms, 0x00, sizeof(test_on_ms));
+    sim_run(&test_sim, LEDS_TEST_BAM_CYCLE, leds_test_bam_loop, NULL);
+    leds_get_stats(&test_inst, &stats, true);
+    // CHECK - two steps of each group, timers are stopped
+    if ((test_on_ms[0] != 255) || (test_on_ms[1] != 255) || (test_on_ms[2] != 0) || (stats.blink_steps != 4)) {
+        return cycle + 40;
+    }
+    if ((swtimers_is_run(&test_swtimers_inst, 3, NULL) != false) || (swtimers_is_run(&test_swtimers_inst, 4, NULL) != false)) {
+        return cycle + 50;
+    }
+
+    // TEST - breathing, linear level is triangle of time base
+    leds_group_breathe(&test_inst, &test_groups[1], NULL, 2040, 1000);
+    uint32_t level = ((swtimers_get_time_ms(&test_swtimers_inst) % 2040) * 510) / 2040;
+    memset(test_on_ms, 0x00, sizeof(test_on_ms));
+    sim_run(&test_sim, LEDS_TEST_BAM_CYCLE, leds_test_bam_loop, NULL);
+    // CHECK
+    if (test_on_ms[2] != ((level > 255) ? (510 - level) : (level))) {
+        return cycle + 60;
+    }
+    level = (((swtimers_get_time_ms(&test_swtimers_inst) - LEDS_TEST_BAM_CYCLE + 1000) % 2040) * 510) / 2040;
+    sim_run(&test_sim, 1000, leds_test_bam_loop, NULL);
+    memset(test_on_ms, 0x00, sizeof(test_on_ms));
+    sim_run(&test_sim, LEDS_TEST_BAM_CYCLE, leds_test_bam_loop, NULL);
+    // CHECK - the next step
+    if (test_on_ms[2] != ((level > 255) ? (510 - level) : (level))) {
+        return cycle + 70;
+    }
+
+    // TEST - stop
+    leds_group_stop(&test_inst, &test_groups[1]);
+    sim_run(&test_sim, LEDS_TEST_BAM_CYCLE, leds_test_bam_loop, NULL);
+    // CHECK
+    if ((swtimers_is_run(&test_swtimers_inst, 4, NULL) != false) || (sim_get_pin(&test_sim, 2) != 0)) {
+        return cycle + 80;
+    }
+
+    leds_test_teardown();
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Init simulation and drivers, LED `i` uses GPIO pin `i` and timer `i`
+// Odd LEDs are active-low in the first test cycle only
+//-----------------------------------------------------------------------------
+static void leds_test_setup(uint32_t tick_ms, uint32_t leds_num)
+{
+    assert(leds_num <= LEDS_TEST_LEDS_NUM);
+
+    sim_init(&test_sim, tick_ms, test_pins, leds_num, test_history, LEDS_TEST_HISTORY_SIZE);
+    swtimers_init(&test_swtimers_inst, sim_get_swtimers_hw(&test_sim), leds_num, test_timers);
+    sim_attach_swtimers(&test_sim, &test_swtimers_inst);
+    leds_init(&test_inst, sim_get_leds_hw(&test_sim), leds_num, test_leds, &test_swtimers_inst);
+
+    for (uint32_t i = 0; i < leds_num; i++) {
+        leds_set_pin(&test_inst, i, i, i, (leds_num != 2) || ((i % 2) == 0));
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Deinit drivers
+//-----------------------------------------------------------------------------
+static void leds_test_teardown(void)
+{
+    leds_deinit(&test_inst);
+    swtimers_deinit(&test_swtimers_inst);
+}
+
+//-----------------------------------------------------------------------------
+// Check that pin is switched at given moments, states alternate
+//-----------------------------------------------------------------------------
+static int32_t leds_test_history_check(uint32_t pin_idx, const uint32_t * times_p, uint32_t num, uint8_t first_state)
+{
+    for (uint32_t i = 0; i < num; i++) {
+        const sim_record_t * record_p = sim_find_record(&test_sim, pin_idx, i);
+        if (record_p == NULL) {
+            return 1;
+        }
+        if (record_p->time_ms != times_p[i]) {
+            return 2;
+        }
+        if (record_p->pin_state != (first_state ^ (i % 2))) {
+            return 3;
+        }
+    }
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static void leds_test_loop(void * arg_p)
+{
+    (void)arg_p;
+    swtimers_task(&test_swtimers_inst);
+}
+
+//-----------------------------------------------------------------------------
+// Application loop which measures ON time of dimmed LEDs
+// (is called after each tick, state of pins is counted for the millisecond until the next tick)
+//-----------------------------------------------------------------------------
+static void leds_test_bam_loop(void * arg_p)
+{
+    (void)arg_p;
+    swtimers_task(&test_swtimers_inst);
+
+    if (sim_get_time_ms(&test_sim) == test_sample_ms) {
+        return;
+    }
+    test_sample_ms = sim_get_time_ms(&test_sim);
+
+    for (uint32_t i = 0; i < LEDS_TEST_BAM_NUM; i++) {
+        test_on_ms[i] += (sim_get_pin(&test_sim, i) == ((i == 5) ? (0) : (1))) ? (1) : (0);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Application loop of LED matrix
+//-----------------------------------------------------------------------------
+static void leds_test_matrix_loop(void * arg_p)
+{
+    (void)arg_p;
+    swtimers_task(&test_swtimers_inst);
+    leds_matrix_commit(&test_matrix);
+}
+
+//-----------------------------------------------------------------------------
+// Check that DMA buffer of strip is bit-by-bit expansion of pixels (G, R, B), ON pixel `i` has color (i * 7, 0xA5 ^ i, 255 - i)
+// or (1, 2, 3) for pixels 10 and 11 if they are changed (`is_changed`)
+//-----------------------------------------------------------------------------
+static bool leds_test_strip_check(uint32_t num, uint32_t format, bool is_changed)
+{
+    uint32_t line_bit = 0;
+
+    for (uint32_t i = 0; i < num; i++) {
+        bool is_on = leds_get_state(&test_inst, i, &is_on) && is_on;
+        uint8_t pixel[3] = { (uint8_t)(0xA5 ^ i), (uint8_t)(i * 7), (uint8_t)(255 - i) };
+        if (((i == 10) || (i == 11)) && is_changed) {
+            pixel[0] = 2;
+            pixel[1] = 1;
+            pixel[2] = 3;
+        }
+
+        for (uint32_t bit = 0; bit < 24; bit++, line_bit += format) {
+            bool is_one = is_on && (((pixel[bit / 8] >> (7 - (bit % 8))) & 1u) != 0);
+            // Line bits: 1, then 1 (or 11) for data one and 0 (or 00) for data zero, then 0
+            for (uint32_t k = 0; k < format; k++) {
+                uint32_t pos = line_bit + k;
+                bool expected = (k == 0) || ((k < format - 1) && is_one);
+                if ((((test_strip_dma[pos / 8] >> (7 - (pos % 8))) & 1u) != 0) != expected) {
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// Output of row of LED matrix, changes of LED 63 are counted
+//-----------------------------------------------------------------------------
+static void leds_test_row_out(void * hw_out_p, uint32_t row_idx, const uint8_t * data_p, uint32_t size)
+{
+    (void)hw_out_p;
+    assert((row_idx < LEDS_TEST_MATRIX_ROWS) && (size == LEDS_TEST_MATRIX_BYTES));
+
+    if ((row_idx == LEDS_TEST_MATRIX_ROWS - 1) && (((test_rows[row_idx][0] ^ data_p[0]) & 0x80) != 0)) {
+        test_last_changes++;
+    }
+    memcpy(test_rows[row_idx], data_p, size);
+    test_rows_cnt++;
+}
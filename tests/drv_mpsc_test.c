@@ -0,0 +1,210 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+//**************************************************************************************************
+// TESTS for lock-free bounded multi-producer single-consumer queue
+//**************************************************************************************************
+#if defined(__linux__)
+#define _GNU_SOURCE
+#endif
+
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "drv_mpsc.h"
+
+//==================================================================================================
+//============================================ TESTS ===============================================
+//==================================================================================================
+
+//-----------------------------------------------------------------------------
+// Additional test functions
+//-----------------------------------------------------------------------------
+static int32_t mpsc_test_cycle_1(uint32_t cycle);
+#if defined(__linux__)
+static int32_t mpsc_test_cycle_2(uint32_t cycle);
+
+static void * mpsc_test_producer(void * arg_p);
+#endif
+
+//-----------------------------------------------------------------------------
+// Additional test data
+//-----------------------------------------------------------------------------
+#define MPSC_TEST_CELLS_NUM     (8)
+#define MPSC_TEST_PRODUCERS_NUM (4)
+#define MPSC_TEST_ITEMS_NUM     (20000)     // items pushed by each producer
+
+// Item - producer id and sequence number of item of this producer
+typedef struct mpsc_test_item_s {
+    uint32_t    seq;
+    uint8_t     producer;
+} mpsc_test_item_t;
+
+static mpsc_t test_inst;
+static uint64_t test_cells[MPSC_TEST_CELLS_NUM * MPSC_CELL_SIZE(sizeof(mpsc_test_item_t)) / sizeof(uint64_t)];
+
+#if defined(__linux__)
+static const uint8_t test_producers_ids[MPSC_TEST_PRODUCERS_NUM] = { 0, 1, 2, 3 };
+static uint32_t test_next_seq[MPSC_TEST_PRODUCERS_NUM];
+#endif
+
+//-----------------------------------------------------------------------------
+// Run unit-tests
+//-----------------------------------------------------------------------------
+int32_t mpsc_tests(void)
+{
+    int32_t res;
+
+    // Test cycle 1
+    res = mpsc_test_cycle_1(1000); // res 1000 - 1999
+    if (res != 0) {
+        return res;
+    }
+
+#if defined(__linux__)
+    // Test cycle 2
+    res = mpsc_test_cycle_2(2000); // res 2000 - 2999
+    if (res != 0) {
+        return res;
+    }
+#endif
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Test cycle 1 - single producer, empty and full queue, several laps of the ring
+//-----------------------------------------------------------------------------
+static int32_t mpsc_test_cycle_1(uint32_t cycle)
+{
+    mpsc_test_item_t item = { 0 };
+    uint32_t pushed = 0;
+    uint32_t popped = 0;
+
+    mpsc_init(&test_inst, test_cells, MPSC_TEST_CELLS_NUM, sizeof(mpsc_test_item_t));
+
+    // TEST - pop from empty queue
+    // CHECK
+    if (mpsc_pop(&test_inst, &item) != false) {
+        return cycle + 10;
+    }
+
+    // TEST - fill the queue
+    for (uint32_t i = 0; i < MPSC_TEST_CELLS_NUM; ++i) {
+        item.seq = pushed;
+        // CHECK
+        if (mpsc_push(&test_inst, &item) != true) {
+            return cycle + 20;
+        }
+        pushed++;
+    }
+    // CHECK - full queue rejects item
+    if (mpsc_push(&test_inst, &item) != false) {
+        return cycle + 30;
+    }
+
+    // TEST - items go through several laps, the queue is kept full
+    for (uint32_t i = 0; i < 10 * MPSC_TEST_CELLS_NUM; ++i) {
+        // CHECK - items are popped in order of pushing
+        if ((mpsc_pop(&test_inst, &item) != true) || (item.seq != popped)) {
+            return cycle + 40;
+        }
+        popped++;
+
+        // CHECK - the freed cell is reused, the next push is rejected
+        item.seq = pushed;
+        if (mpsc_push(&test_inst, &item) != true) {
+            return cycle + 50;
+        }
+        pushed++;
+        item.seq = pushed;
+        if (mpsc_push(&test_inst, &item) != false) {
+            return cycle + 60;
+        }
+    }
+
+    // TEST - drain
+    while (mpsc_pop(&test_inst, &item)) {
+        // CHECK - rejected items aren't stored
+        if (item.seq != popped) {
+            return cycle + 70;
+        }
+        popped++;
+    }
+    // CHECK - each pushed item is popped once
+    if (popped != pushed) {
+        return cycle + 80;
+    }
+
+    return 0;
+}
+
+#if defined(__linux__)
+//-----------------------------------------------------------------------------
+// Test cycle 2 - concurrent producers, FIFO order of items of each producer
+//-----------------------------------------------------------------------------
+static int32_t mpsc_test_cycle_2(uint32_t cycle)
+{
+    pthread_t threads[MPSC_TEST_PRODUCERS_NUM];
+    mpsc_test_item_t item;
+    uint32_t popped = 0;
+
+    mpsc_init(&test_inst, test_cells, MPSC_TEST_CELLS_NUM, sizeof(mpsc_test_item_t));
+    memset(test_next_seq, 0x00, sizeof(test_next_seq));
+
+    // TEST - producers push into small queue, consumer pops concurrently
+    for (uint32_t p = 0; p < MPSC_TEST_PRODUCERS_NUM; ++p) {
+        if (pthread_create(&threads[p], NULL, &mpsc_test_producer, (void*)&test_producers_ids[p]) != 0) {
+            return cycle + 10;
+        }
+    }
+
+    while (popped < MPSC_TEST_PRODUCERS_NUM * MPSC_TEST_ITEMS_NUM) {
+        if (!mpsc_pop(&test_inst, &item)) {
+            sched_yield();
+            continue;
+        }
+        // CHECK - items of one producer are popped in order of pushing, without losses and duplicates
+        if ((item.producer >= MPSC_TEST_PRODUCERS_NUM) || (item.seq != test_next_seq[item.producer])) {
+            return cycle + 20;
+        }
+        test_next_seq[item.producer]++;
+        popped++;
+    }
+
+    for (uint32_t p = 0; p < MPSC_TEST_PRODUCERS_NUM; ++p) {
+        pthread_join(threads[p], NULL);
+    }
+
+    // CHECK - nothing is left
+    if (mpsc_pop(&test_inst, &item) != false) {
+        return cycle + 30;
+    }
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Producer thread - pushes items with increasing sequence numbers, retries while queue is full
+//-----------------------------------------------------------------------------
+static void * mpsc_test_producer(void * arg_p)
+{
+    mpsc_test_item_t item = {
+        .producer = *(const uint8_t*)arg_p,
+    };
+
+    for (uint32_t i = 0; i < MPSC_TEST_ITEMS_NUM; ++i) {
+        item.seq = i;
+        while (!mpsc_push(&test_inst, &item)) {
+            sched_yield();
+        }
+    }
+
+    return NULL;
+}
+#endif
@@ -0,0 +1,277 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+//**************************************************************************************************
+// TESTS for cycle-count profiling statistics and profiling hooks of drivers
+//**************************************************************************************************
+
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+
+#include "drv_prof.h"
+#include "drv_swtimers.h"
+#include "drv_leds.h"
+#include "drv_buttons.h"
+#include "sim.h"
+
+//==================================================================================================
+//============================================ TESTS ===============================================
+//==================================================================================================
+
+//-----------------------------------------------------------------------------
+// Additional test functions
+//-----------------------------------------------------------------------------
+static int32_t prof_test_cycle_1(uint32_t cycle);
+#if (DRV_PROF == 1)
+static int32_t prof_test_cycle_2(uint32_t cycle);
+
+static uint32_t prof_test_cycles(void);
+static void prof_test_handler(uint32_t timer_idx, void * arg_1_p, void * arg_2_p);
+static void prof_test_loop(void * arg_p);
+#endif
+
+//-----------------------------------------------------------------------------
+// Additional test data
+//-----------------------------------------------------------------------------
+#define PROF_TEST_TIMERS_NUM    (4)
+#define PROF_TEST_STEP          (100)   // increment of fake cycle counter on each reading
+
+static prof_stats_t test_stats;
+static prof_stats_t test_snapshot;
+
+#if (DRV_PROF == 1)
+// Simulation
+static sim_t test_sim;
+static sim_pin_t test_pins[PROF_TEST_TIMERS_NUM];
+
+// Instances
+static swtimers_t test_swtimers_inst;
+static swtimers_timer_t test_timers[PROF_TEST_TIMERS_NUM];
+static leds_t test_leds_inst;
+static leds_led_t test_leds[1];
+static buttons_t test_buttons_inst;
+static buttons_button_t test_buttons[1];
+
+// Profiling
+static uint32_t test_cycles;
+static uint32_t test_loop_cnt;
+static swtimers_prof_t test_swtimers_prof;
+static prof_stats_t test_handlers_stats[PROF_TEST_TIMERS_NUM];
+static prof_stats_t test_leds_stats;
+static prof_stats_t test_buttons_stats;
+
+static const buttons_time_settings_t test_times = {
+    .bouncing_ms = 20,
+    .double_click_ms = 300,
+    .hold_ms = 1000,
+};
+#endif
+
+//-----------------------------------------------------------------------------
+// Run unit-tests
+//-----------------------------------------------------------------------------
+int32_t prof_tests(void)
+{
+    int32_t res;
+
+    // Test cycle 1
+    res = prof_test_cycle_1(1000); // res 1000 - 1999
+    if (res != 0) {
+        return res;
+    }
+
+#if (DRV_PROF == 1)
+    // Test cycle 2
+    res = prof_test_cycle_2(2000); // res 2000 - 2999
+    if (res != 0) {
+        return res;
+    }
+#endif
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Test cycle 1 - accumulation of statistics, histogram, snapshot and reset
+//-----------------------------------------------------------------------------
+static int32_t prof_test_cycle_1(uint32_t cycle)
+{
+    memset(&test_stats, 0x00, sizeof(test_stats));
+
+    // TEST - histogram buckets
+    // CHECK
+    if ((prof_hist_bucket(0) != 0) || (prof_hist_bucket(1) != 1) || (prof_hist_bucket(2) != 2) ||
+        (prof_hist_bucket(3) != 2) || (prof_hist_bucket(1024) != 11) || (prof_hist_bucket(UINT32_MAX) != (PROF_HIST_SIZE - 1))) {
+        return cycle + 10;
+    }
+
+    // TEST - empty statistics
+    prof_stats_read(&test_stats, &test_snapshot);
+    // CHECK
+    if ((test_snapshot.count != 0) || (test_snapshot.max != 0) || (prof_stats_mean(&test_snapshot) != 0)) {
+        return cycle + 20;
+    }
+
+    // TEST - measurements
+    prof_stats_add(&test_stats, 50);
+    prof_stats_add(&test_stats, 10);
+    prof_stats_add(&test_stats, 300);
+    prof_stats_read(&test_stats, &test_snapshot);
+    // CHECK
+    if ((test_snapshot.count != 3) || (test_snapshot.min != 10) || (test_snapshot.max != 300) ||
+        (test_snapshot.sum != 360) || (prof_stats_mean(&test_snapshot) != 120)) {
+        return cycle + 30;
+    }
+    if ((test_snapshot.hist[4] != 1) || (test_snapshot.hist[6] != 1) || (test_snapshot.hist[9] != 1)) {
+        return cycle + 40;
+    }
+    // CHECK - writer doesn't update statistics now
+    if ((test_snapshot.seq != test_stats.seq) || ((test_snapshot.seq % 2) != 0)) {
+        return cycle + 50;
+    }
+
+    // TEST - reset is visible at once, applied by the next measurement
+    prof_stats_reset(&test_stats);
+    prof_stats_read(&test_stats, &test_snapshot);
+    // CHECK
+    if ((test_snapshot.count != 0) || (test_snapshot.sum != 0) || (test_snapshot.hist[4] != 0)) {
+        return cycle + 60;
+    }
+    prof_stats_add(&test_stats, 7);
+    prof_stats_read(&test_stats, &test_snapshot);
+    // CHECK
+    if ((test_snapshot.count != 1) || (test_snapshot.min != 7) || (test_snapshot.max != 7) ||
+        (test_snapshot.hist[3] != 1) || (test_snapshot.hist[9] != 0)) {
+        return cycle + 70;
+    }
+
+    return 0;
+}
+
+#if (DRV_PROF == 1)
+//-----------------------------------------------------------------------------
+// Test cycle 2 - profiling hooks of drivers (fake cycle counter runs PROF_TEST_STEP per reading)
+//  timer 0 - periodic handler from ISR, 10 ms
+//  timer 1 - periodic handler from loop, 25 ms
+//  timer 2 - LED meander, 50 ms
+//  timer 3 - polled button
+//-----------------------------------------------------------------------------
+static int32_t prof_test_cycle_2(uint32_t cycle)
+{
+    sim_init(&test_sim, 1, test_pins, PROF_TEST_TIMERS_NUM, NULL, 0);
+    swtimers_init(&test_swtimers_inst, sim_get_swtimers_hw(&test_sim), PROF_TEST_TIMERS_NUM, test_timers);
+    sim_attach_swtimers(&test_sim, &test_swtimers_inst);
+    leds_init(&test_leds_inst, sim_get_leds_hw(&test_sim), 1, test_leds, &test_swtimers_inst);
+    leds_set_pin(&test_leds_inst, 0, 2, 2, true);
+    buttons_init(&test_buttons_inst, sim_get_buttons_hw(&test_sim), 1, test_buttons, &test_swtimers_inst);
+    buttons_configure(&test_buttons_inst, 0, 3, 3, false, BUTTONS_CHECK_IN_POLLING, &test_times, NULL, NULL);
+
+    memset(&test_swtimers_prof, 0x00, sizeof(test_swtimers_prof));
+    memset(test_handlers_stats, 0x00, sizeof(test_handlers_stats));
+    memset(&test_leds_stats, 0x00, sizeof(test_leds_stats));
+    memset(&test_buttons_stats, 0x00, sizeof(test_buttons_stats));
+    test_swtimers_prof.cycles_cb = prof_test_cycles;
+    test_swtimers_prof.handlers_p = test_handlers_stats;
+    swtimers_set_prof(&test_swtimers_inst, &test_swtimers_prof);
+    leds_set_prof(&test_leds_inst, prof_test_cycles, &test_leds_stats);
+    buttons_set_prof(&test_buttons_inst, prof_test_cycles, &test_buttons_stats);
+    test_cycles = 0;
+    test_loop_cnt = 0;
+
+    swtimers_start(&test_swtimers_inst, 0, 10, SWTIMERS_MODE_PERIODIC_FROM_ISR, prof_test_handler, NULL, NULL);
+    swtimers_start(&test_swtimers_inst, 1, 25, SWTIMERS_MODE_PERIODIC_FROM_LOOP, prof_test_handler, NULL, NULL);
+    leds_meander(&test_leds_inst, 0, 50);
+    uint32_t led_writes = test_pins[2].writes_cnt;
+
+    // TEST - one second
+    sim_run(&test_sim, 1000, prof_test_loop, NULL);
+
+    // CHECK - handlers without nested measurements take one step
+    prof_stats_read(&test_handlers_stats[0], &test_snapshot);
+    if ((test_snapshot.count != 100) || (test_snapshot.min != PROF_TEST_STEP) || (test_snapshot.max != PROF_TEST_STEP)) {
+        return cycle + 10;
+    }
+    prof_stats_read(&test_handlers_stats[1], &test_snapshot);
+    if ((test_snapshot.count != 40) || (prof_stats_mean(&test_snapshot) != PROF_TEST_STEP)) {
+        return cycle + 20;
+    }
+    if (test_handlers_stats[3].count != 0) {
+        return cycle + 30;
+    }
+
+    // CHECK - each LED switching is measured, handler of LED timer includes it
+    prof_stats_read(&test_leds_stats, &test_snapshot);
+    if ((test_snapshot.count == 0) || (test_snapshot.count != (test_pins[2].writes_cnt - led_writes)) ||
+        (test_snapshot.max != PROF_TEST_STEP) || (test_snapshot.hist[prof_hist_bucket(PROF_TEST_STEP)] != test_snapshot.count)) {
+        return cycle + 40;
+    }
+    if ((test_handlers_stats[2].count != test_snapshot.count) || (test_handlers_stats[2].min != (3 * PROF_TEST_STEP))) {
+        return cycle + 50;
+    }
+
+    // CHECK - every call of task functions is measured
+    if ((test_swtimers_prof.task.count != test_loop_cnt) || (test_buttons_stats.count != test_loop_cnt)) {
+        return cycle + 60;
+    }
+    if ((test_swtimers_prof.isr.count == 0) || (test_swtimers_prof.isr.max < (3 * PROF_TEST_STEP))) {
+        return cycle + 70;
+    }
+
+    // TEST - reset while running
+    prof_stats_reset(&test_handlers_stats[0]);
+    sim_run(&test_sim, 100, prof_test_loop, NULL);
+    // CHECK
+    prof_stats_read(&test_handlers_stats[0], &test_snapshot);
+    if (test_snapshot.count != 10) {
+        return cycle + 80;
+    }
+
+    // TEST - detach
+    swtimers_set_prof(&test_swtimers_inst, NULL);
+    leds_set_prof(&test_leds_inst, NULL, NULL);
+    buttons_set_prof(&test_buttons_inst, NULL, NULL);
+    uint32_t cycles = test_cycles;
+    sim_run(&test_sim, 100, prof_test_loop, NULL);
+    // CHECK
+    if (test_cycles != cycles) {
+        return cycle + 90;
+    }
+
+    buttons_deinit(&test_buttons_inst);
+    leds_deinit(&test_leds_inst);
+    swtimers_deinit(&test_swtimers_inst);
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Fake cycle counter
+//-----------------------------------------------------------------------------
+static uint32_t prof_test_cycles(void)
+{
+    test_cycles += PROF_TEST_STEP;
+    return test_cycles;
+}
+
+//-----------------------------------------------------------------------------
+// Timer handler - does nothing
+//-----------------------------------------------------------------------------
+static void prof_test_handler(uint32_t timer_idx, void * arg_1_p, void * arg_2_p)
+{
+    (void)timer_idx;
+    (void)arg_1_p;
+    (void)arg_2_p;
+}
+
+//-----------------------------------------------------------------------------
+// Application loop
+//-----------------------------------------------------------------------------
+static void prof_test_loop(void * arg_p)
+{
+    (void)arg_p;
+    test_loop_cnt++;
+    swtimers_task(&test_swtimers_inst);
+    buttons_task(&test_buttons_inst);
+}
+#endif
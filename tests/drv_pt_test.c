@@ -0,0 +1,302 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+//**************************************************************************************************
+// TESTS for protothreads, run on virtual-time simulation of hardware
+//**************************************************************************************************
+
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+
+#include "drv_pt.h"
+#include "sim.h"
+
+//==================================================================================================
+//============================================ TESTS ===============================================
+//==================================================================================================
+
+//-----------------------------------------------------------------------------
+// Additional test functions
+//-----------------------------------------------------------------------------
+static int32_t pt_test_cycle_1(uint32_t cycle);
+static int32_t pt_test_cycle_2(uint32_t cycle, bool is_exit);
+
+static pt_state_t pt_test_timer_thread(pt_t * pt_p, void * arg_p);
+static pt_state_t pt_test_button_thread(pt_t * pt_p, void * arg_p);
+static void pt_test_step(void);
+static void pt_test_setup(const sim_record_t * wave_p, uint32_t wave_num);
+static void pt_test_teardown(void);
+static void pt_test_input(void * arg_p, uint32_t pin_idx, uint8_t pin_state);
+static void pt_test_loop(void * arg_p);
+
+//-----------------------------------------------------------------------------
+// Additional test data
+//-----------------------------------------------------------------------------
+#define PT_TEST_TIMERS_NUM  (2)     // timer 0 - protothread, timer 1 - button
+#define PT_TEST_STEPS_NUM   (8)
+
+static const buttons_time_settings_t test_times = {
+    .bouncing_ms = 20,
+    .double_click_ms = 300,
+    .hold_ms = 1000,
+};
+
+// Simulation
+static sim_t test_sim;
+static sim_pin_t test_pins[1];
+
+// Instances
+static swtimers_t test_swtimers_inst;
+static swtimers_timer_t test_timers[PT_TEST_TIMERS_NUM];
+static buttons_t test_buttons_inst;
+static buttons_button_t test_buttons[1];
+static pt_t test_pt;
+
+// Moments of virtual time when protothread passes its steps
+static uint32_t test_steps[PT_TEST_STEPS_NUM];
+static uint32_t test_steps_cnt;
+static uint8_t test_app_data;
+static bool test_is_ready;
+static bool test_is_exit;
+static buttons_event_t test_event;
+static uint32_t test_button_idx;
+
+//-----------------------------------------------------------------------------
+// Run unit-tests
+//-----------------------------------------------------------------------------
+int32_t pt_tests(void)
+{
+    int32_t res;
+
+    // Test cycle 1
+    res = pt_test_cycle_1(1000); // res 1000 - 1999
+    if (res != 0) {
+        return res;
+    }
+
+    // Test cycle 2
+    res = pt_test_cycle_2(2000, false); // res 2000 - 2999
+    if (res != 0) {
+        return res;
+    }
+
+    // Test cycle 3
+    res = pt_test_cycle_2(3000, true); // res 3000 - 3999
+    if (res != 0) {
+        return res;
+    }
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Test cycle 1 - timeouts, polling of flag and stop while waiting
+//-----------------------------------------------------------------------------
+static int32_t pt_test_cycle_1(uint32_t cycle)
+{
+    static const uint32_t steps[] = { 0, 100, 350, 350, 450, 500, 501 };
+    swtimers_stats_t stats;
+
+    pt_test_setup(NULL, 0);
+    pt_init(&test_pt, &test_swtimers_inst, 0, pt_test_timer_thread, &test_app_data);
+
+    // TEST - protothread runs until the first wait
+    pt_start(&test_pt);
+    // CHECK
+    if ((test_steps_cnt != 1) || (pt_is_exited(&test_pt) != false) || (test_pt.wait != PT_WAIT_TIMER)) {
+        return cycle + 10;
+    }
+
+    // TEST - timeouts, the flag is polled each 50 ms
+    sim_run(&test_sim, 480, pt_test_loop, NULL);
+    test_is_ready = true;
+    sim_run(&test_sim, 120, pt_test_loop, NULL);
+    // CHECK
+    if ((test_steps_cnt != sizeof(steps) / sizeof(steps[0])) || (memcmp(test_steps, steps, sizeof(steps)) != 0)) {
+        return cycle + 20;
+    }
+    // CHECK - each wait re-arms the same timer
+    swtimers_get_stats(&test_swtimers_inst, &stats, false);
+    if ((stats.started != 7) || (pt_is_exited(&test_pt) != false)) {
+        return cycle + 30;
+    }
+
+    // TEST - stop while waiting for timeout
+    pt_stop(&test_pt);
+    sim_run(&test_sim, 2000, pt_test_loop, NULL);
+    // CHECK - protothread isn't resumed
+    if ((test_steps_cnt != sizeof(steps) / sizeof(steps[0])) || (pt_is_exited(&test_pt) != true) ||
+        (swtimers_is_run(&test_swtimers_inst, 0, NULL) != false)) {
+        return cycle + 40;
+    }
+
+    // TEST - restart from the beginning
+    test_steps_cnt = 0;
+    pt_start(&test_pt);
+    sim_run(&test_sim, 100, pt_test_loop, NULL);
+    // CHECK
+    if ((test_steps_cnt != 2) || (test_steps[1] - test_steps[0] != 100)) {
+        return cycle + 50;
+    }
+
+    pt_test_teardown();
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Test cycle 2 - button events and exit from the middle of protothread
+//-----------------------------------------------------------------------------
+static int32_t pt_test_cycle_2(uint32_t cycle, bool is_exit)
+{
+    static const sim_record_t wave[] = {
+        { .time_ms = 100, .pin_state = 1 }, { .time_ms = 400, .pin_state = 0 },
+    };
+    static const uint32_t steps[] = { 0, 120, 420, 520 };
+    uint32_t steps_num = (is_exit) ? (3) : (4);
+
+    pt_test_setup(wave, sizeof(wave) / sizeof(wave[0]));
+    test_is_exit = is_exit;
+    pt_init(&test_pt, &test_swtimers_inst, 0, pt_test_button_thread, &test_app_data);
+    pt_start(&test_pt);
+
+    // TEST - protothread waits for press, release is filtered out by mask
+    sim_run(&test_sim, 300, pt_test_loop, NULL);
+    // CHECK
+    if ((test_steps_cnt != 2) || (test_event != BUTTONS_PRESSED) || (test_button_idx != 0) || (test_pt.wait != PT_WAIT_BUTTON)) {
+        return cycle + 10;
+    }
+
+    // TEST - release, then exit or timeout
+    sim_run(&test_sim, 1000, pt_test_loop, NULL);
+    // CHECK
+    if ((test_steps_cnt != steps_num) || (memcmp(test_steps, steps, steps_num * sizeof(steps[0])) != 0) ||
+        (pt_get_button_event(&test_pt, NULL) != BUTTONS_RELEASED)) {
+        return cycle + 20;
+    }
+    // CHECK - finished protothread doesn't hold the timer
+    if ((pt_is_exited(&test_pt) != true) || (test_pt.wait != PT_WAIT_NONE) || (test_pt.lc != 0) ||
+        (swtimers_is_run(&test_swtimers_inst, 0, NULL) != false)) {
+        return cycle + 30;
+    }
+
+    // TEST - events after exit are ignored
+    pt_buttons_handler(0, BUTTONS_PRESSED, &test_pt);
+    // CHECK
+    if (test_steps_cnt != steps_num) {
+        return cycle + 40;
+    }
+
+    pt_test_teardown();
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Protothread with timeouts and polling of flag
+//-----------------------------------------------------------------------------
+static pt_state_t pt_test_timer_thread(pt_t * pt_p, void * arg_p)
+{
+    (void)arg_p;
+    assert(arg_p == &test_app_data);
+
+    PT_BEGIN(pt_p);
+    pt_test_step();
+    PT_AWAIT_MS(pt_p, 100);
+    pt_test_step();
+    PT_AWAIT_MS(pt_p, 250);
+    pt_test_step();
+    PT_AWAIT_FLAG(pt_p, true);
+    pt_test_step();
+    PT_AWAIT_MS(pt_p, 100);
+    pt_test_step();
+    PT_AWAIT_FLAG_POLL(pt_p, test_is_ready, 50);
+    pt_test_step();
+    PT_AWAIT_MS(pt_p, 0);
+    pt_test_step();
+    PT_AWAIT_MS(pt_p, 10000);
+    pt_test_step();
+    PT_END(pt_p);
+}
+
+//-----------------------------------------------------------------------------
+// Protothread with button events
+//-----------------------------------------------------------------------------
+static pt_state_t pt_test_button_thread(pt_t * pt_p, void * arg_p)
+{
+    (void)arg_p;
+    assert(arg_p == &test_app_data);
+
+    PT_BEGIN(pt_p);
+    pt_test_step();
+    PT_AWAIT_BUTTON(pt_p, BUTTONS_PRESSED);
+    test_event = pt_get_button_event(pt_p, &test_button_idx);
+    pt_test_step();
+    PT_AWAIT_BUTTON(pt_p, BUTTONS_RELEASED);
+    pt_test_step();
+    if (test_is_exit) {
+        PT_EXIT(pt_p);
+    }
+    PT_AWAIT_MS(pt_p, 100);
+    pt_test_step();
+    PT_END(pt_p);
+}
+
+//-----------------------------------------------------------------------------
+// Save virtual time of protothread step
+//-----------------------------------------------------------------------------
+static void pt_test_step(void)
+{
+    assert(test_steps_cnt < PT_TEST_STEPS_NUM);
+    test_steps[test_steps_cnt] = (uint32_t)sim_get_time_ms(&test_sim);
+    test_steps_cnt++;
+}
+
+//-----------------------------------------------------------------------------
+// Init simulation and drivers, button 0 uses GPIO pin 0 and timer 1
+//-----------------------------------------------------------------------------
+static void pt_test_setup(const sim_record_t * wave_p, uint32_t wave_num)
+{
+    test_steps_cnt = 0;
+    test_is_ready = false;
+    test_is_exit = false;
+    test_event = BUTTONS_NO_EVENT;
+    test_button_idx = UINT32_MAX;
+
+    sim_init(&test_sim, 1, test_pins, 1, NULL, 0);
+    sim_set_waveform(&test_sim, wave_p, wave_num, pt_test_input, NULL);
+    swtimers_init(&test_swtimers_inst, sim_get_swtimers_hw(&test_sim), PT_TEST_TIMERS_NUM, test_timers);
+    sim_attach_swtimers(&test_sim, &test_swtimers_inst);
+    buttons_init(&test_buttons_inst, sim_get_buttons_hw(&test_sim), 1, test_buttons, &test_swtimers_inst);
+    buttons_configure(&test_buttons_inst, 0, 0, 1, false, BUTTONS_CHECK_IN_ISR, &test_times, pt_buttons_handler, &test_pt);
+}
+
+//-----------------------------------------------------------------------------
+// Deinit drivers
+//-----------------------------------------------------------------------------
+static void pt_test_teardown(void)
+{
+    pt_stop(&test_pt);
+    buttons_deinit(&test_buttons_inst);
+    swtimers_deinit(&test_swtimers_inst);
+}
+
+//-----------------------------------------------------------------------------
+// GPIO interrupt - passes changes into button checked in ISR
+//-----------------------------------------------------------------------------
+static void pt_test_input(void * arg_p, uint32_t pin_idx, uint8_t pin_state)
+{
+    (void)arg_p;
+    buttons_isr(&test_buttons_inst, pin_idx, pin_state != 0);
+}
+
+//-----------------------------------------------------------------------------
+// Application loop
+//-----------------------------------------------------------------------------
+static void pt_test_loop(void * arg_p)
+{
+    (void)arg_p;
+    swtimers_task(&test_swtimers_inst);
+    buttons_task(&test_buttons_inst);
+}
@@ -0,0 +1,371 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+//**************************************************************************************************
+// TESTS for multi-threaded software timers engine, run in real time on Linux
+//**************************************************************************************************
+#if defined(__linux__)
+
+#define _GNU_SOURCE
+
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+#include <stdatomic.h>
+
+#include "drv_swtimers_mt.h"
+
+//==================================================================================================
+//============================================ TESTS ===============================================
+//==================================================================================================
+
+//-----------------------------------------------------------------------------
+// Additional test functions
+//-----------------------------------------------------------------------------
+static int32_t swtimers_mt_test_cycle_1(uint32_t cycle);
+static int32_t swtimers_mt_test_cycle_2(uint32_t cycle);
+static int32_t swtimers_mt_test_cycle_3(uint32_t cycle);
+static int32_t swtimers_mt_test_cycle_4(uint32_t cycle);
+
+static bool swtimers_mt_test_setup(void);
+static bool swtimers_mt_test_wait(atomic_bool * flag_p);
+static bool swtimers_mt_test_block(swtimers_mode_t mode);
+static bool swtimers_mt_test_sync(void);
+static void swtimers_mt_test_sleep_us(uint32_t us);
+static void swtimers_mt_test_block_handler(uint32_t idx, void * arg_1_p, void * arg_2_p);
+static void swtimers_mt_test_count_handler(uint32_t idx, void * arg_1_p, void * arg_2_p);
+static void swtimers_mt_test_marker_handler(uint32_t idx, void * arg_1_p, void * arg_2_p);
+
+//-----------------------------------------------------------------------------
+// Additional test data
+//-----------------------------------------------------------------------------
+#define SWTIMERS_MT_TEST_TIMERS_NUM     (8)     // timer 0 - blocks thread, timer 7 - marker
+#define SWTIMERS_MT_TEST_MARKER_IDX     (SWTIMERS_MT_TEST_TIMERS_NUM - 1)
+#define SWTIMERS_MT_TEST_SLOTS_NUM      (8)
+#define SWTIMERS_MT_TEST_CMD_NUM        (4)
+#define SWTIMERS_MT_TEST_WORKERS_NUM    (1)     // all handlers FROM_LOOP are called from the same worker
+#define SWTIMERS_MT_TEST_JOB_NUM        (8)
+#define SWTIMERS_MT_TEST_TIMEOUT_US     (2000000u)
+
+static swtimers_mt_t test_inst;
+static swtimers_mt_timer_t test_timers[SWTIMERS_MT_TEST_TIMERS_NUM];
+static uint32_t test_slots[SWTIMERS_MT_TEST_SLOTS_NUM];
+static uint64_t test_cmd_cells[SWTIMERS_MT_TEST_CMD_NUM * SWTIMERS_MT_CMD_CELL_SIZE / sizeof(uint64_t)];
+static swtimers_mt_worker_t test_workers[SWTIMERS_MT_TEST_WORKERS_NUM];
+static uint64_t test_job_cells[SWTIMERS_MT_TEST_WORKERS_NUM * SWTIMERS_MT_TEST_JOB_NUM * SWTIMERS_MT_JOB_CELL_SIZE / sizeof(uint64_t)];
+
+static const swtimers_mt_config_t test_config = {
+    .tick_ms = 1,
+    .num = SWTIMERS_MT_TEST_TIMERS_NUM,
+    .timers_table_p = test_timers,
+    .slots_num = SWTIMERS_MT_TEST_SLOTS_NUM,
+    .slots_table_p = test_slots,
+    .cmd_num = SWTIMERS_MT_TEST_CMD_NUM,
+    .cmd_cells_p = test_cmd_cells,
+    .workers_num = SWTIMERS_MT_TEST_WORKERS_NUM,
+    .workers_table_p = test_workers,
+    .job_num = SWTIMERS_MT_TEST_JOB_NUM,
+    .job_cells_p = test_job_cells,
+};
+
+// State shared with handlers
+static atomic_bool test_is_blocked;
+static atomic_bool test_is_released;
+static atomic_bool test_is_marked;
+static atomic_uint test_calls[SWTIMERS_MT_TEST_TIMERS_NUM];
+
+//-----------------------------------------------------------------------------
+// Run unit-tests
+//-----------------------------------------------------------------------------
+int32_t swtimers_mt_tests(void)
+{
+    int32_t res;
+
+    // Test cycle 1
+    res = swtimers_mt_test_cycle_1(1000); // res 1000 - 1999
+    if (res != 0) {
+        return res;
+    }
+
+    // Test cycle 2
+    res = swtimers_mt_test_cycle_2(2000); // res 2000 - 2999
+    if (res != 0) {
+        return res;
+    }
+
+    // Test cycle 3
+    res = swtimers_mt_test_cycle_3(3000); // res 3000 - 3999
+    if (res != 0) {
+        return res;
+    }
+
+    // Test cycle 4
+    res = swtimers_mt_test_cycle_4(4000); // res 4000 - 4999
+    if (res != 0) {
+        return res;
+    }
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Test cycle 1 - full command queue while the timer thread is blocked
+//-----------------------------------------------------------------------------
+static int32_t swtimers_mt_test_cycle_1(uint32_t cycle)
+{
+    if (!swtimers_mt_test_setup()) {
+        return cycle + 10;
+    }
+
+    // TEST - handler called from the timer thread blocks it, commands aren't applied
+    if (!swtimers_mt_test_block(SWTIMERS_MODE_SINGLE_FROM_ISR)) {
+        atomic_store(&test_is_released, true);
+        swtimers_mt_deinit(&test_inst);
+        return cycle + 20;
+    }
+    bool is_queued = true;
+    for (uint32_t i = 0; i < SWTIMERS_MT_TEST_CMD_NUM; ++i) {
+        is_queued &= swtimers_mt_start(&test_inst, 1, 1, SWTIMERS_MODE_SINGLE_FROM_ISR, swtimers_mt_test_count_handler, NULL, NULL);
+    }
+    // CHECK - queue takes cmd_num commands, the next ones are rejected
+    bool is_rejected = !swtimers_mt_stop(&test_inst, 1) && !swtimers_mt_restart(&test_inst, 1);
+    atomic_store(&test_is_released, true);
+    if (!is_queued || !is_rejected) {
+        swtimers_mt_deinit(&test_inst);
+        return cycle + 30;
+    }
+
+    // TEST - queued commands are applied after unblocking
+    // CHECK - starts of the same timer replace each other, the last one expires once
+    if (!swtimers_mt_test_sync() || (atomic_load(&test_calls[1]) != 1) || swtimers_mt_is_run(&test_inst, 1)) {
+        swtimers_mt_deinit(&test_inst);
+        return cycle + 40;
+    }
+
+    swtimers_mt_deinit(&test_inst);
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Test cycle 2 - stop and restart invalidate handler calls dispatched to worker
+//-----------------------------------------------------------------------------
+static int32_t swtimers_mt_test_cycle_2(uint32_t cycle)
+{
+    if (!swtimers_mt_test_setup()) {
+        return cycle + 10;
+    }
+
+    // TEST - worker is blocked, timers 1 and 2 expire, their calls wait in the job queue
+    bool is_ok = swtimers_mt_test_block(SWTIMERS_MODE_SINGLE_FROM_LOOP) &&
+                 swtimers_mt_start(&test_inst, 1, 1, SWTIMERS_MODE_SINGLE_FROM_LOOP, swtimers_mt_test_count_handler, NULL, NULL) &&
+                 swtimers_mt_start(&test_inst, 2, 1, SWTIMERS_MODE_SINGLE_FROM_LOOP, swtimers_mt_test_count_handler, NULL, NULL) &&
+                 swtimers_mt_test_sync();
+    // CHECK
+    if (!is_ok || swtimers_mt_is_run(&test_inst, 1) || swtimers_mt_is_run(&test_inst, 2)) {
+        atomic_store(&test_is_released, true);
+        swtimers_mt_deinit(&test_inst);
+        return cycle + 20;
+    }
+
+    // TEST - stop timer 1, restart timer 2 (it expires once again)
+    is_ok = swtimers_mt_stop(&test_inst, 1) && swtimers_mt_restart(&test_inst, 2) && swtimers_mt_test_sync();
+    atomic_store(&test_is_released, true);
+    swtimers_mt_deinit(&test_inst);
+    // CHECK - stale calls are dropped, the call after restart is done
+    if (!is_ok || (atomic_load(&test_calls[0]) != 1) || (atomic_load(&test_calls[1]) != 0) || (atomic_load(&test_calls[2]) != 1)) {
+        return cycle + 30;
+    }
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Test cycle 3 - deinit calls handlers dispatched to running worker
+//-----------------------------------------------------------------------------
+static int32_t swtimers_mt_test_cycle_3(uint32_t cycle)
+{
+    if (!swtimers_mt_test_setup()) {
+        return cycle + 10;
+    }
+
+    // TEST - calls of timers 1 .. 4 wait in the job queue behind blocked handler
+    bool is_ok = swtimers_mt_test_block(SWTIMERS_MODE_SINGLE_FROM_LOOP);
+    for (uint32_t idx = 1; idx <= 4; ++idx) {
+        while (is_ok && !swtimers_mt_start(&test_inst, idx, 1, SWTIMERS_MODE_SINGLE_FROM_LOOP, swtimers_mt_test_count_handler, NULL, NULL)) {
+            swtimers_mt_test_sleep_us(100);
+        }
+    }
+    is_ok = is_ok && swtimers_mt_test_sync();
+
+    // TEST - deinit right after unblocking of worker
+    atomic_store(&test_is_released, true);
+    swtimers_mt_deinit(&test_inst);
+    // CHECK - all dispatched calls are done before exit of worker
+    if (!is_ok || (atomic_load(&test_calls[0]) != 1)) {
+        return cycle + 20;
+    }
+    for (uint32_t idx = 1; idx <= 4; ++idx) {
+        if (atomic_load(&test_calls[idx]) != 1) {
+            return cycle + 30;
+        }
+    }
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Test cycle 4 - full job queue doesn't block the timer thread
+//-----------------------------------------------------------------------------
+static int32_t swtimers_mt_test_cycle_4(uint32_t cycle)
+{
+    if (!swtimers_mt_test_setup()) {
+        return cycle + 10;
+    }
+
+    // TEST - worker is blocked, periodic timer 1 fills its job queue
+    bool is_ok = swtimers_mt_test_block(SWTIMERS_MODE_SINGLE_FROM_LOOP) &&
+                 swtimers_mt_start(&test_inst, 1, 1, SWTIMERS_MODE_PERIODIC_FROM_LOOP, swtimers_mt_test_count_handler, NULL, NULL);
+    uint32_t us = 0;
+    while (is_ok && (swtimers_mt_get_overruns(&test_inst) == 0)) {
+        if (us >= SWTIMERS_MT_TEST_TIMEOUT_US) {
+            is_ok = false;
+            break;
+        }
+        swtimers_mt_test_sleep_us(100);
+        us += 100;
+    }
+    // CHECK - calls which don't fit into the queue are counted, the timer thread keeps ticking
+    if (!is_ok || !swtimers_mt_test_sync()) {
+        atomic_store(&test_is_released, true);
+        swtimers_mt_deinit(&test_inst);
+        return cycle + 20;
+    }
+
+    // TEST - stop timer 1 and unblock worker
+    is_ok = swtimers_mt_stop(&test_inst, 1) && swtimers_mt_test_sync();
+    atomic_store(&test_is_released, true);
+    swtimers_mt_deinit(&test_inst);
+    // CHECK - calls of stopped timer which wait in the queue are dropped
+    if (!is_ok || (atomic_load(&test_calls[0]) != 1) || (atomic_load(&test_calls[1]) != 0)) {
+        return cycle + 30;
+    }
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Reset state of handlers and init driver
+//
+// Returns - 'true' if driver is initialized
+//-----------------------------------------------------------------------------
+static bool swtimers_mt_test_setup(void)
+{
+    atomic_store(&test_is_blocked, false);
+    atomic_store(&test_is_released, false);
+    atomic_store(&test_is_marked, false);
+    for (uint32_t i = 0; i < SWTIMERS_MT_TEST_TIMERS_NUM; ++i) {
+        atomic_store(&test_calls[i], 0);
+    }
+
+    return swtimers_mt_init(&test_inst, &test_config);
+}
+
+//-----------------------------------------------------------------------------
+// Wait until flag is set by handler
+//
+// Returns - 'true' if flag is set, 'false' on timeout
+//-----------------------------------------------------------------------------
+static bool swtimers_mt_test_wait(atomic_bool * flag_p)
+{
+    for (uint32_t us = 0; us < SWTIMERS_MT_TEST_TIMEOUT_US; us += 100) {
+        if (atomic_load(flag_p)) {
+            return true;
+        }
+        swtimers_mt_test_sleep_us(100);
+    }
+
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+// Start timer 0 with handler which blocks the calling thread until `test_is_released`
+//
+// `mode` - SINGLE_FROM_ISR - block the timer thread, SINGLE_FROM_LOOP - block the worker
+//
+// Returns - 'true' if the thread is blocked
+//-----------------------------------------------------------------------------
+static bool swtimers_mt_test_block(swtimers_mode_t mode)
+{
+    if (!swtimers_mt_start(&test_inst, 0, 1, mode, swtimers_mt_test_block_handler, NULL, NULL)) {
+        return false;
+    }
+
+    return swtimers_mt_test_wait(&test_is_blocked);
+}
+
+//-----------------------------------------------------------------------------
+// Wait until all commands posted before are applied and timers started by them with 1 ms expire
+// Marker timer is started after them with 2 ms and called from the timer thread
+//
+// Returns - 'true' if marker is called
+//-----------------------------------------------------------------------------
+static bool swtimers_mt_test_sync(void)
+{
+    atomic_store(&test_is_marked, false);
+
+    while (!swtimers_mt_start(&test_inst, SWTIMERS_MT_TEST_MARKER_IDX, 2, SWTIMERS_MODE_SINGLE_FROM_ISR,
+                              swtimers_mt_test_marker_handler, NULL, NULL)) {
+        swtimers_mt_test_sleep_us(100);
+    }
+
+    return swtimers_mt_test_wait(&test_is_marked);
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static void swtimers_mt_test_sleep_us(uint32_t us)
+{
+    struct timespec ts = {
+        .tv_sec = 0,
+        .tv_nsec = (long)us * 1000L,
+    };
+
+    nanosleep(&ts, NULL);
+}
+
+//-----------------------------------------------------------------------------
+// Handlers
+//-----------------------------------------------------------------------------
+static void swtimers_mt_test_block_handler(uint32_t idx, void * arg_1_p, void * arg_2_p)
+{
+    (void)arg_1_p;
+    (void)arg_2_p;
+
+    atomic_fetch_add(&test_calls[idx], 1);
+    atomic_store(&test_is_blocked, true);
+
+    while (!atomic_load(&test_is_released)) {
+        swtimers_mt_test_sleep_us(100);
+    }
+}
+
+static void swtimers_mt_test_count_handler(uint32_t idx, void * arg_1_p, void * arg_2_p)
+{
+    (void)arg_1_p;
+    (void)arg_2_p;
+
+    atomic_fetch_add(&test_calls[idx], 1);
+}
+
+static void swtimers_mt_test_marker_handler(uint32_t idx, void * arg_1_p, void * arg_2_p)
+{
+    (void)idx;
+    (void)arg_1_p;
+    (void)arg_2_p;
+
+    atomic_store(&test_is_marked, true);
+}
+
+#endif // defined(__linux__)
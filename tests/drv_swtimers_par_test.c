@@ -0,0 +1,305 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+//**************************************************************************************************
+// TESTS for parallel dispatch of software timers handlers, run on virtual-time simulation of hardware
+// with real worker threads on Linux
+//**************************************************************************************************
+#if defined(__linux__)
+
+#define _GNU_SOURCE
+
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+#include <sched.h>
+#include <stdatomic.h>
+
+#include "drv_swtimers_par.h"
+#include "sim.h"
+
+//==================================================================================================
+//============================================ TESTS ===============================================
+//==================================================================================================
+
+//-----------------------------------------------------------------------------
+// Additional test functions
+//-----------------------------------------------------------------------------
+static int32_t swtimers_par_test_cycle_1(uint32_t cycle);
+static int32_t swtimers_par_test_cycle_2(uint32_t cycle);
+
+static bool swtimers_par_test_setup(void);
+static void swtimers_par_test_teardown(void);
+static void swtimers_par_test_sleep_us(uint32_t us);
+static void swtimers_par_test_block_handler(uint32_t idx, void * arg_1_p, void * arg_2_p);
+static void swtimers_par_test_count_handler(uint32_t idx, void * arg_1_p, void * arg_2_p);
+static void swtimers_par_test_serial_handler(uint32_t idx, void * arg_1_p, void * arg_2_p);
+static void swtimers_par_test_loop(void * arg_p);
+
+//-----------------------------------------------------------------------------
+// Additional test data
+//-----------------------------------------------------------------------------
+#define SWTIMERS_PAR_TEST_TIMERS_NUM    (6)
+#define SWTIMERS_PAR_TEST_WORKERS_NUM   (2)
+#define SWTIMERS_PAR_TEST_GROUPS_NUM    (1)
+#define SWTIMERS_PAR_TEST_PERIOD_MS     (10)
+#define SWTIMERS_PAR_TEST_TICKS_NUM     (10)
+#define SWTIMERS_PAR_TEST_ORDER_NUM     (3 * SWTIMERS_PAR_TEST_TICKS_NUM)
+#define SWTIMERS_PAR_TEST_TIMEOUT_US    (2000000u)
+
+// Simulation
+static sim_t test_sim;
+static sim_pin_t test_pins[1];
+
+// Instances
+static swtimers_t test_swtimers_inst;
+static swtimers_timer_t test_timers[SWTIMERS_PAR_TEST_TIMERS_NUM];
+static swtimers_par_t test_inst;
+static swtimers_par_worker_t test_workers[SWTIMERS_PAR_TEST_WORKERS_NUM];
+static swtimers_par_job_t * test_units[SWTIMERS_PAR_TEST_TIMERS_NUM];
+static swtimers_par_group_t test_groups[SWTIMERS_PAR_TEST_GROUPS_NUM];
+static swtimers_par_job_t test_jobs[SWTIMERS_PAR_TEST_TIMERS_NUM];
+
+// Calls of handlers
+static atomic_uint test_calls[SWTIMERS_PAR_TEST_TIMERS_NUM];
+static atomic_uint test_others_cnt;
+static atomic_bool test_is_timeout;
+
+// Serial group - order of calls and overlapping
+static uint32_t test_order[SWTIMERS_PAR_TEST_ORDER_NUM];
+static uint32_t test_order_cnt;
+static atomic_bool test_is_inside;
+static atomic_bool test_is_overlap;
+
+//-----------------------------------------------------------------------------
+// Run unit-tests
+//-----------------------------------------------------------------------------
+int32_t swtimers_par_tests(void)
+{
+    int32_t res;
+
+    // Test cycle 1
+    res = swtimers_par_test_cycle_1(1000); // res 1000 - 1999
+    if (res != 0) {
+        return res;
+    }
+
+    // Test cycle 2
+    res = swtimers_par_test_cycle_2(2000); // res 2000 - 2999
+    if (res != 0) {
+        return res;
+    }
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Test cycle 1 - work stealing
+//
+// 6 units are partitioned between 3 participants by 2, the calling thread owns units of timers 4 and 5
+// and takes unit 5 first. Handler of timer 5 blocks until all other handlers are finished, so handler
+// of timer 4 can be called only by worker which steals it
+//-----------------------------------------------------------------------------
+static int32_t swtimers_par_test_cycle_1(uint32_t cycle)
+{
+    int32_t res = 0;
+
+    if (!swtimers_par_test_setup()) {
+        return cycle + 10;
+    }
+
+    for (uint32_t i = 0; i < SWTIMERS_PAR_TEST_TIMERS_NUM; ++i) {
+        swtimers_handler_cb_t handler_cb = (i == SWTIMERS_PAR_TEST_TIMERS_NUM - 1) ? (swtimers_par_test_block_handler)
+                                                                                   : (swtimers_par_test_count_handler);
+        swtimers_par_job_init(&test_jobs[i], handler_cb, NULL, NULL, SWTIMERS_PAR_NO_GROUP);
+        swtimers_par_start(&test_inst, &test_swtimers_inst, i, SWTIMERS_PAR_TEST_PERIOD_MS,
+                           SWTIMERS_MODE_SINGLE_FROM_LOOP, &test_jobs[i]);
+    }
+
+    // TEST - all timers expire on the same tick
+    sim_run(&test_sim, SWTIMERS_PAR_TEST_PERIOD_MS + 1, swtimers_par_test_loop, NULL);
+    // CHECK - blocked handler didn't hold other handlers
+    if (atomic_load(&test_is_timeout) != false) {
+        res = cycle + 20;
+    }
+    // CHECK - each handler is called once
+    for (uint32_t i = 0; (i < SWTIMERS_PAR_TEST_TIMERS_NUM) && (res == 0); ++i) {
+        if (atomic_load(&test_calls[i]) != 1) {
+            res = cycle + 30;
+        }
+    }
+
+    swtimers_par_test_teardown();
+
+    return res;
+}
+
+//-----------------------------------------------------------------------------
+// Test cycle 2 - serial group ordering
+//
+// Odd timers belong to serial group 0, even timers are parallel-safe
+//-----------------------------------------------------------------------------
+static int32_t swtimers_par_test_cycle_2(uint32_t cycle)
+{
+    int32_t res = 0;
+
+    if (!swtimers_par_test_setup()) {
+        return cycle + 10;
+    }
+
+    for (uint32_t i = 0; i < SWTIMERS_PAR_TEST_TIMERS_NUM; ++i) {
+        if ((i % 2) != 0) {
+            swtimers_par_job_init(&test_jobs[i], swtimers_par_test_serial_handler, NULL, NULL, 0);
+        } else {
+            swtimers_par_job_init(&test_jobs[i], swtimers_par_test_count_handler, NULL, NULL, SWTIMERS_PAR_NO_GROUP);
+        }
+        swtimers_par_start(&test_inst, &test_swtimers_inst, i, SWTIMERS_PAR_TEST_PERIOD_MS,
+                           SWTIMERS_MODE_PERIODIC_FROM_LOOP, &test_jobs[i]);
+    }
+
+    // TEST - all timers expire on the same ticks
+    sim_run(&test_sim, SWTIMERS_PAR_TEST_PERIOD_MS * SWTIMERS_PAR_TEST_TICKS_NUM, swtimers_par_test_loop, NULL);
+    // CHECK - handlers of the group aren't called at the same time
+    if (atomic_load(&test_is_overlap) != false) {
+        res = cycle + 20;
+    }
+    // CHECK - handlers of the group are called in order of timers indexes on each tick
+    if ((res == 0) && (test_order_cnt != SWTIMERS_PAR_TEST_ORDER_NUM)) {
+        res = cycle + 30;
+    }
+    for (uint32_t i = 0; (i < test_order_cnt) && (res == 0); ++i) {
+        if (test_order[i] != 2 * (i % 3) + 1) {
+            res = cycle + 40;
+        }
+    }
+    // CHECK - each handler is called once per tick
+    for (uint32_t i = 0; (i < SWTIMERS_PAR_TEST_TIMERS_NUM) && (res == 0); ++i) {
+        if (atomic_load(&test_calls[i]) != SWTIMERS_PAR_TEST_TICKS_NUM) {
+            res = cycle + 50;
+        }
+    }
+
+    swtimers_par_test_teardown();
+
+    return res;
+}
+
+//-----------------------------------------------------------------------------
+// Init simulation and drivers
+//
+// Returns - 'true' if worker threads are started
+//-----------------------------------------------------------------------------
+static bool swtimers_par_test_setup(void)
+{
+    for (uint32_t i = 0; i < SWTIMERS_PAR_TEST_TIMERS_NUM; ++i) {
+        atomic_store(&test_calls[i], 0);
+    }
+    atomic_store(&test_others_cnt, 0);
+    atomic_store(&test_is_timeout, false);
+    atomic_store(&test_is_inside, false);
+    atomic_store(&test_is_overlap, false);
+    test_order_cnt = 0;
+
+    sim_init(&test_sim, 1, test_pins, 1, NULL, 0);
+    swtimers_init(&test_swtimers_inst, sim_get_swtimers_hw(&test_sim), SWTIMERS_PAR_TEST_TIMERS_NUM, test_timers);
+    sim_attach_swtimers(&test_sim, &test_swtimers_inst);
+
+    if (!swtimers_par_init(&test_inst, test_workers, SWTIMERS_PAR_TEST_WORKERS_NUM, test_units, SWTIMERS_PAR_TEST_TIMERS_NUM,
+                           test_groups, SWTIMERS_PAR_TEST_GROUPS_NUM)) {
+        swtimers_deinit(&test_swtimers_inst);
+        return false;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// Deinit drivers
+//-----------------------------------------------------------------------------
+static void swtimers_par_test_teardown(void)
+{
+    swtimers_par_deinit(&test_inst);
+    swtimers_deinit(&test_swtimers_inst);
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static void swtimers_par_test_sleep_us(uint32_t us)
+{
+    struct timespec ts = {
+        .tv_sec = 0,
+        .tv_nsec = (long)us * 1000L,
+    };
+
+    nanosleep(&ts, NULL);
+}
+
+//-----------------------------------------------------------------------------
+// Handler which blocks until handlers of all other timers are finished
+//-----------------------------------------------------------------------------
+static void swtimers_par_test_block_handler(uint32_t idx, void * arg_1_p, void * arg_2_p)
+{
+    (void)arg_1_p;
+    (void)arg_2_p;
+
+    uint32_t us = 0;
+    while (atomic_load(&test_others_cnt) != SWTIMERS_PAR_TEST_TIMERS_NUM - 1) {
+        if (us >= SWTIMERS_PAR_TEST_TIMEOUT_US) {
+            atomic_store(&test_is_timeout, true);
+            break;
+        }
+        swtimers_par_test_sleep_us(100);
+        us += 100;
+    }
+
+    atomic_fetch_add(&test_calls[idx], 1);
+}
+
+//-----------------------------------------------------------------------------
+// Parallel-safe handler
+//-----------------------------------------------------------------------------
+static void swtimers_par_test_count_handler(uint32_t idx, void * arg_1_p, void * arg_2_p)
+{
+    (void)arg_1_p;
+    (void)arg_2_p;
+
+    // Give other participants a chance to run at the same time
+    sched_yield();
+
+    atomic_fetch_add(&test_calls[idx], 1);
+    atomic_fetch_add(&test_others_cnt, 1);
+}
+
+//-----------------------------------------------------------------------------
+// Handler of serial group - saves order of calls, detects calls at the same time
+//-----------------------------------------------------------------------------
+static void swtimers_par_test_serial_handler(uint32_t idx, void * arg_1_p, void * arg_2_p)
+{
+    (void)arg_1_p;
+    (void)arg_2_p;
+
+    if (atomic_exchange(&test_is_inside, true)) {
+        atomic_store(&test_is_overlap, true);
+    }
+
+    sched_yield();
+    if (test_order_cnt < SWTIMERS_PAR_TEST_ORDER_NUM) {
+        test_order[test_order_cnt] = idx;
+    }
+    test_order_cnt++;
+    atomic_fetch_add(&test_calls[idx], 1);
+
+    atomic_store(&test_is_inside, false);
+}
+
+//-----------------------------------------------------------------------------
+// Application loop
+//-----------------------------------------------------------------------------
+static void swtimers_par_test_loop(void * arg_p)
+{
+    (void)arg_p;
+    swtimers_par_task(&test_inst, &test_swtimers_inst);
+}
+
+#endif // defined(__linux__)
@@ -0,0 +1,175 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+//**************************************************************************************************
+// TESTS for POSIX hardware backend for software timers, run in real time on Linux
+//**************************************************************************************************
+#if defined(__linux__)
+
+#define _GNU_SOURCE
+
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+#include <poll.h>
+#include <stdatomic.h>
+
+#include "drv_swtimers_posix.h"
+
+//==================================================================================================
+//============================================ TESTS ===============================================
+//==================================================================================================
+
+//-----------------------------------------------------------------------------
+// Additional test functions
+//-----------------------------------------------------------------------------
+static int32_t swtimers_posix_test_cycle_1(uint32_t cycle, bool is_tickless);
+
+static bool swtimers_posix_test_is_readable(int timeout_ms);
+static void swtimers_posix_test_sleep_ms(uint32_t ms);
+static void swtimers_posix_test_handler(uint32_t idx, void * arg_1_p, void * arg_2_p);
+
+//-----------------------------------------------------------------------------
+// Additional test data
+//-----------------------------------------------------------------------------
+#define SWTIMERS_POSIX_TEST_LOOPS_NUM   (50)
+#define SWTIMERS_POSIX_TEST_PERIOD_MS   (2)
+#define SWTIMERS_POSIX_TEST_TIMEOUT_MS  (1000)
+
+static swtimers_posix_t test_posix_inst;
+static swtimers_t test_swtimers_inst;
+static swtimers_timer_t test_timers[1];
+
+static atomic_uint test_calls;
+
+//-----------------------------------------------------------------------------
+// Run unit-tests
+//-----------------------------------------------------------------------------
+int32_t swtimers_posix_tests(void)
+{
+    int32_t res;
+
+    // Test cycle 1
+    res = swtimers_posix_test_cycle_1(1000, false); // res 1000 - 1999
+    if (res != 0) {
+        return res;
+    }
+
+    // Test cycle 2
+    res = swtimers_posix_test_cycle_1(2000, true); // res 2000 - 2999
+    if (res != 0) {
+        return res;
+    }
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Test cycle 1 - wake-ups of application loop, work appears between acknowledge and swtimers_task()
+//-----------------------------------------------------------------------------
+static int32_t swtimers_posix_test_cycle_1(uint32_t cycle, bool is_tickless)
+{
+    int32_t res = 0;
+
+    atomic_store(&test_calls, 0);
+    if (!swtimers_posix_init(&test_posix_inst, 1, is_tickless)) {
+        return cycle + 10;
+    }
+    swtimers_init(&test_swtimers_inst, swtimers_posix_get_hw_interface(&test_posix_inst), 1, test_timers);
+    if (!swtimers_posix_start(&test_posix_inst, &test_swtimers_inst)) {
+        swtimers_deinit(&test_swtimers_inst);
+        swtimers_posix_deinit(&test_posix_inst);
+        return cycle + 20;
+    }
+
+    // CHECK - nothing to do
+    if (swtimers_posix_test_is_readable(0)) {
+        res = cycle + 30;
+    }
+
+    swtimers_start(&test_swtimers_inst, 0, SWTIMERS_POSIX_TEST_PERIOD_MS, SWTIMERS_MODE_PERIODIC_FROM_LOOP,
+                   swtimers_posix_test_handler, NULL, NULL);
+
+    for (uint32_t i = 0; (i < SWTIMERS_POSIX_TEST_LOOPS_NUM) && (res == 0); ++i) {
+        // TEST - application loop waits for expiration
+        // CHECK - wake-up isn't lost
+        if (!swtimers_posix_test_is_readable(SWTIMERS_POSIX_TEST_TIMEOUT_MS)) {
+            res = cycle + 40;
+            break;
+        }
+
+        // TEST - timer expires between acknowledge and swtimers_task()
+        swtimers_posix_ack(&test_posix_inst);
+        swtimers_posix_test_sleep_ms(2 * SWTIMERS_POSIX_TEST_PERIOD_MS + 1);
+        // CHECK - descriptor is readable again (lost wake-up isn't restored by later expirations, the wait times out)
+        if (!swtimers_posix_test_is_readable(SWTIMERS_POSIX_TEST_TIMEOUT_MS)) {
+            res = cycle + 50;
+            break;
+        }
+
+        swtimers_task(&test_swtimers_inst);
+    }
+
+    // CHECK - handler is called at each wake-up
+    if ((res == 0) && (atomic_load(&test_calls) < SWTIMERS_POSIX_TEST_LOOPS_NUM)) {
+        res = cycle + 60;
+    }
+
+    // TEST - all work is done and acknowledged
+    swtimers_stop(&test_swtimers_inst, 0);
+    swtimers_posix_ack(&test_posix_inst);
+    swtimers_task(&test_swtimers_inst);
+    // CHECK
+    if ((res == 0) && swtimers_posix_test_is_readable(0)) {
+        res = cycle + 70;
+    }
+
+    swtimers_deinit(&test_swtimers_inst);
+    swtimers_posix_deinit(&test_posix_inst);
+
+    return res;
+}
+
+//-----------------------------------------------------------------------------
+// Wait until descriptor of the backend is readable
+//
+// `timeout_ms` - timeout of poll() in milliseconds (0 - check without waiting)
+//
+// Returns - 'true' if descriptor is readable
+//-----------------------------------------------------------------------------
+static bool swtimers_posix_test_is_readable(int timeout_ms)
+{
+    struct pollfd pfd = {
+        .fd = swtimers_posix_get_fd(&test_posix_inst),
+        .events = POLLIN,
+    };
+
+    return (poll(&pfd, 1, timeout_ms) == 1) && ((pfd.revents & POLLIN) != 0);
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static void swtimers_posix_test_sleep_ms(uint32_t ms)
+{
+    struct timespec ts = {
+        .tv_sec = 0,
+        .tv_nsec = (long)ms * 1000000L,
+    };
+
+    nanosleep(&ts, NULL);
+}
+
+//-----------------------------------------------------------------------------
+// Timer handler
+//-----------------------------------------------------------------------------
+static void swtimers_posix_test_handler(uint32_t idx, void * arg_1_p, void * arg_2_p)
+{
+    (void)idx;
+    (void)arg_1_p;
+    (void)arg_2_p;
+
+    atomic_fetch_add(&test_calls, 1);
+}
+
+#endif // defined(__linux__)
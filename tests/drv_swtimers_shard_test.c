@@ -0,0 +1,285 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+//**************************************************************************************************
+// TESTS for sharded software timers, run on virtual-time simulation of hardware (one simulation per shard)
+//**************************************************************************************************
+
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+
+#include "drv_swtimers_shard.h"
+#include "sim.h"
+
+//==================================================================================================
+//============================================ TESTS ===============================================
+//==================================================================================================
+
+//-----------------------------------------------------------------------------
+// Additional test functions
+//-----------------------------------------------------------------------------
+static int32_t swtimers_shard_test_cycle_1(uint32_t cycle);
+static int32_t swtimers_shard_test_cycle_2(uint32_t cycle);
+
+static void swtimers_shard_test_setup(void);
+static void swtimers_shard_test_teardown(void);
+static void swtimers_shard_test_run(uint32_t shard, uint64_t duration_ms);
+static void swtimers_shard_test_handler(uint32_t idx, void * arg_1_p, void * arg_2_p);
+static void swtimers_shard_test_loop(void * arg_p);
+
+//-----------------------------------------------------------------------------
+// Additional test data
+//-----------------------------------------------------------------------------
+#define SWTIMERS_SHARD_TEST_SHARDS_NUM  (2)
+#define SWTIMERS_SHARD_TEST_TIMERS_NUM  (3)
+#define SWTIMERS_SHARD_TEST_CELLS_NUM   (4)
+
+// Shards ids are passed as arguments of the loop, application data ids - as arguments of handlers
+static const uint8_t test_ids[SWTIMERS_SHARD_TEST_SHARDS_NUM] = { 0, 1 };
+
+// Simulations - one per shard
+static sim_t test_sims[SWTIMERS_SHARD_TEST_SHARDS_NUM];
+static sim_pin_t test_pins[SWTIMERS_SHARD_TEST_SHARDS_NUM][1];
+
+// Instances
+static swtimers_t test_swtimers_insts[SWTIMERS_SHARD_TEST_SHARDS_NUM];
+static swtimers_timer_t test_timers[SWTIMERS_SHARD_TEST_SHARDS_NUM][SWTIMERS_SHARD_TEST_TIMERS_NUM];
+static swtimers_shard_t test_inst;
+static swtimers_shard_slot_t test_slots[SWTIMERS_SHARD_TEST_SHARDS_NUM];
+static swtimers_shard_timer_t test_shard_timers[SWTIMERS_SHARD_TEST_SHARDS_NUM][SWTIMERS_SHARD_TEST_TIMERS_NUM];
+static uint64_t test_cells[SWTIMERS_SHARD_TEST_SHARDS_NUM][SWTIMERS_SHARD_TEST_CELLS_NUM * SWTIMERS_SHARD_MAILBOX_CELL_SIZE / sizeof(uint64_t)];
+
+// Calls of handler - shard, index of timer, argument and virtual time of the shard
+static uint32_t test_loop_shard;
+static uint32_t test_calls_cnt;
+static uint32_t test_call_shard;
+static uint32_t test_call_idx;
+static const void * test_call_arg_p;
+static uint64_t test_call_time;
+
+//-----------------------------------------------------------------------------
+// Run unit-tests
+//-----------------------------------------------------------------------------
+int32_t swtimers_shard_tests(void)
+{
+    int32_t res;
+
+    // Test cycle 1
+    res = swtimers_shard_test_cycle_1(1000); // res 1000 - 1999
+    if (res != 0) {
+        return res;
+    }
+
+    // Test cycle 2
+    res = swtimers_shard_test_cycle_2(2000); // res 2000 - 2999
+    if (res != 0) {
+        return res;
+    }
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Test cycle 1 - delivery of operations through mailbox of another shard
+//-----------------------------------------------------------------------------
+static int32_t swtimers_shard_test_cycle_1(uint32_t cycle)
+{
+    uint32_t handle = SWTIMERS_SHARD_HANDLE(1, 2);
+
+    swtimers_shard_test_setup();
+
+    // TEST - shard 0 starts timer of shard 1
+    // CHECK - operation is sent, but isn't applied before the owner's task
+    if ((swtimers_shard_start(&test_inst, 0, handle, 100, SWTIMERS_MODE_SINGLE_FROM_LOOP,
+                              swtimers_shard_test_handler, (void*)&test_ids[0], NULL) != true) ||
+        (swtimers_is_run(&test_swtimers_insts[1], 2, NULL) != false)) {
+        return cycle + 10;
+    }
+
+    // TEST - owner applies the operation and processes the timer
+    swtimers_shard_test_run(1, 100);
+    // CHECK - handler is called by the owner with arguments of the sender
+    if ((test_calls_cnt != 1) || (test_call_shard != 1) || (test_call_idx != 2) ||
+        (test_call_arg_p != &test_ids[0]) || (test_call_time != 100)) {
+        return cycle + 20;
+    }
+
+    // TEST - start and stop are applied in order of sending
+    swtimers_shard_start(&test_inst, 0, handle, 10, SWTIMERS_MODE_PERIODIC_FROM_LOOP, swtimers_shard_test_handler, NULL, NULL);
+    swtimers_shard_stop(&test_inst, 0, handle);
+    swtimers_shard_test_run(1, 100);
+    // CHECK
+    if ((test_calls_cnt != 1) || (swtimers_shard_is_run(&test_inst, 1, handle) != false)) {
+        return cycle + 30;
+    }
+
+    // TEST - fill the mailbox
+    for (uint32_t i = 0; i < SWTIMERS_SHARD_TEST_CELLS_NUM - 1; ++i) {
+        swtimers_shard_start(&test_inst, 0, SWTIMERS_SHARD_HANDLE(1, i), 1000, SWTIMERS_MODE_SINGLE_FROM_LOOP, NULL, NULL, NULL);
+    }
+    swtimers_shard_stop(&test_inst, 0, SWTIMERS_SHARD_HANDLE(1, 0));
+    // CHECK - full mailbox rejects operation
+    if (swtimers_shard_stop(&test_inst, 0, SWTIMERS_SHARD_HANDLE(1, 1)) != false) {
+        return cycle + 40;
+    }
+
+    // TEST - the first task applies operations up to the number of timers
+    swtimers_shard_task(&test_inst, 1);
+    // CHECK - the last operation is still in the mailbox
+    for (uint32_t i = 0; i < SWTIMERS_SHARD_TEST_TIMERS_NUM; ++i) {
+        if (swtimers_shard_is_run(&test_inst, 1, SWTIMERS_SHARD_HANDLE(1, i)) != true) {
+            return cycle + 50;
+        }
+    }
+
+    // TEST - the next task applies the rest
+    swtimers_shard_task(&test_inst, 1);
+    // CHECK
+    if ((swtimers_shard_is_run(&test_inst, 1, SWTIMERS_SHARD_HANDLE(1, 0)) != false) ||
+        (swtimers_shard_is_run(&test_inst, 1, SWTIMERS_SHARD_HANDLE(1, 1)) != true)) {
+        return cycle + 60;
+    }
+
+    swtimers_shard_test_teardown();
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Test cycle 2 - migration of timers
+//-----------------------------------------------------------------------------
+static int32_t swtimers_shard_test_cycle_2(uint32_t cycle)
+{
+    uint32_t handle = SWTIMERS_SHARD_HANDLE(0, 0);
+    uint32_t new_handle;
+
+    swtimers_shard_test_setup();
+
+    // TEST - shard starts its own timer without mailbox
+    swtimers_shard_start(&test_inst, 0, handle, 100, SWTIMERS_MODE_SINGLE_FROM_LOOP,
+                         swtimers_shard_test_handler, (void*)&test_ids[1], NULL);
+    // CHECK
+    if (swtimers_shard_is_run(&test_inst, 0, handle) != true) {
+        return cycle + 10;
+    }
+
+    // TEST - single shot timer is moved after 40 ms
+    swtimers_shard_test_run(0, 40);
+    new_handle = swtimers_shard_migrate(&test_inst, 0, handle, 1, 1);
+    // CHECK - timer is stopped in the calling shard
+    if ((new_handle != SWTIMERS_SHARD_HANDLE(1, 1)) || (swtimers_shard_is_run(&test_inst, 0, handle) != false)) {
+        return cycle + 20;
+    }
+
+    // TEST - the rest of 60 ms in the destination shard
+    swtimers_shard_test_run(1, 59);
+    // CHECK
+    if ((test_calls_cnt != 0) || (swtimers_shard_is_run(&test_inst, 1, new_handle) != true)) {
+        return cycle + 30;
+    }
+    swtimers_shard_test_run(1, 1);
+    // CHECK - handler is called with settings of the last start
+    if ((test_calls_cnt != 1) || (test_call_shard != 1) || (test_call_idx != 1) ||
+        (test_call_arg_p != &test_ids[1]) || (test_call_time != 60)) {
+        return cycle + 40;
+    }
+
+    // TEST - periodic timer is moved after 30 ms
+    test_calls_cnt = 0;
+    swtimers_shard_start(&test_inst, 0, handle, 50, SWTIMERS_MODE_PERIODIC_FROM_LOOP, swtimers_shard_test_handler, NULL, NULL);
+    swtimers_shard_test_run(0, 30);
+    new_handle = swtimers_shard_migrate(&test_inst, 0, handle, 1, 0);
+    swtimers_shard_test_run(1, 120);
+    // CHECK - destination starts a new period
+    if ((new_handle != SWTIMERS_SHARD_HANDLE(1, 0)) || (test_calls_cnt != 2) || (test_call_time != 60 + 100)) {
+        return cycle + 50;
+    }
+
+    // TEST - stopped timer is moved without start
+    new_handle = swtimers_shard_migrate(&test_inst, 0, SWTIMERS_SHARD_HANDLE(0, 1), 1, 2);
+    swtimers_shard_task(&test_inst, 1);
+    // CHECK
+    if ((new_handle != SWTIMERS_SHARD_HANDLE(1, 2)) || (swtimers_shard_is_run(&test_inst, 1, new_handle) != false)) {
+        return cycle + 60;
+    }
+
+    // TEST - timer isn't moved into full mailbox
+    swtimers_shard_start(&test_inst, 0, handle, 100, SWTIMERS_MODE_SINGLE_FROM_LOOP, NULL, NULL, NULL);
+    for (uint32_t i = 0; i < SWTIMERS_SHARD_TEST_CELLS_NUM; ++i) {
+        swtimers_shard_stop(&test_inst, 0, SWTIMERS_SHARD_HANDLE(1, 2));
+    }
+    new_handle = swtimers_shard_migrate(&test_inst, 0, handle, 1, 2);
+    // CHECK - timer stays run in the calling shard
+    if ((new_handle != handle) || (swtimers_shard_is_run(&test_inst, 0, handle) != true)) {
+        return cycle + 70;
+    }
+
+    swtimers_shard_test_teardown();
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Init simulations and drivers
+//-----------------------------------------------------------------------------
+static void swtimers_shard_test_setup(void)
+{
+    test_calls_cnt = 0;
+    test_call_shard = UINT32_MAX;
+    test_call_idx = UINT32_MAX;
+    test_call_arg_p = NULL;
+    test_call_time = 0;
+
+    swtimers_shard_init(&test_inst, test_slots, SWTIMERS_SHARD_TEST_SHARDS_NUM);
+
+    for (uint32_t s = 0; s < SWTIMERS_SHARD_TEST_SHARDS_NUM; ++s) {
+        sim_init(&test_sims[s], 1, test_pins[s], 1, NULL, 0);
+        swtimers_init(&test_swtimers_insts[s], sim_get_swtimers_hw(&test_sims[s]), SWTIMERS_SHARD_TEST_TIMERS_NUM, test_timers[s]);
+        sim_attach_swtimers(&test_sims[s], &test_swtimers_insts[s]);
+        swtimers_shard_attach(&test_inst, s, &test_swtimers_insts[s], test_shard_timers[s], SWTIMERS_SHARD_TEST_TIMERS_NUM,
+                              test_cells[s], SWTIMERS_SHARD_TEST_CELLS_NUM);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Deinit drivers
+//-----------------------------------------------------------------------------
+static void swtimers_shard_test_teardown(void)
+{
+    for (uint32_t s = 0; s < SWTIMERS_SHARD_TEST_SHARDS_NUM; ++s) {
+        swtimers_deinit(&test_swtimers_insts[s]);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Run application loop of shard in virtual time of its simulation
+//-----------------------------------------------------------------------------
+static void swtimers_shard_test_run(uint32_t shard, uint64_t duration_ms)
+{
+    sim_run(&test_sims[shard], duration_ms, swtimers_shard_test_loop, (void*)&test_ids[shard]);
+}
+
+//-----------------------------------------------------------------------------
+// Timer handler - saves the calling shard, index of timer, argument and virtual time of the shard
+//-----------------------------------------------------------------------------
+static void swtimers_shard_test_handler(uint32_t idx, void * arg_1_p, void * arg_2_p)
+{
+    (void)arg_2_p;
+
+    test_calls_cnt++;
+    test_call_shard = test_loop_shard;
+    test_call_idx = idx;
+    test_call_arg_p = arg_1_p;
+    test_call_time = sim_get_time_ms(&test_sims[test_loop_shard]);
+}
+
+//-----------------------------------------------------------------------------
+// Application loop of shard
+//-----------------------------------------------------------------------------
+static void swtimers_shard_test_loop(void * arg_p)
+{
+    assert(arg_p != NULL);
+    test_loop_shard = *(const uint8_t*)arg_p;
+    swtimers_shard_task(&test_inst, test_loop_shard);
+}
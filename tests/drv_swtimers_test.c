@@ -10,6 +10,7 @@
 #include <assert.h>
 
 #include "drv_swtimers.h"
+#include "sim.h"
 
 //==================================================================================================
 //============================================ TESTS ===============================================
@@ -22,13 +23,24 @@ int32_t swtimers_test_all_timers_check(bool timers_state, uint32_t timers_cnt, b
 
 static int32_t swtimers_test_cycle_1(uint32_t cycle);
 static int32_t swtimers_test_cycle_2(uint32_t cycle);
+static int32_t swtimers_test_cycle_3(uint32_t cycle);
+static int32_t swtimers_test_cycle_4(uint32_t cycle);
+static int32_t swtimers_test_cycle_5(uint32_t cycle);
+static int32_t swtimers_test_cycle_6(uint32_t cycle);
+static int32_t swtimers_test_cycle_7(uint32_t cycle);
+static int32_t swtimers_test_cycle_8(uint32_t cycle);
 
 static void swtimers_test_handler(uint32_t id, void * arg_1_p, void * arg_2_p);
+static void swtimers_test_work_handler(void * arg_1_p, void * arg_2_p);
+static void swtimers_test_slow_handler(uint32_t id, void * arg_1_p, void * arg_2_p);
+static void swtimers_test_budget_report(uint32_t timer_idx, uint32_t cycles, void * arg_p);
+static uint32_t swtimers_test_cycles(void);
 static void swtimers_test_hw_isr_enable(void * hw_timer_p);
 static void swtimers_test_hw_isr_disable(void * hw_timer_p);
 static void swtimers_test_hw_start(void * hw_timer_p);
 static void swtimers_test_hw_stop(void * hw_timer_p);
 static bool swtimers_test_hw_is_started(void * hw_timer_p);
+static void swtimers_test_sim_loop(void * arg_p);
 
 //-----------------------------------------------------------------------------
 // Additional test data
@@ -54,6 +66,37 @@ swtimers_hw_interface_t test_hw_interface = {
     .tick_ms = 1
 };
 
+// Work queue
+#define SWTIMERS_TEST_WORK_ITEMS_NUM (4)
+
+static workqueue_t test_workqueue;
+static workqueue_item_t test_work_items[WORKQUEUE_PRIO_NUM * SWTIMERS_TEST_WORK_ITEMS_NUM];
+static uint32_t test_work_order[2 * SWTIMERS_TEST_WORK_ITEMS_NUM];
+
+workqueue_hw_interface_t test_workqueue_hw_interface = {
+    .hw_p = &test_hw_timer_instance,
+    .isr_enable_cb = swtimers_test_hw_isr_enable,
+    .isr_disable_cb = swtimers_test_hw_isr_disable,
+};
+
+// Simulation with tick 10 milliseconds
+#define SWTIMERS_TEST_SIM_TICK_MS (10)
+#define SWTIMERS_TEST_SIM_TIME_MS (10ull * 3600ull * 1000ull)
+
+static sim_t test_sim;
+static sim_pin_t test_sim_pins[1];
+
+// Lateness statistics
+static swtimers_lateness_t test_lateness[SWTIMERS_TEST_TIMERS_NUM];
+
+// Budgets of handlers called from ISR (fake cycle counter is advanced by handlers only)
+static const uint32_t test_budgets[SWTIMERS_TEST_TIMERS_NUM] = { 100, 100, 0 };
+static const uint32_t test_costs[3] = { 50, 500, 1000 };
+static swtimers_watchdog_t test_watchdog;
+static uint32_t test_cycles;
+static uint32_t test_report_cnt;
+static uint32_t test_report_cycles;
+
 // Counters
 uint32_t test_handler_cnt = 0;
 uint32_t test_hw_start_cnt = 0;
@@ -94,6 +137,67 @@ int32_t swtimers_tests(void)
         }
     }
 
+    // Test cycle 3
+    for (uint32_t i = 0; i < 10; i++) {
+
+        test_hw_is_started = false;
+        test_hw_isr_is_enabled = true;
+        test_handler_cnt = 0;
+        test_hw_start_cnt = 0;
+        test_hw_stop_cnt = 0;
+
+        int32_t res = swtimers_test_cycle_3(3000 + 100 * i); // res 3000 - 3999
+        if (res != 0) {
+            return res;
+        }
+    }
+
+    // Test cycle 4
+    for (uint32_t i = 0; i < 10; i++) {
+
+        test_hw_is_started = false;
+        test_hw_isr_is_enabled = true;
+        test_handler_cnt = 0;
+        test_hw_start_cnt = 0;
+        test_hw_stop_cnt = 0;
+
+        int32_t res = swtimers_test_cycle_4(4000 + 100 * i); // res 4000 - 4999
+        if (res != 0) {
+            return res;
+        }
+    }
+
+    // Test cycle 5
+    test_handler_cnt = 0;
+    int32_t res = swtimers_test_cycle_5(5000); // res 5000 - 5999
+    if (res != 0) {
+        return res;
+    }
+
+    // Test cycle 6
+    test_hw_is_started = false;
+    test_handler_cnt = 0;
+    res = swtimers_test_cycle_6(6000); // res 6000 - 6999
+    if (res != 0) {
+        return res;
+    }
+
+    // Test cycle 7
+    test_hw_is_started = false;
+    test_handler_cnt = 0;
+    res = swtimers_test_cycle_7(7000); // res 7000 - 7999
+    if (res != 0) {
+        return res;
+    }
+
+    // Test cycle 8
+    test_hw_is_started = false;
+    test_handler_cnt = 0;
+    res = swtimers_test_cycle_8(8000); // res 8000 - 8999
+    if (res != 0) {
+        return res;
+    }
+
     return 0;
 }
 
@@ -301,6 +405,431 @@ static int32_t swtimers_test_cycle_2(uint32_t cycle)
     return 0;
 }
 
+//-----------------------------------------------------------------------------
+// Test cycle 3 - nearest expiration
+//-----------------------------------------------------------------------------
+static int32_t swtimers_test_cycle_3(uint32_t cycle)
+{
+    // TEST - init driver
+    swtimers_init(&test_inst, &test_hw_interface, SWTIMERS_TEST_TIMERS_NUM, test_timers);
+    // CHECK - no started timers
+    if (swtimers_next_expiry_ticks(&test_inst) != SWTIMERS_NO_EXPIRY) {
+        return cycle + 10;
+    }
+
+    // TEST - start timers: 5 ms periodic from ISR, 3 ms single from loop
+    swtimers_start(&test_inst, 0, 5, SWTIMERS_MODE_PERIODIC_FROM_ISR, swtimers_test_handler, &test_app_data, &test_app_data);
+    swtimers_start(&test_inst, 1, 3, SWTIMERS_MODE_SINGLE_FROM_LOOP, swtimers_test_handler, &test_app_data, &test_app_data);
+    // CHECK
+    if (swtimers_next_expiry_ticks(&test_inst) != 3) {
+        return cycle + 20;
+    }
+
+    // TEST - ISR = 1, 2
+    swtimers_isr(&test_inst);
+    swtimers_isr(&test_inst);
+    // CHECK
+    if (swtimers_next_expiry_ticks(&test_inst) != 1) {
+        return cycle + 30;
+    }
+
+    // TEST - ISR = 3 (loop handler is waiting)
+    swtimers_isr(&test_inst);
+    // CHECK
+    if (swtimers_next_expiry_ticks(&test_inst) != 0) {
+        return cycle + 40;
+    }
+
+    // TEST - task
+    swtimers_task(&test_inst);
+    // CHECK - only periodic timer is left
+    if ((swtimers_next_expiry_ticks(&test_inst) != 2) || (test_handler_cnt != 1)) {
+        return cycle + 50;
+    }
+
+    // TEST - ISR = 4, 5 (periodic timer is restarted)
+    swtimers_isr(&test_inst);
+    swtimers_isr(&test_inst);
+    // CHECK
+    if ((swtimers_next_expiry_ticks(&test_inst) != 5) || (test_handler_cnt != 2)) {
+        return cycle + 60;
+    }
+
+    // TEST - stop all timers and ISR = 6
+    swtimers_stop_all(&test_inst);
+    swtimers_isr(&test_inst);
+    // CHECK
+    if (swtimers_next_expiry_ticks(&test_inst) != SWTIMERS_NO_EXPIRY) {
+        return cycle + 70;
+    }
+
+    // TEST - deinit
+    swtimers_deinit(&test_inst);
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Test cycle 4 - attached work queue
+//-----------------------------------------------------------------------------
+static int32_t swtimers_test_cycle_4(uint32_t cycle)
+{
+    // TEST - init drivers
+    swtimers_init(&test_inst, &test_hw_interface, SWTIMERS_TEST_TIMERS_NUM, test_timers);
+    workqueue_init(&test_workqueue, &test_workqueue_hw_interface, SWTIMERS_TEST_WORK_ITEMS_NUM, test_work_items);
+    swtimers_set_workqueue(&test_inst, &test_workqueue);
+    // CHECK
+    if ((workqueue_is_empty(&test_workqueue) == false) || (swtimers_next_expiry_ticks(&test_inst) != SWTIMERS_NO_EXPIRY)) {
+        return cycle + 10;
+    }
+
+    // TEST - post items with different priorities, the last post to full ring must fail
+    for (uint32_t i = 0; i < SWTIMERS_TEST_WORK_ITEMS_NUM; i++) {
+        if (workqueue_post(&test_workqueue, WORKQUEUE_PRIO_LOW, swtimers_test_work_handler, &test_work_order[i], NULL) == false) {
+            return cycle + 20;
+        }
+    }
+    if (workqueue_post(&test_workqueue, WORKQUEUE_PRIO_LOW, swtimers_test_work_handler, NULL, NULL) == true) {
+        return cycle + 21;
+    }
+    for (uint32_t i = 0; i < SWTIMERS_TEST_WORK_ITEMS_NUM; i++) {
+        if (workqueue_post(&test_workqueue, WORKQUEUE_PRIO_HIGH, swtimers_test_work_handler, &test_work_order[SWTIMERS_TEST_WORK_ITEMS_NUM + i], NULL) == false) {
+            return cycle + 22;
+        }
+    }
+    // CHECK
+    if (swtimers_next_expiry_ticks(&test_inst) != 0) {
+        return cycle + 30;
+    }
+
+    // TEST - task
+    test_handler_cnt = 0;
+    swtimers_task(&test_inst);
+    // CHECK - all items are processed, high priority first
+    if ((workqueue_is_empty(&test_workqueue) == false) || (test_handler_cnt != 2 * SWTIMERS_TEST_WORK_ITEMS_NUM)) {
+        return cycle + 40;
+    }
+    for (uint32_t i = 0; i < SWTIMERS_TEST_WORK_ITEMS_NUM; i++) {
+        if ((test_work_order[SWTIMERS_TEST_WORK_ITEMS_NUM + i] != i + 1) || (test_work_order[i] != SWTIMERS_TEST_WORK_ITEMS_NUM + i + 1)) {
+            return cycle + 50;
+        }
+    }
+
+    // TEST - deinit
+    workqueue_deinit(&test_workqueue);
+    swtimers_deinit(&test_inst);
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Test cycle 5 - ten hours of virtual time, tick of hardware timer is 10 milliseconds
+//-----------------------------------------------------------------------------
+static int32_t swtimers_test_cycle_5(uint32_t cycle)
+{
+    // TEST - init driver on simulated hardware
+    sim_init(&test_sim, SWTIMERS_TEST_SIM_TICK_MS, test_sim_pins, 1, NULL, 0);
+    swtimers_init(&test_inst, sim_get_swtimers_hw(&test_sim), SWTIMERS_TEST_TIMERS_NUM, test_timers);
+    sim_attach_swtimers(&test_sim, &test_inst);
+
+    // TEST - periodic timers 100 .. 900 milliseconds called from loop, 1000 milliseconds called from ISR
+    uint32_t handler_cnt = 0;
+    for (uint32_t i = 0; i < SWTIMERS_TEST_TIMERS_NUM; i++) {
+        uint32_t ms = 100 * (i + 1);
+        swtimers_mode_t mode = (i == SWTIMERS_TEST_TIMERS_NUM - 1) ? SWTIMERS_MODE_PERIODIC_FROM_ISR : SWTIMERS_MODE_PERIODIC_FROM_LOOP;
+        swtimers_start(&test_inst, i, ms, mode, swtimers_test_handler, &test_app_data, &test_app_data);
+        handler_cnt += (uint32_t)(SWTIMERS_TEST_SIM_TIME_MS / ms);
+    }
+    sim_run(&test_sim, SWTIMERS_TEST_SIM_TIME_MS, swtimers_test_sim_loop, NULL);
+    // CHECK - all expirations are handled
+    if (test_handler_cnt != handler_cnt) {
+        return cycle + 10;
+    }
+    // CHECK - all ticks are passed, time jumps between expirations only
+    if ((test_sim.ticks_cnt != SWTIMERS_TEST_SIM_TIME_MS / SWTIMERS_TEST_SIM_TICK_MS) || (test_sim.steps_cnt > SWTIMERS_TEST_SIM_TIME_MS / 100)) {
+        return cycle + 20;
+    }
+
+    // TEST - stop timers, time goes
+    swtimers_stop_all(&test_inst);
+    sim_run(&test_sim, SWTIMERS_TEST_SIM_TIME_MS, swtimers_test_sim_loop, NULL);
+    // CHECK - hardware timer is stopped, no ticks
+    if ((test_sim.is_hw_started) || (test_sim.ticks_cnt != SWTIMERS_TEST_SIM_TIME_MS / SWTIMERS_TEST_SIM_TICK_MS)) {
+        return cycle + 30;
+    }
+
+    // TEST - deinit
+    swtimers_deinit(&test_inst);
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Test cycle 6 - lateness statistics
+//  timer 0 - periodic from loop, 10 ms
+//  timer 1 - single shot from loop, 5 ms
+//  timer 2 - periodic from ISR, 4 ms
+//-----------------------------------------------------------------------------
+static int32_t swtimers_test_cycle_6(uint32_t cycle)
+{
+    swtimers_lateness_t lateness;
+
+    // TEST - init driver, attach statistics, start timers
+    swtimers_init(&test_inst, &test_hw_interface, SWTIMERS_TEST_TIMERS_NUM, test_timers);
+    memset(test_lateness, 0x00, sizeof(test_lateness));
+    swtimers_set_lateness(&test_inst, test_lateness);
+    swtimers_start(&test_inst, 0, 10, SWTIMERS_MODE_PERIODIC_FROM_LOOP, swtimers_test_handler, &test_app_data, &test_app_data);
+    swtimers_start(&test_inst, 1, 5, SWTIMERS_MODE_SINGLE_FROM_LOOP, swtimers_test_handler, &test_app_data, &test_app_data);
+    swtimers_start(&test_inst, 2, 4, SWTIMERS_MODE_PERIODIC_FROM_ISR, swtimers_test_handler, &test_app_data, &test_app_data);
+
+    // TEST - application loop is late: timers 0 and 1 expire at ticks 10 and 5, task is called at tick 13
+    for (uint32_t i = 0; i < 13; i++) {
+        swtimers_isr(&test_inst);
+    }
+    swtimers_task(&test_inst);
+    // CHECK
+    swtimers_get_lateness(&test_inst, 0, &lateness);
+    if ((lateness.count != 1) || (lateness.last != 3) || (lateness.max != 3) || (lateness.period_min != 0)) {
+        return cycle + 10;
+    }
+    swtimers_get_lateness(&test_inst, 1, &lateness);
+    if ((lateness.count != 1) || (lateness.last != 8) || (lateness.max != 8)) {
+        return cycle + 20;
+    }
+
+    // TEST - task at tick 23 (lateness 3, period 10), then at tick 30 (lateness 0, period 7)
+    for (uint32_t i = 0; i < 10; i++) {
+        swtimers_isr(&test_inst);
+    }
+    swtimers_task(&test_inst);
+    for (uint32_t i = 0; i < 7; i++) {
+        swtimers_isr(&test_inst);
+    }
+    swtimers_task(&test_inst);
+    // CHECK
+    swtimers_get_lateness(&test_inst, 0, &lateness);
+    if ((lateness.count != 3) || (lateness.last != 0) || (lateness.max != 3) || (lateness.sum != 6) ||
+        (lateness.period_min != 7) || (lateness.period_max != 10)) {
+        return cycle + 30;
+    }
+    // CHECK - handlers from ISR aren't late, periods are exact
+    swtimers_get_lateness(&test_inst, 2, &lateness);
+    if ((lateness.count != 7) || (lateness.max != 0) || (lateness.period_min != 4) || (lateness.period_max != 4)) {
+        return cycle + 40;
+    }
+
+    // TEST - tickless: 25 ticks at once, expirations at ticks 40 and 50 are merged, lateness from the first one
+    swtimers_isr_ticks(&test_inst, 25);
+    swtimers_task(&test_inst);
+    // CHECK
+    swtimers_get_lateness(&test_inst, 0, &lateness);
+    if ((lateness.count != 4) || (lateness.last != 15) || (lateness.max != 15) || (lateness.period_max != 25)) {
+        return cycle + 50;
+    }
+
+    // TEST - restart, the first period isn't measured
+    swtimers_start(&test_inst, 0, 2, SWTIMERS_MODE_PERIODIC_FROM_LOOP, swtimers_test_handler, &test_app_data, &test_app_data);
+    swtimers_isr(&test_inst);
+    swtimers_isr(&test_inst);
+    swtimers_task(&test_inst);
+    // CHECK
+    swtimers_get_lateness(&test_inst, 0, &lateness);
+    if ((lateness.count != 5) || (lateness.last != 0) || (lateness.period_min != 7)) {
+        return cycle + 60;
+    }
+
+    // TEST - detach, deinit
+    swtimers_set_lateness(&test_inst, NULL);
+    swtimers_isr(&test_inst);
+    swtimers_isr(&test_inst);
+    swtimers_task(&test_inst);
+    // CHECK
+    if (test_lateness[0].count != 5) {
+        return cycle + 70;
+    }
+    swtimers_deinit(&test_inst);
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Test cycle 7 - counters of driver activity
+//  timer 0 - periodic handler from loop, 3 ms
+//  timer 1 - single shot handler from ISR, 5 ms
+//  timer 2 - periodic handler from ISR, 4 ms
+//-----------------------------------------------------------------------------
+static int32_t swtimers_test_cycle_7(uint32_t cycle)
+{
+    swtimers_stats_t stats;
+
+    // TEST - init driver, start timers
+    swtimers_init(&test_inst, &test_hw_interface, SWTIMERS_TEST_TIMERS_NUM, test_timers);
+    swtimers_start(&test_inst, 0, 3, SWTIMERS_MODE_PERIODIC_FROM_LOOP, swtimers_test_handler, &test_app_data, &test_app_data);
+    swtimers_start(&test_inst, 1, 5, SWTIMERS_MODE_SINGLE_FROM_ISR, swtimers_test_handler, &test_app_data, &test_app_data);
+    swtimers_start(&test_inst, 2, 4, SWTIMERS_MODE_PERIODIC_FROM_ISR, swtimers_test_handler, &test_app_data, &test_app_data);
+
+    // TEST - 10 ticks without application loop: timer 0 expires at 3, 6, 9 (two overruns),
+    // timer 1 - at 5, timer 2 - at 4, 8; ticks 1, 2, 7, 10 are idle
+    for (uint32_t i = 0; i < 10; i++) {
+        swtimers_isr(&test_inst);
+    }
+    swtimers_task(&test_inst);
+    swtimers_get_stats(&test_inst, &stats, true);
+    // CHECK
+    if ((stats.started != 3) || (stats.expired != 6) || (stats.dispatched != 4) || (test_handler_cnt != 4)) {
+        return cycle + 10;
+    }
+    if ((stats.overruns != 2) || (stats.idle_isr != 4) || (stats.peak_active != 3)) {
+        return cycle + 20;
+    }
+
+    // TEST - snapshot after reset
+    swtimers_get_stats(&test_inst, &stats, false);
+    // CHECK
+    if ((stats.started != 0) || (stats.expired != 0) || (stats.dispatched != 0) || (stats.overruns != 0) ||
+        (stats.idle_isr != 0) || (stats.peak_active != 0)) {
+        return cycle + 30;
+    }
+
+    // TEST - restart of timer, idle tick with two running timers
+    swtimers_start(&test_inst, 0, 3, SWTIMERS_MODE_PERIODIC_FROM_LOOP, swtimers_test_handler, &test_app_data, &test_app_data);
+    swtimers_isr(&test_inst);
+    swtimers_get_stats(&test_inst, &stats, false);
+    // CHECK - counters aren't cleared without reset
+    swtimers_get_stats(&test_inst, &stats, false);
+    if ((stats.started != 1) || (stats.expired != 0) || (stats.idle_isr != 1) || (stats.peak_active != 2)) {
+        return cycle + 40;
+    }
+
+    swtimers_deinit(&test_inst);
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Test cycle 8 - budgets of handlers called from ISR
+//  timer 0 - periodic handler from ISR, 2 ms, 50 cycles of 100 allowed
+//  timer 1 - periodic handler from ISR, 2 ms, 500 cycles of 100 allowed
+//  timer 2 - periodic handler from ISR, 2 ms, 1000 cycles, not checked
+//-----------------------------------------------------------------------------
+static int32_t swtimers_test_cycle_8(uint32_t cycle)
+{
+    swtimers_stats_t stats;
+
+    // TEST - init driver, attach budgets, start timers
+    swtimers_init(&test_inst, &test_hw_interface, SWTIMERS_TEST_TIMERS_NUM, test_timers);
+    test_watchdog.cycles_cb = swtimers_test_cycles;
+    test_watchdog.budgets_p = test_budgets;
+    test_watchdog.policy = SWTIMERS_BUDGET_COUNT;
+    test_watchdog.report_cb = swtimers_test_budget_report;
+    test_watchdog.report_arg_p = &test_app_data;
+    swtimers_set_watchdog(&test_inst, &test_watchdog);
+    test_cycles = 0;
+    test_report_cnt = 0;
+    for (uint32_t i = 0; i < 3; i++) {
+        swtimers_start(&test_inst, i, 2, SWTIMERS_MODE_PERIODIC_FROM_ISR, swtimers_test_slow_handler, (void*)&test_costs[i], NULL);
+    }
+
+    // TEST - count: two expirations, only timer 1 is over budget
+    for (uint32_t i = 0; i < 4; i++) {
+        swtimers_isr(&test_inst);
+    }
+    swtimers_get_stats(&test_inst, &stats, true);
+    // CHECK
+    if ((test_handler_cnt != 6) || (stats.over_budget != 2) || (test_report_cnt != 2) || (test_report_cycles != 500)) {
+        return cycle + 10;
+    }
+
+    // TEST - demote: timer 1 is called from ISR once more, then from application loop without checks
+    test_watchdog.policy = SWTIMERS_BUDGET_DEMOTE;
+    for (uint32_t i = 0; i < 4; i++) {
+        swtimers_isr(&test_inst);
+    }
+    // CHECK
+    if ((test_handler_cnt != 11) || (test_report_cnt != 3)) {
+        return cycle + 20;
+    }
+    swtimers_task(&test_inst);
+    swtimers_get_stats(&test_inst, &stats, true);
+    if ((test_handler_cnt != 12) || (stats.over_budget != 1) || (stats.dispatched != 6) || (swtimers_is_run(&test_inst, 1, NULL) != true)) {
+        return cycle + 30;
+    }
+
+    // TEST - disable: restarted timer 1 is stopped after the first call
+    test_watchdog.policy = SWTIMERS_BUDGET_DISABLE;
+    swtimers_start(&test_inst, 1, 2, SWTIMERS_MODE_PERIODIC_FROM_ISR, swtimers_test_slow_handler, (void*)&test_costs[1], NULL);
+    for (uint32_t i = 0; i < 4; i++) {
+        swtimers_isr(&test_inst);
+    }
+    swtimers_get_stats(&test_inst, &stats, true);
+    // CHECK
+    if ((swtimers_is_run(&test_inst, 1, NULL) != false) || (swtimers_is_run(&test_inst, 2, NULL) != true) ||
+        (stats.over_budget != 1) || (stats.dispatched != 5) || (test_report_cnt != 4)) {
+        return cycle + 40;
+    }
+
+    // TEST - detach
+    swtimers_set_watchdog(&test_inst, NULL);
+    swtimers_start(&test_inst, 1, 2, SWTIMERS_MODE_PERIODIC_FROM_ISR, swtimers_test_slow_handler, (void*)&test_costs[1], NULL);
+    for (uint32_t i = 0; i < 2; i++) {
+        swtimers_isr(&test_inst);
+    }
+    swtimers_get_stats(&test_inst, &stats, true);
+    // CHECK
+    if ((stats.over_budget != 0) || (test_report_cnt != 4) || (swtimers_is_run(&test_inst, 1, NULL) != true)) {
+        return cycle + 50;
+    }
+
+    swtimers_deinit(&test_inst);
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Timer handler - takes number of cycles given in the first argument
+//-----------------------------------------------------------------------------
+static void swtimers_test_slow_handler(uint32_t id, void * arg_1_p, void * arg_2_p)
+{
+    (void)id;
+    (void)arg_2_p;
+    assert(arg_1_p != NULL);
+
+    test_cycles += *(const uint32_t*)arg_1_p;
+    test_handler_cnt++;
+}
+
+//-----------------------------------------------------------------------------
+// Report of exceeded budget
+//-----------------------------------------------------------------------------
+static void swtimers_test_budget_report(uint32_t timer_idx, uint32_t cycles, void * arg_p)
+{
+    (void)timer_idx;
+    (void)arg_p;
+    assert((arg_p == &test_app_data) && (timer_idx == 1));
+
+    test_report_cnt++;
+    test_report_cycles = cycles;
+}
+
+//-----------------------------------------------------------------------------
+// Fake cycle counter
+//-----------------------------------------------------------------------------
+static uint32_t swtimers_test_cycles(void)
+{
+    return test_cycles;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static void swtimers_test_work_handler(void * arg_1_p, void * arg_2_p)
+{
+    (void)arg_2_p;
+    assert(arg_1_p != NULL);
+
+    test_handler_cnt++;
+    *(uint32_t*)arg_1_p = test_handler_cnt;
+}
+
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
 static void swtimers_test_handler(uint32_t id, void * arg_1_p, void * arg_2_p)
@@ -359,4 +888,10 @@ static bool swtimers_test_hw_is_started(void * hw_timer_p)
     return test_hw_is_started;
 }
 
-
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static void swtimers_test_sim_loop(void * arg_p)
+{
+    (void)arg_p;
+    swtimers_task(&test_inst);
+}
@@ -0,0 +1,362 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+//**************************************************************************************************
+// TESTS for binary event trace ring buffer and trace hooks of drivers
+//**************************************************************************************************
+
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+
+#include "drv_trace.h"
+#include "drv_swtimers.h"
+#include "drv_leds.h"
+#include "drv_buttons.h"
+#include "sim.h"
+
+//==================================================================================================
+//============================================ TESTS ===============================================
+//==================================================================================================
+
+//-----------------------------------------------------------------------------
+// Additional test functions
+//-----------------------------------------------------------------------------
+static int32_t trace_test_cycle_1(uint32_t cycle);
+static int32_t trace_test_cycle_2(uint32_t cycle);
+#if (DRV_TRACE == 1)
+static int32_t trace_test_cycle_3(uint32_t cycle);
+
+static void trace_test_handler(uint32_t timer_idx, void * arg_1_p, void * arg_2_p);
+static void trace_test_loop(void * arg_p);
+static uint32_t trace_test_sim_time(void * timestamp_p);
+#endif
+
+static uint32_t trace_test_time(void * timestamp_p);
+static uint32_t trace_test_count(uint32_t num, uint8_t event, uint32_t idx);
+
+//-----------------------------------------------------------------------------
+// Additional test data
+//-----------------------------------------------------------------------------
+#define TRACE_TEST_SIZE         (8)
+#define TRACE_TEST_HOOKS_SIZE   (1024)
+#define TRACE_TEST_TIMERS_NUM   (4)
+
+static trace_t test_trace;
+static trace_record_t test_records[TRACE_TEST_HOOKS_SIZE];
+static trace_record_t test_out[TRACE_TEST_HOOKS_SIZE];
+static uint32_t test_time;
+
+#if (DRV_TRACE == 1)
+// Simulation
+static sim_t test_sim;
+static sim_pin_t test_pins[TRACE_TEST_TIMERS_NUM];
+
+// Instances
+static swtimers_t test_swtimers_inst;
+static swtimers_timer_t test_timers[TRACE_TEST_TIMERS_NUM];
+static leds_t test_leds_inst;
+static leds_led_t test_leds[1];
+static buttons_t test_buttons_inst;
+static buttons_button_t test_buttons[1];
+
+static const buttons_time_settings_t test_times = {
+    .bouncing_ms = 20,
+    .double_click_ms = 300,
+    .hold_ms = 1000,
+};
+#endif
+
+//-----------------------------------------------------------------------------
+// Run unit-tests
+//-----------------------------------------------------------------------------
+int32_t trace_tests(void)
+{
+    int32_t res;
+
+    // Test cycle 1
+    res = trace_test_cycle_1(1000); // res 1000 - 1999
+    if (res != 0) {
+        return res;
+    }
+
+    // Test cycle 2
+    res = trace_test_cycle_2(2000); // res 2000 - 2999
+    if (res != 0) {
+        return res;
+    }
+
+#if (DRV_TRACE == 1)
+    // Test cycle 3
+    res = trace_test_cycle_3(3000); // res 3000 - 3999
+    if (res != 0) {
+        return res;
+    }
+#endif
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Test cycle 1 - records, reading and overwriting of the oldest records
+//-----------------------------------------------------------------------------
+static int32_t trace_test_cycle_1(uint32_t cycle)
+{
+    uint32_t lost;
+    uint32_t num;
+
+    test_time = 0x00012345;
+    trace_init(&test_trace, test_records, TRACE_TEST_SIZE, trace_test_time, &test_time);
+
+    // TEST - synchronization record after init
+    num = trace_read(&test_trace, test_out, TRACE_TEST_HOOKS_SIZE, &lost);
+    // CHECK
+    if ((num != 1) || (lost != 0) || (test_out[0].event != TRACE_EVT_SYNC) ||
+        (test_out[0].idx != 0x0001) || (test_out[0].time != 0x2345)) {
+        return cycle + 10;
+    }
+
+    // TEST - record fields, saturation of payload
+    test_time += 10;
+    trace_record(&test_trace, TRACE_EVT_SWTIMERS_START, 3, SWTIMERS_MODE_PERIODIC_FROM_ISR, 100);
+    test_time += 10;
+    trace_record(&test_trace, TRACE_EVT_SWTIMERS_START, 4, SWTIMERS_MODE_SINGLE_FROM_LOOP, 100000);
+    trace_record(NULL, TRACE_EVT_SWTIMERS_STOP, 4, 0, 0);
+    num = trace_read(&test_trace, test_out, TRACE_TEST_HOOKS_SIZE, &lost);
+    // CHECK
+    if ((num != 2) || (lost != 0) || (trace_get_head(&test_trace) != 3)) {
+        return cycle + 20;
+    }
+    if ((test_out[0].time != 0x234F) || (test_out[0].event != TRACE_EVT_SWTIMERS_START) || (test_out[0].idx != 3) ||
+        (test_out[0].arg != SWTIMERS_MODE_PERIODIC_FROM_ISR) || (test_out[0].ext != 100)) {
+        return cycle + 30;
+    }
+    if ((test_out[1].time != 0x2359) || (test_out[1].ext != TRACE_EXT_MAX)) {
+        return cycle + 40;
+    }
+
+    // TEST - nothing new
+    num = trace_read(&test_trace, test_out, TRACE_TEST_HOOKS_SIZE, NULL);
+    // CHECK
+    if (num != 0) {
+        return cycle + 50;
+    }
+
+    // TEST - writer overtakes reader, the newest records are kept
+    for (uint32_t i = 0; i < (TRACE_TEST_SIZE + 5); ++i) {
+        trace_record(&test_trace, TRACE_EVT_LEDS_WRITE, i, 1, 0);
+    }
+    num = trace_read(&test_trace, test_out, 3, &lost);
+    // CHECK
+    if ((num != 3) || (lost != 5) || (test_out[0].idx != 5) || (test_out[2].idx != 7)) {
+        return cycle + 60;
+    }
+
+    // TEST - the rest records
+    num = trace_read(&test_trace, test_out, TRACE_TEST_HOOKS_SIZE, &lost);
+    // CHECK
+    if ((num != (TRACE_TEST_SIZE - 3)) || (lost != 0) || (test_out[num - 1].idx != (TRACE_TEST_SIZE + 4))) {
+        return cycle + 70;
+    }
+
+    // TEST - RAM dump starts at (head % size)
+    uint32_t head = trace_get_head(&test_trace);
+    // CHECK
+    if (test_records[head % TRACE_TEST_SIZE].idx != 5) {
+        return cycle + 80;
+    }
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Test cycle 2 - synchronization records on long gaps and timestamp wrap
+//-----------------------------------------------------------------------------
+static int32_t trace_test_cycle_2(uint32_t cycle)
+{
+    uint32_t num;
+
+    test_time = 0xFFFF0000;
+    trace_init(&test_trace, test_records, TRACE_TEST_HOOKS_SIZE, trace_test_time, &test_time);
+
+    // TEST - short gap
+    test_time += 0x7FFF;
+    trace_record(&test_trace, TRACE_EVT_BUTTONS_EDGE, 0, 1, 0);
+    num = trace_read(&test_trace, test_out, TRACE_TEST_HOOKS_SIZE, NULL);
+    // CHECK
+    if ((num != 2) || (trace_test_count(num, TRACE_EVT_SYNC, 0xFFFF) != 1)) {
+        return cycle + 10;
+    }
+
+    // TEST - long gap through wrap of timestamp
+    test_time += 0x10000;
+    trace_record(&test_trace, TRACE_EVT_BUTTONS_EDGE, 0, 0, 0);
+    num = trace_read(&test_trace, test_out, TRACE_TEST_HOOKS_SIZE, NULL);
+    // CHECK
+    if ((num != 2) || (test_out[0].event != TRACE_EVT_SYNC) || (test_out[0].idx != 0x0000) ||
+        (test_out[0].time != 0x7FFF) || (test_out[1].event != TRACE_EVT_BUTTONS_EDGE) || (test_out[1].time != 0x7FFF)) {
+        return cycle + 20;
+    }
+
+    return 0;
+}
+
+#if (DRV_TRACE == 1)
+//-----------------------------------------------------------------------------
+// Test cycle 3 - trace hooks of drivers (timestamp is virtual time in milliseconds)
+//  timer 0 - periodic handler from ISR, 10 ms
+//  timer 1 - not used
+//  timer 2 - LED meander, 50 ms
+//  timer 3 - polled button, pressed from 100 ms to 400 ms
+//-----------------------------------------------------------------------------
+static int32_t trace_test_cycle_3(uint32_t cycle)
+{
+    static const sim_record_t wave[] = {
+        { .time_ms = 100, .pin_idx = 3, .pin_state = 1 },
+        { .time_ms = 400, .pin_idx = 3, .pin_state = 0 },
+    };
+
+    sim_init(&test_sim, 1, test_pins, TRACE_TEST_TIMERS_NUM, NULL, 0);
+    swtimers_init(&test_swtimers_inst, sim_get_swtimers_hw(&test_sim), TRACE_TEST_TIMERS_NUM, test_timers);
+    sim_attach_swtimers(&test_sim, &test_swtimers_inst);
+    leds_init(&test_leds_inst, sim_get_leds_hw(&test_sim), 1, test_leds, &test_swtimers_inst);
+    leds_set_pin(&test_leds_inst, 0, 2, 2, true);
+    buttons_init(&test_buttons_inst, sim_get_buttons_hw(&test_sim), 1, test_buttons, &test_swtimers_inst);
+    buttons_configure(&test_buttons_inst, 0, 3, 3, false, BUTTONS_CHECK_IN_POLLING, &test_times, NULL, NULL);
+    sim_set_waveform(&test_sim, wave, sizeof(wave) / sizeof(wave[0]), NULL, NULL);
+
+    trace_init(&test_trace, test_records, TRACE_TEST_HOOKS_SIZE, trace_test_sim_time, &test_sim);
+    swtimers_set_trace(&test_swtimers_inst, &test_trace);
+    leds_set_trace(&test_leds_inst, &test_trace);
+    buttons_set_trace(&test_buttons_inst, &test_trace);
+
+    uint32_t led_writes = test_pins[2].writes_cnt;
+    swtimers_start(&test_swtimers_inst, 0, 10, SWTIMERS_MODE_PERIODIC_FROM_ISR, trace_test_handler, NULL, NULL);
+    leds_meander(&test_leds_inst, 0, 50);
+
+    // TEST - half a second
+    sim_run(&test_sim, 500, trace_test_loop, NULL);
+    uint32_t lost;
+    uint32_t num = trace_read(&test_trace, test_out, TRACE_TEST_HOOKS_SIZE, &lost);
+
+    // CHECK - nothing is lost, timestamps are ordered
+    if ((num < 2) || (lost != 0) || (num != trace_get_head(&test_trace))) {
+        return cycle + 10;
+    }
+    for (uint32_t i = 1; i < num; ++i) {
+        if ((int16_t)(test_out[i].time - test_out[i - 1].time) < 0) {
+            return cycle + 20;
+        }
+    }
+
+    // CHECK - timer events
+    if ((trace_test_count(num, TRACE_EVT_SWTIMERS_START, 0) != 1) || (trace_test_count(num, TRACE_EVT_SWTIMERS_EXPIRE, 0) != 50) ||
+        (trace_test_count(num, TRACE_EVT_SWTIMERS_CALL, 0) != 50) || (trace_test_count(num, TRACE_EVT_SWTIMERS_RETURN, 0) != 50)) {
+        return cycle + 30;
+    }
+    if ((trace_test_count(num, TRACE_EVT_SWTIMERS_START, 1) != 0) || (trace_test_count(num, TRACE_EVT_SWTIMERS_STOP, 0) != 0)) {
+        return cycle + 40;
+    }
+
+    // CHECK - each LED write is traced
+    if ((trace_test_count(num, TRACE_EVT_LEDS_WRITE, 0) == 0) ||
+        (trace_test_count(num, TRACE_EVT_LEDS_WRITE, 0) != (test_pins[2].writes_cnt - led_writes))) {
+        return cycle + 50;
+    }
+
+    // CHECK - button edges at 100 ms and 400 ms, press and release events
+    if (trace_test_count(num, TRACE_EVT_BUTTONS_EDGE, 0) != 2) {
+        return cycle + 60;
+    }
+    uint32_t events = 0;
+    for (uint32_t i = 0; i < num; ++i) {
+        if ((test_out[i].event == TRACE_EVT_BUTTONS_EDGE) && (test_out[i].arg == 1) && (test_out[i].time != 100)) {
+            return cycle + 70;
+        }
+        if (test_out[i].event == TRACE_EVT_BUTTONS_EVENT) {
+            events |= test_out[i].arg;
+        }
+    }
+    if ((events & (BUTTONS_PRESSED | BUTTONS_RELEASED)) != (BUTTONS_PRESSED | BUTTONS_RELEASED)) {
+        return cycle + 80;
+    }
+
+    // TEST - stop is traced once
+    swtimers_stop(&test_swtimers_inst, 0);
+    swtimers_stop(&test_swtimers_inst, 0);
+    num = trace_read(&test_trace, test_out, TRACE_TEST_HOOKS_SIZE, NULL);
+    // CHECK
+    if ((num != 1) || (test_out[0].event != TRACE_EVT_SWTIMERS_STOP)) {
+        return cycle + 90;
+    }
+
+    // TEST - detach
+    swtimers_set_trace(&test_swtimers_inst, NULL);
+    leds_set_trace(&test_leds_inst, NULL);
+    buttons_set_trace(&test_buttons_inst, NULL);
+    sim_run(&test_sim, 100, trace_test_loop, NULL);
+    num = trace_read(&test_trace, test_out, TRACE_TEST_HOOKS_SIZE, NULL);
+    // CHECK
+    if (num != 0) {
+        return cycle + 100;
+    }
+
+    buttons_deinit(&test_buttons_inst);
+    leds_deinit(&test_leds_inst);
+    swtimers_deinit(&test_swtimers_inst);
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Timer handler - does nothing
+//-----------------------------------------------------------------------------
+static void trace_test_handler(uint32_t timer_idx, void * arg_1_p, void * arg_2_p)
+{
+    (void)timer_idx;
+    (void)arg_1_p;
+    (void)arg_2_p;
+}
+
+//-----------------------------------------------------------------------------
+// Application loop
+//-----------------------------------------------------------------------------
+static void trace_test_loop(void * arg_p)
+{
+    (void)arg_p;
+    swtimers_task(&test_swtimers_inst);
+    buttons_task(&test_buttons_inst);
+}
+
+//-----------------------------------------------------------------------------
+// Timestamp - virtual time of simulation
+//-----------------------------------------------------------------------------
+static uint32_t trace_test_sim_time(void * timestamp_p)
+{
+    return (uint32_t)sim_get_time_ms((const sim_t*)timestamp_p);
+}
+#endif
+
+//-----------------------------------------------------------------------------
+// Timestamp - value of test variable
+//-----------------------------------------------------------------------------
+static uint32_t trace_test_time(void * timestamp_p)
+{
+    return *(const uint32_t*)timestamp_p;
+}
+
+//-----------------------------------------------------------------------------
+// Count records of event with index in test_out array
+//-----------------------------------------------------------------------------
+static uint32_t trace_test_count(uint32_t num, uint8_t event, uint32_t idx)
+{
+    uint32_t cnt = 0;
+
+    for (uint32_t i = 0; i < num; ++i) {
+        if ((test_out[i].event == event) && (test_out[i].idx == idx)) {
+            cnt++;
+        }
+    }
+
+    return cnt;
+}
@@ -0,0 +1,393 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+//**************************************************************************************************
+// Deterministic virtual-time simulation of hardware for drivers tests
+//**************************************************************************************************
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+
+#include "sim.h"
+
+//==================================================================================================
+//================================ PRIVATE FUNCTIONS DECLARATIONS ==================================
+//==================================================================================================
+
+static void sim_apply_waveform(sim_t * sim_p);
+static uint64_t sim_next_deadline(const sim_t * sim_p, uint64_t end_ms);
+static void sim_advance(sim_t * sim_p, uint64_t time_ms);
+static void sim_record(sim_t * sim_p, uint32_t pin_idx, uint8_t pin_state);
+
+static void sim_timer_isr_enable(void * hw_timer_p);
+static void sim_timer_isr_disable(void * hw_timer_p);
+static void sim_timer_start(void * hw_timer_p);
+static void sim_timer_stop(void * hw_timer_p);
+static bool sim_timer_is_started(void * hw_timer_p);
+static void sim_gpio_write(void * hw_gpio_p, uint32_t pin_idx, uint8_t pin_state);
+static void sim_gpio_toggle(void * hw_gpio_p, uint32_t pin_idx);
+static void sim_gpio_write_port(void * hw_gpio_p, uint32_t port_idx, uint32_t set_mask, uint32_t clear_mask);
+static bool sim_gpio_read(void * hw_gpio_p, uint32_t pin_idx);
+static void sim_gpio_isr_enable(void * hw_gpio_p);
+static void sim_gpio_isr_disable(void * hw_gpio_p);
+
+//==================================================================================================
+//================================ PUBLIC FUNCTIONS DEFINITIONS ====================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Init simulation
+//------------------------------------------------------------------------------
+void sim_init(sim_t * sim_p, uint32_t tick_ms, sim_pin_t * pins_p, uint32_t pins_num, sim_record_t * history_p, uint32_t history_size)
+{
+    assert((sim_p != NULL) && (tick_ms > 0) && (pins_p != NULL) && (pins_num > 0));
+    assert((history_p != NULL) || (history_size == 0));
+
+    memset(sim_p, 0x00, sizeof(sim_t));
+    memset(pins_p, 0x00, pins_num * sizeof(sim_pin_t));
+
+    sim_p->pins_p = pins_p;
+    sim_p->pins_num = pins_num;
+    sim_p->history_p = history_p;
+    sim_p->history_size = history_size;
+
+    sim_p->swtimers_hw.hw_timer_p = sim_p;
+    sim_p->swtimers_hw.isr_enable_cb = sim_timer_isr_enable;
+    sim_p->swtimers_hw.isr_disable_cb = sim_timer_isr_disable;
+    sim_p->swtimers_hw.hw_start_cb = sim_timer_start;
+    sim_p->swtimers_hw.hw_stop_cb = sim_timer_stop;
+    sim_p->swtimers_hw.hw_is_started_cb = sim_timer_is_started;
+    sim_p->swtimers_hw.tick_ms = tick_ms;
+
+    sim_p->leds_hw.hw_gpio_p = sim_p;
+    sim_p->leds_hw.gpio_write = sim_gpio_write;
+    sim_p->leds_hw.gpio_toggle = sim_gpio_toggle;
+    sim_p->leds_hw.gpio_write_port = sim_gpio_write_port;
+
+    sim_p->buttons_hw.hw_gpio_p = sim_p;
+    sim_p->buttons_hw.isr_enable_cb = sim_gpio_isr_enable;
+    sim_p->buttons_hw.isr_disable_cb = sim_gpio_isr_disable;
+    sim_p->buttons_hw.gpio_read = sim_gpio_read;
+}
+
+//------------------------------------------------------------------------------
+// Get hardware interfaces
+//------------------------------------------------------------------------------
+const swtimers_hw_interface_t * sim_get_swtimers_hw(sim_t * sim_p)
+{
+    assert(sim_p != NULL);
+    return &sim_p->swtimers_hw;
+}
+
+const leds_hw_interface_t * sim_get_leds_hw(sim_t * sim_p)
+{
+    assert(sim_p != NULL);
+    return &sim_p->leds_hw;
+}
+
+const buttons_hw_interface_t * sim_get_buttons_hw(sim_t * sim_p)
+{
+    assert(sim_p != NULL);
+    return &sim_p->buttons_hw;
+}
+
+//------------------------------------------------------------------------------
+// Attach software timers driver
+//------------------------------------------------------------------------------
+void sim_attach_swtimers(sim_t * sim_p, const swtimers_t * swtimers_p)
+{
+    assert((sim_p != NULL) && (swtimers_p != NULL));
+    sim_p->swtimers_p = swtimers_p;
+}
+
+//------------------------------------------------------------------------------
+// Set input waveform
+//------------------------------------------------------------------------------
+void sim_set_waveform(sim_t * sim_p, const sim_record_t * wave_p, uint32_t wave_num, sim_input_cb_t input_cb, void * input_arg_p)
+{
+    assert((sim_p != NULL) && ((wave_p != NULL) || (wave_num == 0)));
+
+    for (uint32_t i = 1; i < wave_num; ++i) {
+        assert(wave_p[i - 1].time_ms <= wave_p[i].time_ms);
+    }
+
+    sim_p->wave_p = wave_p;
+    sim_p->wave_num = wave_num;
+    sim_p->wave_pos = 0;
+    sim_p->input_cb = input_cb;
+    sim_p->input_arg_p = input_arg_p;
+}
+
+//------------------------------------------------------------------------------
+// Run simulation
+//------------------------------------------------------------------------------
+void sim_run(sim_t * sim_p, uint64_t duration_ms, sim_loop_cb_t loop_cb, void * loop_arg_p)
+{
+    assert(sim_p != NULL);
+
+    uint64_t end_ms = sim_p->time_ms + duration_ms;
+    uint32_t spins = 0;
+
+    for (;;) {
+        sim_apply_waveform(sim_p);
+
+        if (loop_cb != NULL) {
+            loop_cb(loop_arg_p);
+        }
+
+        // Handlers are waiting for the next loop call at the same moment
+        if ((sim_p->swtimers_p != NULL) && (swtimers_next_expiry_ticks(sim_p->swtimers_p) == 0) && (loop_cb != NULL)) {
+            spins++;
+            assert(spins < SIM_LOOP_SPINS_MAX);
+            continue;
+        }
+        spins = 0;
+
+        if (sim_p->time_ms >= end_ms) {
+            break;
+        }
+
+        sim_advance(sim_p, sim_next_deadline(sim_p, end_ms));
+    }
+}
+
+//------------------------------------------------------------------------------
+// Get current virtual time
+//------------------------------------------------------------------------------
+uint64_t sim_get_time_ms(const sim_t * sim_p)
+{
+    assert(sim_p != NULL);
+    return sim_p->time_ms;
+}
+
+//------------------------------------------------------------------------------
+// Get pin state
+//------------------------------------------------------------------------------
+uint8_t sim_get_pin(const sim_t * sim_p, uint32_t pin_idx)
+{
+    assert((sim_p != NULL) && (pin_idx < sim_p->pins_num));
+    return sim_p->pins_p[pin_idx].state;
+}
+
+//------------------------------------------------------------------------------
+// Find record of output history
+//------------------------------------------------------------------------------
+const sim_record_t * sim_find_record(const sim_t * sim_p, uint32_t pin_idx, uint32_t nth)
+{
+    assert(sim_p != NULL);
+
+    for (uint32_t i = 0; i < sim_p->history_cnt; ++i) {
+        if (sim_p->history_p[i].pin_idx != pin_idx) {
+            continue;
+        }
+        if (nth == 0) {
+            return &sim_p->history_p[i];
+        }
+        nth--;
+    }
+
+    return NULL;
+}
+
+//==================================================================================================
+//================================ PRIVATE FUNCTIONS DEFINITIONS ===================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Apply steps of waveform up to current virtual time
+//
+// `sim_p` - pointer to initialized simulation instance
+//------------------------------------------------------------------------------
+static void sim_apply_waveform(sim_t * sim_p)
+{
+    while ((sim_p->wave_pos < sim_p->wave_num) && (sim_p->wave_p[sim_p->wave_pos].time_ms <= sim_p->time_ms)) {
+        const sim_record_t * step_p = &sim_p->wave_p[sim_p->wave_pos];
+        assert(step_p->pin_idx < sim_p->pins_num);
+        sim_pin_t * pin_p = &sim_p->pins_p[step_p->pin_idx];
+        uint8_t state = (step_p->pin_state != 0) ? (1) : (0);
+
+        sim_p->wave_pos++;
+
+        if (pin_p->state == state) {
+            continue;
+        }
+
+        pin_p->state = state;
+        pin_p->last_ms = sim_p->time_ms;
+
+        // GPIO interrupt can't happen inside critical section
+        assert(sim_p->gpio_isr_depth == 0);
+        if (sim_p->input_cb != NULL) {
+            sim_p->input_cb(sim_p->input_arg_p, step_p->pin_idx, state);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+// Get virtual time of the nearest event - timer expiration or step of waveform
+//
+// `sim_p`  - pointer to initialized simulation instance
+// `end_ms` - end of simulation
+//------------------------------------------------------------------------------
+static uint64_t sim_next_deadline(const sim_t * sim_p, uint64_t end_ms)
+{
+    uint64_t next_ms = end_ms;
+
+    if (sim_p->wave_pos < sim_p->wave_num) {
+        uint64_t wave_ms = sim_p->wave_p[sim_p->wave_pos].time_ms;
+        next_ms = (wave_ms < next_ms) ? (wave_ms) : (next_ms);
+    }
+
+    if ((sim_p->swtimers_p != NULL) && sim_p->is_hw_started) {
+        uint32_t ticks = swtimers_next_expiry_ticks(sim_p->swtimers_p);
+        if (ticks != SWTIMERS_NO_EXPIRY) {
+            uint64_t timer_ms = sim_p->tick_time_ms + ((uint64_t)ticks * sim_p->swtimers_hw.tick_ms);
+            next_ms = (timer_ms < next_ms) ? (timer_ms) : (next_ms);
+        }
+    }
+
+    return (next_ms > sim_p->time_ms) ? (next_ms) : (sim_p->time_ms);
+}
+
+//------------------------------------------------------------------------------
+// Move virtual time forward and pass elapsed ticks into swtimers driver
+//
+// Ticks of hardware timer are aligned to multiples of tick_ms since the simulation start
+//
+// `sim_p`   - pointer to initialized simulation instance
+// `time_ms` - new virtual time
+//------------------------------------------------------------------------------
+static void sim_advance(sim_t * sim_p, uint64_t time_ms)
+{
+    uint64_t ticks = (time_ms - sim_p->tick_time_ms) / sim_p->swtimers_hw.tick_ms;
+
+    sim_p->time_ms = time_ms;
+    sim_p->tick_time_ms += ticks * sim_p->swtimers_hw.tick_ms;
+    sim_p->steps_cnt++;
+
+    // Stopped hardware timer doesn't generate interrupts
+    if ((sim_p->swtimers_p == NULL) || (sim_p->is_hw_started == false)) {
+        return;
+    }
+
+    // Timer interrupt can't happen inside critical section
+    assert(sim_p->timer_isr_depth == 0);
+
+    while (ticks > 0) {
+        uint32_t chunk = (ticks < UINT32_MAX) ? ((uint32_t)ticks) : (UINT32_MAX - 1);
+        swtimers_isr_ticks(sim_p->swtimers_p, chunk);
+        sim_p->ticks_cnt += chunk;
+        ticks -= chunk;
+    }
+}
+
+//------------------------------------------------------------------------------
+// Store change of output into history
+//
+// `sim_p`     - pointer to initialized simulation instance
+// `pin_idx`   - index of GPIO pin
+// `pin_state` - new pin state
+//------------------------------------------------------------------------------
+static void sim_record(sim_t * sim_p, uint32_t pin_idx, uint8_t pin_state)
+{
+    sim_pin_t * pin_p = &sim_p->pins_p[pin_idx];
+
+    pin_p->state = pin_state;
+    pin_p->last_ms = sim_p->time_ms;
+    pin_p->writes_cnt++;
+
+    if (sim_p->history_cnt >= sim_p->history_size) {
+        sim_p->history_lost++;
+        return;
+    }
+
+    sim_record_t * record_p = &sim_p->history_p[sim_p->history_cnt++];
+    record_p->time_ms = sim_p->time_ms;
+    record_p->pin_idx = pin_idx;
+    record_p->pin_state = pin_state;
+}
+
+//------------------------------------------------------------------------------
+// Callbacks of virtual hardware timer
+//------------------------------------------------------------------------------
+static void sim_timer_isr_enable(void * hw_timer_p)
+{
+    sim_t * sim_p = (sim_t*)hw_timer_p;
+    assert(sim_p->timer_isr_depth > 0);
+    sim_p->timer_isr_depth--;
+}
+
+static void sim_timer_isr_disable(void * hw_timer_p)
+{
+    sim_t * sim_p = (sim_t*)hw_timer_p;
+    assert(sim_p->timer_isr_depth < UINT8_MAX);
+    sim_p->timer_isr_depth++;
+}
+
+static void sim_timer_start(void * hw_timer_p)
+{
+    sim_t * sim_p = (sim_t*)hw_timer_p;
+    sim_p->is_hw_started = true;
+}
+
+static void sim_timer_stop(void * hw_timer_p)
+{
+    sim_t * sim_p = (sim_t*)hw_timer_p;
+    sim_p->is_hw_started = false;
+}
+
+static bool sim_timer_is_started(void * hw_timer_p)
+{
+    const sim_t * sim_p = (const sim_t*)hw_timer_p;
+    return sim_p->is_hw_started;
+}
+
+//------------------------------------------------------------------------------
+// Callbacks of virtual GPIO
+//------------------------------------------------------------------------------
+static void sim_gpio_write(void * hw_gpio_p, uint32_t pin_idx, uint8_t pin_state)
+{
+    sim_t * sim_p = (sim_t*)hw_gpio_p;
+    assert(pin_idx < sim_p->pins_num);
+    sim_record(sim_p, pin_idx, (pin_state != 0) ? (1) : (0));
+}
+
+static void sim_gpio_toggle(void * hw_gpio_p, uint32_t pin_idx)
+{
+    sim_t * sim_p = (sim_t*)hw_gpio_p;
+    assert(pin_idx < sim_p->pins_num);
+    sim_record(sim_p, pin_idx, (sim_p->pins_p[pin_idx].state != 0) ? (0) : (1));
+}
+
+static void sim_gpio_write_port(void * hw_gpio_p, uint32_t port_idx, uint32_t set_mask, uint32_t clear_mask)
+{
+    sim_t * sim_p = (sim_t*)hw_gpio_p;
+    assert((set_mask & clear_mask) == 0);
+    for (uint32_t bit = 0; bit < 32; bit++) {
+        if (((set_mask | clear_mask) & (1ul << bit)) != 0) {
+            assert(LEDS_PORT_PIN(port_idx, bit) < sim_p->pins_num);
+            sim_record(sim_p, LEDS_PORT_PIN(port_idx, bit), ((set_mask & (1ul << bit)) != 0) ? (1) : (0));
+        }
+    }
+}
+
+static bool sim_gpio_read(void * hw_gpio_p, uint32_t pin_idx)
+{
+    const sim_t * sim_p = (const sim_t*)hw_gpio_p;
+    assert(pin_idx < sim_p->pins_num);
+    return (sim_p->pins_p[pin_idx].state != 0);
+}
+
+static void sim_gpio_isr_enable(void * hw_gpio_p)
+{
+    sim_t * sim_p = (sim_t*)hw_gpio_p;
+    assert(sim_p->gpio_isr_depth > 0);
+    sim_p->gpio_isr_depth--;
+}
+
+static void sim_gpio_isr_disable(void * hw_gpio_p)
+{
+    sim_t * sim_p = (sim_t*)hw_gpio_p;
+    assert(sim_p->gpio_isr_depth < UINT8_MAX);
+    sim_p->gpio_isr_depth++;
+}
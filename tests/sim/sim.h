@@ -0,0 +1,228 @@
+//**************************************************************************************************
+// Deterministic virtual-time simulation of hardware for drivers tests
+//**************************************************************************************************
+// Provides ready-made hardware interfaces for drv_swtimers, drv_leds and drv_buttons:
+//  - virtual clock - hardware timer of swtimers driver, ticks every `tick_ms` of virtual time
+//  - virtual GPIO pins - outputs record write/toggle history with timestamps, inputs are read by buttons driver
+//    (port writes of LEDs driver are supported, pin index is LEDS_PORT_PIN(port, bit))
+//  - scripted input waveforms - changes of input pins at given moments of virtual time
+//
+// sim_run() fast-forwards virtual time from one deadline to the next one:
+//  - the nearest timer expiration (swtimers_next_expiry_ticks()) or the next change of waveform
+//  - elapsed ticks are passed into swtimers_isr_ticks() with one call
+//  - application loop callback is called after each jump
+// so hours of device time with hundreds of timers are simulated in milliseconds of wall time
+//
+// Simulation is single-threaded and doesn't depend on OS - ISR context is emulated by sim_run(),
+// "interrupts" never happen inside critical sections of drivers (it is checked by assertions)
+//
+// All functions are reenterable:
+//  - simulation doesn't use internal static data
+//  - simulation instance, pins and history are supposed to be stored externally
+//
+//**************************************************************************************************
+// Example
+//**************************************************************************************************
+//  sim_init(&sim, 1, pins, PINS_NUM, history, HISTORY_SIZE);
+//  swtimers_init(&timers_inst, sim_get_swtimers_hw(&sim), TIMERS_NUM, timers);
+//  sim_attach_swtimers(&sim, &timers_inst);
+//  leds_init(&leds_inst, sim_get_leds_hw(&sim), LEDS_NUM, leds, &timers_inst);
+//
+//  leds_meander(&leds_inst, 0, 500);
+//  sim_run(&sim, 3600 * 1000, app_loop, NULL);   // one hour of device time
+//
+//**************************************************************************************************
+
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "drv_swtimers.h"
+#include "drv_leds.h"
+#include "drv_buttons.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//==================================================================================================
+//=========================================== MACROS ===============================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Maximal number of application loop calls without advancing of virtual time
+// (if swtimers_task() still has work to do - application loop doesn't call it)
+//------------------------------------------------------------------------------
+#define SIM_LOOP_SPINS_MAX (1000)
+
+//==================================================================================================
+//========================================== TYPEDEFS ==============================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Change of GPIO pin - record of output history or step of input waveform
+//------------------------------------------------------------------------------
+typedef struct sim_record_s {
+    uint64_t    time_ms;        // virtual time of change in milliseconds
+    uint32_t    pin_idx;        // index of GPIO pin
+    uint8_t     pin_state;      // new pin state, '0' - logical zero, otherwise - logical one
+    uint8_t     align[3];
+} sim_record_t;
+
+//------------------------------------------------------------------------------
+// Virtual GPIO pin
+//------------------------------------------------------------------------------
+typedef struct sim_pin_s {
+    uint64_t    last_ms;        // virtual time of the last change in milliseconds
+    uint32_t    writes_cnt;     // number of write/toggle calls
+    uint8_t     state;          // current state, '0' - logical zero, '1' - logical one
+    uint8_t     align[3];
+} sim_pin_t;
+
+//------------------------------------------------------------------------------
+// Callback - application loop body (calls swtimers_task(), buttons_task() etc.)
+//
+// `arg_p` - pointer to application data, passed over sim_run function (can be NULL)
+//------------------------------------------------------------------------------
+typedef void (*sim_loop_cb_t)(void * arg_p);
+
+//------------------------------------------------------------------------------
+// Callback - change of input pin by waveform (emulates GPIO interrupt, e.g. calls buttons_isr())
+//
+// `arg_p`     - pointer to application data, passed over sim_set_waveform function (can be NULL)
+// `pin_idx`   - index of GPIO pin
+// `pin_state` - new pin state
+//------------------------------------------------------------------------------
+typedef void (*sim_input_cb_t)(void * arg_p, uint32_t pin_idx, uint8_t pin_state);
+
+//------------------------------------------------------------------------------
+// Simulation instance
+//------------------------------------------------------------------------------
+typedef struct sim_s {
+
+    // Virtual clock
+    uint64_t                    time_ms;            // current virtual time in milliseconds
+    uint64_t                    tick_time_ms;       // virtual time of the last tick of hardware timer
+    uint64_t                    ticks_cnt;          // number of ticks passed into swtimers driver
+    uint64_t                    steps_cnt;          // number of jumps of virtual time
+    const swtimers_t*           swtimers_p;         // attached software timers driver instance (can be NULL)
+    bool                        is_hw_started;      // hardware timer is started by swtimers driver
+    uint8_t                     timer_isr_depth;    // nesting of critical sections of swtimers driver
+    uint8_t                     gpio_isr_depth;     // nesting of critical sections of buttons driver
+    uint8_t                     align;
+
+    // Virtual GPIO
+    sim_pin_t*                  pins_p;             // array of pins
+    uint32_t                    pins_num;           // number of pins
+    sim_record_t*               history_p;          // array of output changes (can be NULL)
+    uint32_t                    history_size;       // size of history array
+    uint32_t                    history_cnt;        // number of stored records
+    uint32_t                    history_lost;       // number of records which didn't fit into history array
+
+    // Input waveform
+    const sim_record_t*         wave_p;             // steps of waveform sorted by time (can be NULL)
+    uint32_t                    wave_num;           // number of steps
+    uint32_t                    wave_pos;           // index of the next step
+    sim_input_cb_t              input_cb;           // input change callback (can be NULL)
+    void*                       input_arg_p;        // argument of input change callback
+
+    // Hardware interfaces
+    swtimers_hw_interface_t     swtimers_hw;
+    leds_hw_interface_t         leds_hw;
+    buttons_hw_interface_t      buttons_hw;
+
+} sim_t;
+
+//==================================================================================================
+//================================ PUBLIC FUNCTIONS DECLARATIONS ===================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Init simulation, virtual time is 0, all pins are logical zero
+//
+// `sim_p`        - pointer to simulation instance, can be uninitialized
+// `tick_ms`      - tick of virtual hardware timer in milliseconds (must be > 0)
+// `pins_p`       - pointer to array of pins
+// `pins_num`     - number of pins (must be > 0)
+// `history_p`    - pointer to array for history of outputs (can be NULL)
+// `history_size` - size of history array
+//------------------------------------------------------------------------------
+void sim_init(sim_t * sim_p, uint32_t tick_ms, sim_pin_t * pins_p, uint32_t pins_num, sim_record_t * history_p, uint32_t history_size);
+
+//------------------------------------------------------------------------------
+// Get hardware interfaces to be passed into init functions of drivers
+//
+// `sim_p` - pointer to initialized simulation instance
+//------------------------------------------------------------------------------
+const swtimers_hw_interface_t * sim_get_swtimers_hw(sim_t * sim_p);
+const leds_hw_interface_t * sim_get_leds_hw(sim_t * sim_p);
+const buttons_hw_interface_t * sim_get_buttons_hw(sim_t * sim_p);
+
+//------------------------------------------------------------------------------
+// Attach software timers driver to be driven by virtual clock
+//
+// `sim_p`      - pointer to initialized simulation instance
+// `swtimers_p` - pointer to software timers driver instance initialized with sim_get_swtimers_hw()
+//------------------------------------------------------------------------------
+void sim_attach_swtimers(sim_t * sim_p, const swtimers_t * swtimers_p);
+
+//------------------------------------------------------------------------------
+// Set input waveform
+//
+// Steps with time earlier than current virtual time are applied at the next sim_run() call
+//
+// `sim_p`       - pointer to initialized simulation instance
+// `wave_p`      - pointer to array of steps sorted by time (array must be alive until the end of simulation)
+// `wave_num`    - number of steps
+// `input_cb`    - input change callback (can be NULL)
+// `input_arg_p` - pointer to application data to be passed into callback (can be NULL)
+//------------------------------------------------------------------------------
+void sim_set_waveform(sim_t * sim_p, const sim_record_t * wave_p, uint32_t wave_num, sim_input_cb_t input_cb, void * input_arg_p);
+
+//------------------------------------------------------------------------------
+// Run simulation
+//
+// Application loop is called at current virtual time and after each jump of virtual time
+//
+// `sim_p`       - pointer to initialized simulation instance
+// `duration_ms` - duration of simulation in milliseconds of virtual time
+// `loop_cb`     - application loop callback (can be NULL)
+// `loop_arg_p`  - pointer to application data to be passed into callback (can be NULL)
+//------------------------------------------------------------------------------
+void sim_run(sim_t * sim_p, uint64_t duration_ms, sim_loop_cb_t loop_cb, void * loop_arg_p);
+
+//------------------------------------------------------------------------------
+// Get current virtual time in milliseconds
+//
+// `sim_p` - pointer to initialized simulation instance
+//------------------------------------------------------------------------------
+uint64_t sim_get_time_ms(const sim_t * sim_p);
+
+//------------------------------------------------------------------------------
+// Get pin state
+//
+// `sim_p`   - pointer to initialized simulation instance
+// `pin_idx` - index of GPIO pin
+//
+// Returns - '0' - logical zero, '1' - logical one
+//------------------------------------------------------------------------------
+uint8_t sim_get_pin(const sim_t * sim_p, uint32_t pin_idx);
+
+//------------------------------------------------------------------------------
+// Find record of output history
+//
+// `sim_p`   - pointer to initialized simulation instance
+// `pin_idx` - index of GPIO pin
+// `nth`     - number of record of the pin (0 - the first record)
+//
+// Returns - pointer to record or NULL if there is no such record
+//------------------------------------------------------------------------------
+const sim_record_t * sim_find_record(const sim_t * sim_p, uint32_t pin_idx, uint32_t nth);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // SIM_H
@@ -0,0 +1,77 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+//**************************************************************************************************
+// Host runner of drivers tests on virtual-time simulation of hardware
+//**************************************************************************************************
+#include <stdio.h>
+#include <time.h>
+
+#include "drv_swtimers.h"
+#include "drv_leds.h"
+#include "drv_buttons.h"
+#include "drv_prof.h"
+#include "drv_trace.h"
+#include "drv_idle.h"
+#include "drv_pt.h"
+#include "drv_cyclic.h"
+#include "drv_mpsc.h"
+#include "drv_swtimers_shard.h"
+#include "drv_swtimers_mt.h"
+#include "drv_swtimers_posix.h"
+#include "drv_swtimers_par.h"
+
+//==================================================================================================
+//========================================== TYPEDEFS ==============================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Test suite of one driver
+//------------------------------------------------------------------------------
+typedef struct sim_main_suite_s {
+    const char*     name_p;         // name of the driver
+    int32_t         (*tests_cb)(void);
+} sim_main_suite_t;
+
+//==================================================================================================
+//================================ PUBLIC FUNCTIONS DEFINITIONS ====================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Run all test suites
+// Returns - 0 if all tests are successful, 1 otherwise
+//------------------------------------------------------------------------------
+int main(void)
+{
+    static const sim_main_suite_t suites[] = {
+        { "swtimers", swtimers_tests },
+        { "leds",     leds_tests },
+        { "buttons",  buttons_tests },
+        { "prof",     prof_tests },
+        { "trace",    trace_tests },
+        { "idle",     drv_idle_tests },
+        { "pt",       pt_tests },
+        { "cyclic",   cyclic_tests },
+        { "mpsc",     mpsc_tests },
+        { "shard",    swtimers_shard_tests },
+#if defined(__linux__)
+        { "mt",       swtimers_mt_tests },
+        { "posix",    swtimers_posix_tests },
+        { "par",      swtimers_par_tests },
+#endif
+    };
+    int result = 0;
+
+    for (size_t i = 0; i < sizeof(suites) / sizeof(suites[0]); ++i) {
+        clock_t start = clock();
+        int32_t res = suites[i].tests_cb();
+        double wall_ms = 1000.0 * (double)(clock() - start) / CLOCKS_PER_SEC;
+
+        printf("%-10s %s (%d), %.1f ms\n", suites[i].name_p, (res == 0) ? "OK" : "FAILED", (int)res, wall_ms);
+        if (res != 0) {
+            result = 1;
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,276 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+//**************************************************************************************************
+// Host decoder of drv_trace records into Chrome trace JSON (chrome://tracing, ui.perfetto.dev)
+//**************************************************************************************************
+// Usage: trace_decode [--head=N] [--ts-per-us=N] <file>
+//  --head      - value of trace_get_head() for RAM dump of the whole array of records
+//                (the oldest record is at N % size), without it records are decoded in file order
+//                (stream of trace_read() output)
+//  --ts-per-us - timestamp units per microsecond (default 1, e.g. 72 for DWT->CYCCNT at 72 MHz)
+//
+// Input is an array of 8-byte little-endian records (see trace_record_t in drv_trace.h)
+// Output JSON is written to stdout:
+//  - handlers of timers are duration events ("B"/"E"), one track per timer
+//  - other records are instant events, one track per driver
+//
+// Absolute time is restored from TRACE_EVT_SYNC records and signed 16-bit deltas between records
+// (records before the first TRACE_EVT_SYNC of RAM dump can't be placed in time and are skipped)
+//**************************************************************************************************
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//==================================================================================================
+//=========================================== MACROS ===============================================
+//==================================================================================================
+
+#define TRACE_DECODE_RECORD_SIZE        (8)
+#define TRACE_DECODE_HANDLER_TID        (100)   // track of timer N handlers is (TRACE_DECODE_HANDLER_TID + N)
+
+// Event types (binary format of drv_trace.h)
+#define TRACE_DECODE_SYNC               (0)
+#define TRACE_DECODE_SWTIMERS_START     (1)
+#define TRACE_DECODE_SWTIMERS_STOP      (2)
+#define TRACE_DECODE_SWTIMERS_EXPIRE    (3)
+#define TRACE_DECODE_SWTIMERS_CALL      (4)
+#define TRACE_DECODE_SWTIMERS_RETURN    (5)
+#define TRACE_DECODE_LEDS_WRITE         (6)
+#define TRACE_DECODE_BUTTONS_EDGE       (7)
+#define TRACE_DECODE_BUTTONS_EVENT      (8)
+#define TRACE_DECODE_EVENTS_NUM         (9)
+
+//==================================================================================================
+//========================================== TYPEDEFS ==============================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Decoded record
+//------------------------------------------------------------------------------
+typedef struct trace_decode_record_s {
+    uint16_t    time;
+    uint8_t     event;
+    uint8_t     arg;
+    uint16_t    idx;
+    uint16_t    ext;
+} trace_decode_record_t;
+
+//------------------------------------------------------------------------------
+// Description of event type
+//------------------------------------------------------------------------------
+typedef struct trace_decode_event_s {
+    const char* name_p;     // name of event
+    const char* cat_p;      // driver
+    int         tid;        // track of instant event
+} trace_decode_event_t;
+
+//==================================================================================================
+//================================ PRIVATE FUNCTIONS DECLARATIONS ==================================
+//==================================================================================================
+
+static trace_decode_record_t trace_decode_parse(const uint8_t * bytes_p);
+static void trace_decode_print(const trace_decode_record_t * record_p, uint64_t time, double ts_per_us, bool * is_first_p);
+
+//==================================================================================================
+//=========================================== DATA =================================================
+//==================================================================================================
+
+static const trace_decode_event_t trace_decode_events[TRACE_DECODE_EVENTS_NUM] = {
+    [TRACE_DECODE_SYNC]             = { "sync",   "trace",    0 },
+    [TRACE_DECODE_SWTIMERS_START]   = { "start",  "swtimers", 1 },
+    [TRACE_DECODE_SWTIMERS_STOP]    = { "stop",   "swtimers", 1 },
+    [TRACE_DECODE_SWTIMERS_EXPIRE]  = { "expire", "swtimers", 1 },
+    [TRACE_DECODE_SWTIMERS_CALL]    = { "timer",  "swtimers", 1 },
+    [TRACE_DECODE_SWTIMERS_RETURN]  = { "timer",  "swtimers", 1 },
+    [TRACE_DECODE_LEDS_WRITE]       = { "write",  "leds",     2 },
+    [TRACE_DECODE_BUTTONS_EDGE]     = { "edge",   "buttons",  3 },
+    [TRACE_DECODE_BUTTONS_EVENT]    = { "event",  "buttons",  3 },
+};
+
+//==================================================================================================
+//================================ PUBLIC FUNCTIONS DEFINITIONS ====================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Decode file of records into Chrome trace JSON
+// Returns - 0 on success, 1 on wrong arguments or file
+//------------------------------------------------------------------------------
+int main(int argc, char * argv[])
+{
+    const char * file_name_p = NULL;
+    bool is_head = false;
+    uint32_t head = 0;
+    double ts_per_us = 1.0;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strncmp(argv[i], "--head=", 7) == 0) {
+            head = (uint32_t)strtoul(argv[i] + 7, NULL, 0);
+            is_head = true;
+        }
+        else if (strncmp(argv[i], "--ts-per-us=", 12) == 0) {
+            ts_per_us = strtod(argv[i] + 12, NULL);
+        }
+        else if ((argv[i][0] != '-') && (file_name_p == NULL)) {
+            file_name_p = argv[i];
+        }
+        else {
+            file_name_p = NULL;
+            break;
+        }
+    }
+    if ((file_name_p == NULL) || !(ts_per_us > 0.0)) {
+        fprintf(stderr, "Usage: %s [--head=N] [--ts-per-us=N] <file>\n", argv[0]);
+        return 1;
+    }
+
+    FILE * file_p = fopen(file_name_p, "rb");
+    if (file_p == NULL) {
+        fprintf(stderr, "Can't open %s\n", file_name_p);
+        return 1;
+    }
+
+    // Read the whole file
+    size_t size = 0;
+    size_t capacity = 4096;
+    uint8_t * data_p = malloc(capacity);
+    size_t len;
+    while ((data_p != NULL) && ((len = fread(data_p + size, 1, capacity - size, file_p)) > 0)) {
+        size += len;
+        if (size == capacity) {
+            capacity *= 2;
+            uint8_t * new_data_p = realloc(data_p, capacity);
+            if (new_data_p == NULL) {
+                free(data_p);
+            }
+            data_p = new_data_p;
+        }
+    }
+    fclose(file_p);
+    if (data_p == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+
+    size_t ring_size = size / TRACE_DECODE_RECORD_SIZE;
+    size_t num = ring_size;
+    size_t start = 0;
+
+    // RAM dump - unroll ring, unwritten records are skipped
+    if (is_head && (head < ring_size)) {
+        num = head;
+    }
+    else if (is_head && (ring_size != 0)) {
+        start = head % ring_size;
+    }
+
+    printf("{\"traceEvents\":[\n");
+    bool is_first = true;
+
+    // Names of tracks
+    static const char * const tracks[] = { "trace", "swtimers", "leds", "buttons" };
+    for (size_t i = 0; i < sizeof(tracks) / sizeof(tracks[0]); ++i) {
+        printf("%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%zu,\"args\":{\"name\":\"%s\"}}",
+               (is_first) ? "" : ",\n", i, tracks[i]);
+        is_first = false;
+    }
+
+    // Skip records before the first synchronization (delta to it doesn't fit into 16 bits)
+    size_t first = 0;
+    while ((first < num) && (data_p[((start + first) % ring_size) * TRACE_DECODE_RECORD_SIZE + 2] != TRACE_DECODE_SYNC)) {
+        first++;
+    }
+    if (first == num) {
+        first = 0;
+        fprintf(stderr, "No synchronization records, time is relative to the first record\n");
+    }
+    else if (first != 0) {
+        fprintf(stderr, "%zu records before the first synchronization are skipped\n", first);
+    }
+
+    uint64_t time = 0;
+    for (size_t i = first; i < num; ++i) {
+        trace_decode_record_t record = trace_decode_parse(&data_p[((start + i) % ring_size) * TRACE_DECODE_RECORD_SIZE]);
+
+        if (record.event == TRACE_DECODE_SYNC) {
+            // Full 32-bit timestamp, 64-bit time is unwrapped with signed difference
+            uint32_t sync = ((uint32_t)record.idx << 16) | record.time;
+            time = (i == first) ? (sync) : (time + (uint64_t)(int64_t)(int32_t)(sync - (uint32_t)time));
+        }
+        else {
+            // Records can be slightly out of order (ISR between timestamp reading and writing of record)
+            time += (uint64_t)(int64_t)(int16_t)(record.time - (uint16_t)time);
+        }
+
+        trace_decode_print(&record, time, ts_per_us, &is_first);
+    }
+
+    printf("\n],\"displayTimeUnit\":\"ms\"}\n");
+
+    free(data_p);
+    return 0;
+}
+
+//==================================================================================================
+//================================ PRIVATE FUNCTIONS DEFINITIONS ===================================
+//==================================================================================================
+
+//------------------------------------------------------------------------------
+// Parse little-endian record
+//
+// `bytes_p` - pointer to 8 bytes of record
+//
+// Returns - decoded record
+//------------------------------------------------------------------------------
+static trace_decode_record_t trace_decode_parse(const uint8_t * bytes_p)
+{
+    trace_decode_record_t record;
+
+    record.time = (uint16_t)(bytes_p[0] | (bytes_p[1] << 8));
+    record.event = bytes_p[2];
+    record.arg = bytes_p[3];
+    record.idx = (uint16_t)(bytes_p[4] | (bytes_p[5] << 8));
+    record.ext = (uint16_t)(bytes_p[6] | (bytes_p[7] << 8));
+
+    return record;
+}
+
+//------------------------------------------------------------------------------
+// Print JSON object of record
+//
+// `record_p`   - pointer to record
+// `time`       - absolute time of record in timestamp units
+// `ts_per_us`  - timestamp units per microsecond
+// `is_first_p` - in/out - 'true' if there were no objects printed
+//------------------------------------------------------------------------------
+static void trace_decode_print(const trace_decode_record_t * record_p, uint64_t time, double ts_per_us, bool * is_first_p)
+{
+    double ts = (double)time / ts_per_us;
+    const char * separator_p = (*is_first_p) ? "" : ",\n";
+
+    if (record_p->event >= TRACE_DECODE_EVENTS_NUM) {
+        fprintf(stderr, "Unknown event %u at %.3f us\n", record_p->event, ts);
+        return;
+    }
+    if (record_p->event == TRACE_DECODE_SYNC) {
+        return;
+    }
+
+    const trace_decode_event_t * event_p = &trace_decode_events[record_p->event];
+    *is_first_p = false;
+
+    if ((record_p->event == TRACE_DECODE_SWTIMERS_CALL) || (record_p->event == TRACE_DECODE_SWTIMERS_RETURN)) {
+        printf("%s{\"name\":\"%s %u\",\"cat\":\"%s\",\"ph\":\"%s\",\"ts\":%.3f,\"pid\":1,\"tid\":%d,\"args\":{\"mode\":%u}}",
+               separator_p, event_p->name_p, record_p->idx, event_p->cat_p,
+               (record_p->event == TRACE_DECODE_SWTIMERS_CALL) ? "B" : "E",
+               ts, TRACE_DECODE_HANDLER_TID + record_p->idx, record_p->arg);
+        return;
+    }
+
+    printf("%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":1,\"tid\":%d,"
+           "\"args\":{\"idx\":%u,\"arg\":%u,\"ext\":%u}}",
+           separator_p, event_p->name_p, event_p->cat_p, ts, event_p->tid, record_p->idx, record_p->arg, record_p->ext);
+}